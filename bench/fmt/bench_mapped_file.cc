@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include <walle/fmt/posix.h>
+#include <walle/wsl/stack_buffer.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+static const size_t kFileSize = 64 << 20;
+
+static std::string make_file()
+{
+    char name[] = "/tmp/walle_bench_XXXXXX";
+    int fd = mkstemp(name);
+    std::string line(79, 'x');
+    line.push_back('\n');
+    std::string chunk;
+    while (chunk.size() < (1 << 20)) {
+        chunk += line;
+    }
+    for (size_t written = 0; written < kFileSize; written += chunk.size()) {
+        if (write(fd, chunk.data(), chunk.size()) != static_cast<ssize_t>(chunk.size())) {
+            abort();
+        }
+    }
+    ::close(fd);
+    return name;
+}
+
+static void remove_file();
+
+static const std::string &bench_file()
+{
+    static const std::string path = make_file();
+    static const int registered = atexit(remove_file);
+    (void)registered;
+    return path;
+}
+
+static void remove_file()
+{
+    unlink(bench_file().c_str());
+}
+
+// a cheap pass over every byte, so the cost of getting the bytes shows.
+static uint64_t checksum(const char *p, size_t n)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i + 8 <= n; i += 8) {
+        uint64_t v;
+        memcpy(&v, p + i, 8);
+        sum ^= v;
+    }
+    return sum;
+}
+
+// read the file chunk by chunk into a stack_buffer.
+static void BM_read_chunks(benchmark::State &state)
+{
+    const std::string &path = bench_file();
+    for (auto _ : state) {
+        FILE *f = fopen(path.c_str(), "rb");
+        wsl::stack_buffer<char, 1 << 16> buf;
+        buf.resize(1 << 16);
+        uint64_t sum = 0;
+        size_t n;
+        while ((n = fread(buf.data(), 1, buf.size(), f)) > 0) {
+            sum ^= checksum(buf.data(), n);
+        }
+        fclose(f);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * kFileSize);
+}
+BENCHMARK(BM_read_chunks)->Unit(benchmark::kMillisecond);
+
+// scan the mapping in place.
+static void BM_mapped_file(benchmark::State &state)
+{
+    const std::string &path = bench_file();
+    for (auto _ : state) {
+        walle::mapped_file mf(path, walle::mapped_file::READ_ONLY, walle::mapped_file::POPULATE);
+        mf.advise(walle::mapped_file::SEQUENTIAL);
+        benchmark::DoNotOptimize(checksum(mf.data(), mf.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * kFileSize);
+}
+BENCHMARK(BM_mapped_file)->Unit(benchmark::kMillisecond);
+
+// the mapping set up once, e.g. a file parsed in several passes.
+static void BM_mapped_file_scan(benchmark::State &state)
+{
+    walle::mapped_file mf(bench_file(), walle::mapped_file::READ_ONLY, walle::mapped_file::POPULATE);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(checksum(mf.data(), mf.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * kFileSize);
+}
+BENCHMARK(BM_mapped_file_scan)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
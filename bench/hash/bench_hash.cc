@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+#include <walle/hash/hash.h>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+// the byte at a time fnv-1a loop wsl::hash used before.
+static uint64_t fnv1a(const void *data, size_t len)
+{
+    const unsigned char *p = static_cast<const unsigned char*>(data);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+// a rotating set of keys so the branch predictor does not learn one key.
+static std::vector<std::string> make_keys(size_t len)
+{
+    std::mt19937 rng(5);
+    std::vector<std::string> keys(64);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        for (size_t j = 0; j < len; ++j) {
+            keys[i].push_back(static_cast<char>('a' + rng() % 26));
+        }
+    }
+    return keys;
+}
+
+static void BM_hash64(benchmark::State &state)
+{
+    const std::vector<std::string> keys = make_keys(state.range(0));
+    size_t i = 0;
+    for (auto _ : state) {
+        const std::string &k = keys[i++ & 63];
+        benchmark::DoNotOptimize(walle::hash64(k.data(), k.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_hash64)->Arg(4)->Arg(8)->Arg(16)->Arg(32)->Arg(64)->Arg(256)->Arg(1024)->Arg(4096);
+
+static void BM_fnv1a(benchmark::State &state)
+{
+    const std::vector<std::string> keys = make_keys(state.range(0));
+    size_t i = 0;
+    for (auto _ : state) {
+        const std::string &k = keys[i++ & 63];
+        benchmark::DoNotOptimize(fnv1a(k.data(), k.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_fnv1a)->Arg(4)->Arg(8)->Arg(16)->Arg(32)->Arg(64)->Arg(256)->Arg(1024)->Arg(4096);
+
+// libstdc++ murmur2 based std::hash<std::string>.
+static void BM_std_hash(benchmark::State &state)
+{
+    const std::vector<std::string> keys = make_keys(state.range(0));
+    std::hash<std::string> h;
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(h(keys[i++ & 63]));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_std_hash)->Arg(4)->Arg(8)->Arg(16)->Arg(32)->Arg(64)->Arg(256)->Arg(1024)->Arg(4096);
+
+static void BM_hasher_streaming(benchmark::State &state)
+{
+    const std::vector<std::string> keys = make_keys(4096);
+    const size_t chunk = state.range(0);
+    for (auto _ : state) {
+        walle::hasher h;
+        const std::string &k = keys[0];
+        for (size_t off = 0; off < k.size(); off += chunk) {
+            h.update(k.data() + off, std::min(chunk, k.size() - off));
+        }
+        benchmark::DoNotOptimize(h.digest());
+    }
+    state.SetBytesProcessed(state.iterations() * 4096);
+}
+BENCHMARK(BM_hasher_streaming)->Arg(16)->Arg(100)->Arg(4096);
+
+static void BM_hash_int(benchmark::State &state)
+{
+    uint64_t key = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(walle::hash_int(key++));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_hash_int);
+
+static void BM_hash64_of_int(benchmark::State &state)
+{
+    uint64_t key = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(walle::hash64(&key, sizeof(key)));
+        ++key;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_hash64_of_int);
+
+BENCHMARK_MAIN();
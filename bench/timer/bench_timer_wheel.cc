@@ -0,0 +1,148 @@
+#include <benchmark/benchmark.h>
+#include <walle/timer/timer_wheel.h>
+#include <walle/wsl/skip_list.h>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+static const uint64_t kNotArmed = ~uint64_t(0);
+
+// a deadline ordered timer queue as it is built on a skip list: arm and
+// cancel are O(log n) insert/erase, expiry pops from the front.
+class skip_list_timer_queue {
+public:
+    typedef std::pair<uint64_t, uint32_t> key_type;
+
+    void schedule(uint32_t id, uint64_t deadline)
+    {
+        if (_deadlines.size() <= id) {
+            _deadlines.resize(id + 1, kNotArmed);
+        }
+        cancel(id);
+        _deadlines[id] = deadline;
+        _queue.insert(key_type(deadline, id));
+    }
+
+    void cancel(uint32_t id)
+    {
+        if (_deadlines[id] != kNotArmed) {
+            _queue.erase(key_type(_deadlines[id], id));
+            _deadlines[id] = kNotArmed;
+        }
+    }
+
+    size_t advance(uint64_t now)
+    {
+        size_t fired = 0;
+        while (!_queue.empty() && _queue.begin()->first <= now) {
+            _deadlines[_queue.begin()->second] = kNotArmed;
+            _queue.erase(_queue.begin());
+            ++fired;
+        }
+        return fired;
+    }
+
+private:
+    wsl::multi_skip_list<key_type> _queue;
+    std::vector<uint64_t>          _deadlines;
+};
+
+static std::vector<uint64_t> make_deadlines(size_t n, uint64_t horizon)
+{
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<uint64_t> dist(1, horizon);
+    std::vector<uint64_t> out(n);
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = dist(rng);
+    }
+    return out;
+}
+
+static void noop(walle::timer_entry &)
+{
+}
+
+// re-arm a random pending timer: the request deadline/retry pattern.
+static void BM_timer_wheel_rearm(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const std::vector<uint64_t> deadlines = make_deadlines(n * 2, 1000000);
+    walle::timer_wheel wheel;
+    std::vector<walle::timer_entry> entries(n);
+    for (size_t i = 0; i < n; ++i) {
+        entries[i].set_callback(walle::timer_entry::callback_type::make<noop>());
+        wheel.schedule(entries[i], deadlines[i]);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        wheel.schedule(entries[i % n], deadlines[i % (n * 2)]);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_timer_wheel_rearm)->Range(1 << 10, 1 << 20);
+
+static void BM_skip_list_rearm(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const std::vector<uint64_t> deadlines = make_deadlines(n * 2, 1000000);
+    skip_list_timer_queue queue;
+    for (size_t i = 0; i < n; ++i) {
+        queue.schedule(i, deadlines[i]);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        queue.schedule(i % n, deadlines[i % (n * 2)]);
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_skip_list_rearm)->Range(1 << 10, 1 << 20);
+
+// arm n timers, then expire all of them with one advance() per tick.
+static void BM_timer_wheel_expire(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const uint64_t horizon = 100000;
+    const std::vector<uint64_t> deadlines = make_deadlines(n, horizon);
+    std::vector<walle::timer_entry> entries(n);
+    for (size_t i = 0; i < n; ++i) {
+        entries[i].set_callback(walle::timer_entry::callback_type::make<noop>());
+    }
+    for (auto _ : state) {
+        walle::timer_wheel wheel;
+        for (size_t i = 0; i < n; ++i) {
+            wheel.schedule(entries[i], deadlines[i]);
+        }
+        size_t fired = 0;
+        for (uint64_t now = 1; now <= horizon; ++now) {
+            fired += wheel.advance(now);
+        }
+        benchmark::DoNotOptimize(fired);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_timer_wheel_expire)->Range(1 << 10, 1 << 20);
+
+static void BM_skip_list_expire(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const uint64_t horizon = 100000;
+    const std::vector<uint64_t> deadlines = make_deadlines(n, horizon);
+    for (auto _ : state) {
+        skip_list_timer_queue queue;
+        for (size_t i = 0; i < n; ++i) {
+            queue.schedule(i, deadlines[i]);
+        }
+        size_t fired = 0;
+        for (uint64_t now = 1; now <= horizon; ++now) {
+            fired += queue.advance(now);
+        }
+        benchmark::DoNotOptimize(fired);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_skip_list_expire)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,171 @@
+#include <benchmark/benchmark.h>
+#include <walle/unicode/utf.h>
+#include <codecvt>
+#include <locale>
+#include <random>
+#include <string>
+
+static const size_t kTextSize = 1 << 20;
+
+static void append_utf8(std::string &s, uint32_t cp)
+{
+    if (cp < 0x80) {
+        s += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        s += static_cast<char>(0xc0 | (cp >> 6));
+        s += static_cast<char>(0x80 | (cp & 0x3f));
+    } else if (cp < 0x10000) {
+        s += static_cast<char>(0xe0 | (cp >> 12));
+        s += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        s += static_cast<char>(0x80 | (cp & 0x3f));
+    } else {
+        s += static_cast<char>(0xf0 | (cp >> 18));
+        s += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+        s += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        s += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+}
+
+// 0 ascii (json like payloads), 1 latin text with an accent every ~12
+// bytes, 2 cjk text with ascii punctuation, 3 emoji in ascii text.
+static const std::string &text(int kind)
+{
+    static std::string texts[4];
+    std::string &s = texts[kind];
+    if (s.empty()) {
+        std::mt19937 rng(kind);
+        while (s.size() < kTextSize) {
+            const uint32_t r = rng() % 100;
+            switch (kind) {
+            case 0:
+                s += static_cast<char>(' ' + rng() % 95);
+                break;
+            case 1:
+                append_utf8(s, r < 8 ? 0xc0 + rng() % 0x40 : 'a' + rng() % 26);
+                break;
+            case 2:
+                append_utf8(s, r < 85 ? 0x4e00 + rng() % 0x5000 : ' ' + rng() % 32);
+                break;
+            default:
+                append_utf8(s, r < 5 ? 0x1f600 + rng() % 0x50 : 'a' + rng() % 26);
+                break;
+            }
+        }
+    }
+    return s;
+}
+
+// the usual branchy decoder loop.
+static bool scalar_validate(const std::string &s)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(s.data());
+    const size_t n = s.size();
+    size_t i = 0;
+    while (i < n) {
+        const unsigned char b = p[i];
+        if (b < 0x80) {
+            ++i;
+            continue;
+        }
+        unsigned char lo = 0x80;
+        unsigned char hi = 0xbf;
+        size_t len;
+        if (b >= 0xc2 && b <= 0xdf) {
+            len = 2;
+        } else if (b >= 0xe0 && b <= 0xef) {
+            len = 3;
+            lo = b == 0xe0 ? 0xa0 : 0x80;
+            hi = b == 0xed ? 0x9f : 0xbf;
+        } else if (b >= 0xf0 && b <= 0xf4) {
+            len = 4;
+            lo = b == 0xf0 ? 0x90 : 0x80;
+            hi = b == 0xf4 ? 0x8f : 0xbf;
+        } else {
+            return false;
+        }
+        if (n - i < len || p[i + 1] < lo || p[i + 1] > hi) {
+            return false;
+        }
+        for (size_t k = 2; k < len; ++k) {
+            if ((p[i + k] & 0xc0) != 0x80) {
+                return false;
+            }
+        }
+        i += len;
+    }
+    return true;
+}
+
+static void BM_scalar_validate(benchmark::State &state)
+{
+    const std::string &s = text(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(scalar_validate(s));
+    }
+    state.SetBytesProcessed(state.iterations() * s.size());
+}
+
+static void BM_validate_utf8(benchmark::State &state)
+{
+    const std::string &s = text(static_cast<int>(state.range(0)));
+    if (!walle::utf_detail::set_isa(static_cast<wsl::internal::simd_isa>(state.range(1)))) {
+        state.SkipWithError("isa not supported");
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(walle::validate_utf8(s.data(), s.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * s.size());
+    walle::utf_detail::set_isa(wsl::internal::best_simd_isa());
+}
+
+static void BM_utf16_length_from_utf8(benchmark::State &state)
+{
+    const std::string &s = text(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(walle::utf16_length_from_utf8(s.data(), s.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * s.size());
+}
+
+static void BM_codecvt_utf8_to_utf16(benchmark::State &state)
+{
+    const std::string &s = text(static_cast<int>(state.range(0)));
+    std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> convert;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(convert.from_bytes(s));
+    }
+    state.SetBytesProcessed(state.iterations() * s.size());
+}
+
+static void BM_convert_utf8_to_utf16(benchmark::State &state)
+{
+    const std::string &s = text(static_cast<int>(state.range(0)));
+    std::u16string out(s.size(), 0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(walle::convert_utf8_to_utf16(s.data(), s.size(), &out[0]));
+    }
+    state.SetBytesProcessed(state.iterations() * s.size());
+}
+
+static void BM_convert_utf16_to_utf8(benchmark::State &state)
+{
+    const std::string &s = text(static_cast<int>(state.range(0)));
+    std::u16string in(s.size(), 0);
+    in.resize(walle::convert_utf8_to_utf16(s.data(), s.size(), &in[0]).count);
+    std::string out(in.size() * 3, 0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(walle::convert_utf16_to_utf8(in.data(), in.size(), &out[0]));
+    }
+    state.SetBytesProcessed(state.iterations() * s.size());
+}
+
+// arg: text kind, and the isa for the validation.
+BENCHMARK(BM_scalar_validate)->DenseRange(0, 3);
+BENCHMARK(BM_validate_utf8)->ArgsProduct({{0, 1, 2, 3}, {wsl::internal::kSimdSse2, wsl::internal::kSimdAvx2}});
+BENCHMARK(BM_utf16_length_from_utf8)->DenseRange(0, 3);
+BENCHMARK(BM_codecvt_utf8_to_utf16)->DenseRange(0, 3);
+BENCHMARK(BM_convert_utf8_to_utf16)->DenseRange(0, 3);
+BENCHMARK(BM_convert_utf16_to_utf8)->DenseRange(0, 3);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,52 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/allocator.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// random reads over a table much larger than the tlb reach of 4 KB pages,
+// every access is a likely dtlb miss unless the table sits in huge pages.
+template <typename Allocator>
+static void BM_random_access(benchmark::State &state)
+{
+    const size_t n = (size_t(state.range(0)) << 20) / sizeof(uint64_t);
+    std::vector<uint64_t, Allocator> table(n);
+    for (size_t i = 0; i < n; ++i) {
+        table[i] = i * 0x9e3779b97f4a7c15ull;
+    }
+    uint64_t x = 88172645463325252ull;
+    uint64_t sum = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < 1024; ++i) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            sum += table[x % n];
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK_TEMPLATE(BM_random_access, std::allocator<uint64_t>)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_random_access, wsl::huge_page_allocator<uint64_t>)->Arg(16)->Arg(256);
+
+// allocate and first touch, the huge page path faults once per 2 MB.
+template <typename Allocator>
+static void BM_allocate_touch(benchmark::State &state)
+{
+    const size_t n = (size_t(state.range(0)) << 20) / sizeof(uint64_t);
+    Allocator alloc;
+    for (auto _ : state) {
+        uint64_t *p = alloc.allocate(n);
+        for (size_t i = 0; i < n; i += 512) {
+            p[i] = i;
+        }
+        benchmark::DoNotOptimize(p);
+        alloc.deallocate(p, n);
+    }
+    state.SetBytesProcessed(state.iterations() * n * sizeof(uint64_t));
+}
+BENCHMARK_TEMPLATE(BM_allocate_touch, std::allocator<uint64_t>)->Arg(64);
+BENCHMARK_TEMPLATE(BM_allocate_touch, wsl::huge_page_allocator<uint64_t>)->Arg(64);
+
+BENCHMARK_MAIN();
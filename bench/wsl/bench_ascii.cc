@@ -0,0 +1,232 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/ascii.h>
+#include <walle/wsl/string_view.h>
+#include <random>
+#include <string>
+#include <strings.h>
+#include <vector>
+
+static std::string make_text(size_t n)
+{
+    std::mt19937 rng(9);
+    std::string s;
+    for (size_t i = 0; i < n; ++i) {
+        s.push_back(static_cast<char>(32 + rng() % 95));
+    }
+    return s;
+}
+
+static void set_isa(benchmark::State &state)
+{
+    if (!wsl::internal::set_ascii_isa(static_cast<wsl::internal::simd_isa>(state.range(1)))) {
+        state.SkipWithError("isa not supported");
+    }
+}
+
+// the per character ascii::to_lower(int) loop.
+static void BM_to_lower_per_char(benchmark::State &state)
+{
+    std::string text = make_text(state.range(0));
+    for (auto _ : state) {
+        for (size_t i = 0; i < text.size(); ++i) {
+            text[i] = static_cast<char>(wsl::ascii::to_lower(static_cast<unsigned char>(text[i])));
+        }
+        benchmark::DoNotOptimize(text.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_to_lower_per_char)->Arg(64)->Arg(4096);
+
+static void BM_to_lower_bulk(benchmark::State &state)
+{
+    set_isa(state);
+    std::string text = make_text(state.range(0));
+    for (auto _ : state) {
+        wsl::ascii::to_lower(wsl::buffer_view<char>(&text[0], text.size()));
+        benchmark::DoNotOptimize(text.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_to_lower_bulk)->Args({64, 0})->Args({64, 1})->Args({4096, 0})->Args({4096, 1});
+
+static const char *kHeaders[] = {
+    "Host", "User-Agent", "Accept", "Accept-Encoding", "Connection",
+    "Content-Type", "Content-Length", "Cookie", "X-Forwarded-For", "Authorization"
+};
+
+// look a request's header names up in a table of known names, the names
+// arrive in arbitrary case.
+template <typename Equals>
+static void header_lookup(benchmark::State &state, Equals equals)
+{
+    std::vector<std::string> known(kHeaders, kHeaders + 10);
+    std::vector<std::string> incoming;
+    for (size_t i = 0; i < 10; ++i) {
+        std::string s = kHeaders[(i * 7) % 10];
+        for (size_t j = 0; j < s.size(); j += 2) {
+            s[j] = static_cast<char>(wsl::ascii::to_upper(static_cast<unsigned char>(s[j])));
+        }
+        incoming.push_back(s);
+    }
+    size_t found = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < incoming.size(); ++i) {
+            for (size_t k = 0; k < known.size(); ++k) {
+                if (known[k].size() == incoming[i].size() &&
+                    equals(known[k].data(), incoming[i].data(), known[k].size())) {
+                    ++found;
+                    break;
+                }
+            }
+        }
+    }
+    benchmark::DoNotOptimize(found);
+    state.SetItemsProcessed(state.iterations() * incoming.size());
+}
+
+// the per character loop the char overloads used before.
+static int compare_per_char(const char *a, const char *b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const int ca = wsl::ascii::to_lower(static_cast<unsigned char>(a[i]));
+        const int cb = wsl::ascii::to_lower(static_cast<unsigned char>(b[i]));
+        if (ca != cb) {
+            return ca < cb ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static bool equals_per_char(const char *a, const char *b, size_t n)
+{
+    return compare_per_char(a, b, n) == 0;
+}
+
+static void BM_header_equals_per_char(benchmark::State &state)
+{
+    header_lookup(state, equals_per_char);
+}
+BENCHMARK(BM_header_equals_per_char);
+
+static void BM_header_strncasecmp(benchmark::State &state)
+{
+    header_lookup(state, [](const char *a, const char *b, size_t n) { return strncasecmp(a, b, n) == 0; });
+}
+BENCHMARK(BM_header_strncasecmp);
+
+static void BM_header_equals_i(benchmark::State &state)
+{
+    header_lookup(state, wsl::ascii::equals_i);
+}
+BENCHMARK(BM_header_equals_i);
+
+static void BM_compare_i_long(benchmark::State &state)
+{
+    set_isa(state);
+    const std::string a = make_text(state.range(0));
+    std::string b = a;
+    wsl::ascii::to_upper(wsl::buffer_view<char>(&b[0], b.size()));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(wsl::ascii::compare_i(a.data(), b.data(), a.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * a.size());
+}
+BENCHMARK(BM_compare_i_long)->Args({4096, 0})->Args({4096, 1});
+
+static void BM_compare_i_per_char(benchmark::State &state)
+{
+    const std::string a = make_text(state.range(0));
+    std::string b = a;
+    wsl::ascii::to_upper(wsl::buffer_view<char>(&b[0], b.size()));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(compare_per_char(a.data(), b.data(), a.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * a.size());
+}
+BENCHMARK(BM_compare_i_per_char)->Arg(4096);
+
+// validate a header value: the first byte that is not printable, none in
+// the text, per character and in bulk.
+static void BM_find_not_print_per_char(benchmark::State &state)
+{
+    const std::string text = make_text(state.range(0));
+    for (auto _ : state) {
+        size_t i = 0;
+        while (i < text.size() && wsl::ascii::has_properties(static_cast<unsigned char>(text[i]),
+                                                             wsl::ascii::eAcpPrint)) {
+            ++i;
+        }
+        benchmark::DoNotOptimize(i);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_find_not_print_per_char)->Arg(64)->Arg(4096);
+
+static void BM_find_not_print_bulk(benchmark::State &state)
+{
+    set_isa(state);
+    const std::string text = make_text(state.range(0));
+    const wsl::buffer_view<const char> buf(text.data(), text.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(wsl::ascii::find_first_without_properties(buf, wsl::ascii::eAcpPrint));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_find_not_print_bulk)->Args({64, 0})->Args({64, 1})->Args({4096, 0})->Args({4096, 1});
+
+static void BM_count_digits_per_char(benchmark::State &state)
+{
+    const std::string text = make_text(state.range(0));
+    for (auto _ : state) {
+        size_t n = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            n += wsl::ascii::is_digit(static_cast<unsigned char>(text[i]));
+        }
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_count_digits_per_char)->Arg(4096);
+
+static void BM_count_digits_bulk(benchmark::State &state)
+{
+    set_isa(state);
+    const std::string text = make_text(state.range(0));
+    const wsl::buffer_view<const char> buf(text.data(), text.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(wsl::ascii::count_properties(buf, wsl::ascii::eAcpDigit));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_count_digits_bulk)->Args({4096, 0})->Args({4096, 1});
+
+static void BM_all_ascii_bulk(benchmark::State &state)
+{
+    set_isa(state);
+    const std::string text = make_text(state.range(0));
+    const wsl::buffer_view<const char> buf(text.data(), text.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(wsl::ascii::all_ascii(buf));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_all_ascii_bulk)->Args({4096, 0})->Args({4096, 1});
+
+static void BM_classify_into(benchmark::State &state)
+{
+    set_isa(state);
+    const std::string text = make_text(state.range(0));
+    const wsl::buffer_view<const char> buf(text.data(), text.size());
+    std::vector<uint64_t> bits((text.size() + 63) / 64);
+    for (auto _ : state) {
+        wsl::ascii::classify_into(buf, wsl::ascii::eAcpAlpha, wsl::buffer_view<uint64_t>(bits.data(), bits.size()));
+        benchmark::DoNotOptimize(bits.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_classify_into)->Args({4096, 0})->Args({4096, 1});
+
+BENCHMARK_MAIN();
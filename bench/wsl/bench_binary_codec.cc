@@ -0,0 +1,256 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/binary_codec.h>
+#include <walle/wsl/stack_buffer.h>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef wsl::stack_buffer<char, 256> buffer_type;
+
+struct message {
+    uint32_t    id;
+    uint64_t    timestamp;
+    uint16_t    kind;
+    int64_t     delta;
+    std::string name;
+};
+
+static const size_t kBatch = 1024;
+
+static std::vector<message> make_messages()
+{
+    std::mt19937_64 rng(42);
+    std::vector<message> out(kBatch);
+    for (size_t i = 0; i < kBatch; ++i) {
+        out[i].id = static_cast<uint32_t>(rng() % 100000);
+        out[i].timestamp = 1700000000000ull + rng() % 1000000;
+        out[i].kind = static_cast<uint16_t>(rng() % 16);
+        out[i].delta = static_cast<int64_t>(rng() % 2001) - 1000;
+        out[i].name.assign(8 + rng() % 16, 'a' + static_cast<char>(i % 26));
+    }
+    return out;
+}
+
+static size_t fixed_size(const message &m)
+{
+    return 4 + 8 + 2 + 8 + 4 + m.name.size();
+}
+
+// the hand rolled way: every field is an append() with its own capacity
+// check and size update.
+static void BM_encode_append(benchmark::State &state)
+{
+    const std::vector<message> msgs = make_messages();
+    buffer_type buf;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        buf.clear();
+        for (size_t i = 0; i < kBatch; ++i) {
+            const message &m = msgs[i];
+            const uint32_t len = static_cast<uint32_t>(m.name.size());
+            buf.append(reinterpret_cast<const char*>(&m.id), sizeof(m.id));
+            buf.append(reinterpret_cast<const char*>(&m.timestamp), sizeof(m.timestamp));
+            buf.append(reinterpret_cast<const char*>(&m.kind), sizeof(m.kind));
+            buf.append(reinterpret_cast<const char*>(&m.delta), sizeof(m.delta));
+            buf.append(reinterpret_cast<const char*>(&len), sizeof(len));
+            buf.append(m.name.data(), m.name.size());
+        }
+        bytes = buf.size();
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kBatch);
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_encode_append);
+
+// memcpy only into storage sized up front, the lower bound for the layout.
+static void BM_encode_memcpy(benchmark::State &state)
+{
+    const std::vector<message> msgs = make_messages();
+    size_t total = 0;
+    for (size_t i = 0; i < kBatch; ++i) {
+        total += fixed_size(msgs[i]);
+    }
+    std::vector<char> out(total);
+    for (auto _ : state) {
+        char *p = out.data();
+        for (size_t i = 0; i < kBatch; ++i) {
+            const message &m = msgs[i];
+            const uint32_t len = static_cast<uint32_t>(m.name.size());
+            std::memcpy(p, &m.id, 4); p += 4;
+            std::memcpy(p, &m.timestamp, 8); p += 8;
+            std::memcpy(p, &m.kind, 2); p += 2;
+            std::memcpy(p, &m.delta, 8); p += 8;
+            std::memcpy(p, &len, 4); p += 4;
+            std::memcpy(p, m.name.data(), len); p += len;
+        }
+        benchmark::DoNotOptimize(p);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kBatch);
+    state.SetBytesProcessed(state.iterations() * total);
+}
+BENCHMARK(BM_encode_memcpy);
+
+// same layout through binary_writer with a check per field.
+static void BM_encode_writer(benchmark::State &state)
+{
+    const std::vector<message> msgs = make_messages();
+    buffer_type buf;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        buf.clear();
+        {
+            wsl::binary_writer<buffer_type> w(buf);
+            for (size_t i = 0; i < kBatch; ++i) {
+                const message &m = msgs[i];
+                w.write_le(m.id);
+                w.write_le(m.timestamp);
+                w.write_le(m.kind);
+                w.write_le(m.delta);
+                w.write_le(static_cast<uint32_t>(m.name.size()));
+                w.write_bytes(m.name.data(), m.name.size());
+            }
+        }
+        bytes = buf.size();
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kBatch);
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_encode_writer);
+
+// one reserve() per message, fields written unchecked.
+static void BM_encode_writer_unchecked(benchmark::State &state)
+{
+    const std::vector<message> msgs = make_messages();
+    buffer_type buf;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        buf.clear();
+        {
+            wsl::binary_writer<buffer_type> w(buf);
+            for (size_t i = 0; i < kBatch; ++i) {
+                const message &m = msgs[i];
+                w.reserve(fixed_size(m));
+                w.write_le_unchecked(m.id);
+                w.write_le_unchecked(m.timestamp);
+                w.write_le_unchecked(m.kind);
+                w.write_le_unchecked(m.delta);
+                w.write_le_unchecked(static_cast<uint32_t>(m.name.size()));
+                w.write_bytes_unchecked(m.name.data(), m.name.size());
+            }
+        }
+        bytes = buf.size();
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kBatch);
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_encode_writer_unchecked);
+
+// compact encoding: varints, zigzag delta, length prefixed name.
+static void BM_encode_writer_varint(benchmark::State &state)
+{
+    const std::vector<message> msgs = make_messages();
+    buffer_type buf;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        buf.clear();
+        {
+            wsl::binary_writer<buffer_type> w(buf);
+            for (size_t i = 0; i < kBatch; ++i) {
+                const message &m = msgs[i];
+                w.reserve(4 * wsl::kMaxVarintSize + 2 + m.name.size());
+                w.write_varint_unchecked(m.id);
+                w.write_varint_unchecked(m.timestamp);
+                w.write_le_unchecked(m.kind);
+                w.write_zigzag_unchecked(m.delta);
+                w.write_string_unchecked(wsl::string_view(m.name.data(), m.name.size()));
+            }
+        }
+        bytes = buf.size();
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kBatch);
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_encode_writer_varint);
+
+static void BM_decode_memcpy(benchmark::State &state)
+{
+    const std::vector<message> msgs = make_messages();
+    buffer_type buf;
+    {
+        wsl::binary_writer<buffer_type> w(buf);
+        for (size_t i = 0; i < kBatch; ++i) {
+            w.write_le(msgs[i].id);
+            w.write_le(msgs[i].timestamp);
+            w.write_le(msgs[i].kind);
+            w.write_le(msgs[i].delta);
+            w.write_le(static_cast<uint32_t>(msgs[i].name.size()));
+            w.write_bytes(msgs[i].name.data(), msgs[i].name.size());
+        }
+    }
+    for (auto _ : state) {
+        const char *p = buf.data();
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kBatch; ++i) {
+            uint32_t id, len;
+            uint64_t ts;
+            uint16_t kind;
+            int64_t delta;
+            std::memcpy(&id, p, 4); p += 4;
+            std::memcpy(&ts, p, 8); p += 8;
+            std::memcpy(&kind, p, 2); p += 2;
+            std::memcpy(&delta, p, 8); p += 8;
+            std::memcpy(&len, p, 4); p += 4;
+            sum += id + ts + kind + delta + static_cast<unsigned char>(p[0]);
+            p += len;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * kBatch);
+    state.SetBytesProcessed(state.iterations() * buf.size());
+}
+BENCHMARK(BM_decode_memcpy);
+
+static void BM_decode_reader_varint(benchmark::State &state)
+{
+    const std::vector<message> msgs = make_messages();
+    buffer_type buf;
+    {
+        wsl::binary_writer<buffer_type> w(buf);
+        for (size_t i = 0; i < kBatch; ++i) {
+            w.write_varint(msgs[i].id);
+            w.write_varint(msgs[i].timestamp);
+            w.write_le(msgs[i].kind);
+            w.write_zigzag(msgs[i].delta);
+            w.write_string(wsl::string_view(msgs[i].name.data(), msgs[i].name.size()));
+        }
+    }
+    for (auto _ : state) {
+        wsl::binary_reader r(buf.data(), buf.size());
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kBatch; ++i) {
+            uint64_t id = 0, ts = 0;
+            uint16_t kind = 0;
+            int64_t delta = 0;
+            wsl::string_view name;
+            if (!(r.read_varint(id) && r.read_varint(ts) && r.read_le(kind) &&
+                  r.read_zigzag(delta) && r.read_string(name))) {
+                state.SkipWithError("malformed input");
+                break;
+            }
+            sum += id + ts + kind + delta + static_cast<unsigned char>(name[0]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * kBatch);
+    state.SetBytesProcessed(state.iterations() * buf.size());
+}
+BENCHMARK(BM_decode_reader_varint);
+
+BENCHMARK_MAIN();
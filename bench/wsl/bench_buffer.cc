@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/stack_buffer.h>
+#include <cstring>
+
+// byte at a time appends, the formatter/serializer write pattern.
+static void BM_stack_buffer_push_back(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    for (auto _ : state) {
+        wsl::stack_buffer<char, 500> buf;
+        for (size_t i = 0; i < n; ++i) {
+            buf.push_back(static_cast<char>(i));
+        }
+        benchmark::DoNotOptimize(buf.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_stack_buffer_push_back)->Range(64, 1 << 16);
+
+// short appends, as written for numbers and field separators.
+static void BM_stack_buffer_append(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    const char chunk[] = "12345678";
+    for (auto _ : state) {
+        wsl::stack_buffer<char, 500> buf;
+        for (size_t i = 0; i < n; i += 8) {
+            buf.append(chunk, 8);
+        }
+        benchmark::DoNotOptimize(buf.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_stack_buffer_append)->Range(64, 1 << 16);
+
+// assemble a multi megabyte log record from 64 byte lines, growth dominated.
+template <typename Buffer>
+static void BM_log_assembly(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    char line[64];
+    std::memset(line, 'x', sizeof(line));
+    for (auto _ : state) {
+        Buffer buf;
+        for (size_t i = 0; i < n; i += sizeof(line)) {
+            buf.append(line, sizeof(line));
+        }
+        benchmark::DoNotOptimize(buf.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_log_assembly, wsl::stack_buffer<char, 500, std::allocator<char> >)
+    ->Range(1 << 16, 1 << 24);
+BENCHMARK_TEMPLATE(BM_log_assembly, wsl::stack_buffer<char, 500>)
+    ->Range(1 << 16, 1 << 24);
+BENCHMARK_TEMPLATE(BM_log_assembly, wsl::stack_buffer<char, 500, wsl::malloc_allocator<char>, wsl::grow_double>)
+    ->Range(1 << 16, 1 << 24);
+
+BENCHMARK_MAIN();
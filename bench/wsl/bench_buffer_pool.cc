@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/buffer_pool.h>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// request path pattern: a handful of 4-64 KB buffers live at a time.
+static std::vector<size_t> make_sizes()
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<size_t> dist(4 << 10, 64 << 10);
+    std::vector<size_t> sizes(1024);
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        sizes[i] = dist(rng);
+    }
+    return sizes;
+}
+
+static const size_t kLive = 8;
+
+static void BM_malloc(benchmark::State &state)
+{
+    const std::vector<size_t> sizes = make_sizes();
+    void *live[kLive] = {0};
+    size_t i = 0;
+    for (auto _ : state) {
+        const size_t slot = i % kLive;
+        std::free(live[slot]);
+        live[slot] = std::malloc(sizes[i % sizes.size()]);
+        static_cast<char*>(live[slot])[0] = 1;
+        ++i;
+    }
+    for (size_t k = 0; k < kLive; ++k) {
+        std::free(live[k]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_malloc)->ThreadRange(1, 8);
+
+static void BM_buffer_pool(benchmark::State &state)
+{
+    wsl::buffer_pool &pool = wsl::buffer_pool::global();
+    const std::vector<size_t> sizes = make_sizes();
+    void *live[kLive] = {0};
+    size_t live_size[kLive] = {0};
+    size_t i = 0;
+    for (auto _ : state) {
+        const size_t slot = i % kLive;
+        pool.deallocate(live[slot], live_size[slot]);
+        live_size[slot] = sizes[i % sizes.size()];
+        live[slot] = pool.allocate(live_size[slot]);
+        static_cast<char*>(live[slot])[0] = 1;
+        ++i;
+    }
+    for (size_t k = 0; k < kLive; ++k) {
+        pool.deallocate(live[k], live_size[k]);
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        const wsl::buffer_pool::stats s = pool.get_stats();
+        state.counters["hit_rate"] = s.hit_rate();
+    }
+}
+BENCHMARK(BM_buffer_pool)->ThreadRange(1, 8);
+
+BENCHMARK_MAIN();
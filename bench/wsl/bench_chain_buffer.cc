@@ -0,0 +1,50 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/chain_buffer.h>
+#include <walle/wsl/stack_buffer.h>
+#include <vector>
+
+static const size_t kHops = 4;
+
+// a message read from the network, handed through kHops pipeline stages and
+// framed, each stage copying it into its own buffer.
+static void BM_proxy_copy(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    std::vector<char> payload(n, 'p');
+    for (auto _ : state) {
+        wsl::stack_buffer<char, 512> in;
+        in.append(payload.data(), n);
+        for (size_t hop = 0; hop < kHops; ++hop) {
+            wsl::stack_buffer<char, 512> out;
+            out.append("HDR:", 4);
+            out.append(in.data(), in.size());
+            in = std::move(out);
+        }
+        benchmark::DoNotOptimize(in.data());
+    }
+    state.SetBytesProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_proxy_copy)->Range(1 << 10, 1 << 20);
+
+// the same pipeline passing the blocks along.
+static void BM_proxy_chain(benchmark::State &state)
+{
+    const size_t n = state.range(0);
+    std::vector<char> payload(n, 'p');
+    for (auto _ : state) {
+        wsl::chain_buffer in;
+        in.append(payload.data(), n);
+        for (size_t hop = 0; hop < kHops; ++hop) {
+            wsl::chain_buffer out;
+            out.append("HDR:", 4);
+            out.append(std::move(in));
+            in = std::move(out);
+        }
+        struct iovec iov[16];
+        benchmark::DoNotOptimize(in.to_iovec(iov, 16));
+    }
+    state.SetBytesProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_proxy_chain)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_MAIN();
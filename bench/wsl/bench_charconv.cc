@@ -0,0 +1,100 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/charconv.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+static const size_t kValues = 4096;
+
+// kValues numbers, each followed by a ',' as in a csv field.
+static std::vector<std::string> integers()
+{
+    std::mt19937_64 rng(46);
+    std::vector<std::string> out;
+    for (size_t i = 0; i < kValues; ++i) {
+        // uniform over 1 to 19 digits.
+        const uint64_t v = rng() % 10000000000000000000ull;
+        out.push_back(std::to_string(v >> (rng() % 60)) + ",");
+    }
+    return out;
+}
+
+static std::vector<std::string> doubles(int precision)
+{
+    std::mt19937_64 rng(46);
+    std::uniform_real_distribution<double> dist(-1e6, 1e6);
+    std::vector<std::string> out;
+    char buf[64];
+    for (size_t i = 0; i < kValues; ++i) {
+        std::snprintf(buf, sizeof(buf), "%.*g,", precision, dist(rng) * std::pow(10.0, int(rng() % 40) - 20));
+        out.push_back(buf);
+    }
+    return out;
+}
+
+static void BM_from_chars_int(benchmark::State &state)
+{
+    const std::vector<std::string> in = integers();
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < in.size(); ++i) {
+            uint64_t v = 0;
+            wsl::from_chars(in[i].data(), in[i].data() + in[i].size(), v);
+            sum += v;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * in.size());
+}
+
+static void BM_strtoull(benchmark::State &state)
+{
+    const std::vector<std::string> in = integers();
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < in.size(); ++i) {
+            sum += std::strtoull(in[i].c_str(), WALLE_NULL, 10);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * in.size());
+}
+
+static void BM_from_chars_double(benchmark::State &state)
+{
+    const std::vector<std::string> in = doubles(int(state.range(0)));
+    for (auto _ : state) {
+        double sum = 0;
+        for (size_t i = 0; i < in.size(); ++i) {
+            double v = 0;
+            wsl::from_chars(in[i].data(), in[i].data() + in[i].size(), v);
+            sum += v;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * in.size());
+}
+
+static void BM_strtod(benchmark::State &state)
+{
+    const std::vector<std::string> in = doubles(int(state.range(0)));
+    for (auto _ : state) {
+        double sum = 0;
+        for (size_t i = 0; i < in.size(); ++i) {
+            sum += std::strtod(in[i].c_str(), WALLE_NULL);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * in.size());
+}
+
+BENCHMARK(BM_from_chars_int);
+BENCHMARK(BM_strtoull);
+// arg: significant digits printed.
+BENCHMARK(BM_from_chars_double)->Arg(6)->Arg(17);
+BENCHMARK(BM_strtod)->Arg(6)->Arg(17);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/concurrent_hash_map.h>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+static const uint64_t kKeys = 1 << 20;
+
+// the mutex around std::unordered_map it replaces.
+class locked_map {
+public:
+    bool find(uint64_t k, uint64_t &v)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        std::unordered_map<uint64_t, uint64_t>::const_iterator it = _map.find(k);
+        if (it == _map.end()) {
+            return false;
+        }
+        v = it->second;
+        return true;
+    }
+
+    void insert_or_assign(uint64_t k, uint64_t v)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _map[k] = v;
+    }
+
+private:
+    std::mutex                              _lock;
+    std::unordered_map<uint64_t, uint64_t>  _map;
+};
+
+typedef wsl::concurrent_hash_map<uint64_t, uint64_t> sharded_map;
+
+// the key space is bounded, so one map is filled once and shared by every
+// run: threads leave the loop at different times, none of them may free it.
+template <typename Map>
+static Map *shared_map()
+{
+    static Map *m = WALLE_NULL;
+    static std::once_flag once;
+    std::call_once(once, []() {
+        m = new Map;
+        for (uint64_t k = 0; k < kKeys; k += 2) {
+            m->insert_or_assign(k, k);
+        }
+    });
+    return m;
+}
+
+// arg: writes per 100 operations, the rest are lookups (half of them hit).
+template <typename Map>
+static void run(benchmark::State &state)
+{
+    Map *m = shared_map<Map>();
+    const uint64_t write_pct = uint64_t(state.range(0));
+    uint64_t x = 0x9e3779b97f4a7c15ull * uint64_t(state.thread_index() + 1);
+    uint64_t sum = 0;
+    for (auto _ : state) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        const uint64_t k = x % kKeys;
+        if (x >> 57 < write_pct * 128 / 100) {
+            m->insert_or_assign(k, x);
+        } else {
+            uint64_t v;
+            sum += m->find(k, v) ? v : 0;
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_locked_map(benchmark::State &state)
+{
+    run<locked_map>(state);
+}
+
+static void BM_concurrent_hash_map(benchmark::State &state)
+{
+    run<sharded_map>(state);
+}
+
+BENCHMARK(BM_locked_map)->Arg(10)->Arg(1)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_concurrent_hash_map)->Arg(10)->Arg(1)->ThreadRange(1, 64)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,132 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/flat_hash_map.h>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static const size_t kLookups = 1 << 16;
+
+static std::vector<uint64_t> random_keys(size_t n, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = rng();
+    }
+    return keys;
+}
+
+template <typename Map>
+static void BM_insert(benchmark::State &state)
+{
+    const std::vector<uint64_t> keys = random_keys(size_t(state.range(0)), 47);
+    for (auto _ : state) {
+        Map m;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            m[keys[i]] = i;
+        }
+        benchmark::DoNotOptimize(m.size());
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+// lookups of present keys (hit) or absent keys (miss) in a map of n.
+template <typename Map, bool Hit>
+static void BM_find(benchmark::State &state)
+{
+    const std::vector<uint64_t> keys = random_keys(size_t(state.range(0)), 47);
+    Map m;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        m[keys[i]] = i;
+    }
+    std::vector<uint64_t> queries = random_keys(kLookups, 48);
+    if (Hit) {
+        for (size_t i = 0; i < queries.size(); ++i) {
+            queries[i] = keys[queries[i] % keys.size()];
+        }
+    }
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            typename Map::const_iterator it = m.find(queries[i]);
+            sum += it == m.end() ? 0 : it->second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+typedef wsl::flat_hash_map<uint64_t, uint64_t> flat_map;
+typedef std::unordered_map<uint64_t, uint64_t> std_map;
+
+// arg: entries.
+#define SIZES ->RangeMultiplier(10)->Range(1000, 100000000)->Unit(benchmark::kMillisecond)
+BENCHMARK_TEMPLATE(BM_insert, flat_map) SIZES;
+BENCHMARK_TEMPLATE(BM_insert, std_map) SIZES;
+BENCHMARK_TEMPLATE(BM_find, flat_map, true) SIZES;
+BENCHMARK_TEMPLATE(BM_find, std_map, true) SIZES;
+BENCHMARK_TEMPLATE(BM_find, flat_map, false) SIZES;
+BENCHMARK_TEMPLATE(BM_find, std_map, false) SIZES;
+
+// string keys, the flat map probed with views of the query text.
+static std::vector<std::string> string_keys(size_t n)
+{
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n; ++i) {
+        keys.push_back("user:" + std::to_string(i * 2654435761u % 1000000007u));
+    }
+    return keys;
+}
+
+static void BM_find_string_flat(benchmark::State &state)
+{
+    const std::vector<std::string> keys = string_keys(size_t(state.range(0)));
+    wsl::flat_hash_map<std::string, size_t> m;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        m[keys[i]] = i;
+    }
+    std::mt19937_64 rng(48);
+    std::vector<wsl::string_view> queries;
+    for (size_t i = 0; i < kLookups; ++i) {
+        const std::string &k = keys[rng() % keys.size()];
+        queries.push_back(wsl::string_view(k.data(), k.size()));
+    }
+    for (auto _ : state) {
+        size_t sum = 0;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            sum += m.find(queries[i])->second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+// std::unordered_map needs a std::string per lookup of a view.
+static void BM_find_string_std(benchmark::State &state)
+{
+    const std::vector<std::string> keys = string_keys(size_t(state.range(0)));
+    std::unordered_map<std::string, size_t> m;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        m[keys[i]] = i;
+    }
+    std::mt19937_64 rng(48);
+    std::vector<wsl::string_view> queries;
+    for (size_t i = 0; i < kLookups; ++i) {
+        const std::string &k = keys[rng() % keys.size()];
+        queries.push_back(wsl::string_view(k.data(), k.size()));
+    }
+    for (auto _ : state) {
+        size_t sum = 0;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            sum += m.find(std::string(queries[i].data(), queries[i].size()))->second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+BENCHMARK(BM_find_string_flat)->Arg(1000)->Arg(1000000);
+BENCHMARK(BM_find_string_std)->Arg(1000)->Arg(1000000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,138 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/lru_cache.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+static const uint64_t kKeys = 1 << 20;
+static const size_t kCapacity = 1 << 16;
+static const size_t kSamples = 1 << 22;
+
+// one list under one mutex, every hit relinks its node to the front.
+class locked_lru {
+public:
+    explicit locked_lru(size_t capacity) : _capacity(capacity) {}
+
+    bool find(uint64_t k, uint64_t &v)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        std::unordered_map<uint64_t, entry_list::iterator>::iterator it = _index.find(k);
+        if (it == _index.end()) {
+            return false;
+        }
+        _lru.splice(_lru.begin(), _lru, it->second);
+        v = it->second->second;
+        return true;
+    }
+
+    void insert(uint64_t k, uint64_t v)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        std::unordered_map<uint64_t, entry_list::iterator>::iterator it = _index.find(k);
+        if (it != _index.end()) {
+            it->second->second = v;
+            _lru.splice(_lru.begin(), _lru, it->second);
+            return;
+        }
+        _lru.push_front(std::make_pair(k, v));
+        _index[k] = _lru.begin();
+        if (_lru.size() > _capacity) {
+            _index.erase(_lru.back().first);
+            _lru.pop_back();
+        }
+    }
+
+private:
+    typedef std::list<std::pair<uint64_t, uint64_t> > entry_list;
+
+    std::mutex                                              _lock;
+    size_t                                                  _capacity;
+    entry_list                                              _lru;
+    std::unordered_map<uint64_t, entry_list::iterator>      _index;
+};
+
+typedef wsl::lru_cache<uint64_t, uint64_t> sharded_cache;
+
+// zipf(s = 0.99) keys over kKeys, drawn once by inverting the cdf.
+static const std::vector<uint64_t> &zipf_keys()
+{
+    static std::vector<uint64_t> keys;
+    static std::once_flag once;
+    std::call_once(once, []() {
+        std::vector<double> cdf(kKeys);
+        double sum = 0;
+        for (uint64_t i = 0; i < kKeys; ++i) {
+            sum += 1.0 / std::pow(double(i + 1), 0.99);
+            cdf[i] = sum;
+        }
+        std::mt19937_64 rng(49);
+        std::uniform_real_distribution<double> u(0, sum);
+        keys.resize(kSamples);
+        for (size_t i = 0; i < kSamples; ++i) {
+            const uint64_t rank = uint64_t(std::lower_bound(cdf.begin(), cdf.end(), u(rng)) - cdf.begin());
+            // spread the hot ranks over the key space.
+            keys[i] = rank * 0x9e3779b97f4a7c15ull;
+        }
+    });
+    return keys;
+}
+
+// caches live for the whole process: threads leave the loop at different
+// times, none of them may free it.
+template <typename Cache>
+static Cache *shared_cache()
+{
+    static Cache *c = WALLE_NULL;
+    static std::once_flag once;
+    std::call_once(once, []() {
+        c = new Cache(kCapacity);
+        const std::vector<uint64_t> &keys = zipf_keys();
+        for (size_t i = 0; i < kSamples; ++i) {
+            c->insert(keys[i], keys[i]);
+        }
+    });
+    return c;
+}
+
+// a lookup per key, a miss loads the key into the cache.
+template <typename Cache>
+static void run(benchmark::State &state)
+{
+    const std::vector<uint64_t> &keys = zipf_keys();
+    Cache *c = shared_cache<Cache>();
+    size_t i = size_t(state.thread_index()) * 7919 * 131;
+    uint64_t hits = 0;
+    for (auto _ : state) {
+        const uint64_t k = keys[i++ & (kSamples - 1)];
+        uint64_t v;
+        if (c->find(k, v)) {
+            ++hits;
+        } else {
+            c->insert(k, k);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["hit_ratio"] = benchmark::Counter(double(hits) / double(state.iterations()),
+                                                     benchmark::Counter::kAvgThreads);
+}
+
+static void BM_locked_lru(benchmark::State &state)
+{
+    run<locked_lru>(state);
+}
+
+static void BM_lru_cache(benchmark::State &state)
+{
+    run<sharded_cache>(state);
+}
+
+BENCHMARK(BM_locked_lru)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_lru_cache)->ThreadRange(1, 64)->UseRealTime();
+
+BENCHMARK_MAIN();
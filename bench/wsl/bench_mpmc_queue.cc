@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/mpmc_queue.h>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+// the mutex plus std::deque stage queue.
+class locked_queue {
+public:
+    void push(uint64_t v)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _queue.push_back(v);
+    }
+
+    bool try_pop(uint64_t &v)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_queue.empty()) {
+            return false;
+        }
+        v = _queue.front();
+        _queue.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex              _lock;
+    std::deque<uint64_t>    _queue;
+};
+
+static locked_queue *g_locked;
+static wsl::mpmc_queue<uint64_t> *g_queue;
+
+// every thread is a producer and a consumer: push one, pop one.
+static void BM_locked_queue(benchmark::State &state)
+{
+    if (state.thread_index() == 0) {
+        g_locked = new locked_queue;
+    }
+    uint64_t v = 0;
+    for (auto _ : state) {
+        g_locked->push(v);
+        while (!g_locked->try_pop(v)) {
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        delete g_locked;
+    }
+}
+BENCHMARK(BM_locked_queue)->ThreadRange(1, 64)->UseRealTime();
+
+static void BM_mpmc_queue(benchmark::State &state)
+{
+    if (state.thread_index() == 0) {
+        g_queue = new wsl::mpmc_queue<uint64_t>(1024);
+    }
+    uint64_t v = 0;
+    for (auto _ : state) {
+        g_queue->push(v);
+        g_queue->pop(v);
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        delete g_queue;
+    }
+}
+BENCHMARK(BM_mpmc_queue)->ThreadRange(1, 64)->UseRealTime();
+
+// batches of 16 through a single slot claim.
+static void BM_mpmc_queue_batch(benchmark::State &state)
+{
+    if (state.thread_index() == 0) {
+        g_queue = new wsl::mpmc_queue<uint64_t>(1024);
+    }
+    uint64_t in[16] = {0};
+    uint64_t out[16];
+    for (auto _ : state) {
+        g_queue->push_n(in, 16);
+        size_t left = 16;
+        while (left) {
+            left -= g_queue->pop_n(out, left);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 16);
+    if (state.thread_index() == 0) {
+        delete g_queue;
+    }
+}
+BENCHMARK(BM_mpmc_queue_batch)->ThreadRange(1, 64)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,130 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/multi_matcher.h>
+#include <random>
+#include <string>
+#include <vector>
+
+static const size_t kVocabulary = 200000;
+static const size_t kTextSize = 1 << 20;
+
+static const std::vector<std::string> &vocabulary()
+{
+    static std::vector<std::string> words;
+    if (words.empty()) {
+        std::mt19937 rng(12);
+        for (size_t i = 0; i < kVocabulary; ++i) {
+            std::string w;
+            const size_t len = 5 + rng() % 8;
+            for (size_t k = 0; k < len; ++k) {
+                w.push_back(static_cast<char>('a' + rng() % 26));
+            }
+            words.push_back(w);
+        }
+    }
+    return words;
+}
+
+// messages made of vocabulary words, the first n words are the keywords so
+// about n / kVocabulary of the words hit.
+static const std::string &text()
+{
+    static std::string t;
+    if (t.empty()) {
+        const std::vector<std::string> &words = vocabulary();
+        std::mt19937 rng(13);
+        while (t.size() < kTextSize) {
+            t += words[rng() % words.size()];
+            t += rng() % 12 ? ' ' : '\n';
+        }
+    }
+    return t;
+}
+
+static void build(wsl::multi_matcher &m, size_t n)
+{
+    const std::vector<std::string> &words = vocabulary();
+    for (size_t i = 0; i < n; ++i) {
+        m.add(wsl::string_view(words[i].data(), words[i].size()));
+    }
+    m.compile();
+}
+
+struct counter {
+    size_t matches;
+
+    bool on_match(uint32_t, size_t)
+    {
+        ++matches;
+        return true;
+    }
+};
+
+static void BM_multi_matcher(benchmark::State &state)
+{
+    wsl::multi_matcher m(state.range(1) != 0);
+    build(m, state.range(0));
+    const std::string &t = text();
+    counter c = {0};
+    const wsl::multi_matcher::callback_type cb =
+        wsl::multi_matcher::callback_type::make<counter, &counter::on_match>(&c);
+    for (auto _ : state) {
+        m.match(wsl::string_view(t.data(), t.size()), cb);
+    }
+    state.SetBytesProcessed(state.iterations() * t.size());
+    state.counters["states"] = static_cast<double>(m.state_count());
+    state.counters["MB"] = static_cast<double>(m.memory_usage()) / (1 << 20);
+    state.counters["hits"] = static_cast<double>(c.matches / state.iterations());
+}
+BENCHMARK(BM_multi_matcher)->Args({1000, 0})->Args({10000, 0})->Args({100000, 0})
+                           ->Args({1000, 1})->Args({10000, 1})->Args({100000, 1});
+
+static void BM_multi_matcher_stream(benchmark::State &state)
+{
+    wsl::multi_matcher m;
+    build(m, state.range(0));
+    const std::string &t = text();
+    counter c = {0};
+    const wsl::multi_matcher::callback_type cb =
+        wsl::multi_matcher::callback_type::make<counter, &counter::on_match>(&c);
+    for (auto _ : state) {
+        wsl::multi_matcher::stream s(m);
+        for (size_t at = 0; at < t.size(); at += 4096) {
+            s.feed(wsl::string_view(t.data() + at, std::min<size_t>(4096, t.size() - at)), cb);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * t.size());
+}
+BENCHMARK(BM_multi_matcher_stream)->Arg(10000);
+
+static void BM_multi_matcher_compile(benchmark::State &state)
+{
+    for (auto _ : state) {
+        wsl::multi_matcher m;
+        build(m, state.range(0));
+        benchmark::DoNotOptimize(m.state_count());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_multi_matcher_compile)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// one string_view::find pass per keyword.
+static void BM_find_per_keyword(benchmark::State &state)
+{
+    const std::vector<std::string> &words = vocabulary();
+    const std::string &t = text();
+    const wsl::string_view h(t.data(), t.size());
+    size_t hits = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < static_cast<size_t>(state.range(0)); ++i) {
+            const wsl::string_view w(words[i].data(), words[i].size());
+            for (size_t pos = h.find(w); pos != wsl::string_view::npos; pos = h.find(w, pos + 1)) {
+                ++hits;
+            }
+        }
+    }
+    benchmark::DoNotOptimize(hits);
+    state.SetBytesProcessed(state.iterations() * t.size());
+}
+BENCHMARK(BM_find_per_keyword)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
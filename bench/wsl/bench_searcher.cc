@@ -0,0 +1,148 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/searcher.h>
+#include <algorithm>
+#include <random>
+#include <string>
+
+static const size_t kHaystackSize = 4 << 20;
+
+// log lines built from a small vocabulary, the way grep sees them.
+static const std::string &log_text()
+{
+    static std::string text;
+    if (text.empty()) {
+        static const char *kWords[] = {
+            "INFO", "WARN", "request", "served", "in", "ms", "shard", "lease", "renewed",
+            "replication", "client", "10.0.3.17", "GET", "/api/v1/items", "status=200",
+            "user_id=", "latency", "bytes", "connection", "closed", "[worker-3]", "2024-05-01T12:"
+        };
+        std::mt19937 rng(5);
+        while (text.size() < kHaystackSize) {
+            const size_t words = 6 + rng() % 10;
+            for (size_t i = 0; i < words; ++i) {
+                text += kWords[rng() % (sizeof(kWords) / sizeof(kWords[0]))];
+                text += ' ';
+                if (rng() % 4 == 0) {
+                    text += std::to_string(rng() % 100000);
+                    text += ' ';
+                }
+            }
+            text += '\n';
+        }
+    }
+    return text;
+}
+
+static const std::string &dna_text()
+{
+    static std::string text;
+    if (text.empty()) {
+        std::mt19937 rng(6);
+        for (size_t i = 0; i < kHaystackSize; ++i) {
+            text.push_back("acgt"[rng() % 4]);
+        }
+    }
+    return text;
+}
+
+static const std::string &random_bytes()
+{
+    static std::string text;
+    if (text.empty()) {
+        std::mt19937 rng(8);
+        for (size_t i = 0; i < kHaystackSize; ++i) {
+            text.push_back(static_cast<char>(rng()));
+        }
+    }
+    return text;
+}
+
+static const std::string &uniform_text()
+{
+    static std::string text(kHaystackSize, 'a');
+    return text;
+}
+
+// a needle of size m assembled like the haystack but absent from it, so the
+// whole haystack is scanned.
+static std::string needle_for(const std::string &hay, size_t m, int kind)
+{
+    if (kind == 2) {
+        std::string s(m, 'a');
+        s[0] = 'b';
+        return s;
+    }
+    std::mt19937 rng(static_cast<unsigned>(m));
+    std::string s = hay.substr(rng() % (hay.size() / 2), m);
+    s[m / 2] = kind == 0 ? '#' : kind == 1 ? 'n' : static_cast<char>(s[m / 2] + 1);
+    return s;
+}
+
+static const std::string &haystack(int kind)
+{
+    switch (kind) {
+    case 0:
+        return log_text();
+    case 1:
+        return dna_text();
+    case 2:
+        return uniform_text();
+    default:
+        return random_bytes();
+    }
+}
+
+static void BM_std_search(benchmark::State &state)
+{
+    const std::string &hay = haystack(static_cast<int>(state.range(1)));
+    const std::string needle = needle_for(hay, state.range(0), static_cast<int>(state.range(1)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::search(hay.begin(), hay.end(), needle.begin(), needle.end()));
+    }
+    state.SetBytesProcessed(state.iterations() * hay.size());
+}
+
+static void BM_string_view_find(benchmark::State &state)
+{
+    const std::string &hay = haystack(static_cast<int>(state.range(1)));
+    const std::string needle = needle_for(hay, state.range(0), static_cast<int>(state.range(1)));
+    const wsl::string_view h(hay.data(), hay.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(h.find(wsl::string_view(needle.data(), needle.size())));
+    }
+    state.SetBytesProcessed(state.iterations() * hay.size());
+}
+
+template <wsl::searcher::algorithm Algo>
+static void BM_searcher(benchmark::State &state)
+{
+    const std::string &hay = haystack(static_cast<int>(state.range(1)));
+    const std::string needle = needle_for(hay, state.range(0), static_cast<int>(state.range(1)));
+    const wsl::string_view h(hay.data(), hay.size());
+    const wsl::searcher s(wsl::string_view(needle.data(), needle.size()), Algo);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(s.find(h));
+    }
+    state.SetBytesProcessed(state.iterations() * hay.size());
+}
+
+// args: needle size, haystack (0 log text, 1 dna, 2 one repeated byte,
+// 3 random bytes).
+static void searcher_args(benchmark::internal::Benchmark *b)
+{
+    static const int kSizes[] = {4, 16, 40, 128, 300, 1000};
+    for (int kind = 0; kind < 4; ++kind) {
+        for (size_t i = 0; i < sizeof(kSizes) / sizeof(kSizes[0]); ++i) {
+            b->Args({kSizes[i], kind});
+        }
+    }
+}
+
+BENCHMARK(BM_std_search)->Apply(searcher_args);
+BENCHMARK(BM_string_view_find)->Apply(searcher_args);
+BENCHMARK_TEMPLATE(BM_searcher, wsl::searcher::kAuto)->Apply(searcher_args);
+BENCHMARK_TEMPLATE(BM_searcher, wsl::searcher::kPrefilter)->Apply(searcher_args);
+BENCHMARK_TEMPLATE(BM_searcher, wsl::searcher::kHorspool)->Apply(searcher_args);
+BENCHMARK_TEMPLATE(BM_searcher, wsl::searcher::kTwoWay)->Apply(searcher_args);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,172 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/split.h>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const size_t kTextSize = 4 << 20;
+
+// tab separated rows of short fields, the shape of an ingestion batch.
+static const std::string &tsv_text()
+{
+    static std::string text;
+    if (text.empty()) {
+        static const char *kFields[] = {
+            "2024-05-01T12:00:03", "10.0.3.17", "GET", "/api/v1/items", "200", "", "0.0042",
+            "Mozilla/5.0", "user_4711", "-", "eu-west-1", "shard-17"
+        };
+        std::mt19937 rng(41);
+        while (text.size() < kTextSize) {
+            for (size_t i = 0; i < 12; ++i) {
+                text += i ? "\t" : "";
+                text += kFields[rng() % (sizeof(kFields) / sizeof(kFields[0]))];
+            }
+            text += '\n';
+        }
+    }
+    return text;
+}
+
+// space separated log lines with longer words.
+static const std::string &log_text()
+{
+    static std::string text;
+    if (text.empty()) {
+        static const char *kWords[] = {
+            "INFO", "request", "served", "replication", "connection", "closed", "status=200",
+            "[worker-3]", "latency_ms=12.5", "/api/v1/items/1234567/details", "lease", "renewed"
+        };
+        std::mt19937 rng(42);
+        while (text.size() < kTextSize) {
+            const size_t words = 6 + rng() % 10;
+            for (size_t i = 0; i < words; ++i) {
+                text += i ? " " : "";
+                text += kWords[rng() % (sizeof(kWords) / sizeof(kWords[0]))];
+            }
+            text += '\n';
+        }
+    }
+    return text;
+}
+
+static const std::string &text_for(int kind)
+{
+    return kind == 0 ? tsv_text() : log_text();
+}
+
+static const char *delims_for(int kind)
+{
+    return kind == 0 ? "\t\n" : " \n";
+}
+
+static void BM_split(benchmark::State &state)
+{
+    const std::string &text = text_for(static_cast<int>(state.range(0)));
+    const wsl::string_view t(text.data(), text.size());
+    const wsl::split_range range = wsl::split(t, delims_for(static_cast<int>(state.range(0))));
+    for (auto _ : state) {
+        size_t n = 0;
+        for (wsl::split_range::iterator it = range.begin(); it != range.end(); ++it) {
+            n += it->size() + 1;
+        }
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+// rows first, then the fields of each row, a single delimiter each.
+static void BM_split_nested(benchmark::State &state)
+{
+    const std::string &text = text_for(static_cast<int>(state.range(0)));
+    const wsl::string_view t(text.data(), text.size());
+    const char field_delim = state.range(0) == 0 ? '\t' : ' ';
+    for (auto _ : state) {
+        size_t n = 0;
+        const wsl::split_range rows = wsl::split(t, '\n', true);
+        for (wsl::split_range::iterator row = rows.begin(); row != rows.end(); ++row) {
+            const wsl::split_range fields = wsl::split(*row, field_delim);
+            for (wsl::split_range::iterator it = fields.begin(); it != fields.end(); ++it) {
+                n += it->size() + 1;
+            }
+        }
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+static void BM_find_first_of_loop(benchmark::State &state)
+{
+    const std::string &text = text_for(static_cast<int>(state.range(0)));
+    const wsl::string_view t(text.data(), text.size());
+    const wsl::string_view delims(delims_for(static_cast<int>(state.range(0))));
+    for (auto _ : state) {
+        size_t n = 0;
+        size_t pos = 0;
+        for (;;) {
+            const size_t d = t.find_first_of(delims, pos);
+            if (d == wsl::string_view::npos) {
+                n += t.size() - pos;
+                break;
+            }
+            n += d - pos + 1;
+            pos = d + 1;
+        }
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+static void BM_strpbrk_loop(benchmark::State &state)
+{
+    const std::string &text = text_for(static_cast<int>(state.range(0)));
+    const char *delims = delims_for(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        size_t n = 0;
+        const char *p = text.c_str();
+        for (;;) {
+            const char *d = std::strpbrk(p, delims);
+            if (!d) {
+                n += std::strlen(p);
+                break;
+            }
+            n += d - p + 1;
+            p = d + 1;
+        }
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+static void BM_getline_vector(benchmark::State &state)
+{
+    const std::string &text = text_for(static_cast<int>(state.range(0)));
+    const char field_delim = state.range(0) == 0 ? '\t' : ' ';
+    for (auto _ : state) {
+        size_t n = 0;
+        std::istringstream in(text);
+        std::string line;
+        std::vector<std::string> fields;
+        while (std::getline(in, line)) {
+            fields.clear();
+            std::istringstream row(line);
+            std::string field;
+            while (std::getline(row, field, field_delim)) {
+                fields.push_back(field);
+            }
+            n += fields.size();
+        }
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+// arg: 0 tsv rows, 1 log lines.
+BENCHMARK(BM_split)->Arg(0)->Arg(1);
+BENCHMARK(BM_split_nested)->Arg(0)->Arg(1);
+BENCHMARK(BM_find_first_of_loop)->Arg(0)->Arg(1);
+BENCHMARK(BM_strpbrk_loop)->Arg(0)->Arg(1);
+BENCHMARK(BM_getline_vector)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,116 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/spsc_ring.h>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+static const uint64_t kMessages = 1 << 22;
+
+// the mutex protected queue the pipeline stages used so far.
+class locked_queue {
+public:
+    bool try_push(uint64_t v)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _queue.push_back(v);
+        return true;
+    }
+
+    bool try_pop(uint64_t &v)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_queue.empty()) {
+            return false;
+        }
+        v = _queue.front();
+        _queue.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex              _lock;
+    std::deque<uint64_t>    _queue;
+};
+
+template <typename Queue>
+static void run_pair(Queue &q)
+{
+    std::thread producer([&q]() {
+        for (uint64_t i = 0; i < kMessages; ++i) {
+            while (!q.try_push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint64_t v = 0;
+    for (uint64_t i = 0; i < kMessages; ++i) {
+        while (!q.try_pop(v)) {
+            std::this_thread::yield();
+        }
+    }
+    benchmark::DoNotOptimize(v);
+    producer.join();
+}
+
+static void BM_locked_queue(benchmark::State &state)
+{
+    for (auto _ : state) {
+        locked_queue q;
+        run_pair(q);
+    }
+    state.SetItemsProcessed(state.iterations() * kMessages);
+}
+BENCHMARK(BM_locked_queue)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_spsc_ring(benchmark::State &state)
+{
+    for (auto _ : state) {
+        wsl::spsc_ring<uint64_t> q(4096);
+        run_pair(q);
+    }
+    state.SetItemsProcessed(state.iterations() * kMessages);
+}
+BENCHMARK(BM_spsc_ring)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// batches through the zero copy spans.
+static void BM_spsc_ring_spans(benchmark::State &state)
+{
+    const size_t batch = state.range(0);
+    for (auto _ : state) {
+        wsl::spsc_ring<uint64_t> q(4096);
+        std::thread producer([&q, batch]() {
+            for (uint64_t i = 0; i < kMessages; ) {
+                wsl::buffer_view<uint64_t> span = q.push_n(batch);
+                if (span.size() == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                size_t n = 0;
+                for (; n < span.size() && i < kMessages; ++n) {
+                    span[n] = i++;
+                }
+                q.produce(n);
+            }
+        });
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < kMessages; ) {
+            wsl::buffer_view<uint64_t> span = q.pop_n(batch);
+            if (span.size() == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (size_t n = 0; n < span.size(); ++n) {
+                sum += span[n];
+            }
+            q.consume(span.size());
+            i += span.size();
+        }
+        benchmark::DoNotOptimize(sum);
+        producer.join();
+    }
+    state.SetItemsProcessed(state.iterations() * kMessages);
+}
+BENCHMARK(BM_spsc_ring_spans)->Arg(16)->Arg(256)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
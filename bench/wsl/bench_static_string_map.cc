@@ -0,0 +1,132 @@
+#include <benchmark/benchmark.h>
+#include <walle/hash/hash.h>
+#include <walle/wsl/static_string_map.h>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+static const size_t kQueries = 4096;
+
+static const char *kCommands[] = {
+    "get", "set", "del", "incr", "decr", "expire", "ttl", "exists", "mget", "mset"
+};
+
+// n command like keys and a query stream with 10% misses.
+struct workload {
+    std::vector<std::string> keys;
+    std::vector<std::string> queries;
+
+    explicit workload(size_t n)
+    {
+        std::mt19937 rng(46);
+        for (size_t i = 0; i < n; ++i) {
+            keys.push_back(i < 10 ? std::string(kCommands[i]) : "cmd." + std::to_string(i * 7919 % 100000));
+        }
+        for (size_t i = 0; i < kQueries; ++i) {
+            queries.push_back(rng() % 10 ? keys[rng() % n] : "missing." + std::to_string(i));
+        }
+    }
+};
+
+static void BM_static_string_map(benchmark::State &state)
+{
+    const workload w(static_cast<size_t>(state.range(0)));
+    std::vector<std::pair<wsl::string_view, int> > items;
+    for (size_t i = 0; i < w.keys.size(); ++i) {
+        items.push_back(std::make_pair(wsl::string_view(w.keys[i].data(), w.keys[i].size()), int(i + 1)));
+    }
+    const wsl::static_string_map<int> map(items.begin(), items.end());
+    for (auto _ : state) {
+        int sum = 0;
+        for (size_t i = 0; i < w.queries.size(); ++i) {
+            sum += map.get(wsl::string_view(w.queries[i].data(), w.queries[i].size()));
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * w.queries.size());
+}
+
+static void BM_unordered_map(benchmark::State &state)
+{
+    const workload w(static_cast<size_t>(state.range(0)));
+    std::unordered_map<std::string, int> map;
+    for (size_t i = 0; i < w.keys.size(); ++i) {
+        map[w.keys[i]] = int(i + 1);
+    }
+    for (auto _ : state) {
+        int sum = 0;
+        for (size_t i = 0; i < w.queries.size(); ++i) {
+            std::unordered_map<std::string, int>::const_iterator it = map.find(w.queries[i]);
+            sum += it == map.end() ? 0 : it->second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * w.queries.size());
+}
+
+// the chain of compares this replaces, 10 commands.
+static int if_chain(wsl::string_view s)
+{
+    for (size_t i = 0; i < sizeof(kCommands) / sizeof(kCommands[0]); ++i) {
+        if (s.size() == std::strlen(kCommands[i]) && s.compare(kCommands[i]) == 0) {
+            return int(i + 1);
+        }
+    }
+    return 0;
+}
+
+static void BM_if_chain(benchmark::State &state)
+{
+    const workload w(10);
+    for (auto _ : state) {
+        int sum = 0;
+        for (size_t i = 0; i < w.queries.size(); ++i) {
+            sum += if_chain(wsl::string_view(w.queries[i].data(), w.queries[i].size()));
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * w.queries.size());
+}
+
+static int hash_switch(wsl::string_view s)
+{
+    int r;
+    switch (walle::hash_const(s.data(), s.size())) {
+    case walle::hash_const("get"): r = 1; break;
+    case walle::hash_const("set"): r = 2; break;
+    case walle::hash_const("del"): r = 3; break;
+    case walle::hash_const("incr"): r = 4; break;
+    case walle::hash_const("decr"): r = 5; break;
+    case walle::hash_const("expire"): r = 6; break;
+    case walle::hash_const("ttl"): r = 7; break;
+    case walle::hash_const("exists"): r = 8; break;
+    case walle::hash_const("mget"): r = 9; break;
+    case walle::hash_const("mset"): r = 10; break;
+    default: return 0;
+    }
+    return s.size() == std::strlen(kCommands[r - 1]) && s.compare(kCommands[r - 1]) == 0 ? r : 0;
+}
+
+static void BM_hash_switch(benchmark::State &state)
+{
+    const workload w(10);
+    for (auto _ : state) {
+        int sum = 0;
+        for (size_t i = 0; i < w.queries.size(); ++i) {
+            sum += hash_switch(wsl::string_view(w.queries[i].data(), w.queries[i].size()));
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * w.queries.size());
+}
+
+// arg: number of keys.
+BENCHMARK(BM_static_string_map)->Arg(10)->Arg(50)->Arg(100)->Arg(500);
+BENCHMARK(BM_unordered_map)->Arg(10)->Arg(50)->Arg(100)->Arg(500);
+BENCHMARK(BM_if_chain);
+BENCHMARK(BM_hash_switch);
+
+BENCHMARK_MAIN();
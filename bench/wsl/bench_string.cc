@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/string.h>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+static const size_t kKeys = 1 << 16;
+
+// keys of 20 to 30 bytes, the common length of cache and session keys.
+static const std::vector<std::string> &keys()
+{
+    static std::vector<std::string> k;
+    if (k.empty()) {
+        std::mt19937 rng(43);
+        k.reserve(kKeys);
+        for (size_t i = 0; i < kKeys; ++i) {
+            std::string s = "user:";
+            const size_t len = 20 + rng() % 11;
+            while (s.size() < len) {
+                s += static_cast<char>('a' + rng() % 26);
+            }
+            k.push_back(s);
+        }
+    }
+    return k;
+}
+
+template <typename String>
+static void BM_construct(benchmark::State &state)
+{
+    const std::vector<std::string> &k = keys();
+    std::vector<String> out;
+    out.reserve(k.size());
+    for (auto _ : state) {
+        out.clear();
+        for (size_t i = 0; i < k.size(); ++i) {
+            out.push_back(String(k[i].data(), k[i].size()));
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * k.size());
+}
+
+template <typename String>
+static void BM_copy(benchmark::State &state)
+{
+    const std::vector<std::string> &k = keys();
+    std::vector<String> in;
+    for (size_t i = 0; i < k.size(); ++i) {
+        in.push_back(String(k[i].data(), k[i].size()));
+    }
+    for (auto _ : state) {
+        std::vector<String> out(in);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * k.size());
+}
+
+// builds "<prefix>:<id>" keys, the zero filled resize of std::string
+// against resize_and_overwrite.
+static void BM_format_std(benchmark::State &state)
+{
+    std::vector<std::string> out(kKeys);
+    for (auto _ : state) {
+        for (size_t i = 0; i < kKeys; ++i) {
+            std::string &s = out[i];
+            s.resize(32);
+            s.resize(std::snprintf(&s[0], 32, "session:%016zx", static_cast<size_t>(i * 0x9e3779b97f4a7c15ull)));
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kKeys);
+}
+
+static void BM_format_wsl(benchmark::State &state)
+{
+    std::vector<wsl::string> out(kKeys);
+    for (auto _ : state) {
+        for (size_t i = 0; i < kKeys; ++i) {
+            out[i].resize_and_overwrite(32, [i](char *p, size_t n) {
+                return static_cast<size_t>(std::snprintf(p, n, "session:%016zx", static_cast<size_t>(i * 0x9e3779b97f4a7c15ull)));
+            });
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kKeys);
+}
+
+BENCHMARK_TEMPLATE(BM_construct, std::string);
+BENCHMARK_TEMPLATE(BM_construct, wsl::string);
+BENCHMARK_TEMPLATE(BM_copy, std::string);
+BENCHMARK_TEMPLATE(BM_copy, wsl::string);
+BENCHMARK(BM_format_std);
+BENCHMARK(BM_format_wsl);
+
+BENCHMARK_MAIN();
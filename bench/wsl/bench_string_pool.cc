@@ -0,0 +1,133 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/string_pool.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static const size_t kDistinct = 20000;
+static const size_t kStream = 1 << 20;
+
+// a stream of metric label values, zipf distributed over kDistinct
+// strings of 16 to 40 bytes.
+static const std::vector<std::string> &stream()
+{
+    static std::vector<std::string> s;
+    if (s.empty()) {
+        std::vector<std::string> distinct;
+        std::mt19937 rng(44);
+        for (size_t i = 0; i < kDistinct; ++i) {
+            std::string v = "host=web-" + std::to_string(i) + ".dc";
+            const size_t len = 16 + rng() % 25;
+            while (v.size() < len) {
+                v += static_cast<char>('a' + rng() % 26);
+            }
+            distinct.push_back(v);
+        }
+        std::vector<double> cdf(kDistinct);
+        double sum = 0;
+        for (size_t i = 0; i < kDistinct; ++i) {
+            sum += 1.0 / std::pow(double(i + 1), 0.9);
+            cdf[i] = sum;
+        }
+        std::uniform_real_distribution<double> u(0, sum);
+        s.reserve(kStream);
+        for (size_t i = 0; i < kStream; ++i) {
+            const size_t k = std::lower_bound(cdf.begin(), cdf.end(), u(rng)) - cdf.begin();
+            s.push_back(distinct[std::min(k, kDistinct - 1)]);
+        }
+    }
+    return s;
+}
+
+static void BM_intern_pool(benchmark::State &state)
+{
+    const std::vector<std::string> &s = stream();
+    for (auto _ : state) {
+        wsl::string_pool pool;
+        for (size_t i = 0; i < s.size(); ++i) {
+            benchmark::DoNotOptimize(pool.intern(wsl::string_view(s[i].data(), s[i].size())));
+        }
+        const wsl::string_pool::stats st = pool.get_stats();
+        state.counters["MB"] = double(st.arena_bytes + st.table_bytes) / (1 << 20);
+    }
+    state.SetItemsProcessed(state.iterations() * s.size());
+}
+
+// the usual dedup map from string to id.
+static void BM_intern_unordered_map(benchmark::State &state)
+{
+    const std::vector<std::string> &s = stream();
+    for (auto _ : state) {
+        std::unordered_map<std::string, uint32_t> ids;
+        for (size_t i = 0; i < s.size(); ++i) {
+            benchmark::DoNotOptimize(ids.emplace(s[i], uint32_t(ids.size())).first->second);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * s.size());
+}
+
+// finding a label in a frozen pool from the hot path.
+static void BM_find_frozen(benchmark::State &state)
+{
+    const std::vector<std::string> &s = stream();
+    wsl::string_pool pool;
+    for (size_t i = 0; i < s.size(); ++i) {
+        pool.intern(wsl::string_view(s[i].data(), s[i].size()));
+    }
+    pool.freeze();
+    for (auto _ : state) {
+        for (size_t i = 0; i < s.size(); ++i) {
+            benchmark::DoNotOptimize(pool.find(wsl::string_view(s[i].data(), s[i].size())));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * s.size());
+}
+
+// equality of two label columns, as symbols and as owned strings.
+static void BM_equal_symbols(benchmark::State &state)
+{
+    const std::vector<std::string> &s = stream();
+    wsl::string_pool pool;
+    std::vector<wsl::string_pool::symbol> ids;
+    for (size_t i = 0; i < s.size(); ++i) {
+        ids.push_back(pool.intern(wsl::string_view(s[i].data(), s[i].size())));
+    }
+    for (auto _ : state) {
+        size_t equal = 0;
+        for (size_t i = 1; i < ids.size(); ++i) {
+            equal += ids[i] == ids[i - 1];
+        }
+        benchmark::DoNotOptimize(equal);
+    }
+    state.SetItemsProcessed(state.iterations() * s.size());
+    state.counters["MB"] = double(ids.size() * sizeof(ids[0])) / (1 << 20);
+}
+
+static void BM_equal_strings(benchmark::State &state)
+{
+    const std::vector<std::string> &s = stream();
+    size_t bytes = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        bytes += sizeof(std::string) + (s[i].size() > 15 ? s[i].size() + 1 : 0);
+    }
+    for (auto _ : state) {
+        size_t equal = 0;
+        for (size_t i = 1; i < s.size(); ++i) {
+            equal += s[i] == s[i - 1];
+        }
+        benchmark::DoNotOptimize(equal);
+    }
+    state.SetItemsProcessed(state.iterations() * s.size());
+    state.counters["MB"] = double(bytes) / (1 << 20);
+}
+
+BENCHMARK(BM_intern_pool);
+BENCHMARK(BM_intern_unordered_map);
+BENCHMARK(BM_find_frozen);
+BENCHMARK(BM_equal_symbols);
+BENCHMARK(BM_equal_strings);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,156 @@
+#include <benchmark/benchmark.h>
+#include <walle/wsl/string_view.h>
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+
+// log like text: words, numbers and key=value pairs, no match for the
+// probes so every search scans the whole input.
+static std::string make_text(size_t n)
+{
+    static const char *words[] = {"GET", "/api/v1/items", "200", "latency_ms=12",
+                                  "user=alice", "INFO", "request", "upstream", "ok"};
+    std::mt19937 rng(3);
+    std::string out;
+    while (out.size() < n) {
+        out += words[rng() % 9];
+        out += ' ';
+    }
+    out.resize(n);
+    return out;
+}
+
+static void set_isa(benchmark::State &state)
+{
+    if (!wsl::internal::set_search_isa(static_cast<wsl::internal::simd_isa>(state.range(1)))) {
+        state.SkipWithError("isa not supported");
+    }
+}
+
+static void BM_find_char_std_search(benchmark::State &state)
+{
+    const std::string text = make_text(state.range(0));
+    const char c = '#';
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::search(text.data(), text.data() + text.size(), &c, &c + 1));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_find_char_std_search)->Arg(64)->Arg(4096);
+
+static void BM_find_char_memchr(benchmark::State &state)
+{
+    const std::string text = make_text(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::memchr(text.data(), '#', text.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_find_char_memchr)->Arg(64)->Arg(4096);
+
+static void BM_find_char(benchmark::State &state)
+{
+    set_isa(state);
+    const std::string text = make_text(state.range(0));
+    wsl::string_view sv(text.data(), text.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sv.find('#'));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_find_char)->Args({64, 0})->Args({64, 1})->Args({4096, 0})->Args({4096, 1});
+
+static void BM_rfind_char(benchmark::State &state)
+{
+    set_isa(state);
+    const std::string text = make_text(state.range(0));
+    wsl::string_view sv(text.data(), text.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sv.rfind('#'));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_rfind_char)->Args({4096, 0})->Args({4096, 1});
+
+static void BM_find_substring_std_search(benchmark::State &state)
+{
+    const std::string text = make_text(state.range(0));
+    const std::string needle = "latency_ms=99";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::search(text.begin(), text.end(), needle.begin(), needle.end()));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_find_substring_std_search)->Arg(4096)->Arg(65536);
+
+static void BM_find_substring_std_string(benchmark::State &state)
+{
+    const std::string text = make_text(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(text.find("latency_ms=99"));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_find_substring_std_string)->Arg(4096)->Arg(65536);
+
+static void BM_find_substring(benchmark::State &state)
+{
+    set_isa(state);
+    const std::string text = make_text(state.range(0));
+    wsl::string_view sv(text.data(), text.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sv.find("latency_ms=99"));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_find_substring)->Args({4096, 0})->Args({4096, 1})->Args({65536, 0})->Args({65536, 1});
+
+static void BM_rfind_substring(benchmark::State &state)
+{
+    set_isa(state);
+    const std::string text = make_text(state.range(0));
+    wsl::string_view sv(text.data(), text.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sv.rfind("latency_ms=99"));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_rfind_substring)->Args({65536, 0})->Args({65536, 1});
+
+static void BM_find_first_of_std(benchmark::State &state)
+{
+    const std::string text = make_text(state.range(0));
+    const char set[] = "\t\n\r\"[]";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::find_first_of(text.begin(), text.end(), set, set + 6));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_find_first_of_std)->Arg(4096);
+
+static void BM_find_first_of(benchmark::State &state)
+{
+    set_isa(state);
+    const std::string text = make_text(state.range(0));
+    wsl::string_view sv(text.data(), text.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sv.find_first_of("\t\n\r\"[]"));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_find_first_of)->Args({64, 0})->Args({64, 1})->Args({4096, 0})->Args({4096, 1});
+
+static void BM_find_first_not_of(benchmark::State &state)
+{
+    set_isa(state);
+    const std::string text(state.range(0), ' ');
+    wsl::string_view sv(text.data(), text.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sv.find_first_not_of(" \t"));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_find_first_not_of)->Args({4096, 0})->Args({4096, 1});
+
+BENCHMARK_MAIN();
@@ -29,6 +29,11 @@ SET(CMAKE_VERBOSE_MAKEFILE OFF)
 option(test "enable test on" ON)
 #########################################
 
+######################################
+#for benchmark, skipped when google benchmark is not found
+option(bench "enable benchmark on" ON)
+#########################################
+
 ##########################################
 #do not modify belows
 ##########################################
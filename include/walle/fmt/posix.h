@@ -21,11 +21,19 @@
 
 #include <cstddef>
 
+#ifndef _WIN32
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
 #if defined __APPLE__ || defined(__FreeBSD__)
 # include <xlocale.h>  // for LC_NUMERIC_MASK on OS X
 #endif
 
 #include "format.h"
+#include <walle/wsl/buffer_view.h>
+#include <walle/wsl/string_view.h>
 
 #ifndef FMT_POSIX
 # if defined(_WIN32) && !defined(__MINGW32__)
@@ -406,6 +414,240 @@ class Locale {
 #endif  // FMT_LOCALE
 FMT_END_NAMESPACE
 
+#ifndef _WIN32
+namespace walle {
+
+// A read-only or read-write memory mapping of a file, or of a window of it.
+// The mapping is exposed as wsl::buffer_view / wsl::string_view so large
+// inputs can be parsed in place instead of read() into buffers. Files larger
+// than the address budget are processed by moving the window with map().
+// Methods that are not declared with FMT_NOEXCEPT throw fmt::system_error
+// on failure.
+class mapped_file {
+ public:
+  enum mode {
+    READ_ONLY,
+    READ_WRITE   // Writes go to the file (MAP_SHARED).
+  };
+
+  // Flags for the constructor.
+  enum {
+    POPULATE = 1  // Prefault the mapping (MAP_POPULATE on Linux).
+  };
+
+  // Access pattern hints for advise().
+  enum advice {
+    NORMAL     = MADV_NORMAL,
+    SEQUENTIAL = MADV_SEQUENTIAL,
+    RANDOM     = MADV_RANDOM,
+    WILLNEED   = MADV_WILLNEED,
+    DONTNEED   = MADV_DONTNEED,
+#ifdef MADV_HUGEPAGE
+    HUGEPAGE   = MADV_HUGEPAGE
+#else
+    HUGEPAGE   = MADV_NORMAL
+#endif
+  };
+
+  mapped_file() FMT_NOEXCEPT
+  : fd_(-1), mode_(READ_ONLY), flags_(0), file_size_(0),
+    base_(FMT_NULL), mapped_size_(0), offset_(0), size_(0) {}
+
+  // Opens path and maps the whole file.
+  mapped_file(fmt::cstring_view path, mode m = READ_ONLY, unsigned flags = 0)
+  : fd_(-1), mode_(m), flags_(flags), file_size_(0),
+    base_(FMT_NULL), mapped_size_(0), offset_(0), size_(0) {
+    fd_guard guard(fd_);
+    open(path);
+    map(0, static_cast<std::size_t>(file_size_));
+    guard.release();
+  }
+
+  // Opens path and maps length bytes starting at offset.
+  mapped_file(fmt::cstring_view path, mode m, unsigned long long offset,
+              std::size_t length, unsigned flags = 0)
+  : fd_(-1), mode_(m), flags_(flags), file_size_(0),
+    base_(FMT_NULL), mapped_size_(0), offset_(0), size_(0) {
+    fd_guard guard(fd_);
+    open(path);
+    map(offset, length);
+    guard.release();
+  }
+
+  mapped_file(mapped_file &&other) FMT_NOEXCEPT
+  : fd_(other.fd_), mode_(other.mode_), flags_(other.flags_),
+    file_size_(other.file_size_), base_(other.base_),
+    mapped_size_(other.mapped_size_), offset_(other.offset_),
+    size_(other.size_) {
+    other.fd_ = -1;
+    other.base_ = FMT_NULL;
+    other.mapped_size_ = other.size_ = 0;
+  }
+
+  mapped_file &operator=(mapped_file &&other) {
+    if (this != &other) {
+      close();
+      fd_ = other.fd_;
+      mode_ = other.mode_;
+      flags_ = other.flags_;
+      file_size_ = other.file_size_;
+      base_ = other.base_;
+      mapped_size_ = other.mapped_size_;
+      offset_ = other.offset_;
+      size_ = other.size_;
+      other.fd_ = -1;
+      other.base_ = FMT_NULL;
+      other.mapped_size_ = other.size_ = 0;
+    }
+    return *this;
+  }
+
+  ~mapped_file() FMT_DTOR_NOEXCEPT {
+    unmap();
+    if (fd_ != -1)
+      FMT_POSIX_CALL(close(fd_));
+  }
+
+  WALLE_NON_COPYABLE(mapped_file);
+
+  // Maps length bytes of the file starting at offset, replacing the current
+  // window. The window is clamped to the end of the file, offset does not
+  // need to be page aligned.
+  void map(unsigned long long offset, std::size_t length) {
+    unmap();
+    if (offset > file_size_)
+      offset = file_size_;
+    if (length > file_size_ - offset)
+      length = static_cast<std::size_t>(file_size_ - offset);
+    offset_ = offset;
+    size_ = length;
+    if (length == 0)
+      return;
+    const unsigned long long page = static_cast<unsigned long long>(::sysconf(_SC_PAGESIZE));
+    const unsigned long long aligned = offset & ~(page - 1);
+    const std::size_t lead = static_cast<std::size_t>(offset - aligned);
+    int prot = PROT_READ;
+    if (mode_ == READ_WRITE)
+      prot |= PROT_WRITE;
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (flags_ & POPULATE)
+      flags |= MAP_POPULATE;
+#endif
+    void *p = ::mmap(FMT_NULL, length + lead, prot, flags, fd_,
+                     static_cast<off_t>(aligned));
+    if (p == MAP_FAILED) {
+      size_ = 0;
+      FMT_THROW(fmt::system_error(errno, "cannot map file"));
+    }
+    base_ = static_cast<char*>(p);
+    mapped_size_ = length + lead;
+  }
+
+  // Releases the mapping and the file descriptor.
+  void close() {
+    unmap();
+    if (fd_ == -1)
+      return;
+    int result = FMT_POSIX_CALL(close(fd_));
+    fd_ = -1;
+    if (result != 0)
+      FMT_THROW(fmt::system_error(errno, "cannot close file"));
+  }
+
+  // Applies an access pattern hint to the current window. Hints are
+  // advisory, returns false if the kernel rejected it.
+  bool advise(advice a) FMT_NOEXCEPT {
+    if (mapped_size_ == 0)
+      return true;
+    return ::madvise(base_, mapped_size_, static_cast<int>(a)) == 0;
+  }
+
+  // Flushes the changes of a read-write window to the file.
+  void sync() {
+    if (mapped_size_ != 0 && ::msync(base_, mapped_size_, MS_SYNC) != 0)
+      FMT_THROW(fmt::system_error(errno, "cannot sync mapped file"));
+  }
+
+  // Returns the size of the file when it was opened.
+  unsigned long long file_size() const FMT_NOEXCEPT { return file_size_; }
+
+  // Returns the file offset of the current window.
+  unsigned long long offset() const FMT_NOEXCEPT { return offset_; }
+
+  // Returns the size of the current window.
+  std::size_t size() const FMT_NOEXCEPT { return size_; }
+
+  bool empty() const FMT_NOEXCEPT { return size_ == 0; }
+
+  const char *data() const FMT_NOEXCEPT { return base_ ? base_ + lead() : FMT_NULL; }
+
+  // Returns the writable window, only for READ_WRITE mappings.
+  char *mutable_data() FMT_NOEXCEPT {
+    WALLE_ASSERT_MSG(mode_ == READ_WRITE, "mapped_file is read only");
+    return base_ ? base_ + lead() : FMT_NULL;
+  }
+
+  wsl::buffer_view<const char> view() const FMT_NOEXCEPT {
+    return wsl::buffer_view<const char>(data(), size_);
+  }
+
+  wsl::string_view str() const FMT_NOEXCEPT {
+    return wsl::string_view(data(), size_);
+  }
+
+ private:
+  // Closes the descriptor of a constructor that throws before its mapping
+  // is in place, the destructor doesn't run then.
+  class fd_guard {
+   public:
+    explicit fd_guard(int &fd) FMT_NOEXCEPT : fd_(&fd) {}
+    ~fd_guard() FMT_DTOR_NOEXCEPT {
+      if (fd_ && *fd_ != -1) {
+        FMT_POSIX_CALL(close(*fd_));
+        *fd_ = -1;
+      }
+    }
+    void release() FMT_NOEXCEPT { fd_ = FMT_NULL; }
+
+   private:
+    int *fd_;
+  };
+
+  std::size_t lead() const FMT_NOEXCEPT { return mapped_size_ - size_; }
+
+  void open(fmt::cstring_view path) {
+    int oflag = mode_ == READ_WRITE ? O_RDWR : O_RDONLY;
+    FMT_RETRY(fd_, FMT_POSIX_CALL(open(path.c_str(), oflag | O_CLOEXEC)));
+    if (fd_ == -1)
+      FMT_THROW(fmt::system_error(errno, "cannot open file {}", path.c_str()));
+    struct stat file_stat;
+    if (::fstat(fd_, &file_stat) == -1)
+      FMT_THROW(fmt::system_error(errno, "cannot get file attributes"));
+    file_size_ = static_cast<unsigned long long>(file_stat.st_size);
+  }
+
+  void unmap() FMT_NOEXCEPT {
+    if (base_)
+      ::munmap(base_, mapped_size_);
+    base_ = FMT_NULL;
+    mapped_size_ = 0;
+    size_ = 0;
+  }
+
+  int fd_;
+  mode mode_;
+  unsigned flags_;
+  unsigned long long file_size_;
+  char *base_;
+  std::size_t mapped_size_;
+  unsigned long long offset_;
+  std::size_t size_;
+};
+
+}  // namespace walle
+#endif  // _WIN32
+
 #if !FMT_USE_RVALUE_REFERENCES
 namespace std {
 // For compatibility with C++98.
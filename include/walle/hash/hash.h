@@ -0,0 +1,261 @@
+#ifndef WALLE_HASH_HASH_H_
+#define WALLE_HASH_HASH_H_
+#include <walle/config/base.h>
+#include <walle/wsl/buffer_view.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace wsl {
+template <typename T> class basic_string_view;
+}
+
+namespace walle {
+
+namespace hash_detail {
+
+// the wyhash (final version 4, public domain) construction: every step is
+// a 64x64->128 bit multiply of two key words xored with secrets, folded
+// back to 64 bits.
+static const uint64_t kSecret0 = 0x2d358dccaa6c78a5ull;
+static const uint64_t kSecret1 = 0x8bb84b93962eacc9ull;
+static const uint64_t kSecret2 = 0x4b33a62ed433d4a3ull;
+static const uint64_t kSecret3 = 0x4d5a2da51de1aa47ull;
+
+WALLE_FORCE_INLINE void mum(uint64_t &a, uint64_t &b)
+{
+    const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    a = static_cast<uint64_t>(r);
+    b = static_cast<uint64_t>(r >> 64);
+}
+
+WALLE_FORCE_INLINE uint64_t mix(uint64_t a, uint64_t b)
+{
+    mum(a, b);
+    return a ^ b;
+}
+
+WALLE_FORCE_INLINE uint64_t read8(const unsigned char *p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+WALLE_FORCE_INLINE uint64_t read4(const unsigned char *p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+// 1 to 3 bytes: first, middle and last.
+WALLE_FORCE_INLINE uint64_t read3(const unsigned char *p, size_t k)
+{
+    return (uint64_t(p[0]) << 16) | (uint64_t(p[k >> 1]) << 8) | p[k - 1];
+}
+
+WALLE_FORCE_INLINE uint64_t seed_state(uint64_t seed)
+{
+    return seed ^ mix(seed ^ kSecret0, kSecret1);
+}
+
+WALLE_FORCE_INLINE uint64_t finish(uint64_t a, uint64_t b, uint64_t seed, uint64_t len)
+{
+    a ^= kSecret1;
+    b ^= seed;
+    mum(a, b);
+    return mix(a ^ kSecret0 ^ len, b ^ kSecret1);
+}
+
+/**
+ * @brief  keys longer than 16 bytes.
+ */
+uint64_t hash_long(const unsigned char *p, size_t len, uint64_t seed);
+
+}
+
+/**
+ * @brief  64 bit non cryptographic hash of len bytes.
+ * @note   keys up to 16 bytes are inlined and hashed with two multiplies
+ *         from (overlapping) 4/8 byte reads, longer keys go through three
+ *         independent 16 byte lanes per step. the value is stable across
+ *         runs and processes, not across byte orders. not for untrusted
+ *         keys where collisions would be an attack.
+ */
+WALLE_FORCE_INLINE uint64_t hash64(const void *data, size_t len, uint64_t seed = 0)
+{
+    const unsigned char *p = static_cast<const unsigned char*>(data);
+    seed = hash_detail::seed_state(seed);
+    uint64_t a, b;
+    if (WALLE_LIKELY(len <= 16)) {
+        if (WALLE_LIKELY(len >= 4)) {
+            const size_t step = (len >> 3) << 2;
+            a = (hash_detail::read4(p) << 32) | hash_detail::read4(p + step);
+            b = (hash_detail::read4(p + len - 4) << 32) | hash_detail::read4(p + len - 4 - step);
+        } else if (WALLE_LIKELY(len > 0)) {
+            a = hash_detail::read3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+        return hash_detail::finish(a, b, seed, len);
+    }
+    return hash_detail::hash_long(p, len, seed);
+}
+
+template <typename T>
+WALLE_FORCE_INLINE uint64_t hash64(wsl::buffer_view<T> view, uint64_t seed = 0)
+{
+    return hash64(view.data(), view.size() * sizeof(T), seed);
+}
+
+template <typename T>
+WALLE_FORCE_INLINE uint64_t hash64(const wsl::basic_string_view<T> &view, uint64_t seed = 0)
+{
+    return hash64(view.data(), view.size() * sizeof(T), seed);
+}
+
+/**
+ * @brief  integer keys: two multiplies, no length handling.
+ * @note   not equal to hash64() of the key bytes.
+ */
+WALLE_FORCE_INLINE uint64_t hash_int(uint64_t key, uint64_t seed = 0)
+{
+    uint64_t a = key ^ hash_detail::kSecret0;
+    uint64_t b = seed ^ hash_detail::kSecret1;
+    hash_detail::mum(a, b);
+    return hash_detail::mix(a ^ hash_detail::kSecret0, b ^ hash_detail::kSecret1);
+}
+
+/**
+ * @brief  combine a hash into seed, for composite keys.
+ */
+WALLE_FORCE_INLINE uint64_t hash_combine(uint64_t seed, uint64_t value)
+{
+    return hash_detail::mix(seed ^ hash_detail::kSecret2, value ^ hash_detail::kSecret3);
+}
+
+namespace hash_detail {
+
+WALLE_CONSTEXPR uint64_t const_mix(uint64_t a, uint64_t b)
+{
+    return uint64_t(static_cast<unsigned __int128>(a) * b) ^
+           uint64_t((static_cast<unsigned __int128>(a) * b) >> 64);
+}
+
+WALLE_CONSTEXPR uint64_t const_byte(const char *p, size_t i)
+{
+    return uint64_t(static_cast<unsigned char>(p[i])) << (8 * i);
+}
+
+// spelled out so that the runtime version is a single load.
+WALLE_CONSTEXPR uint64_t const_read8(const char *p)
+{
+    return const_byte(p, 0) | const_byte(p, 1) | const_byte(p, 2) | const_byte(p, 3) |
+           const_byte(p, 4) | const_byte(p, 5) | const_byte(p, 6) | const_byte(p, 7);
+}
+
+WALLE_CONSTEXPR uint64_t const_read_tail(const char *p, size_t n, uint64_t acc)
+{
+    return n == 0 ? acc : const_read_tail(p, n - 1, acc | const_byte(p, n - 1));
+}
+
+// the state is fed forward, a word equal to the secret can't zero it.
+WALLE_CONSTEXPR uint64_t const_step(uint64_t h, uint64_t w)
+{
+    return const_mix(w ^ kSecret1, h ^ kSecret2) ^ h;
+}
+
+// one call per 8 bytes, only for literals: the runtime hash_const() loops.
+WALLE_CONSTEXPR uint64_t const_hash(const char *p, size_t n, uint64_t h, uint64_t len)
+{
+    return n > 8 ? const_hash(p + 8, n - 8, const_step(h, const_read8(p)), len)
+                 : const_mix(const_step(h, const_read_tail(p, n, 0)) ^ kSecret0, len ^ kSecret3);
+}
+
+}
+
+/**
+ * @brief  64 bit hash that is a constant expression (c++11 constexpr) for
+ *         string literals, e.g. case labels of a switch over strings:
+ *             switch (walle::hash_const(s.data(), s.size())) {
+ *             case walle::hash_const("get"): ...
+ *         a collision between two labels is a duplicate case compile error.
+ * @note   8 bytes and one multiply per step, about hash64() speed at
+ *         runtime for short keys, but a different value than hash64().
+ *         this form is a loop for runtime input of any length, the literal
+ *         form below computes the same value by recursion.
+ */
+inline uint64_t hash_const(const char *p, size_t n, uint64_t seed = 0)
+{
+    const uint64_t len = n;
+    uint64_t h = seed ^ hash_detail::kSecret0;
+    for (; n > 8; p += 8, n -= 8) {
+        h = hash_detail::const_step(h, hash_detail::const_read8(p));
+    }
+    return hash_detail::const_mix(hash_detail::const_step(h, hash_detail::const_read_tail(p, n, 0)) ^
+                                  hash_detail::kSecret0, len ^ hash_detail::kSecret3);
+}
+
+/**
+ * @brief  hash_const() of a string literal, without its terminator.
+ */
+template <size_t N>
+WALLE_CONSTEXPR uint64_t hash_const(const char (&s)[N])
+{
+    return hash_detail::const_hash(s, N - 1, hash_detail::kSecret0, N - 1);
+}
+
+/**
+ * @brief  incremental hash64(), the digest of the concatenated updates
+ *         equals hash64() over the whole input with the same seed.
+ * @note   48 byte blocks are hashed as soon as more input follows them,
+ *         so at most 64 bytes are buffered.
+ */
+class hasher {
+public:
+    explicit hasher(uint64_t seed = 0);
+
+    void reset(uint64_t seed = 0);
+
+    void update(const void *data, size_t len);
+
+    template <typename T>
+    void update(wsl::buffer_view<T> view)
+    {
+        update(view.data(), view.size() * sizeof(T));
+    }
+
+    template <typename T>
+    void update(const wsl::basic_string_view<T> &view)
+    {
+        update(view.data(), view.size() * sizeof(T));
+    }
+
+    uint64_t digest() const;
+
+    uint64_t length() const
+    {
+        return _length;
+    }
+
+private:
+    static const size_t kBlockSize = 48;
+    static const size_t kHistorySize = 16;
+
+    void consume(const unsigned char *block);
+
+    uint64_t        _seed;
+    uint64_t        _see1;
+    uint64_t        _see2;
+    uint64_t        _length;
+    size_t          _buffered;
+    bool            _bulk;
+    // [0, 16) the 16 bytes before the pending ones, read by digest() when
+    // the tail is shorter than 16. [16, 64) pending input.
+    unsigned char   _buffer[kHistorySize + kBlockSize];
+};
+
+}
+#endif //WALLE_HASH_HASH_H_
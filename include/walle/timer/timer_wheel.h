@@ -0,0 +1,278 @@
+#ifndef WALLE_TIMER_TIMER_WHEEL_H_
+#define WALLE_TIMER_TIMER_WHEEL_H_
+#include <walle/config/base.h>
+#include <walle/wsl/delegate.h>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace walle {
+
+class timer_wheel;
+
+namespace timer_detail {
+
+/**
+ * @brief  intrusive doubly linked list hook, every wheel slot is a
+ *         sentinel of this type and every timer entry embeds one.
+ */
+struct list_hook {
+    list_hook *prev;
+    list_hook *next;
+
+    list_hook() : prev(this), next(this) {}
+
+    bool empty() const
+    {
+        return next == this;
+    }
+
+    void link_back(list_hook *node)
+    {
+        node->prev = prev;
+        node->next = this;
+        prev->next = node;
+        prev = node;
+    }
+
+    void unlink()
+    {
+        prev->next = next;
+        next->prev = prev;
+        prev = this;
+        next = this;
+    }
+
+    /**
+     * @brief  move all nodes of other to the back of this list.
+     */
+    void splice_back(list_hook &other)
+    {
+        if (other.empty()) {
+            return;
+        }
+        other.next->prev = prev;
+        prev->next = other.next;
+        other.prev->next = this;
+        prev = other.prev;
+        other.prev = &other;
+        other.next = &other;
+    }
+};
+
+} //namespace timer_detail
+
+/**
+ * @brief  a timer armed on a timer_wheel. the entry is owned by the caller,
+ *         the wheel only links it, so arm/cancel never allocate.
+ * @note   destroying an armed entry cancels it.
+ */
+class timer_entry : private timer_detail::list_hook {
+public:
+    typedef wsl::delegate<void(timer_entry&)> callback_type;
+
+    timer_entry()
+    : _wheel(WALLE_NULL),
+      _deadline(0),
+      _expires(0),
+      _slot(0)
+    {
+
+    }
+
+    explicit timer_entry(const callback_type &cb)
+    : _callback(cb),
+      _wheel(WALLE_NULL),
+      _deadline(0),
+      _expires(0),
+      _slot(0)
+    {
+
+    }
+
+    ~timer_entry();
+
+    WALLE_NON_COPYABLE(timer_entry);
+
+    void set_callback(const callback_type &cb)
+    {
+        _callback = cb;
+    }
+
+    const callback_type& callback() const
+    {
+        return _callback;
+    }
+
+    /**
+     * @brief  true while the entry is linked on a wheel.
+     */
+    bool armed() const
+    {
+        return _wheel != WALLE_NULL;
+    }
+
+    /**
+     * @brief  the deadline the entry was last armed with,
+     *         in the time unit of the wheel.
+     */
+    uint64_t deadline() const
+    {
+        return _deadline;
+    }
+
+    timer_wheel* wheel() const
+    {
+        return _wheel;
+    }
+
+private:
+    friend class timer_wheel;
+
+    callback_type  _callback;
+    timer_wheel   *_wheel;
+    uint64_t       _deadline;
+    uint64_t       _expires;
+    uint32_t       _slot;
+};
+
+/**
+ * @brief  hierarchical timing wheel (Varghese & Lauck).
+ * @note   time is an opaque unsigned counter (ns, ms, ...), resolution is
+ *         the length of one tick in that unit. level 0 holds timers due within
+ *         2^slot_bits ticks at tick granularity, every higher level covers
+ *         2^slot_bits times the range of the one below and is cascaded down
+ *         when the lower level wraps. schedule/cancel are O(1), advance() walks
+ *         only non empty slots by scanning per level occupancy bitmaps, and
+ *         goes straight over the turns of empty lower levels.
+ *         deadlines beyond the covered range are parked in the top level and
+ *         re-cascaded until they fit. not thread safe.
+ */
+class timer_wheel {
+public:
+    static const WALLE_CONSTEXPR unsigned kDefaultLevels   = 4;
+    static const WALLE_CONSTEXPR unsigned kDefaultSlotBits = 8;
+    static const WALLE_CONSTEXPR unsigned kMaxSlotBits     = 16;
+
+    /**
+     * @brief
+     * @param  resolution: tick length in caller time units, must be > 0
+     * @param  now: current time
+     * @param  levels: number of wheels
+     * @param  slot_bits: log2 of the slot count of each wheel
+     */
+    explicit timer_wheel(uint64_t resolution = 1,
+                         uint64_t now = 0,
+                         unsigned levels = kDefaultLevels,
+                         unsigned slot_bits = kDefaultSlotBits);
+
+    /**
+     * @brief  disarms every pending timer without running it.
+     */
+    ~timer_wheel();
+
+    WALLE_NON_COPYABLE(timer_wheel);
+
+    /**
+     * @brief  arm or re-arm t to fire once now() >= deadline.
+     * @note   deadlines that are not in the future fire on the next tick.
+     *         an entry armed on another wheel is moved to this one.
+     */
+    void schedule(timer_entry &t, uint64_t deadline);
+
+    /**
+     * @brief  arm or re-arm t to fire delay time units from now().
+     */
+    void schedule_after(timer_entry &t, uint64_t delay)
+    {
+        schedule(t, _now + delay);
+    }
+
+    /**
+     * @brief  disarm t.
+     * @retval false if t was not armed on this wheel.
+     */
+    bool cancel(timer_entry &t);
+
+    /**
+     * @brief  move the wheel to now and run the callbacks of every timer that
+     *         expired on the way, in deadline tick order.
+     * @note   callbacks may schedule and cancel any entry, including the one
+     *         being run. a time earlier than now() is ignored.
+     * @retval number of callbacks run.
+     */
+    size_t advance(uint64_t now);
+
+    uint64_t now() const
+    {
+        return _now;
+    }
+
+    uint64_t resolution() const
+    {
+        return _resolution;
+    }
+
+    /**
+     * @brief  the time span that is tracked without re-cascading.
+     */
+    uint64_t range() const;
+
+    size_t size() const
+    {
+        return _count;
+    }
+
+    bool empty() const
+    {
+        return _count == 0;
+    }
+
+private:
+    typedef timer_detail::list_hook list_type;
+
+    uint64_t to_tick(uint64_t t) const
+    {
+        return t / _resolution;
+    }
+
+    uint64_t to_tick_ceil(uint64_t t) const
+    {
+        return t / _resolution + (t % _resolution != 0);
+    }
+
+    uint32_t slot_index(unsigned level, uint64_t expires) const
+    {
+        return (level << _slot_bits) +
+            static_cast<uint32_t>((expires >> (level * _slot_bits)) & _slot_mask);
+    }
+
+    void link(timer_entry &t);
+    void unlink(timer_entry &t);
+    void mark(uint32_t slot);
+    void clear(uint32_t slot);
+    void cascade(unsigned level);
+    size_t expire(uint32_t slot);
+    uint64_t next_tick(uint64_t limit) const;
+
+    uint64_t                _resolution;
+    uint64_t                _now;
+    uint64_t                _tick;
+    unsigned                _levels;
+    unsigned                _slot_bits;
+    uint64_t                _slot_mask;
+    size_t                  _words_per_level;
+    size_t                  _count;
+    std::vector<list_type>  _slots;
+    std::vector<uint64_t>   _bitmap;
+};
+
+inline timer_entry::~timer_entry()
+{
+    if (_wheel) {
+        _wheel->cancel(*this);
+    }
+}
+
+} //namespace walle
+#endif //WALLE_TIMER_TIMER_WHEEL_H_
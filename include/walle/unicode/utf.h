@@ -0,0 +1,140 @@
+#ifndef WALLE_UNICODE_UTF_H_
+#define WALLE_UNICODE_UTF_H_
+#include <walle/config/base.h>
+#include <walle/wsl/internal/basic_buffer.h>
+#include <walle/wsl/internal/cpu.h>
+#include <walle/wsl/string_view.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace walle {
+
+/**
+ * @brief  why an input is not valid utf-8/16/32.
+ */
+enum utf_error {
+    kUtfOk,
+    kUtfHeaderBits,     // utf-8: a byte above 0xf7.
+    kUtfTooShort,       // utf-8: a lead byte without enough continuation bytes.
+    kUtfTooLong,        // utf-8: a continuation byte without a lead byte.
+    kUtfOverlong,       // utf-8: a code point in more bytes than it needs.
+    kUtfTooLarge,       // a code point above U+10FFFF.
+    kUtfSurrogate       // utf-8/32: an encoded surrogate. utf-16: an unpaired one.
+};
+
+/**
+ * @brief  outcome of a validation or conversion.
+ * @note   on success count is the number of code units written (the input
+ *         size for a validation), on error the offset of the first invalid
+ *         input code unit.
+ */
+struct utf_result {
+    utf_error   error;
+    size_t      count;
+
+    utf_result(utf_error e, size_t c)
+    : error(e),
+      count(c)
+    {
+
+    }
+
+    bool ok() const
+    {
+        return error == kUtfOk;
+    }
+};
+
+/**
+ * @brief  utf-8 validation.
+ * @note   64 bytes per step: all ascii blocks are skipped after one test,
+ *         the others go through three nibble table lookups (on the byte,
+ *         the one before it and its high nibble) whose and is non zero
+ *         exactly for the invalid 2 byte patterns, plus a check that
+ *         continuation bytes appear where 3 and 4 byte sequences need them
+ *         (Keiser and Lemire, validating utf-8 in less than one
+ *         instruction per byte). avx2 or ssse3, scalar without them.
+ *         validate_utf8_with_errors() is as fast on valid input and rescans
+ *         the failing block to locate the error.
+ */
+bool validate_utf8(const char *p, size_t n);
+utf_result validate_utf8_with_errors(const char *p, size_t n);
+
+bool validate_utf16(const char16_t *p, size_t n);
+utf_result validate_utf16_with_errors(const char16_t *p, size_t n);
+
+bool validate_utf32(const char32_t *p, size_t n);
+utf_result validate_utf32_with_errors(const char32_t *p, size_t n);
+
+/**
+ * @brief  size of the conversion output in code units, for sizing the
+ *         output up front. the input must be valid, the result for invalid
+ *         input is unspecified but no larger than the worst case of the
+ *         conversion.
+ */
+size_t utf16_length_from_utf8(const char *p, size_t n);
+size_t utf32_length_from_utf8(const char *p, size_t n);
+size_t utf8_length_from_utf16(const char16_t *p, size_t n);
+size_t utf32_length_from_utf16(const char16_t *p, size_t n);
+size_t utf8_length_from_utf32(const char32_t *p, size_t n);
+size_t utf16_length_from_utf32(const char32_t *p, size_t n);
+
+/**
+ * @brief  validating conversions into out, which must hold the length
+ *         reported by the matching length function, or the worst case:
+ *         n units from utf-8, 3 * n bytes utf-16 to utf-8, 4 * n bytes and
+ *         2 * n units from utf-32.
+ * @note   utf-8 input is validated first, then converted without checks,
+ *         utf-16 and utf-32 input is checked as it is converted. blocks of
+ *         ascii (or, between utf-16 and utf-32, of code points that are a
+ *         single unit in both) go a vector at a time, the rest code point by
+ *         code point. on error out holds the conversion of the input before
+ *         the error.
+ */
+utf_result convert_utf8_to_utf16(const char *p, size_t n, char16_t *out);
+utf_result convert_utf8_to_utf32(const char *p, size_t n, char32_t *out);
+utf_result convert_utf16_to_utf8(const char16_t *p, size_t n, char *out);
+utf_result convert_utf16_to_utf32(const char16_t *p, size_t n, char32_t *out);
+utf_result convert_utf32_to_utf8(const char32_t *p, size_t n, char *out);
+utf_result convert_utf32_to_utf16(const char32_t *p, size_t n, char16_t *out);
+
+/**
+ * @brief  append the conversion of s to out, reserving the worst case
+ *         first. out is unchanged on error.
+ */
+utf_result utf8_to_utf16(wsl::string_view s, wsl::internal::basic_buffer<char16_t> &out);
+utf_result utf8_to_utf32(wsl::string_view s, wsl::internal::basic_buffer<char32_t> &out);
+utf_result utf16_to_utf8(wsl::u16string_view s, wsl::internal::basic_buffer<char> &out);
+utf_result utf16_to_utf32(wsl::u16string_view s, wsl::internal::basic_buffer<char32_t> &out);
+utf_result utf32_to_utf8(wsl::u32string_view s, wsl::internal::basic_buffer<char> &out);
+utf_result utf32_to_utf16(wsl::u32string_view s, wsl::internal::basic_buffer<char16_t> &out);
+
+inline bool validate_utf8(wsl::string_view s)
+{
+    return validate_utf8(s.data(), s.size());
+}
+
+inline bool validate_utf16(wsl::u16string_view s)
+{
+    return validate_utf16(s.data(), s.size());
+}
+
+inline bool validate_utf32(wsl::u32string_view s)
+{
+    return validate_utf32(s.data(), s.size());
+}
+
+namespace utf_detail {
+
+/**
+ * @brief  the utf-8 validation kernel in use, and forcing one for tests
+ *         and benchmarks.
+ * @retval false when the cpu lacks the instructions.
+ */
+wsl::internal::simd_isa current_isa();
+bool set_isa(wsl::internal::simd_isa isa);
+
+}
+
+}
+#endif //WALLE_UNICODE_UTF_H_
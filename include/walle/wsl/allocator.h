@@ -0,0 +1,303 @@
+#ifndef WALLE_WSL_ALLOCATOR_H_
+#define WALLE_WSL_ALLOCATOR_H_
+#include <walle/config/base.h>
+#include <walle/wsl/algorithm.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace wsl {
+
+/**
+ * @brief  allocator on top of malloc/free that can also resize a block in
+ *         place through reallocate().
+ * @note   large blocks are mmap backed in glibc and realloc moves them with
+ *         mremap, so growing them costs page table updates instead of a copy.
+ *         reallocate() moves bytes, only use it for trivially copyable T.
+ */
+template <typename T>
+class malloc_allocator {
+public:
+    typedef T           value_type;
+    typedef T*          pointer;
+    typedef const T*    const_pointer;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+    typedef size_t      size_type;
+    typedef ptrdiff_t   difference_type;
+
+    template <typename U>
+    struct rebind {
+        typedef malloc_allocator<U> other;
+    };
+
+    malloc_allocator() WALLE_NOEXCEPT
+    {
+
+    }
+
+    template <typename U>
+    malloc_allocator(const malloc_allocator<U> &) WALLE_NOEXCEPT
+    {
+
+    }
+
+    T *allocate(size_type n)
+    {
+        void *p = std::malloc(n * sizeof(T));
+        if (WALLE_UNLIKELY(!p)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T *p, size_type)
+    {
+        std::free(p);
+    }
+
+    /**
+     * @brief  resize the block p of old_n elements to new_n elements,
+     *         keeping min(old_n, new_n) leading elements.
+     * @retval the new block, p is invalid afterwards.
+     */
+    T *reallocate(T *p, size_type old_n, size_type new_n)
+    {
+        void *np = std::realloc(p, new_n * sizeof(T));
+        if (WALLE_UNLIKELY(!np)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(np);
+    }
+};
+
+template <typename T, typename U>
+inline bool operator==(const malloc_allocator<T> &, const malloc_allocator<U> &)
+{
+    return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const malloc_allocator<T> &, const malloc_allocator<U> &)
+{
+    return false;
+}
+
+namespace internal {
+
+template <typename Allocator>
+struct has_reallocate_impl {
+    template <typename A>
+    static std::true_type test(decltype(std::declval<A&>().reallocate(
+        std::declval<typename A::value_type*>(), size_t(0), size_t(0)))*);
+    template <typename A>
+    static std::false_type test(...);
+    typedef decltype(test<Allocator>(WALLE_NULL)) type;
+};
+
+}
+
+/**
+ * @brief  true when Allocator provides reallocate(p, old_n, new_n).
+ */
+template <typename Allocator>
+struct has_reallocate : public internal::has_reallocate_impl<Allocator>::type { };
+
+static const WALLE_CONSTEXPR size_t kPageSize = 4096;
+static const WALLE_CONSTEXPR size_t kHugePageSize = 2 * 1024 * 1024;
+
+/**
+ * @brief  size bytes aligned to align (a power of two), from malloc.
+ * @note   the block is over allocated and the start moved up with align_up,
+ *         the malloc pointer is kept just below the returned address.
+ *         release with deallocate_aligned().
+ */
+inline void *allocate_aligned(size_t size, size_t align)
+{
+    WALLE_ASSERT_MSG((align & (align - 1)) == 0, "alignment must be a power of two");
+    if (align < sizeof(void*)) {
+        align = sizeof(void*);
+    }
+    // the padding must not wrap size around to a tiny block.
+    if (WALLE_UNLIKELY(size > SIZE_MAX - align - sizeof(void*))) {
+        throw std::bad_alloc();
+    }
+    char *raw = static_cast<char*>(std::malloc(size + align + sizeof(void*)));
+    if (WALLE_UNLIKELY(!raw)) {
+        throw std::bad_alloc();
+    }
+    char *p = wsl::align_up(raw + sizeof(void*), align);
+    reinterpret_cast<void**>(p)[-1] = raw;
+    return p;
+}
+
+inline void deallocate_aligned(void *p)
+{
+    if (p) {
+        std::free(reinterpret_cast<void**>(p)[-1]);
+    }
+}
+
+/**
+ * @brief  a block that starts on its own cache line, no false sharing
+ *         with neighbouring allocations at the front.
+ */
+inline void *allocate_cache_aligned(size_t size)
+{
+    if (WALLE_UNLIKELY(size > SIZE_MAX - WALLE_CACHE_LINE_SIZE)) {
+        throw std::bad_alloc();
+    }
+    return allocate_aligned(wsl::align_up(size, size_t(WALLE_CACHE_LINE_SIZE)), WALLE_CACHE_LINE_SIZE);
+}
+
+inline void *allocate_page_aligned(size_t size)
+{
+    return allocate_aligned(size, kPageSize);
+}
+
+/**
+ * @brief  allocator returning Align aligned blocks (cache line by default).
+ */
+template <typename T, size_t Align = WALLE_CACHE_LINE_SIZE>
+class aligned_allocator {
+public:
+    typedef T           value_type;
+    typedef T*          pointer;
+    typedef const T*    const_pointer;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+    typedef size_t      size_type;
+    typedef ptrdiff_t   difference_type;
+
+    template <typename U>
+    struct rebind {
+        typedef aligned_allocator<U, Align> other;
+    };
+
+    aligned_allocator() WALLE_NOEXCEPT
+    {
+
+    }
+
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Align> &) WALLE_NOEXCEPT
+    {
+
+    }
+
+    T *allocate(size_type n)
+    {
+        if (WALLE_UNLIKELY(n > SIZE_MAX / sizeof(T))) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(allocate_aligned(n * sizeof(T), Align));
+    }
+
+    void deallocate(T *p, size_type)
+    {
+        deallocate_aligned(p);
+    }
+};
+
+template <typename T, typename U, size_t Align>
+inline bool operator==(const aligned_allocator<T, Align> &, const aligned_allocator<U, Align> &)
+{
+    return true;
+}
+
+template <typename T, typename U, size_t Align>
+inline bool operator!=(const aligned_allocator<T, Align> &, const aligned_allocator<U, Align> &)
+{
+    return false;
+}
+
+namespace internal {
+
+/**
+ * @brief  map bytes rounded up to whole huge pages, 2 MB aligned. with
+ *         hugetlb MAP_HUGETLB is tried first, otherwise and as fallback the
+ *         range is madvise(MADV_HUGEPAGE)d for transparent huge pages,
+ *         which the kernel may still serve with normal pages.
+ */
+void *huge_page_map(size_t bytes, bool hugetlb);
+void huge_page_unmap(void *p, size_t bytes);
+
+}
+
+/**
+ * @brief  allocator for large buffers backed by 2 MB (huge) pages.
+ * @note   requests of at least Threshold bytes are mapped with
+ *         internal::huge_page_map, smaller ones come cache line aligned
+ *         from malloc. with HugeTLB the reserved hugetlbfs pool is tried
+ *         first. fits the Allocator parameter of stack_buffer, skip_list
+ *         and the std containers.
+ */
+template <typename T, bool HugeTLB = false, size_t Threshold = kHugePageSize / 2>
+class huge_page_allocator {
+public:
+    typedef T           value_type;
+    typedef T*          pointer;
+    typedef const T*    const_pointer;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+    typedef size_t      size_type;
+    typedef ptrdiff_t   difference_type;
+
+    template <typename U>
+    struct rebind {
+        typedef huge_page_allocator<U, HugeTLB, Threshold> other;
+    };
+
+    huge_page_allocator() WALLE_NOEXCEPT
+    {
+
+    }
+
+    template <typename U>
+    huge_page_allocator(const huge_page_allocator<U, HugeTLB, Threshold> &) WALLE_NOEXCEPT
+    {
+
+    }
+
+    T *allocate(size_type n)
+    {
+        if (WALLE_UNLIKELY(n > SIZE_MAX / sizeof(T))) {
+            throw std::bad_alloc();
+        }
+        const size_t bytes = n * sizeof(T);
+        if (bytes < Threshold) {
+            return static_cast<T*>(allocate_cache_aligned(bytes));
+        }
+        return static_cast<T*>(internal::huge_page_map(bytes, HugeTLB));
+    }
+
+    void deallocate(T *p, size_type n)
+    {
+        const size_t bytes = n * sizeof(T);
+        if (bytes < Threshold) {
+            deallocate_aligned(p);
+        } else {
+            internal::huge_page_unmap(p, bytes);
+        }
+    }
+};
+
+template <typename T, typename U, bool HugeTLB, size_t Threshold>
+inline bool operator==(const huge_page_allocator<T, HugeTLB, Threshold> &,
+                       const huge_page_allocator<U, HugeTLB, Threshold> &)
+{
+    return true;
+}
+
+template <typename T, typename U, bool HugeTLB, size_t Threshold>
+inline bool operator!=(const huge_page_allocator<T, HugeTLB, Threshold> &,
+                       const huge_page_allocator<U, HugeTLB, Threshold> &)
+{
+    return false;
+}
+
+}
+#endif //WALLE_WSL_ALLOCATOR_H_
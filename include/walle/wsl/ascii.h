@@ -1,6 +1,9 @@
 #ifndef WALLE_WSL_ASCII_H_
 #define WALLE_WSL_ASCII_H_
 #include <walle/config/base.h>
+#include <walle/wsl/buffer_view.h>
+#include <walle/wsl/internal/cpu.h>
+#include <cstddef>
 #include <cstdint>
 
 namespace wsl {
@@ -125,7 +128,68 @@ public:
 	 */
 	static int to_upper(int ch);
 
-		
+	/**
+	 * Bulk case conversion of n bytes from src to dst (which may be
+	 * src), 16 or 32 bytes at a time. Bytes outside 'A'..'Z' /
+	 * 'a'..'z', including every non-ASCII byte, are copied unchanged,
+	 * as by to_lower(int)/to_upper(int).
+	 */
+	static void to_lower(const char *src, size_t n, char *dst);
+	static void to_upper(const char *src, size_t n, char *dst);
+
+	/**
+	 * In place bulk case conversion.
+	 */
+	static void to_lower(buffer_view<char> buf);
+	static void to_upper(buffer_view<char> buf);
+
+	/**
+	 * Compares n bytes of a and b ignoring ASCII case, a vector at a
+	 * time. The order is that of the lowercased bytes as unsigned
+	 * values, non-ASCII bytes compare as themselves.
+	 * @returns <0, 0 or >0 like memcmp.
+	 */
+	static int compare_i(const char *a, const char *b, size_t n);
+
+	/**
+	 * @returns true iff a and b are equal ignoring ASCII case.
+	 */
+	static bool equals_i(const char *a, const char *b, size_t n);
+
+	/**
+	 * @returns true iff every byte of buf is within the ASCII range,
+	 * checked 16 or 32 bytes at a time.
+	 */
+	static bool all_ascii(buffer_view<const char> buf);
+
+	/**
+	 * Bulk classification, 16 or 32 bytes at a time through nibble
+	 * lookup tables (pshufb). A byte matches when it is within the
+	 * ASCII range and has all of the given properties, as by
+	 * has_properties(); properties must not be 0.
+	 * @returns the index of the first byte that matches, or buf.size().
+	 */
+	static size_t find_first_with_properties(buffer_view<const char> buf, int properties);
+
+	/**
+	 * @returns the index of the first byte that doesn't match, or
+	 * buf.size(), e.g. the end of a run of digits or the first byte
+	 * that is not printable.
+	 */
+	static size_t find_first_without_properties(buffer_view<const char> buf, int properties);
+
+	/**
+	 * @returns the number of bytes that match.
+	 */
+	static size_t count_properties(buffer_view<const char> buf, int properties);
+
+	/**
+	 * Sets bit i % 64 of out[i / 64] iff byte i matches and clears the
+	 * other bits. out holds at least (buf.size() + 63) / 64 words.
+	 */
+	static void classify_into(buffer_view<const char> buf, int properties, buffer_view<uint64_t> out);
+
+
 private:
 	static const int CHARACTER_PROPERTIES[128];
 };
@@ -228,6 +292,30 @@ WALLE_FORCE_INLINE int ascii::to_upper(int ch)
     }
 }
 
+
+inline void ascii::to_lower(buffer_view<char> buf)
+{
+	to_lower(buf.data(), buf.size(), buf.data());
+}
+
+
+inline void ascii::to_upper(buffer_view<char> buf)
+{
+	to_upper(buf.data(), buf.size(), buf.data());
+}
+
+
+namespace internal {
+
+/**
+ * @brief  kernel set of the bulk ascii functions, forcing one is for tests
+ *         and benchmarks.
+ */
+simd_isa current_ascii_isa();
+bool set_ascii_isa(simd_isa isa);
+
+}
+
 } //namespace wsl
 #endif //WALLE_WSL_ASCII_H_
 
@@ -0,0 +1,453 @@
+#ifndef WALLE_WSL_BINARY_CODEC_H_
+#define WALLE_WSL_BINARY_CODEC_H_
+#include <walle/config/base.h>
+#include <walle/wsl/buffer_view.h>
+#include <walle/wsl/string_view.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace wsl {
+
+namespace internal {
+
+inline uint8_t byte_swap(uint8_t v) { return v; }
+inline uint16_t byte_swap(uint16_t v) { return __builtin_bswap16(v); }
+inline uint32_t byte_swap(uint32_t v) { return __builtin_bswap32(v); }
+inline uint64_t byte_swap(uint64_t v) { return __builtin_bswap64(v); }
+
+template <size_t Size>
+struct uint_of_size;
+template <> struct uint_of_size<1> { typedef uint8_t type; };
+template <> struct uint_of_size<2> { typedef uint16_t type; };
+template <> struct uint_of_size<4> { typedef uint32_t type; };
+template <> struct uint_of_size<8> { typedef uint64_t type; };
+
+/**
+ * @brief  store/load an integer or floating point value with the given byte
+ *         order, memcpy compiles to a plain (unaligned) move.
+ */
+template <bool BigEndian, typename T>
+WALLE_FORCE_INLINE void store_ordered(char *p, T value)
+{
+    typedef typename uint_of_size<sizeof(T)>::type uint_type;
+    uint_type u;
+    std::memcpy(&u, &value, sizeof(T));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (BigEndian) {
+        u = byte_swap(u);
+    }
+#else
+    if (!BigEndian) {
+        u = byte_swap(u);
+    }
+#endif
+    std::memcpy(p, &u, sizeof(T));
+}
+
+template <bool BigEndian, typename T>
+WALLE_FORCE_INLINE T load_ordered(const char *p)
+{
+    typedef typename uint_of_size<sizeof(T)>::type uint_type;
+    uint_type u;
+    std::memcpy(&u, p, sizeof(T));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (BigEndian) {
+        u = byte_swap(u);
+    }
+#else
+    if (!BigEndian) {
+        u = byte_swap(u);
+    }
+#endif
+    T value;
+    std::memcpy(&value, &u, sizeof(T));
+    return value;
+}
+
+}
+
+/**
+ * @brief  LEB128 encoding length of v.
+ */
+inline size_t varint_size(uint64_t v)
+{
+    // (bits + 6) / 7 with bits = 64 - clz, one byte for zero.
+    const int bits = 64 - __builtin_clzll(v | 1);
+    return static_cast<size_t>((bits * 9 + 64) >> 6);
+}
+
+inline uint64_t zigzag_encode(int64_t v)
+{
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t zigzag_decode(uint64_t v)
+{
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+static const WALLE_CONSTEXPR size_t kMaxVarintSize = 10;
+
+/**
+ * @brief  binary encoder appending to a char buffer (stack_buffer,
+ *         container_buffer, basic_buffer...).
+ * @note   the writer keeps a raw cursor into the buffer storage and only
+ *         publishes the written size with flush() or on destruction, so a
+ *         field costs one pointer compare instead of a size update and a
+ *         capacity check. reserve() once for a whole message and use the
+ *         *_unchecked writes to drop the compare as well. the buffer must
+ *         not be used directly while a writer is active.
+ */
+template <typename Buffer>
+class binary_writer {
+public:
+    explicit binary_writer(Buffer &buffer)
+    : _buffer(buffer),
+      _begin(buffer.data()),
+      _cursor(buffer.data() + buffer.size()),
+      _limit(buffer.data() + buffer.capacity())
+    {
+
+    }
+
+    ~binary_writer()
+    {
+        flush();
+    }
+
+    WALLE_NON_COPYABLE(binary_writer);
+
+    /**
+     * @brief  bytes in the buffer including the not yet flushed ones.
+     */
+    size_t size() const
+    {
+        return _cursor - _begin;
+    }
+
+    /**
+     * @brief  bytes that can be written without growing the buffer.
+     */
+    size_t available() const
+    {
+        return _limit - _cursor;
+    }
+
+    /**
+     * @brief  make room for n more bytes, after which n bytes of
+     *         *_unchecked writes are safe.
+     */
+    void reserve(size_t n)
+    {
+        if (WALLE_UNLIKELY(available() < n)) {
+            grow(n);
+        }
+    }
+
+    /**
+     * @brief  publish the written bytes to the buffer's size.
+     */
+    void flush()
+    {
+        _buffer.resize(size());
+    }
+
+    template <typename T>
+    void write_le(T value)
+    {
+        reserve(sizeof(T));
+        write_le_unchecked(value);
+    }
+
+    template <typename T>
+    void write_be(T value)
+    {
+        reserve(sizeof(T));
+        write_be_unchecked(value);
+    }
+
+    void write_varint(uint64_t value)
+    {
+        reserve(kMaxVarintSize);
+        write_varint_unchecked(value);
+    }
+
+    void write_zigzag(int64_t value)
+    {
+        write_varint(zigzag_encode(value));
+    }
+
+    void write_bytes(const void *data, size_t len)
+    {
+        reserve(len);
+        write_bytes_unchecked(data, len);
+    }
+
+    /**
+     * @brief  varint length followed by the bytes.
+     */
+    void write_string(string_view str)
+    {
+        reserve(kMaxVarintSize + str.size());
+        write_string_unchecked(str);
+    }
+
+    template <typename T>
+    WALLE_FORCE_INLINE void write_le_unchecked(T value)
+    {
+        WALLE_STATIC_ASSERT(std::is_arithmetic<T>::value, "binary_writer writes arithmetic types");
+        WALLE_ASSERT_MSG(available() >= sizeof(T), "binary_writer overflow");
+        internal::store_ordered<false>(_cursor, value);
+        _cursor += sizeof(T);
+    }
+
+    template <typename T>
+    WALLE_FORCE_INLINE void write_be_unchecked(T value)
+    {
+        WALLE_STATIC_ASSERT(std::is_arithmetic<T>::value, "binary_writer writes arithmetic types");
+        WALLE_ASSERT_MSG(available() >= sizeof(T), "binary_writer overflow");
+        internal::store_ordered<true>(_cursor, value);
+        _cursor += sizeof(T);
+    }
+
+    WALLE_FORCE_INLINE void write_varint_unchecked(uint64_t value)
+    {
+        WALLE_ASSERT_MSG(available() >= varint_size(value), "binary_writer overflow");
+        char *p = _cursor;
+        while (value >= 0x80) {
+            *p++ = static_cast<char>(value | 0x80);
+            value >>= 7;
+        }
+        *p++ = static_cast<char>(value);
+        _cursor = p;
+    }
+
+    WALLE_FORCE_INLINE void write_zigzag_unchecked(int64_t value)
+    {
+        write_varint_unchecked(zigzag_encode(value));
+    }
+
+    WALLE_FORCE_INLINE void write_bytes_unchecked(const void *data, size_t len)
+    {
+        WALLE_ASSERT_MSG(available() >= len, "binary_writer overflow");
+        std::memcpy(_cursor, data, len);
+        _cursor += len;
+    }
+
+    WALLE_FORCE_INLINE void write_string_unchecked(string_view str)
+    {
+        write_varint_unchecked(str.size());
+        write_bytes_unchecked(str.data(), str.size());
+    }
+
+private:
+    void grow(size_t n)
+    {
+        const size_t used = size();
+        _buffer.resize(used);
+        _buffer.reserve(used + n);
+        _begin = _buffer.data();
+        _cursor = _begin + used;
+        _limit = _begin + _buffer.capacity();
+    }
+
+    Buffer &_buffer;
+    char   *_begin;
+    char   *_cursor;
+    char   *_limit;
+};
+
+/**
+ * @brief  binary decoder over a byte range, the counterpart of
+ *         binary_writer.
+ * @note   checked reads return false and leave the position unchanged
+ *         when the input is too short or malformed. after checking
+ *         remaining() for a fixed size message the *_unchecked reads skip
+ *         the per field bounds checks. read_string() returns a view into
+ *         the input.
+ */
+class binary_reader {
+public:
+    binary_reader(const void *data, size_t size)
+    : _cursor(static_cast<const char*>(data)),
+      _end(static_cast<const char*>(data) + size)
+    {
+
+    }
+
+    explicit binary_reader(buffer_view<const char> view)
+    : _cursor(view.data()),
+      _end(view.data() + view.size())
+    {
+
+    }
+
+    size_t remaining() const
+    {
+        return _end - _cursor;
+    }
+
+    bool empty() const
+    {
+        return _cursor == _end;
+    }
+
+    const char *position() const
+    {
+        return _cursor;
+    }
+
+    bool skip(size_t n)
+    {
+        if (WALLE_UNLIKELY(remaining() < n)) {
+            return false;
+        }
+        _cursor += n;
+        return true;
+    }
+
+    template <typename T>
+    bool read_le(T &out)
+    {
+        if (WALLE_UNLIKELY(remaining() < sizeof(T))) {
+            return false;
+        }
+        out = read_le_unchecked<T>();
+        return true;
+    }
+
+    template <typename T>
+    bool read_be(T &out)
+    {
+        if (WALLE_UNLIKELY(remaining() < sizeof(T))) {
+            return false;
+        }
+        out = read_be_unchecked<T>();
+        return true;
+    }
+
+    /**
+     * @brief  false on truncated input or an encoding longer than
+     *         kMaxVarintSize bytes.
+     */
+    bool read_varint(uint64_t &out)
+    {
+        if (WALLE_LIKELY(_cursor != _end && static_cast<signed char>(*_cursor) >= 0)) {
+            out = static_cast<unsigned char>(*_cursor++);
+            return true;
+        }
+        return read_varint_slow(out);
+    }
+
+    bool read_zigzag(int64_t &out)
+    {
+        uint64_t v;
+        if (!read_varint(v)) {
+            return false;
+        }
+        out = zigzag_decode(v);
+        return true;
+    }
+
+    bool read_bytes(void *out, size_t len)
+    {
+        if (WALLE_UNLIKELY(remaining() < len)) {
+            return false;
+        }
+        read_bytes_unchecked(out, len);
+        return true;
+    }
+
+    bool read_string(string_view &out)
+    {
+        const char *start = _cursor;
+        uint64_t len;
+        if (!read_varint(len)) {
+            return false;
+        }
+        if (WALLE_UNLIKELY(remaining() < len)) {
+            _cursor = start;
+            return false;
+        }
+        out = string_view(_cursor, static_cast<size_t>(len));
+        _cursor += len;
+        return true;
+    }
+
+    template <typename T>
+    WALLE_FORCE_INLINE T read_le_unchecked()
+    {
+        WALLE_STATIC_ASSERT(std::is_arithmetic<T>::value, "binary_reader reads arithmetic types");
+        WALLE_ASSERT_MSG(remaining() >= sizeof(T), "binary_reader overflow");
+        const T v = internal::load_ordered<false, T>(_cursor);
+        _cursor += sizeof(T);
+        return v;
+    }
+
+    template <typename T>
+    WALLE_FORCE_INLINE T read_be_unchecked()
+    {
+        WALLE_STATIC_ASSERT(std::is_arithmetic<T>::value, "binary_reader reads arithmetic types");
+        WALLE_ASSERT_MSG(remaining() >= sizeof(T), "binary_reader overflow");
+        const T v = internal::load_ordered<true, T>(_cursor);
+        _cursor += sizeof(T);
+        return v;
+    }
+
+    WALLE_FORCE_INLINE void read_bytes_unchecked(void *out, size_t len)
+    {
+        WALLE_ASSERT_MSG(remaining() >= len, "binary_reader overflow");
+        std::memcpy(out, _cursor, len);
+        _cursor += len;
+    }
+
+private:
+    bool read_varint_slow(uint64_t &out)
+    {
+        const char *p = _cursor;
+        if (WALLE_LIKELY(remaining() >= kMaxVarintSize)) {
+            // no end check needed, at most kMaxVarintSize bytes are read.
+            uint64_t v = 0;
+            for (size_t i = 0; i < kMaxVarintSize - 1; ++i) {
+                const uint64_t b = static_cast<unsigned char>(p[i]);
+                v |= (b & 0x7f) << (7 * i);
+                if (b < 0x80) {
+                    out = v;
+                    _cursor = p + i + 1;
+                    return true;
+                }
+            }
+            const uint64_t last = static_cast<unsigned char>(p[kMaxVarintSize - 1]);
+            if (last > 1) {
+                return false;
+            }
+            out = v | (last << 63);
+            _cursor = p + kMaxVarintSize;
+            return true;
+        }
+        const size_t limit = remaining() < kMaxVarintSize ? remaining() : kMaxVarintSize;
+        uint64_t v = 0;
+        for (size_t i = 0; i < limit; ++i) {
+            const uint64_t b = static_cast<unsigned char>(p[i]);
+            v |= (b & 0x7f) << (7 * i);
+            if (b < 0x80) {
+                // the tenth byte may only carry the top bit.
+                if (i == kMaxVarintSize - 1 && b > 1) {
+                    return false;
+                }
+                out = v;
+                _cursor = p + i + 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const char *_cursor;
+    const char *_end;
+};
+
+}
+#endif //WALLE_WSL_BINARY_CODEC_H_
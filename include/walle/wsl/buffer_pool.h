@@ -0,0 +1,243 @@
+#ifndef WALLE_WSL_BUFFER_POOL_H_
+#define WALLE_WSL_BUFFER_POOL_H_
+#include <walle/config/base.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace wsl {
+
+namespace internal {
+struct pool_thread_cache;
+struct thread_cache_table;
+}
+
+/**
+ * @brief  pool of power of two sized memory blocks with a cache per thread
+ *         in front of a shared depot.
+ * @note   requests are rounded up to a size class between kMinBlockSize and
+ *         kMaxBlockSize, bigger ones go to malloc directly. a thread
+ *         allocates from and frees to its own cache without locking, an
+ *         empty cache refills a batch from the depot and a full one spills
+ *         half of its blocks to it, the depot only calls malloc/free on a
+ *         miss or trim(). blocks may be freed on any thread. a thread cache
+ *         is handed back to the depot when its thread exits.
+ *         a pool may be destroyed while threads that used it still run, as
+ *         long as none of them uses it again; their caches are freed when
+ *         they exit.
+ */
+class buffer_pool {
+public:
+    static const WALLE_CONSTEXPR size_t kMinBlockShift = 6;
+    static const WALLE_CONSTEXPR size_t kMaxBlockShift = 20;
+    static const WALLE_CONSTEXPR size_t kMinBlockSize = size_t(1) << kMinBlockShift;
+    static const WALLE_CONSTEXPR size_t kMaxBlockSize = size_t(1) << kMaxBlockShift;
+    static const WALLE_CONSTEXPR size_t kClassCount = kMaxBlockShift - kMinBlockShift + 1;
+
+    struct stats {
+        uint64_t allocations;       // allocate() calls.
+        uint64_t thread_hits;       // served by the calling thread's cache.
+        uint64_t depot_hits;        // served by a refill from the depot.
+        uint64_t misses;            // served by malloc.
+        uint64_t oversized;         // larger than kMaxBlockSize.
+        size_t   bytes_cached;      // free bytes held by thread caches and depot.
+        size_t   bytes_in_depot;    // free bytes held by the depot.
+
+        double hit_rate() const
+        {
+            return allocations ? double(thread_hits + depot_hits) / double(allocations) : 0.0;
+        }
+    };
+
+    /**
+     * @param  thread_cache_bytes: free bytes each thread keeps per size
+     *         class before spilling to the depot (at least one block).
+     */
+    explicit buffer_pool(size_t thread_cache_bytes = 256 * 1024);
+
+    /**
+     * @brief  releases the blocks of the depot and of the calling thread,
+     *         other threads free theirs when they exit. blocks still
+     *         allocated must not be freed to the pool afterwards.
+     */
+    ~buffer_pool();
+
+    WALLE_NON_COPYABLE(buffer_pool);
+
+    /**
+     * @brief  the process wide pool, never destroyed.
+     */
+    static buffer_pool &global();
+
+    /**
+     * @brief  a block of at least size bytes.
+     */
+    void *allocate(size_t size);
+
+    /**
+     * @brief  return a block, size is the size passed to allocate().
+     */
+    void deallocate(void *p, size_t size);
+
+    /**
+     * @brief  the usable size of a block allocated with size bytes.
+     */
+    static size_t block_size(size_t size)
+    {
+        if (size > kMaxBlockSize) {
+            return size;
+        }
+        return kMinBlockSize << size_class(size);
+    }
+
+    stats get_stats() const;
+
+    /**
+     * @brief  hand the calling thread's cached blocks to the depot.
+     */
+    void flush_thread_cache();
+
+    /**
+     * @brief  flush the calling thread's cache and free every depot block.
+     * @retval number of bytes returned to the system.
+     */
+    size_t trim();
+
+private:
+    friend struct internal::pool_thread_cache;
+    friend struct internal::thread_cache_table;
+
+    struct free_block {
+        free_block *next;
+    };
+
+    struct free_list {
+        free_block *head;
+        size_t      count;
+    };
+
+    struct depot_class {
+        std::mutex  lock;
+        free_list   list;
+    };
+
+    static size_t size_class(size_t size)
+    {
+        if (size <= kMinBlockSize) {
+            return 0;
+        }
+        return 64 - __builtin_clzll(static_cast<unsigned long long>(size - 1)) - kMinBlockShift;
+    }
+
+    size_t class_limit(size_t cls) const
+    {
+        const size_t n = _thread_cache_bytes >> (cls + kMinBlockShift);
+        return n ? n : 1;
+    }
+
+    internal::pool_thread_cache *thread_cache();
+    void *refill(internal::pool_thread_cache *tc, size_t cls);
+    void spill(internal::pool_thread_cache *tc, size_t cls, size_t keep);
+    void push_depot(size_t cls, free_block *first, free_block *last, size_t count);
+    void release_thread_cache(internal::pool_thread_cache *tc);
+
+    const uint64_t                              _id;
+    const size_t                                _thread_cache_bytes;
+    depot_class                                 _depot[kClassCount];
+    mutable std::mutex                          _caches_lock;
+    std::vector<internal::pool_thread_cache*>   _caches;
+    // counters of the caches of exited threads.
+    uint64_t                                    _retired[4];
+    // counters of threads without a cache for this pool.
+    std::atomic<uint64_t>                       _uncached_allocations;
+    std::atomic<uint64_t>                       _uncached_depot_hits;
+    std::atomic<uint64_t>                       _uncached_misses;
+    std::atomic<uint64_t>                       _oversized;
+    std::atomic<size_t>                         _depot_bytes;
+};
+
+/**
+ * @brief  allocator on top of a buffer_pool, for stack_buffer, containers
+ *         and container_buffer.
+ * @note   reallocate() keeps the block when the new size falls in the same
+ *         size class.
+ */
+template <typename T>
+class pool_allocator {
+public:
+    typedef T           value_type;
+    typedef T*          pointer;
+    typedef const T*    const_pointer;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+    typedef size_t      size_type;
+    typedef ptrdiff_t   difference_type;
+
+    template <typename U>
+    struct rebind {
+        typedef pool_allocator<U> other;
+    };
+
+    pool_allocator() WALLE_NOEXCEPT : _pool(&buffer_pool::global())
+    {
+
+    }
+
+    explicit pool_allocator(buffer_pool &pool) WALLE_NOEXCEPT : _pool(&pool)
+    {
+
+    }
+
+    template <typename U>
+    pool_allocator(const pool_allocator<U> &other) WALLE_NOEXCEPT : _pool(other.pool())
+    {
+
+    }
+
+    T *allocate(size_type n)
+    {
+        return static_cast<T*>(_pool->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_type n)
+    {
+        _pool->deallocate(p, n * sizeof(T));
+    }
+
+    T *reallocate(T *p, size_type old_n, size_type new_n)
+    {
+        if (buffer_pool::block_size(old_n * sizeof(T)) == buffer_pool::block_size(new_n * sizeof(T))) {
+            return p;
+        }
+        T *np = allocate(new_n);
+        std::memcpy(static_cast<void*>(np), p, (old_n < new_n ? old_n : new_n) * sizeof(T));
+        deallocate(p, old_n);
+        return np;
+    }
+
+    buffer_pool *pool() const
+    {
+        return _pool;
+    }
+
+private:
+    buffer_pool *_pool;
+};
+
+template <typename T, typename U>
+inline bool operator==(const pool_allocator<T> &a, const pool_allocator<U> &b)
+{
+    return a.pool() == b.pool();
+}
+
+template <typename T, typename U>
+inline bool operator!=(const pool_allocator<T> &a, const pool_allocator<U> &b)
+{
+    return a.pool() != b.pool();
+}
+
+}
+#endif //WALLE_WSL_BUFFER_POOL_H_
@@ -0,0 +1,206 @@
+#ifndef WALLE_WSL_CHAIN_BUFFER_H_
+#define WALLE_WSL_CHAIN_BUFFER_H_
+#include <walle/config/base.h>
+#include <walle/wsl/buffer_view.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <sys/uio.h>
+
+namespace wsl {
+
+namespace internal {
+
+/**
+ * @brief  refcounted storage block of a chain_buffer, the payload follows
+ *         the header in the same allocation.
+ */
+class chain_block {
+public:
+    static chain_block *create(size_t capacity);
+
+    void ref()
+    {
+        _refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void unref();
+
+    /**
+     * @brief  true when no other chain references this block,
+     *         so the bytes past every segment may be written.
+     */
+    bool unique() const
+    {
+        return _refs.load(std::memory_order_acquire) == 1;
+    }
+
+    size_t capacity() const
+    {
+        return _capacity;
+    }
+
+    char *data()
+    {
+        return reinterpret_cast<char*>(this + 1);
+    }
+
+private:
+    explicit chain_block(size_t capacity) : _refs(1), _capacity(capacity) {}
+    ~chain_block() {}
+
+    std::atomic<uint32_t>   _refs;
+    size_t                  _capacity;
+};
+
+}
+
+/**
+ * @brief  a byte sequence stored as a chain of refcounted blocks.
+ * @note   copying, appending another chain and split() share the blocks
+ *         instead of copying bytes, only appending raw memory copies it.
+ *         a block is written only while exactly one chain references it, so
+ *         shared bytes are never modified. the refcount is atomic and chains
+ *         sharing blocks may live on different threads, a single chain is
+ *         not thread safe.
+ */
+class chain_buffer {
+public:
+    static const WALLE_CONSTEXPR size_t kDefaultBlockSize = 4096 - 64;
+
+    /**
+     * @param  block_size: payload size of the blocks allocated by append()
+     *         and prepare().
+     */
+    explicit chain_buffer(size_t block_size = kDefaultBlockSize);
+
+    /**
+     * @brief  shares the blocks of other, no payload is copied.
+     */
+    chain_buffer(const chain_buffer &other);
+    chain_buffer(chain_buffer &&other);
+    chain_buffer &operator=(const chain_buffer &other);
+    chain_buffer &operator=(chain_buffer &&other);
+    ~chain_buffer();
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    size_t block_size() const
+    {
+        return _block_size;
+    }
+
+    /**
+     * @brief  number of contiguous segments, the iovec count of to_iovec().
+     */
+    size_t segment_count() const
+    {
+        return _segments.size();
+    }
+
+    buffer_view<const char> segment(size_t index) const
+    {
+        WALLE_ASSERT_MSG(index < _segments.size(), "segment index overflow");
+        const segment_type &s = _segments[index];
+        return buffer_view<const char>(s.block->data() + s.offset, s.length);
+    }
+
+    /**
+     * @brief  copy len bytes to the end, filling the free tail of the last
+     *         block first when it is not shared.
+     */
+    void append(const void *data, size_t len);
+
+    void append(buffer_view<const char> view)
+    {
+        append(view.data(), view.size());
+    }
+
+    void append(buffer_view<char> view)
+    {
+        append(view.data(), view.size());
+    }
+
+    /**
+     * @brief  link the blocks of other to the end without copying.
+     */
+    void append(const chain_buffer &other);
+    void append(chain_buffer &&other);
+
+    /**
+     * @brief  writable space of at least len contiguous bytes at the end,
+     *         e.g. to read() into. the bytes become part of the chain
+     *         with commit().
+     */
+    buffer_view<char> prepare(size_t len);
+
+    /**
+     * @brief  append len bytes written to the last prepare() view.
+     */
+    void commit(size_t len);
+
+    /**
+     * @brief  drop the first len bytes.
+     */
+    void trim_front(size_t len);
+
+    /**
+     * @brief  drop the last len bytes.
+     */
+    void trim_back(size_t len);
+
+    /**
+     * @brief  remove the first len bytes and return them as a new chain,
+     *         a block on the boundary is shared by both chains.
+     */
+    chain_buffer split(size_t len);
+
+    void clear();
+
+    /**
+     * @brief  fill iov with up to max segments for writev().
+     * @retval number of entries written.
+     */
+    size_t to_iovec(struct iovec *iov, size_t max) const;
+
+    /**
+     * @brief  copy up to len bytes from the front to out.
+     * @retval number of bytes copied.
+     */
+    size_t copy_to(void *out, size_t len) const;
+
+    /**
+     * @brief  make the content a single segment and return it.
+     * @note   copies when the chain has more than one segment.
+     */
+    buffer_view<const char> linearize();
+
+private:
+    struct segment_type {
+        internal::chain_block  *block;
+        size_t                  offset;
+        size_t                  length;
+    };
+
+    size_t tail_room() const;
+    void release();
+
+    std::deque<segment_type>    _segments;
+    size_t                      _size;
+    size_t                      _block_size;
+    // block handed out by prepare() when the tail had no room.
+    internal::chain_block      *_spare;
+    bool                        _prepared_spare;
+};
+
+}
+#endif //WALLE_WSL_CHAIN_BUFFER_H_
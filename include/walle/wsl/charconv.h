@@ -0,0 +1,226 @@
+#ifndef WALLE_WSL_CHARCONV_H_
+#define WALLE_WSL_CHARCONV_H_
+#include <walle/config/base.h>
+#include <walle/wsl/buffer_view.h>
+#include <walle/wsl/string_view.h>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <type_traits>
+
+namespace wsl {
+
+/**
+ * @brief  outcome of from_chars(), as std::from_chars_result.
+ * @note   ptr is the first character that is not part of the number, so a
+ *         field parsed completely ends with ptr == last and any other ptr
+ *         is the exact position of the offending character.
+ *         ec is std::errc() on success, invalid_argument when there is no
+ *         number at first (ptr == first) and result_out_of_range when the
+ *         number does not fit (ptr past it), value is unchanged on error.
+ */
+struct from_chars_result {
+    const char  *ptr;
+    std::errc   ec;
+
+    bool ok() const
+    {
+        return ec == std::errc();
+    }
+};
+
+namespace internal {
+
+WALLE_FORCE_INLINE uint64_t load_digits8(const char *p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+// every byte of v is '0'..'9'.
+WALLE_FORCE_INLINE bool is_eight_digits(uint64_t v)
+{
+    return (((v & 0xf0f0f0f0f0f0f0f0ull) |
+             (((v + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) >> 4)) == 0x3333333333333333ull);
+}
+
+// eight ascii digits, the first in the lowest byte, to their value with
+// three multiplies: pairs, then quads, then the whole.
+WALLE_FORCE_INLINE uint32_t parse_eight_digits(uint64_t v)
+{
+    v = (v & 0x0f0f0f0f0f0f0f0full) * 2561 >> 8;
+    v = (v & 0x00ff00ff00ff00ffull) * 6553601 >> 16;
+    return uint32_t((v & 0x0000ffff0000ffffull) * 42949672960001ull >> 32);
+}
+
+WALLE_FORCE_INLINE bool is_digit(char c)
+{
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+/**
+ * @brief  the decimal digits at p as an uint64_t.
+ * @retval the end of the digits, overflow is set when the value doesn't
+ *         fit. 19 digits never overflow, so those go eight at a time
+ *         without checks.
+ */
+WALLE_FORCE_INLINE const char *parse_decimal(const char *p, const char *last, uint64_t &value, bool &overflow)
+{
+    while (p < last && *p == '0') {
+        ++p;
+    }
+    const char *const significant = p;
+    uint64_t v = 0;
+    while (last - p >= 8 && p - significant <= 11) {
+        const uint64_t chunk = load_digits8(p);
+        if (!is_eight_digits(chunk)) {
+            break;
+        }
+        v = v * 100000000 + parse_eight_digits(chunk);
+        p += 8;
+    }
+    while (p < last && is_digit(*p) && p - significant < 19) {
+        v = v * 10 + uint64_t(*p - '0');
+        ++p;
+    }
+    overflow = false;
+    if (p < last && is_digit(*p)) {
+        // the 20th digit fits only below 18446744073709551615.
+        const uint64_t d = uint64_t(*p - '0');
+        ++p;
+        if (v > (std::numeric_limits<uint64_t>::max() - d) / 10) {
+            overflow = true;
+        }
+        v = v * 10 + d;
+        while (p < last && is_digit(*p)) {
+            overflow = true;
+            ++p;
+        }
+    }
+    value = v;
+    return p;
+}
+
+WALLE_FORCE_INLINE unsigned digit_value(char c)
+{
+    const unsigned char u = static_cast<unsigned char>(c);
+    if (u - '0' < 10) {
+        return u - '0';
+    }
+    if ((u | 0x20) - 'a' < 26) {
+        return (u | 0x20) - 'a' + 10;
+    }
+    return 36;
+}
+
+inline const char *parse_base(const char *p, const char *last, unsigned base, uint64_t &value, bool &overflow)
+{
+    uint64_t v = 0;
+    overflow = false;
+    for (; p < last; ++p) {
+        const unsigned d = digit_value(*p);
+        if (d >= base) {
+            break;
+        }
+        if (__builtin_mul_overflow(v, uint64_t(base), &v) || __builtin_add_overflow(v, uint64_t(d), &v)) {
+            overflow = true;
+        }
+    }
+    value = v;
+    return p;
+}
+
+}
+
+/**
+ * @brief  parse an integer from [first, last) in base 2 to 36, as
+ *         std::from_chars: an optional '-' for signed types, no '+', no
+ *         whitespace, no base prefix, not locale dependent.
+ * @note   base 10 digits are validated and converted eight at a time from
+ *         one 8 byte load (SWAR) while 19 digits can't overflow.
+ */
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, from_chars_result>::type
+from_chars(const char *first, const char *last, T &value, int base = 10)
+{
+    WALLE_ASSERT_MSG(base >= 2 && base <= 36, "base out of range");
+    typedef typename std::make_unsigned<T>::type unsigned_type;
+    const char *p = first;
+    bool negative = false;
+    if (std::is_signed<T>::value && p < last && *p == '-') {
+        negative = true;
+        ++p;
+    }
+    uint64_t magnitude;
+    bool overflow;
+    const char *const digits = p;
+    if (base == 10) {
+        p = internal::parse_decimal(p, last, magnitude, overflow);
+    } else {
+        p = internal::parse_base(p, last, unsigned(base), magnitude, overflow);
+    }
+    from_chars_result r;
+    if (p == digits) {
+        r.ptr = first;
+        r.ec = std::errc::invalid_argument;
+        return r;
+    }
+    r.ptr = p;
+    // the largest magnitude: max for positive, max + 1 for negative.
+    const uint64_t limit = uint64_t(std::numeric_limits<unsigned_type>::max() >> (std::is_signed<T>::value ? 1 : 0)) + (negative ? 1 : 0);
+    if (overflow || magnitude > limit) {
+        r.ec = std::errc::result_out_of_range;
+        return r;
+    }
+    value = negative ? T(unsigned_type(0) - unsigned_type(magnitude)) : T(magnitude);
+    r.ec = std::errc();
+    return r;
+}
+
+/**
+ * @brief  parse a double or float from [first, last), as std::from_chars
+ *         with chars_format::general: [-]digits[.digits][(e|E)[+|-]digits],
+ *         inf, infinity, nan and nan(chars) in any case. correctly rounded
+ *         to nearest, not locale dependent.
+ * @note   up to 19 significant digits (8 at a time with SWAR) form the
+ *         decimal mantissa w of w * 10^q. small w and q are converted
+ *         exactly with one floating point multiply or divide (Clinger),
+ *         the others with the Eisel-Lemire algorithm: one or two 64x128
+ *         bit multiplies by a table of truncated powers of five, which
+ *         rounds correctly or reports that it can't. longer mantissas
+ *         are bounded by w and w + 1. the rare inputs left undecided go to
+ *         strtod_l in the "C" locale.
+ *         out of range: finite input that overflows to infinity or
+ *         underflows to zero.
+ */
+from_chars_result from_chars(const char *first, const char *last, double &value);
+from_chars_result from_chars(const char *first, const char *last, float &value);
+
+template <typename T>
+inline from_chars_result from_chars(string_view s, T &value)
+{
+    return from_chars(s.data(), s.data() + s.size(), value);
+}
+
+template <typename T>
+inline from_chars_result from_chars(string_view s, T &value, int base)
+{
+    return from_chars(s.data(), s.data() + s.size(), value, base);
+}
+
+template <typename T>
+inline from_chars_result from_chars(buffer_view<const char> s, T &value)
+{
+    return from_chars(s.data(), s.data() + s.size(), value);
+}
+
+template <typename T>
+inline from_chars_result from_chars(buffer_view<const char> s, T &value, int base)
+{
+    return from_chars(s.data(), s.data() + s.size(), value, base);
+}
+
+}
+#endif //WALLE_WSL_CHARCONV_H_
@@ -0,0 +1,735 @@
+#ifndef WALLE_WSL_CONCURRENT_HASH_MAP_H_
+#define WALLE_WSL_CONCURRENT_HASH_MAP_H_
+#include <walle/config/base.h>
+#include <walle/math/power2.h>
+#include <walle/wsl/allocator.h>
+#include <walle/wsl/internal/raw_hash_table.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace wsl {
+
+/**
+ * @brief  hash map shared by many threads, for read mostly data: lookups
+ *         of trivially copyable keys and values never lock and never
+ *         write shared memory.
+ * @note   keys are spread over 2^k shards (cache line aligned, 4 per
+ *         hardware thread by default), each a linear probing table behind
+ *         a mutex for writers and a sequence counter (seqlock) for
+ *         readers: a writer makes the counter odd, changes the table and
+ *         makes it even again, a reader copies the key and value out and
+ *         keeps them only if the counter was even and unchanged around the
+ *         copy, so reads scale with cores and a write only delays readers
+ *         of its own shard. keys or values that are not trivially copyable
+ *         can't be copied half written, their readers take the shard
+ *         mutex instead; intern string keys with wsl::string_pool to keep
+ *         reads lock free.
+ *         a shard grows without stopping: past 3/4 full it starts a table
+ *         of twice the size, new keys go there and every write moves a few
+ *         slots of the old table over, lookups search both until the old
+ *         one is empty. replaced tables stay allocated until the map is
+ *         destroyed, a reader may still be in one; they add up to less
+ *         than the current tables.
+ *         Eq must be safe to call on any key a slot ever held.
+ *         values are returned by copy, there are no iterators.
+ */
+template <typename K,
+          typename V,
+          typename Hash = wsl::hash<K>,
+          typename Eq = wsl::hash_equal<K> >
+class concurrent_hash_map {
+public:
+    typedef K           key_type;
+    typedef V           mapped_type;
+    typedef size_t      size_type;
+
+    struct shard_stats {
+        size_t  size;           // keys.
+        size_t  capacity;       // slots of the current table.
+        size_t  migrating;      // slots of the table being emptied, 0 when none.
+        size_t  writes;         // inserts, assigns and erases.
+        size_t  grows;          // tables started.
+        size_t  read_retries;   // lock free reads repeated after a write.
+        size_t  retired_bytes;  // replaced tables kept for late readers.
+    };
+
+    /**
+     * @param  shards: rounded up to a power of two, 0 for 4 per hardware
+     *         thread (at least 16).
+     * @param  capacity: keys to hold without growing.
+     */
+    explicit concurrent_hash_map(size_t shards = 0, size_t capacity = 0,
+                                 const Hash &hf = Hash(), const Eq &eq = Eq())
+    : _hash(hf),
+      _eq(eq)
+    {
+        if (shards == 0) {
+            shards = 4 * size_t(std::thread::hardware_concurrency());
+            shards = shards < 16 ? 16 : shards;
+        }
+        shards = shards > kMaxShards ? kMaxShards : shards;
+        _shard_count = walle::math::round_up_to_power_of_two(shards);
+        _shard_mask = _shard_count - 1;
+        _shards = static_cast<shard*>(allocate_cache_aligned(_shard_count * sizeof(shard)));
+        const size_t per_shard = (capacity + _shard_count - 1) / _shard_count;
+        for (size_t i = 0; i < _shard_count; ++i) {
+            new (_shards + i) shard();
+            _shards[i].current.store(make_table(capacity_for(per_shard)), std::memory_order_release);
+        }
+    }
+
+    ~concurrent_hash_map()
+    {
+        for (size_t i = 0; i < _shard_count; ++i) {
+            shard &s = _shards[i];
+            free_table(s.current.load(std::memory_order_relaxed));
+            free_table(s.old.load(std::memory_order_relaxed));
+            for (size_t j = 0; j < s.retired.size(); ++j) {
+                free_table(s.retired[j]);
+            }
+            s.~shard();
+        }
+        deallocate_aligned(_shards);
+    }
+
+    WALLE_NON_COPYABLE(concurrent_hash_map);
+
+    /**
+     * @brief  copy the value of key into value.
+     * @retval false when key is absent, value is left alone.
+     */
+    bool find(const K &key, V &value) const
+    {
+        const uint64_t h = hash_of(key);
+        shard &s = shard_of(h);
+        if (kOptimistic) {
+            return optimistic_find(s, h, key, &value);
+        }
+        std::lock_guard<std::mutex> guard(s.lock);
+        slot *p = locked_find(s, h, key);
+        if (!p) {
+            return false;
+        }
+        value = p->value();
+        return true;
+    }
+
+    bool contains(const K &key) const
+    {
+        const uint64_t h = hash_of(key);
+        shard &s = shard_of(h);
+        if (kOptimistic) {
+            return optimistic_find(s, h, key, WALLE_NULL);
+        }
+        std::lock_guard<std::mutex> guard(s.lock);
+        return locked_find(s, h, key) != WALLE_NULL;
+    }
+
+    V get(const K &key, const V &missing = V()) const
+    {
+        V v;
+        return find(key, v) ? v : missing;
+    }
+
+    /**
+     * @brief  add key with value unless key is present.
+     * @retval true when added.
+     */
+    bool insert(const K &key, const V &value)
+    {
+        const uint64_t h = hash_of(key);
+        shard &s = shard_of(h);
+        std::lock_guard<std::mutex> guard(s.lock);
+        if (locked_find(s, h, key)) {
+            return false;
+        }
+        table *bigger = table_to_grow(s);
+        write_section section(s);
+        add(s, h, key, value, bigger);
+        return true;
+    }
+
+    /**
+     * @brief  set the value of key, adding it when absent.
+     * @retval true when added.
+     */
+    bool insert_or_assign(const K &key, const V &value)
+    {
+        const uint64_t h = hash_of(key);
+        shard &s = shard_of(h);
+        std::lock_guard<std::mutex> guard(s.lock);
+        slot *p = locked_find(s, h, key);
+        table *bigger = p ? WALLE_NULL : table_to_grow(s);
+        write_section section(s);
+        if (p) {
+            p->value() = value;
+            ++s.writes;
+            migrate_step(s);
+        } else {
+            add(s, h, key, value, bigger);
+        }
+        return p == WALLE_NULL;
+    }
+
+    /**
+     * @brief  the value of key, or make() stored as its value when absent.
+     * @note   make runs under the shard's writer lock but readers go on,
+     *         only one thread makes the value of a key.
+     */
+    template <typename F>
+    V compute_if_absent(const K &key, F make)
+    {
+        V v;
+        if (kOptimistic && find(key, v)) {
+            return v;
+        }
+        const uint64_t h = hash_of(key);
+        shard &s = shard_of(h);
+        std::lock_guard<std::mutex> guard(s.lock);
+        if (slot *p = locked_find(s, h, key)) {
+            return p->value();
+        }
+        v = make();
+        table *bigger = table_to_grow(s);
+        write_section section(s);
+        add(s, h, key, v, bigger);
+        return v;
+    }
+
+    /**
+     * @brief  update(V &) the value of key when present.
+     * @note   update runs on a copy under the shard's writer lock, outside
+     *         the write section, and the result is stored back; when update
+     *         throws the value is left alone.
+     * @retval true when key was present.
+     */
+    template <typename F>
+    bool compute_if_present(const K &key, F update)
+    {
+        const uint64_t h = hash_of(key);
+        shard &s = shard_of(h);
+        std::lock_guard<std::mutex> guard(s.lock);
+        slot *p = locked_find(s, h, key);
+        if (!p) {
+            return false;
+        }
+        V v(p->value());
+        update(v);
+        write_section section(s);
+        p->value() = std::move(v);
+        ++s.writes;
+        migrate_step(s);
+        return true;
+    }
+
+    /**
+     * @retval true when key was present.
+     */
+    bool erase(const K &key)
+    {
+        const uint64_t h = hash_of(key);
+        shard &s = shard_of(h);
+        std::lock_guard<std::mutex> guard(s.lock);
+        table *t = s.current.load(std::memory_order_relaxed);
+        size_t i = locked_index(t, h, key);
+        table *in = t;
+        if (i == kNotFound && s.old.load(std::memory_order_relaxed)) {
+            in = s.old.load(std::memory_order_relaxed);
+            i = locked_index(in, h, key);
+        }
+        if (i == kNotFound) {
+            return false;
+        }
+        write_section section(s);
+        if (in != t) {
+            // in the old table: leave a moved marker, its probe chains stay.
+            in->slots[i].destroy();
+            in->slots[i].meta.store(kMoved, std::memory_order_relaxed);
+        } else {
+            remove(t, i);
+        }
+        s.count.store(s.count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        ++s.writes;
+        migrate_step(s);
+        return true;
+    }
+
+    /**
+     * @brief  remove every key, the tables keep their size.
+     */
+    void clear()
+    {
+        for (size_t i = 0; i < _shard_count; ++i) {
+            shard &s = _shards[i];
+            std::lock_guard<std::mutex> guard(s.lock);
+            write_section section(s);
+            finish_migration(s);
+            table *t = s.current.load(std::memory_order_relaxed);
+            for (size_t j = 0; j <= t->mask; ++j) {
+                if (t->slots[j].full()) {
+                    t->slots[j].destroy();
+                    t->slots[j].meta.store(kEmpty, std::memory_order_relaxed);
+                }
+            }
+            t->size = 0;
+            s.count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief  the number of keys, exact only while no writer runs.
+     */
+    size_t size() const
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < _shard_count; ++i) {
+            n += _shards[i].count.load(std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    size_t shard_count() const
+    {
+        return _shard_count;
+    }
+
+    shard_stats get_shard_stats(size_t i) const
+    {
+        WALLE_ASSERT_MSG(i < _shard_count, "shard out of range");
+        shard &s = _shards[i];
+        std::lock_guard<std::mutex> guard(s.lock);
+        const table *o = s.old.load(std::memory_order_relaxed);
+        shard_stats st;
+        st.size = s.count.load(std::memory_order_relaxed);
+        st.capacity = s.current.load(std::memory_order_relaxed)->mask + 1;
+        st.migrating = o ? o->mask + 1 : 0;
+        st.writes = s.writes;
+        st.grows = s.grows;
+        st.read_retries = s.read_retries.load(std::memory_order_relaxed);
+        st.retired_bytes = s.retired_bytes;
+        return st;
+    }
+
+    /**
+     * @brief  the sum over all shards.
+     */
+    shard_stats get_stats() const
+    {
+        shard_stats total;
+        std::memset(&total, 0, sizeof(total));
+        for (size_t i = 0; i < _shard_count; ++i) {
+            const shard_stats st = get_shard_stats(i);
+            total.size += st.size;
+            total.capacity += st.capacity;
+            total.migrating += st.migrating;
+            total.writes += st.writes;
+            total.grows += st.grows;
+            total.read_retries += st.read_retries;
+            total.retired_bytes += st.retired_bytes;
+        }
+        return total;
+    }
+
+private:
+    static const bool kOptimistic = std::is_trivially_copyable<K>::value &&
+                                    std::is_trivially_copyable<V>::value;
+    static const size_t kMaxShards = 1 << 16;
+    static const size_t kMinCapacity = 16;
+    // old table slots moved per write while a shard grows.
+    static const size_t kMigrateStep = 8;
+    static const size_t kNotFound = size_t(-1);
+    // slot meta: empty, moved out of an old table, or the key's hash (two
+    // low bits forced on so it is neither).
+    static const uint64_t kEmpty = 0;
+    static const uint64_t kMoved = 1;
+
+    struct slot {
+        std::atomic<uint64_t>                                   meta;
+        typename std::aligned_storage<sizeof(K), alignof(K)>::type key_storage;
+        typename std::aligned_storage<sizeof(V), alignof(V)>::type value_storage;
+
+        uint64_t hash() const
+        {
+            return meta.load(std::memory_order_relaxed);
+        }
+
+        bool full() const
+        {
+            return hash() > kMoved;
+        }
+
+        K &key()
+        {
+            return *reinterpret_cast<K*>(&key_storage);
+        }
+
+        V &value()
+        {
+            return *reinterpret_cast<V*>(&value_storage);
+        }
+
+        void destroy()
+        {
+            key().~K();
+            value().~V();
+        }
+    };
+
+    struct table {
+        size_t  mask;
+        size_t  size;   // full slots, under the shard lock.
+        slot    *slots;
+    };
+
+    struct alignas(WALLE_CACHE_LINE_SIZE) shard {
+        // read by every lookup.
+        std::atomic<uint64_t>   version;
+        std::atomic<table*>     current;
+        std::atomic<table*>     old;
+        std::atomic<size_t>     count;
+        std::atomic<size_t>     read_retries;
+        // writers only, under lock.
+        std::mutex              lock;
+        size_t                  migrate_pos;
+        size_t                  writes;
+        size_t                  grows;
+        size_t                  retired_bytes;
+        std::vector<table*>     retired;
+
+        shard()
+        : version(0),
+          current(WALLE_NULL),
+          old(WALLE_NULL),
+          count(0),
+          read_retries(0),
+          migrate_pos(0),
+          writes(0),
+          grows(0),
+          retired_bytes(0)
+        {
+
+        }
+    };
+
+    uint64_t hash_of(const K &key) const
+    {
+        return uint64_t(_hash(key)) | 3;
+    }
+
+    // the top bits pick the shard, the low bits the slot.
+    shard &shard_of(uint64_t h) const
+    {
+        return _shards[(h >> 40) & _shard_mask];
+    }
+
+    // the two low bits are always set.
+    static size_t home(const table *t, uint64_t h)
+    {
+        return size_t(h >> 2) & t->mask;
+    }
+
+    static size_t capacity_for(size_t n)
+    {
+        size_t c = kMinCapacity;
+        while (c * 3 / 4 < n) {
+            c <<= 1;
+        }
+        return c;
+    }
+
+    static size_t table_bytes(const table *t)
+    {
+        return sizeof(table) + (t->mask + 1) * sizeof(slot);
+    }
+
+    static table *make_table(size_t capacity)
+    {
+        table *t = new table;
+        t->mask = capacity - 1;
+        t->size = 0;
+        t->slots = static_cast<slot*>(allocate_cache_aligned(capacity * sizeof(slot)));
+        for (size_t i = 0; i < capacity; ++i) {
+            new (&t->slots[i].meta) std::atomic<uint64_t>(kEmpty);
+        }
+        return t;
+    }
+
+    static void free_table(table *t)
+    {
+        if (!t) {
+            return;
+        }
+        for (size_t i = 0; i <= t->mask; ++i) {
+            if (t->slots[i].full()) {
+                t->slots[i].destroy();
+            }
+        }
+        deallocate_aligned(t->slots);
+        delete t;
+    }
+
+    // seqlock reader: a copy is kept only when no writer touched the shard
+    // while it was made.
+    bool optimistic_find(shard &s, uint64_t h, const K &key, V *value) const
+    {
+        typedef typename std::aligned_storage<sizeof(V), alignof(V)>::type value_storage;
+        value_storage found_value = value_storage();
+        for (unsigned spins = 0;; ++spins) {
+            const uint64_t v = s.version.load(std::memory_order_acquire);
+            if (WALLE_UNLIKELY(v & 1)) {
+                pause(spins);
+                continue;
+            }
+            const table *t = s.current.load(std::memory_order_acquire);
+            const table *o = s.old.load(std::memory_order_acquire);
+            const bool found = optimistic_probe(t, h, key, &found_value) ||
+                               (o && optimistic_probe(o, h, key, &found_value));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (WALLE_LIKELY(s.version.load(std::memory_order_relaxed) == v)) {
+                if (found && value) {
+                    std::memcpy(static_cast<void*>(value), &found_value, sizeof(V));
+                }
+                return found;
+            }
+            s.read_retries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename Storage>
+    bool optimistic_probe(const table *t, uint64_t h, const K &key, Storage *value) const
+    {
+        typename std::aligned_storage<sizeof(K), alignof(K)>::type copy;
+        // a torn table can look full, the probe is bounded.
+        for (size_t i = home(t, h), n = 0; n <= t->mask; i = (i + 1) & t->mask, ++n) {
+            const slot &p = t->slots[i];
+            const uint64_t m = p.meta.load(std::memory_order_relaxed);
+            if (m == kEmpty) {
+                return false;
+            }
+            if (m == h) {
+                std::memcpy(&copy, &p.key_storage, sizeof(K));
+                if (_eq(*reinterpret_cast<const K*>(&copy), key)) {
+                    std::memcpy(value, &p.value_storage, sizeof(V));
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    static void pause(unsigned spins)
+    {
+        if (spins < 64) {
+#if defined(__SSE2__)
+            __builtin_ia32_pause();
+#endif
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    size_t locked_index(const table *t, uint64_t h, const K &key) const
+    {
+        for (size_t i = home(t, h);; i = (i + 1) & t->mask) {
+            const slot &p = t->slots[i];
+            const uint64_t m = p.hash();
+            if (m == kEmpty) {
+                return kNotFound;
+            }
+            if (m == h && _eq(const_cast<slot&>(p).key(), key)) {
+                return i;
+            }
+        }
+    }
+
+    slot *locked_find(shard &s, uint64_t h, const K &key) const
+    {
+        table *t = s.current.load(std::memory_order_relaxed);
+        size_t i = locked_index(t, h, key);
+        if (i != kNotFound) {
+            return &t->slots[i];
+        }
+        table *o = s.old.load(std::memory_order_relaxed);
+        if (o && (i = locked_index(o, h, key)) != kNotFound) {
+            return &o->slots[i];
+        }
+        return WALLE_NULL;
+    }
+
+    // the version is odd from construction to destruction, also when the
+    // section is left by an exception: a version left odd would stall every
+    // reader of the shard. the retired list gets room for the tables the
+    // section may retire first, so that only user code (K and V
+    // constructors and assignment) can throw inside.
+    class write_section {
+    public:
+        explicit write_section(shard &s) : _s(s)
+        {
+            s.retired.reserve(s.retired.size() + 2);
+            s.version.store(s.version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        ~write_section()
+        {
+            _s.version.store(_s.version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        WALLE_NON_COPYABLE(write_section);
+
+    private:
+        shard &_s;
+    };
+
+    // a slot of t that is known to be absent.
+    static slot &place(table *t, uint64_t h)
+    {
+        size_t i = home(t, h);
+        while (t->slots[i].full()) {
+            i = (i + 1) & t->mask;
+        }
+        ++t->size;
+        return t->slots[i];
+    }
+
+    // the table a new key would make the shard grow into, allocated before
+    // the write section. the retired list is reserved first, so the section
+    // doesn't throw and leak the table.
+    static table *table_to_grow(shard &s)
+    {
+        s.retired.reserve(s.retired.size() + 2);
+        const table *t = s.current.load(std::memory_order_relaxed);
+        if (t->size + 1 > (t->mask + 1) / 4 * 3) {
+            return make_table((t->mask + 1) * 2);
+        }
+        return WALLE_NULL;
+    }
+
+    // a key known to be absent, inside a write section. bigger is
+    // table_to_grow() of the shard.
+    void add(shard &s, uint64_t h, const K &key, const V &value, table *bigger)
+    {
+        table *t = s.current.load(std::memory_order_relaxed);
+        if (bigger) {
+            finish_migration(s);
+            start_migration(s, bigger);
+            t = bigger;
+        }
+        slot &p = place(t, h);
+        new (&p.key_storage) K(key);
+        new (&p.value_storage) V(value);
+        p.meta.store(h, std::memory_order_relaxed);
+        s.count.store(s.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        ++s.writes;
+        migrate_step(s);
+    }
+
+    // linear probing erase without tombstones: later keys of the cluster
+    // that may not sit before their home slot move back.
+    static void remove(table *t, size_t i)
+    {
+        t->slots[i].destroy();
+        for (size_t j = (i + 1) & t->mask;; j = (j + 1) & t->mask) {
+            slot &p = t->slots[j];
+            if (!p.full()) {
+                break;
+            }
+            const size_t k = home(t, p.hash());
+            // move p to the hole when its home k is not in (i, j] cyclically.
+            if ((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j)) {
+                slot &hole = t->slots[i];
+                new (&hole.key_storage) K(std::move(p.key()));
+                new (&hole.value_storage) V(std::move(p.value()));
+                hole.meta.store(p.hash(), std::memory_order_relaxed);
+                p.destroy();
+                i = j;
+            }
+        }
+        t->slots[i].meta.store(kEmpty, std::memory_order_relaxed);
+        --t->size;
+    }
+
+    void start_migration(shard &s, table *bigger)
+    {
+        table *t = s.current.load(std::memory_order_relaxed);
+        s.old.store(t, std::memory_order_release);
+        s.current.store(bigger, std::memory_order_release);
+        s.migrate_pos = 0;
+        ++s.grows;
+    }
+
+    void move_slot(table *o, size_t i, table *t)
+    {
+        slot &from = o->slots[i];
+        if (!from.full()) {
+            return;
+        }
+        const uint64_t h = from.hash();
+        slot &to = place(t, h);
+        new (&to.key_storage) K(std::move(from.key()));
+        new (&to.value_storage) V(std::move(from.value()));
+        to.meta.store(h, std::memory_order_relaxed);
+        from.destroy();
+        from.meta.store(kMoved, std::memory_order_relaxed);
+    }
+
+    void migrate_step(shard &s)
+    {
+        table *o = s.old.load(std::memory_order_relaxed);
+        if (!o) {
+            return;
+        }
+        table *t = s.current.load(std::memory_order_relaxed);
+        const size_t end = s.migrate_pos + kMigrateStep;
+        for (; s.migrate_pos <= o->mask && s.migrate_pos < end; ++s.migrate_pos) {
+            move_slot(o, s.migrate_pos, t);
+        }
+        if (s.migrate_pos > o->mask) {
+            retire_old(s);
+        }
+    }
+
+    void finish_migration(shard &s)
+    {
+        table *o = s.old.load(std::memory_order_relaxed);
+        if (!o) {
+            return;
+        }
+        table *t = s.current.load(std::memory_order_relaxed);
+        for (; s.migrate_pos <= o->mask; ++s.migrate_pos) {
+            move_slot(o, s.migrate_pos, t);
+        }
+        retire_old(s);
+    }
+
+    // the emptied table stays allocated, a reader may still be probing it.
+    void retire_old(shard &s)
+    {
+        table *o = s.old.load(std::memory_order_relaxed);
+        s.old.store(WALLE_NULL, std::memory_order_release);
+        s.retired.push_back(o);
+        s.retired_bytes += table_bytes(o);
+    }
+
+    Hash    _hash;
+    Eq      _eq;
+    shard   *_shards;
+    size_t  _shard_count;
+    size_t  _shard_mask;
+};
+
+}
+#endif //WALLE_WSL_CONCURRENT_HASH_MAP_H_
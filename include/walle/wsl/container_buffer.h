@@ -4,12 +4,19 @@
 namespace wsl {
 
 template <typename Container>
-class container_buffer : public wsl::internal::basic_buffer<typename Container::value_type> {
+class container_buffer : public wsl::internal::buffer_base<typename Container::value_type,
+                                                             container_buffer<Container> > {
+public:
+    typedef wsl::internal::buffer_base<typename Container::value_type,
+                                       container_buffer<Container> > base_type;
 private:
     Container &_container;
 
 protected:
-    void grow(std::size_t capacity) WALLE_OVERRIDE 
+    friend class wsl::internal::buffer_base<typename Container::value_type,
+                                            container_buffer<Container> >;
+
+    void grow(std::size_t capacity)
     {
         _container.resize(capacity);
         this->set(&_container[0], capacity);
@@ -17,7 +24,7 @@ protected:
 
 public:
     explicit container_buffer(Container &c)
-    : basic_buffer<typename Container::value_type>(&c[0], c.size(), c.size()),
+    : base_type(&c[0], c.size(), c.size()),
       _container(c) 
     {
 
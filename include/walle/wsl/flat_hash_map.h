@@ -0,0 +1,194 @@
+#ifndef WALLE_WSL_FLAT_HASH_MAP_H_
+#define WALLE_WSL_FLAT_HASH_MAP_H_
+#include <walle/config/base.h>
+#include <walle/wsl/internal/raw_hash_table.h>
+#include <initializer_list>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+namespace wsl {
+
+namespace internal {
+
+template <typename K, typename V>
+struct map_policy {
+    typedef K                       key_type;
+    typedef std::pair<const K, V>   value_type;
+    typedef value_type              iterator_slot;
+
+    static const K &key(const value_type &v)
+    {
+        return v.first;
+    }
+
+    // a rehash moves the key too, it is const only to users.
+    template <typename Alloc>
+    static void transfer(Alloc &alloc, value_type *to, value_type *from)
+    {
+        std::allocator_traits<Alloc>::construct(alloc, to, std::move(const_cast<K&>(from->first)),
+                                                std::move(from->second));
+        std::allocator_traits<Alloc>::destroy(alloc, from);
+    }
+};
+
+}
+
+/**
+ * @brief  unordered map with the values inline in an open addressing
+ *         (Swiss) table: no allocation per insert, lookups compare 16
+ *         control bytes per SSE2 instruction. see internal::raw_hash_table.
+ * @note   the std::unordered_map interface, except that any insert or
+ *         rehash may move the values: pointers, references and iterators
+ *         are invalidated by anything that can grow the table, erase
+ *         invalidates only the erased element.
+ *         with wsl::hash and wsl::hash_equal string keys are transparent:
+ *         find/contains/count/erase take a string_view or a c string
+ *         without building a key.
+ */
+template <typename K,
+          typename V,
+          typename Hash = wsl::hash<K>,
+          typename Eq = wsl::hash_equal<K>,
+          typename Alloc = std::allocator<std::pair<const K, V> > >
+class flat_hash_map : public internal::raw_hash_table<internal::map_policy<K, V>, Hash, Eq, Alloc> {
+    typedef internal::raw_hash_table<internal::map_policy<K, V>, Hash, Eq, Alloc> base_type;
+
+public:
+    typedef V                                       mapped_type;
+    typedef typename base_type::key_type            key_type;
+    typedef typename base_type::value_type          value_type;
+    typedef typename base_type::size_type           size_type;
+    typedef typename base_type::iterator            iterator;
+    typedef typename base_type::const_iterator      const_iterator;
+    typedef typename base_type::allocator_type      allocator_type;
+
+    explicit flat_hash_map(size_type n = 0, const Hash &hf = Hash(), const Eq &eq = Eq(),
+                           const allocator_type &alloc = allocator_type())
+    : base_type(n, hf, eq, alloc)
+    {
+
+    }
+
+    template <typename InputIterator>
+    flat_hash_map(InputIterator first, InputIterator last, size_type n = 0)
+    : base_type(n)
+    {
+        this->insert(first, last);
+    }
+
+    flat_hash_map(std::initializer_list<value_type> init, size_type n = 0)
+    : base_type(n ? n : init.size())
+    {
+        this->insert(init.begin(), init.end());
+    }
+
+    using base_type::insert;
+
+    /**
+     * @brief  construct the value from args only when key is new.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const key_type &key, Args&&... args)
+    {
+        return try_emplace_key(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(key_type &&key, Args&&... args)
+    {
+        return try_emplace_key(std::move(key), std::forward<Args>(args)...);
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const key_type &key, M &&value)
+    {
+        std::pair<iterator, bool> r = try_emplace_key(key, std::forward<M>(value));
+        if (!r.second) {
+            r.first->second = std::forward<M>(value);
+        }
+        return r;
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(key_type &&key, M &&value)
+    {
+        std::pair<iterator, bool> r = try_emplace_key(std::move(key), std::forward<M>(value));
+        if (!r.second) {
+            r.first->second = std::forward<M>(value);
+        }
+        return r;
+    }
+
+    mapped_type &operator[](const key_type &key)
+    {
+        return try_emplace_key(key).first->second;
+    }
+
+    mapped_type &operator[](key_type &&key)
+    {
+        return try_emplace_key(std::move(key)).first->second;
+    }
+
+    /**
+     * @brief  the value of a key that has to be in the map.
+     */
+    template <typename Key = key_type>
+    mapped_type &at(const typename base_type::template key_arg<Key> &key)
+    {
+        iterator it = this->find(key);
+        WALLE_ASSERT_MSG(it != this->end(), "flat_hash_map::at: no such key");
+        return it->second;
+    }
+
+    template <typename Key = key_type>
+    const mapped_type &at(const typename base_type::template key_arg<Key> &key) const
+    {
+        const_iterator it = this->find(key);
+        WALLE_ASSERT_MSG(it != this->end(), "flat_hash_map::at: no such key");
+        return it->second;
+    }
+
+private:
+    template <typename KeyArg, typename... Args>
+    std::pair<iterator, bool> try_emplace_key(KeyArg &&key, Args&&... args)
+    {
+        const std::pair<size_t, bool> r = this->find_or_prepare_insert(key);
+        if (r.second) {
+            this->construct_at(r.first, std::piecewise_construct,
+                               std::forward_as_tuple(std::forward<KeyArg>(key)),
+                               std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+        return std::make_pair(this->iterator_at(r.first), r.second);
+    }
+};
+
+template <typename K, typename V, typename H, typename E, typename A>
+inline bool operator==(const flat_hash_map<K, V, H, E, A> &lhs, const flat_hash_map<K, V, H, E, A> &rhs)
+{
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (typename flat_hash_map<K, V, H, E, A>::const_iterator it = lhs.begin(); it != lhs.end(); ++it) {
+        typename flat_hash_map<K, V, H, E, A>::const_iterator other = rhs.find(it->first);
+        if (other == rhs.end() || !(other->second == it->second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+inline bool operator!=(const flat_hash_map<K, V, H, E, A> &lhs, const flat_hash_map<K, V, H, E, A> &rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+inline void swap(flat_hash_map<K, V, H, E, A> &lhs, flat_hash_map<K, V, H, E, A> &rhs) WALLE_NOEXCEPT
+{
+    lhs.swap(rhs);
+}
+
+}
+#endif //WALLE_WSL_FLAT_HASH_MAP_H_
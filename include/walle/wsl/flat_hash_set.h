@@ -0,0 +1,104 @@
+#ifndef WALLE_WSL_FLAT_HASH_SET_H_
+#define WALLE_WSL_FLAT_HASH_SET_H_
+#include <walle/config/base.h>
+#include <walle/wsl/internal/raw_hash_table.h>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+namespace wsl {
+
+namespace internal {
+
+template <typename K>
+struct set_policy {
+    typedef K           key_type;
+    typedef K           value_type;
+    typedef const K     iterator_slot;
+
+    static const K &key(const value_type &v)
+    {
+        return v;
+    }
+
+    template <typename Alloc>
+    static void transfer(Alloc &alloc, value_type *to, value_type *from)
+    {
+        std::allocator_traits<Alloc>::construct(alloc, to, std::move(*from));
+        std::allocator_traits<Alloc>::destroy(alloc, from);
+    }
+};
+
+}
+
+/**
+ * @brief  unordered set over the same open addressing table as
+ *         flat_hash_map, the keys are stored inline.
+ * @note   the std::unordered_set interface, insert and rehash invalidate
+ *         iterators and references. string keys are transparent with the
+ *         default hash and equality.
+ */
+template <typename K,
+          typename Hash = wsl::hash<K>,
+          typename Eq = wsl::hash_equal<K>,
+          typename Alloc = std::allocator<K> >
+class flat_hash_set : public internal::raw_hash_table<internal::set_policy<K>, Hash, Eq, Alloc> {
+    typedef internal::raw_hash_table<internal::set_policy<K>, Hash, Eq, Alloc> base_type;
+
+public:
+    typedef typename base_type::key_type            key_type;
+    typedef typename base_type::value_type          value_type;
+    typedef typename base_type::size_type           size_type;
+    typedef typename base_type::iterator            iterator;
+    typedef typename base_type::const_iterator      const_iterator;
+    typedef typename base_type::allocator_type      allocator_type;
+
+    explicit flat_hash_set(size_type n = 0, const Hash &hf = Hash(), const Eq &eq = Eq(),
+                           const allocator_type &alloc = allocator_type())
+    : base_type(n, hf, eq, alloc)
+    {
+
+    }
+
+    template <typename InputIterator>
+    flat_hash_set(InputIterator first, InputIterator last, size_type n = 0)
+    : base_type(n)
+    {
+        this->insert(first, last);
+    }
+
+    flat_hash_set(std::initializer_list<value_type> init, size_type n = 0)
+    : base_type(n ? n : init.size())
+    {
+        this->insert(init.begin(), init.end());
+    }
+};
+
+template <typename K, typename H, typename E, typename A>
+inline bool operator==(const flat_hash_set<K, H, E, A> &lhs, const flat_hash_set<K, H, E, A> &rhs)
+{
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (typename flat_hash_set<K, H, E, A>::const_iterator it = lhs.begin(); it != lhs.end(); ++it) {
+        if (!rhs.contains(*it)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename K, typename H, typename E, typename A>
+inline bool operator!=(const flat_hash_set<K, H, E, A> &lhs, const flat_hash_set<K, H, E, A> &rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <typename K, typename H, typename E, typename A>
+inline void swap(flat_hash_set<K, H, E, A> &lhs, flat_hash_set<K, H, E, A> &rhs) WALLE_NOEXCEPT
+{
+    lhs.swap(rhs);
+}
+
+}
+#endif //WALLE_WSL_FLAT_HASH_SET_H_
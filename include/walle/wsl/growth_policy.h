@@ -0,0 +1,48 @@
+#ifndef WALLE_WSL_GROWTH_POLICY_H_
+#define WALLE_WSL_GROWTH_POLICY_H_
+#include <walle/config/base.h>
+#include <cstddef>
+
+namespace wsl {
+
+/**
+ * @brief  growth policies for the dynamic buffers. a policy is a type with
+ *         static size_t next_capacity(size_t capacity, size_t required)
+ *         returning the new capacity, it must be >= required.
+ */
+
+/**
+ * @brief  grow by 1.5x, keeps the old blocks reusable by the allocator.
+ */
+struct grow_by_half {
+    static size_t next_capacity(size_t capacity, size_t required)
+    {
+        const size_t n = capacity + capacity / 2;
+        return n < required ? required : n;
+    }
+};
+
+/**
+ * @brief  grow by 2x, fewer reallocations for buffers that get large.
+ */
+struct grow_double {
+    static size_t next_capacity(size_t capacity, size_t required)
+    {
+        const size_t n = capacity * 2;
+        return n < required ? required : n;
+    }
+};
+
+/**
+ * @brief  grow to exactly the required size, for buffers that are sized
+ *         up front with reserve().
+ */
+struct grow_exact {
+    static size_t next_capacity(size_t capacity, size_t required)
+    {
+        return required;
+    }
+};
+
+}
+#endif //WALLE_WSL_GROWTH_POLICY_H_
@@ -6,14 +6,23 @@
 #include <cstring>
 #include <iostream>
 #include <iterator>
+#include <memory>
 
 namespace wsl {
 namespace internal {
 
-template <typename T>
-class basic_buffer {
+/**
+ * @brief  storage and element access shared by all buffers.
+ * @note   growth is resolved at compile time through Derived::grow(size_type),
+ *         so concrete buffers carry no vtable and push_back/append inline
+ *         down to a capacity check. Derived must befriend this class if
+ *         its grow is not public.
+ */
+template <typename T, typename Derived>
+class buffer_base {
 public:
-    typedef basic_buffer<T>                             this_type;
+    typedef buffer_base<T, Derived>                     this_type;
+    typedef Derived                                     derived_type;
     typedef T 											value_type;
     typedef T* 											pointer;
     typedef const T* 									const_pointer;
@@ -28,11 +37,6 @@ public:
 
     static const WALLE_CONSTEXPR size_type npos = size_type(-1); 
 public:
-    virtual ~basic_buffer()
-    {
-
-    }
-
     /**  
      * @brief returns the size of this buffer. 
      * @note   
@@ -66,7 +70,7 @@ public:
     void resize(size_type new_size)
     {
         if (new_size > _capacity)
-            grow(new_size);
+            derived().grow(new_size);
         _size = new_size;
     }
 
@@ -74,7 +78,7 @@ public:
     void reserve(size_type capacitySize)
     {
         if (capacitySize > _capacity)
-            grow(capacitySize);
+            derived().grow(capacitySize);
     }
 
     void clear()
@@ -91,7 +95,7 @@ public:
     void push_back(const T &value)
     {
         if (_size == _capacity)
-            grow(_size + 1);
+            derived().grow(_size + 1);
         _ptr[_size++] = value;
     }
 
@@ -149,7 +153,7 @@ protected:
     size_type     _size;
     size_type     _capacity;
 protected:
-    basic_buffer(T *ptr = WALLE_NULL, size_type buffer_size = 0, size_type capacitySize = 0)
+    buffer_base(T *ptr = WALLE_NULL, size_type buffer_size = 0, size_type capacitySize = 0)
         : _ptr(ptr), 
           _size(buffer_size), 
           _capacity(capacitySize)
@@ -157,58 +161,121 @@ protected:
 
     }
 
+    ~buffer_base()
+    {
+
+    }
+
+    Derived &derived() WALLE_NOEXCEPT
+    {
+        return *static_cast<Derived*>(this);
+    }
+
     void set(value_type *buf_data, size_type buf_capacity) WALLE_NOEXCEPT 
     {
         _ptr = buf_data;
         _capacity = buf_capacity;
     }
-
-    virtual void grow(size_type size) = 0;
 };
 
-template <typename T>
+template <typename T, typename Derived>
 template <typename U>
-void basic_buffer<T>::append(const U *begin, const U *end)
+void buffer_base<T, Derived>::append(const U *begin, const U *end)
 {
-    basic_buffer<T>::size_type new_size = _size + end - begin;
+    size_type new_size = _size + end - begin;
     if (new_size > _capacity)
-        grow(new_size);
+        derived().grow(new_size);
     std::uninitialized_copy(begin, end,
                             _ptr + _size);
     _size = new_size;
 }
 
-template <typename T>
+template <typename T, typename Derived>
 template <typename U>
-void basic_buffer<T>::append(const U *begin, basic_buffer<T>::size_type len)
+void buffer_base<T, Derived>::append(const U *begin, size_type len)
 {
-    basic_buffer<T>::size_type new_size = _size + len;
+    size_type new_size = _size + len;
     if (new_size > _capacity)
-        grow(new_size);
+        derived().grow(new_size);
     std::uninitialized_copy(begin, begin + len,
                             _ptr + _size);
     _size = new_size;
 }
 
+/**
+ * @brief  type erased buffer, for code that has to accept any buffer
+ *         through a basic_buffer& without being a template.
+ * @note   growth goes through a virtual call, prefer the concrete
+ *         buffer types on hot paths.
+ */
+template <typename T>
+class basic_buffer : public buffer_base<T, basic_buffer<T> > {
+public:
+    typedef buffer_base<T, basic_buffer<T> >            base_type;
+    typedef typename base_type::size_type               size_type;
+
+    virtual ~basic_buffer()
+    {
+
+    }
+
+protected:
+    friend class buffer_base<T, basic_buffer<T> >;
+
+    basic_buffer(T *ptr = WALLE_NULL, size_type buffer_size = 0, size_type capacitySize = 0)
+        : base_type(ptr, buffer_size, capacitySize)
+    {
+
+    }
+
+    virtual void grow(size_type size) = 0;
+};
+
 typedef basic_buffer<char> buffer;
 typedef basic_buffer<wchar_t> wbuffer;
 
-template <typename Container>
-class container_buffer : public basic_buffer<typename Container::value_type> {
-private:
-    Container &_container;
+/**
+ * @brief  exposes a concrete buffer (stack_buffer, container_buffer...)
+ *         through the type erased basic_buffer interface.
+ * @note   elements are written in place into the adaptee, its size is
+ *         synchronised on growth and when the adapter is destroyed.
+ */
+template <typename Buffer>
+class buffer_adapter : public basic_buffer<typename Buffer::value_type> {
+public:
+    typedef basic_buffer<typename Buffer::value_type>   base_type;
+    typedef typename base_type::size_type               size_type;
+
+    explicit buffer_adapter(Buffer &b)
+        : base_type(b.data(), b.size(), b.capacity()),
+          _buffer(b)
+    {
+
+    }
 
- protected:
-    void grow(std::size_t capacity) WALLE_OVERRIDE 
+    ~buffer_adapter()
     {
-        _container.resize(capacity);
-        this->set(&_container[0], capacity);
+        sync();
     }
 
-public:
-    explicit container_buffer(Container &c)
-        : basic_buffer<typename Container::value_type>(&c[0], c.size(), c.size()),
-            _container(c) {}
+    /**
+     * @brief  publish the size written through this adapter to the adaptee.
+     */
+    void sync()
+    {
+        _buffer.resize(this->size());
+    }
+
+protected:
+    void grow(size_type size) WALLE_OVERRIDE
+    {
+        sync();
+        _buffer.reserve(size);
+        this->set(_buffer.data(), _buffer.capacity());
+    }
+
+private:
+    Buffer &_buffer;
 };
 
 }
@@ -2,6 +2,7 @@
 #define WALLE_WSL_INTERNAL_CHAR_TRAITS_H_
 #include <walle/config/base.h>
 #include <walle/wsl/ascii.h>
+#include <walle/wsl/internal/string_search.h>
 #include <walle/wsl/type_traits.h>
 #include <cstring>
 
@@ -178,6 +179,26 @@ inline int compare_i(const T* p1, const T* p2, size_t n)
 	return 0;
 }
 
+inline int compare_i(const char8_t* p1, const char8_t* p2, size_t n)
+{
+	return wsl::ascii::compare_i(p1, p2, n);
+}
+
+template <typename T>
+inline bool equals_i(const T* p1, const T* p2, size_t n)
+{
+	for(; n > 0; ++p1, ++p2, --n) {
+		if(char_to_lower(*p1) != char_to_lower(*p2))
+			return false;
+	}
+	return true;
+}
+
+inline bool equals_i(const char8_t* p1, const char8_t* p2, size_t n)
+{
+	return wsl::ascii::equals_i(p1, p2, n);
+}
+
 
 inline const char8_t* find(const char8_t* p, char8_t c, size_t n)
 {
@@ -186,22 +207,12 @@ inline const char8_t* find(const char8_t* p, char8_t c, size_t n)
 
 inline const char16_t* find(const char16_t* p, char16_t c, size_t n)
 {
-	for(; n > 0; --n, ++p) {
-		if(*p == c)
-			return p;
-	}
-
-	return NULL;
+	return simd_find(p, n, c);
 }
 
 inline const char32_t* find(const char32_t* p, char32_t c, size_t n)
 {
-	for(; n > 0; --n, ++p) {
-		if(*p == c)
-			return p;
-	}
-
-	return NULL;
+	return simd_find(p, n, c);
 }
 
 #if defined(WALLE_WCHAR_UNIQUE) && WALLE_WCHAR_UNIQUE
@@ -0,0 +1,39 @@
+#ifndef WALLE_WSL_INTERNAL_CPU_H_
+#define WALLE_WSL_INTERNAL_CPU_H_
+#include <walle/config/base.h>
+
+/**
+ * @brief  the instructions a runtime dispatched kernel is built for, the
+ *         same ones cpu_has_ssse3() and cpu_has_avx2() check.
+ */
+#define WALLE_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define WALLE_TARGET_AVX2  __attribute__((target("avx2,bmi")))
+
+namespace wsl {
+namespace internal {
+
+/**
+ * @brief  instruction set levels of the runtime dispatched kernels.
+ */
+enum simd_isa {
+    kSimdSse2,
+    kSimdAvx2
+};
+
+/**
+ * @brief  cpu feature checks, resolved once.
+ * @note   cpu_has_avx2() also checks bmi, the avx2 kernels use both.
+ */
+bool cpu_has_ssse3();
+bool cpu_has_avx2();
+
+bool cpu_supports(simd_isa isa);
+
+/**
+ * @brief  the best level the cpu supports.
+ */
+simd_isa best_simd_isa();
+
+}
+}
+#endif //WALLE_WSL_INTERNAL_CPU_H_
@@ -0,0 +1,25 @@
+#ifndef WALLE_WSL_INTERNAL_FUTEX_H_
+#define WALLE_WSL_INTERNAL_FUTEX_H_
+#include <walle/config/base.h>
+#include <atomic>
+#include <cstdint>
+
+namespace wsl {
+namespace internal {
+
+/**
+ * @brief  sleep while *word == expected, for at most timeout_ns nanoseconds
+ *         (negative waits forever).
+ * @note   may return spuriously, callers re-check their condition.
+ * @retval false when the timeout expired.
+ */
+bool futex_wait(std::atomic<uint32_t> *word, uint32_t expected, int64_t timeout_ns = -1);
+
+/**
+ * @brief  wake up to count threads sleeping on word.
+ */
+void futex_wake(std::atomic<uint32_t> *word, int count);
+
+}
+}
+#endif //WALLE_WSL_INTERNAL_FUTEX_H_
@@ -0,0 +1,873 @@
+#ifndef WALLE_WSL_INTERNAL_RAW_HASH_TABLE_H_
+#define WALLE_WSL_INTERNAL_RAW_HASH_TABLE_H_
+#include <walle/config/base.h>
+#include <walle/math/ffs.h>
+#include <walle/math/power2.h>
+#include <walle/wsl/string.h>
+#include <walle/wsl/string_view.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace wsl {
+
+/**
+ * @brief  key equality of the flat hash tables, operator==.
+ */
+template <typename T>
+struct hash_equal {
+    bool operator()(const T &a, const T &b) const
+    {
+        return a == b;
+    }
+};
+
+/**
+ * @brief  transparent equality of string keys: any mix of views, std and
+ *         wsl strings and c strings of C compares by content.
+ */
+template <typename C>
+struct string_hash_equal {
+    typedef void is_transparent;
+
+    template <typename A, typename B>
+    bool operator()(const A &a, const B &b) const
+    {
+        return view(a) == view(b);
+    }
+
+private:
+    static basic_string_view<C> view(const basic_string_view<C> &s)
+    {
+        return s;
+    }
+
+    static basic_string_view<C> view(const std::basic_string<C> &s)
+    {
+        return basic_string_view<C>(s.data(), s.size());
+    }
+
+    template <typename A, size_t N, typename G>
+    static basic_string_view<C> view(const basic_string<C, A, N, G> &s)
+    {
+        return s.view();
+    }
+
+    static basic_string_view<C> view(const C *s)
+    {
+        return basic_string_view<C>(s);
+    }
+};
+
+template <typename C> struct hash_equal<basic_string_view<C> > : public string_hash_equal<C> { };
+template <typename C> struct hash_equal<std::basic_string<C> > : public string_hash_equal<C> { };
+template <typename C, typename A, size_t N, typename G>
+struct hash_equal<basic_string<C, A, N, G> > : public string_hash_equal<C> { };
+
+namespace internal {
+
+// one control byte per slot: the low 7 bits of the hash when the slot is
+// full, or one of these (sign bit set).
+typedef int8_t ctrl_t;
+static const ctrl_t kCtrlEmpty = -128;
+static const ctrl_t kCtrlDeleted = -2;
+static const ctrl_t kCtrlSentinel = -1;
+
+/**
+ * @brief  the control bytes of the zero capacity table: no probe matches,
+ *         every probe stops, iteration ends at once.
+ */
+extern const ctrl_t kEmptyGroup[16];
+
+/**
+ * @brief  16 control bytes compared at once, each result a bit mask with
+ *         bit i for byte i.
+ */
+class ctrl_group {
+public:
+    static const size_t kWidth = 16;
+
+#if defined(__SSE2__)
+    explicit ctrl_group(const ctrl_t *p)
+    : _ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))
+    {
+
+    }
+
+    uint32_t match(ctrl_t h2) const
+    {
+        return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), _ctrl)));
+    }
+
+    uint32_t match_empty() const
+    {
+        return match(kCtrlEmpty);
+    }
+
+    uint32_t match_empty_or_deleted() const
+    {
+        return uint32_t(_mm_movemask_epi8(_ctrl));
+    }
+
+    uint32_t match_full_or_sentinel() const
+    {
+        return uint32_t(_mm_movemask_epi8(_mm_cmpgt_epi8(_ctrl, _mm_set1_epi8(kCtrlDeleted))));
+    }
+
+private:
+    __m128i _ctrl;
+#else
+    explicit ctrl_group(const ctrl_t *p)
+    {
+        std::memcpy(_ctrl, p, kWidth);
+    }
+
+    uint32_t match(ctrl_t h2) const
+    {
+        uint32_t m = 0;
+        for (size_t i = 0; i < kWidth; ++i) {
+            m |= uint32_t(_ctrl[i] == h2) << i;
+        }
+        return m;
+    }
+
+    uint32_t match_empty() const
+    {
+        return match(kCtrlEmpty);
+    }
+
+    uint32_t match_empty_or_deleted() const
+    {
+        uint32_t m = 0;
+        for (size_t i = 0; i < kWidth; ++i) {
+            m |= uint32_t(_ctrl[i] < 0) << i;
+        }
+        return m;
+    }
+
+    uint32_t match_full_or_sentinel() const
+    {
+        uint32_t m = 0;
+        for (size_t i = 0; i < kWidth; ++i) {
+            m |= uint32_t(_ctrl[i] > kCtrlDeleted) << i;
+        }
+        return m;
+    }
+
+private:
+    ctrl_t _ctrl[kWidth];
+#endif
+};
+
+WALLE_FORCE_INLINE size_t lowest_bit(uint32_t mask)
+{
+    return walle::math::ffs(mask) - 1;
+}
+
+template <typename T, typename = void>
+struct is_transparent : public std::false_type { };
+
+template <typename T>
+struct is_transparent<T, typename std::conditional<true, void, typename T::is_transparent>::type>
+    : public std::true_type { };
+
+// with a transparent hash and equality lookups take any key type K,
+// otherwise key_type.
+template <bool Transparent>
+struct key_arg_impl {
+    template <typename K, typename Key>
+    using type = K;
+};
+
+template <>
+struct key_arg_impl<false> {
+    template <typename K, typename Key>
+    using type = Key;
+};
+
+template <typename Ctrl, typename Slot>
+class raw_hash_iterator {
+public:
+    typedef std::forward_iterator_tag                   iterator_category;
+    typedef typename std::remove_const<Slot>::type      value_type;
+    typedef ptrdiff_t                                   difference_type;
+    typedef Slot*                                       pointer;
+    typedef Slot&                                       reference;
+
+    raw_hash_iterator()
+    : _ctrl(WALLE_NULL),
+      _slot(WALLE_NULL)
+    {
+
+    }
+
+    raw_hash_iterator(const ctrl_t *ctrl, Slot *slot)
+    : _ctrl(ctrl),
+      _slot(slot)
+    {
+
+    }
+
+    // iterator to const_iterator.
+    template <typename S>
+    raw_hash_iterator(const raw_hash_iterator<Ctrl, S> &other,
+                      typename std::enable_if<std::is_convertible<S*, Slot*>::value>::type * = WALLE_NULL)
+    : _ctrl(other._ctrl),
+      _slot(other._slot)
+    {
+
+    }
+
+    reference operator*() const
+    {
+        return *_slot;
+    }
+
+    pointer operator->() const
+    {
+        return _slot;
+    }
+
+    raw_hash_iterator &operator++()
+    {
+        ++_ctrl;
+        ++_slot;
+        skip_empty();
+        return *this;
+    }
+
+    raw_hash_iterator operator++(int)
+    {
+        raw_hash_iterator tmp(*this);
+        ++*this;
+        return tmp;
+    }
+
+    // the first full slot at or after the current one, or the sentinel.
+    void skip_empty()
+    {
+        for (;;) {
+            const uint32_t mask = ctrl_group(_ctrl).match_full_or_sentinel();
+            if (mask) {
+                const size_t shift = lowest_bit(mask);
+                _ctrl += shift;
+                _slot += shift;
+                return;
+            }
+            _ctrl += ctrl_group::kWidth;
+            _slot += ctrl_group::kWidth;
+        }
+    }
+
+    template <typename S>
+    bool operator==(const raw_hash_iterator<Ctrl, S> &other) const
+    {
+        return _ctrl == other._ctrl;
+    }
+
+    template <typename S>
+    bool operator!=(const raw_hash_iterator<Ctrl, S> &other) const
+    {
+        return _ctrl != other._ctrl;
+    }
+
+private:
+    template <typename C, typename S> friend class raw_hash_iterator;
+    template <typename P, typename H, typename E, typename A> friend class raw_hash_table;
+
+    const ctrl_t    *_ctrl;
+    Slot            *_slot;
+};
+
+/**
+ * @brief  open addressing hash table behind flat_hash_map / flat_hash_set,
+ *         the Swiss table layout.
+ * @note   values live inline in one array of slots, a parallel array of
+ *         control bytes holds 7 hash bits per full slot. a lookup hashes
+ *         once, picks a group of 16 slots from the other hash bits and
+ *         compares the 7 bits against all 16 control bytes with one SSE2
+ *         compare, keys are compared only on those (rare false) matches.
+ *         the probe moves to the next group (triangular steps over a power
+ *         of two number of groups) only while a group has no empty slot.
+ *         at most 7/8 of the slots are used, erase leaves a tombstone only
+ *         in a group with no empty slot, tombstones are dropped by the
+ *         rehash that grows the table.
+ *         Policy supplies value_type, key_type and key(value).
+ *         the hash has to spread its bits, as wsl::hash does.
+ */
+template <typename Policy, typename Hash, typename Eq, typename Alloc>
+class raw_hash_table {
+public:
+    typedef typename Policy::key_type                               key_type;
+    typedef typename Policy::value_type                             value_type;
+    typedef Hash                                                    hasher;
+    typedef Eq                                                      key_equal;
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<value_type>
+                                                                    allocator_type;
+    typedef size_t                                                  size_type;
+    typedef ptrdiff_t                                               difference_type;
+    typedef value_type&                                             reference;
+    typedef const value_type&                                       const_reference;
+    typedef raw_hash_iterator<ctrl_t, typename Policy::iterator_slot>        iterator;
+    typedef raw_hash_iterator<ctrl_t, const value_type>             const_iterator;
+
+protected:
+    template <typename K>
+    using key_arg = typename key_arg_impl<is_transparent<Hash>::value &&
+                                          is_transparent<Eq>::value>::template type<K, key_type>;
+
+public:
+    explicit raw_hash_table(size_type n = 0, const Hash &hf = Hash(), const Eq &eq = Eq(),
+                            const allocator_type &alloc = allocator_type())
+    : _hash(hf),
+      _eq(eq),
+      _alloc(alloc)
+    {
+        reset_empty();
+        if (n) {
+            reserve(n);
+        }
+    }
+
+    raw_hash_table(const raw_hash_table &other)
+    : _hash(other._hash),
+      _eq(other._eq),
+      _alloc(std::allocator_traits<allocator_type>::select_on_container_copy_construction(other._alloc))
+    {
+        reset_empty();
+        copy_from(other);
+    }
+
+    raw_hash_table(raw_hash_table &&other) WALLE_NOEXCEPT
+    : _hash(std::move(other._hash)),
+      _eq(std::move(other._eq)),
+      _alloc(std::move(other._alloc))
+    {
+        take(other);
+    }
+
+    ~raw_hash_table()
+    {
+        destroy();
+    }
+
+    raw_hash_table &operator=(const raw_hash_table &other)
+    {
+        if (this != &other) {
+            raw_hash_table tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    raw_hash_table &operator=(raw_hash_table &&other) WALLE_NOEXCEPT
+    {
+        if (this != &other) {
+            destroy();
+            _hash = std::move(other._hash);
+            _eq = std::move(other._eq);
+            _alloc = std::move(other._alloc);
+            take(other);
+        }
+        return *this;
+    }
+
+    iterator begin()
+    {
+        iterator it(_ctrl, _slots);
+        it.skip_empty();
+        return it;
+    }
+
+    const_iterator begin() const
+    {
+        return const_cast<raw_hash_table*>(this)->begin();
+    }
+
+    const_iterator cbegin() const
+    {
+        return begin();
+    }
+
+    iterator end()
+    {
+        return iterator(_ctrl + _capacity, _slots + _capacity);
+    }
+
+    const_iterator end() const
+    {
+        return const_cast<raw_hash_table*>(this)->end();
+    }
+
+    const_iterator cend() const
+    {
+        return end();
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    size_type size() const
+    {
+        return _size;
+    }
+
+    size_type capacity() const
+    {
+        return _capacity;
+    }
+
+    float load_factor() const
+    {
+        return _capacity ? float(_size) / float(_capacity) : 0.0f;
+    }
+
+    float max_load_factor() const
+    {
+        return 7.0f / 8.0f;
+    }
+
+    hasher hash_function() const
+    {
+        return _hash;
+    }
+
+    key_equal key_eq() const
+    {
+        return _eq;
+    }
+
+    allocator_type get_allocator() const
+    {
+        return _alloc;
+    }
+
+    /**
+     * @brief  destroy every value, the capacity stays.
+     */
+    void clear()
+    {
+        if (!_capacity) {
+            return;
+        }
+        destroy_values();
+        std::memset(_ctrl, kCtrlEmpty, _capacity);
+        _size = 0;
+        _growth_left = max_size_for(_capacity);
+    }
+
+    /**
+     * @brief  room for n values without a rehash.
+     */
+    void reserve(size_type n)
+    {
+        if (n > _size + _growth_left) {
+            resize(capacity_for(n));
+        }
+    }
+
+    /**
+     * @brief  rebuild with capacity for max(n, size()) values, dropping
+     *         tombstones. rehash(0) shrinks to fit.
+     */
+    void rehash(size_type n)
+    {
+        if (n < _size) {
+            n = _size;
+        }
+        if (n == 0 && _capacity) {
+            destroy();
+            reset_empty();
+            return;
+        }
+        resize(capacity_for(n));
+    }
+
+    std::pair<iterator, bool> insert(const value_type &value)
+    {
+        return emplace_key(Policy::key(value), value);
+    }
+
+    std::pair<iterator, bool> insert(value_type &&value)
+    {
+        return emplace_key(Policy::key(value), std::move(value));
+    }
+
+    template <typename InputIterator>
+    void insert(InputIterator first, InputIterator last)
+    {
+        for (; first != last; ++first) {
+            insert(*first);
+        }
+    }
+
+    void insert(std::initializer_list<value_type> init)
+    {
+        insert(init.begin(), init.end());
+    }
+
+    /**
+     * @brief  construct a value from args, kept only when its key is new.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        // the key is only known after construction.
+        typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type storage;
+        value_type *v = reinterpret_cast<value_type*>(&storage);
+        std::allocator_traits<allocator_type>::construct(_alloc, v, std::forward<Args>(args)...);
+        std::pair<iterator, bool> r = emplace_key(Policy::key(*v), std::move(*v));
+        std::allocator_traits<allocator_type>::destroy(_alloc, v);
+        return r;
+    }
+
+    template <typename K = key_type>
+    iterator find(const key_arg<K> &key)
+    {
+        const size_t i = find_index(key, hash_of(key));
+        return i == kNotFound ? end() : iterator_at(i);
+    }
+
+    template <typename K = key_type>
+    const_iterator find(const key_arg<K> &key) const
+    {
+        return const_cast<raw_hash_table*>(this)->find(key);
+    }
+
+    template <typename K = key_type>
+    bool contains(const key_arg<K> &key) const
+    {
+        return find_index(key, hash_of(key)) != kNotFound;
+    }
+
+    template <typename K = key_type>
+    size_type count(const key_arg<K> &key) const
+    {
+        return contains(key) ? 1 : 0;
+    }
+
+    // not for iterators, they go to erase(const_iterator).
+    template <typename K = key_type>
+    typename std::enable_if<!std::is_convertible<const K&, const_iterator>::value, size_type>::type
+    erase(const key_arg<K> &key)
+    {
+        const size_t i = find_index(key, hash_of(key));
+        if (i == kNotFound) {
+            return 0;
+        }
+        erase_at(i);
+        return 1;
+    }
+
+    /**
+     * @retval the iterator after pos.
+     */
+    iterator erase(const_iterator pos)
+    {
+        const size_t i = size_t(pos._ctrl - _ctrl);
+        erase_at(i);
+        iterator next(_ctrl + i, _slots + i);
+        ++next;
+        return next;
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        while (first != last) {
+            first = erase(first);
+        }
+        return iterator(first._ctrl, const_cast<typename Policy::iterator_slot*>(first._slot));
+    }
+
+    void swap(raw_hash_table &other) WALLE_NOEXCEPT
+    {
+        std::swap(_hash, other._hash);
+        std::swap(_eq, other._eq);
+        std::swap(_alloc, other._alloc);
+        std::swap(_ctrl, other._ctrl);
+        std::swap(_slots, other._slots);
+        std::swap(_capacity, other._capacity);
+        std::swap(_size, other._size);
+        std::swap(_growth_left, other._growth_left);
+    }
+
+protected:
+    static const size_t kNotFound = size_t(-1);
+
+    template <typename K>
+    size_t hash_of(const K &key) const
+    {
+        return _hash(key);
+    }
+
+    iterator iterator_at(size_t i)
+    {
+        return iterator(_ctrl + i, _slots + i);
+    }
+
+    /**
+     * @brief  the slot of key, or the new slot for key made ready for
+     *         construction (the caller constructs it).
+     * @retval the slot index and true when it is new.
+     */
+    template <typename K>
+    std::pair<size_t, bool> find_or_prepare_insert(const K &key)
+    {
+        const size_t h = hash_of(key);
+        const size_t i = find_index(key, h);
+        if (i != kNotFound) {
+            return std::make_pair(i, false);
+        }
+        return std::make_pair(prepare_insert(h), true);
+    }
+
+    // construct into the slot from find_or_prepare_insert().
+    template <typename... Args>
+    void construct_at(size_t i, Args&&... args)
+    {
+        std::allocator_traits<allocator_type>::construct(_alloc, _slots + i, std::forward<Args>(args)...);
+    }
+
+    value_type &slot_at(size_t i)
+    {
+        return _slots[i];
+    }
+
+private:
+    // the control bytes are followed by one group of sentinels, iteration
+    // stops at the first one.
+    static size_t ctrl_bytes(size_t capacity)
+    {
+        return capacity + ctrl_group::kWidth;
+    }
+
+    static size_t max_size_for(size_t capacity)
+    {
+        return capacity - capacity / 8;
+    }
+
+    static size_t capacity_for(size_t n)
+    {
+        size_t c = ctrl_group::kWidth;
+        if (n > max_size_for(c)) {
+            c = walle::math::round_up_to_power_of_two(n + n / 7 + 1);
+            while (max_size_for(c) < n) {
+                c <<= 1;
+            }
+        }
+        return c;
+    }
+
+    size_t group_mask() const
+    {
+        return _capacity ? _capacity / ctrl_group::kWidth - 1 : 0;
+    }
+
+    static ctrl_t h2(size_t h)
+    {
+        return ctrl_t(h & 0x7f);
+    }
+
+    template <typename K>
+    size_t find_index(const K &key, size_t h) const
+    {
+        const size_t mask = group_mask();
+        size_t g = (h >> 7) & mask;
+        const ctrl_t tag = h2(h);
+        for (size_t step = 1;; ++step) {
+            const ctrl_t *base = _ctrl + g * ctrl_group::kWidth;
+            const ctrl_group group(base);
+            for (uint32_t m = group.match(tag); m; m &= m - 1) {
+                const size_t i = g * ctrl_group::kWidth + lowest_bit(m);
+                if (WALLE_LIKELY(_eq(Policy::key(_slots[i]), key))) {
+                    return i;
+                }
+            }
+            if (WALLE_LIKELY(group.match_empty())) {
+                return kNotFound;
+            }
+            g = (g + step) & mask;
+        }
+    }
+
+    // the first empty or deleted slot on the probe sequence of h.
+    size_t find_first_non_full(size_t h) const
+    {
+        const size_t mask = group_mask();
+        size_t g = (h >> 7) & mask;
+        for (size_t step = 1;; ++step) {
+            const uint32_t m = ctrl_group(_ctrl + g * ctrl_group::kWidth).match_empty_or_deleted();
+            if (WALLE_LIKELY(m)) {
+                return g * ctrl_group::kWidth + lowest_bit(m);
+            }
+            g = (g + step) & mask;
+        }
+    }
+
+    size_t prepare_insert(size_t h)
+    {
+        size_t i = find_first_non_full(h);
+        if (WALLE_UNLIKELY(_growth_left == 0 && _ctrl[i] != kCtrlDeleted)) {
+            grow();
+            i = find_first_non_full(h);
+        }
+        _growth_left -= _ctrl[i] == kCtrlEmpty ? 1 : 0;
+        _ctrl[i] = h2(h);
+        ++_size;
+        return i;
+    }
+
+    template <typename K, typename V>
+    std::pair<iterator, bool> emplace_key(const K &key, V &&value)
+    {
+        const std::pair<size_t, bool> r = find_or_prepare_insert(key);
+        if (r.second) {
+            construct_at(r.first, std::forward<V>(value));
+        }
+        return std::make_pair(iterator_at(r.first), r.second);
+    }
+
+    void erase_at(size_t i)
+    {
+        std::allocator_traits<allocator_type>::destroy(_alloc, _slots + i);
+        --_size;
+        // a probe only passes a group that has no empty slot, and such a
+        // group gets no empty slot until the next rehash. so a group that
+        // still has one can take another, all others need a tombstone.
+        const ctrl_t *base = _ctrl + i / ctrl_group::kWidth * ctrl_group::kWidth;
+        if (ctrl_group(base).match_empty()) {
+            _ctrl[i] = kCtrlEmpty;
+            ++_growth_left;
+        } else {
+            _ctrl[i] = kCtrlDeleted;
+        }
+    }
+
+    // full: double, or mostly tombstones: rebuild at the same size.
+    void grow()
+    {
+        if (_capacity && _size * 32 <= _capacity * 25) {
+            resize(_capacity);
+        } else {
+            resize(_capacity ? _capacity * 2 : ctrl_group::kWidth);
+        }
+    }
+
+    size_t allocation_units(size_t capacity) const
+    {
+        return capacity + (ctrl_bytes(capacity) + sizeof(value_type) - 1) / sizeof(value_type);
+    }
+
+    void resize(size_t capacity)
+    {
+        value_type *old_slots = _slots;
+        ctrl_t *old_ctrl = _ctrl;
+        const size_t old_capacity = _capacity;
+
+        // one block: the slots, then the control bytes.
+        _slots = std::allocator_traits<allocator_type>::allocate(_alloc, allocation_units(capacity));
+        _ctrl = reinterpret_cast<ctrl_t*>(_slots + capacity);
+        std::memset(_ctrl, kCtrlEmpty, capacity);
+        std::memset(_ctrl + capacity, kCtrlSentinel, ctrl_group::kWidth);
+        _capacity = capacity;
+        _growth_left = max_size_for(capacity) - _size;
+
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (old_ctrl[i] >= 0) {
+                const size_t h = hash_of(Policy::key(old_slots[i]));
+                const size_t j = find_first_non_full(h);
+                _ctrl[j] = h2(h);
+                Policy::transfer(_alloc, _slots + j, old_slots + i);
+            }
+        }
+        if (old_capacity) {
+            std::allocator_traits<allocator_type>::deallocate(_alloc, old_slots, allocation_units(old_capacity));
+        }
+    }
+
+    void copy_from(const raw_hash_table &other)
+    {
+        if (!other._size) {
+            return;
+        }
+        resize(capacity_for(other._size));
+        for (const_iterator it = other.begin(); it != other.end(); ++it) {
+            const size_t h = hash_of(Policy::key(*it));
+            const size_t j = find_first_non_full(h);
+            _ctrl[j] = h2(h);
+            construct_at(j, *it);
+            ++_size;
+            --_growth_left;
+        }
+    }
+
+    void destroy_values()
+    {
+        if (std::is_trivially_destructible<value_type>::value) {
+            return;
+        }
+        for (size_t i = 0; i < _capacity; ++i) {
+            if (_ctrl[i] >= 0) {
+                std::allocator_traits<allocator_type>::destroy(_alloc, _slots + i);
+            }
+        }
+    }
+
+    void destroy()
+    {
+        if (_capacity) {
+            destroy_values();
+            std::allocator_traits<allocator_type>::deallocate(_alloc, _slots, allocation_units(_capacity));
+        }
+    }
+
+    void reset_empty()
+    {
+        _ctrl = const_cast<ctrl_t*>(kEmptyGroup);
+        _slots = WALLE_NULL;
+        _capacity = 0;
+        _size = 0;
+        _growth_left = 0;
+    }
+
+    void take(raw_hash_table &other)
+    {
+        _ctrl = other._ctrl;
+        _slots = other._slots;
+        _capacity = other._capacity;
+        _size = other._size;
+        _growth_left = other._growth_left;
+        other.reset_empty();
+    }
+
+    Hash            _hash;
+    Eq              _eq;
+    allocator_type  _alloc;
+    ctrl_t          *_ctrl;
+    value_type      *_slots;
+    size_t          _capacity;
+    size_t          _size;
+    size_t          _growth_left;
+};
+
+template <typename P, typename H, typename E, typename A>
+inline void swap(raw_hash_table<P, H, E, A> &lhs, raw_hash_table<P, H, E, A> &rhs) WALLE_NOEXCEPT
+{
+    lhs.swap(rhs);
+}
+
+}
+}
+#endif //WALLE_WSL_INTERNAL_RAW_HASH_TABLE_H_
@@ -3,6 +3,8 @@
 #include <walle/config/base.h>
 #include <cmath>
 #include <cstdlib>
+#include <iterator>
+#include <utility>
 
 namespace wsl {
 namespace sk_detail {
@@ -499,10 +501,10 @@ public:
     typedef typename impl_type::const_pointer   const_pointer;
 
     sl_iterator() :
-        _node(0) {}
+        _impl(0), _node(0) {}
 
-    sl_iterator(node_type *node) :
-        _node(node) {}
+    sl_iterator(impl_type *impl, node_type *node) :
+        _impl(impl), _node(node) {}
 
     self_type &operator++()
     { 
@@ -534,7 +536,7 @@ public:
     }
     const_pointer   operator->() 
     { 
-        return _node->value; 
+        return &_node->value; 
     }
     
     bool operator==(const self_type &other) const
@@ -560,7 +562,14 @@ public:
         return _node; 
     }
 
+    // the list the iterator walks, to check it is given back to that list.
+    const impl_type *get_impl() const
+    {
+        return _impl;
+    }
+
 private:
+    impl_type   *_impl;
     node_type   *_node;
 };
 
@@ -580,8 +589,9 @@ public:
     typedef typename impl_type::const_reference const_reference;
     typedef typename impl_type::const_pointer   const_pointer;
 
-    sl_const_iterator() : _node(0) {}
-    sl_const_iterator(const iterator &i) :_node(i.get_node()) {}
+    sl_const_iterator() : _impl(0), _node(0) {}
+    sl_const_iterator(impl_type *impl, node_type *node) : _impl(impl), _node(node) {}
+    sl_const_iterator(const iterator &i) : _impl(i.get_impl()), _node(i.get_node()) {}
 
     self_type &operator++()
     { 
@@ -614,7 +624,7 @@ public:
     }
     const_pointer   operator->() 
     { 
-        return _node->value; 
+        return &_node->value; 
     }
 
     bool operator==(const self_type &other) const
@@ -640,7 +650,13 @@ public:
         return _node; 
     } 
 
+    const impl_type *get_impl() const
+    {
+        return _impl;
+    }
+
 private:
+    impl_type *_impl;
     node_type *_node;
 };
 
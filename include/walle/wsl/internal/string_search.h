@@ -0,0 +1,180 @@
+#ifndef WALLE_WSL_INTERNAL_STRING_SEARCH_H_
+#define WALLE_WSL_INTERNAL_STRING_SEARCH_H_
+#include <walle/config/base.h>
+#include <walle/wsl/internal/cpu.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace wsl {
+namespace internal {
+
+/**
+ * @brief  vector kernels behind the string_view searches.
+ * @note   the kernels are picked on first use from the cpu features, avx2
+ *         when available and sse2 (with ssse3 for the byte set search)
+ *         otherwise. every function returns null when nothing matches.
+ */
+simd_isa current_search_isa();
+
+/**
+ * @brief  force a kernel set, for tests and benchmarks.
+ * @retval false when the cpu lacks the instructions.
+ */
+bool set_search_isa(simd_isa isa);
+
+const char *simd_find(const char *p, size_t n, char c);
+const char16_t *simd_find(const char16_t *p, size_t n, char16_t c);
+const char32_t *simd_find(const char32_t *p, size_t n, char32_t c);
+
+/**
+ * @brief  last c in [p, p + n).
+ */
+const char *simd_rfind(const char *p, size_t n, char c);
+
+/**
+ * @brief  first/last occurrence of needle, candidates are filtered with the
+ *         first and last needle byte a vector at a time before the middle
+ *         is compared.
+ */
+const char *simd_search(const char *p, size_t n, const char *needle, size_t m);
+const char *simd_rsearch(const char *p, size_t n, const char *needle, size_t m);
+
+/**
+ * @brief  first byte in / not in set, membership is a pshufb nibble table
+ *         lookup.
+ */
+const char *simd_find_first_of(const char *p, size_t n, const char *set, size_t m);
+const char *simd_find_first_not_of(const char *p, size_t n, const char *set, size_t m);
+
+/**
+ * @brief  a byte set prepared once for repeated delimiter_mask() calls.
+ */
+struct delimiter_set {
+    uint64_t    bits[4];        // membership bitmap.
+    uint8_t     lo_low[16];     // pshufb tables, see simd_find_first_of.
+    uint8_t     lo_high[16];
+    bool        has_high;
+    size_t      size;           // distinct bytes in the set.
+    char        first;          // the byte of a single byte set.
+
+    bool contains(char c) const
+    {
+        const uint8_t b = static_cast<uint8_t>(c);
+        return (bits[b >> 6] >> (b & 63)) & 1;
+    }
+};
+
+void make_delimiter_set(const char *set, size_t m, delimiter_set &out);
+
+/**
+ * @brief  bit i set when p[i] is in the set, for the n <= 64 bytes at p.
+ */
+uint64_t simd_delimiter_mask(const char *p, size_t n, const delimiter_set &set);
+
+// string_view entry points: vector kernels for char, the generic loops for
+// the other character types.
+
+template <typename T>
+inline const T *string_find_char(const T *p, size_t n, T c)
+{
+    const T *end = p + n;
+    const T *r = std::find(p, end, c);
+    return r == end ? WALLE_NULL : r;
+}
+
+inline const char *string_find_char(const char *p, size_t n, char c)
+{
+    return simd_find(p, n, c);
+}
+
+inline const char16_t *string_find_char(const char16_t *p, size_t n, char16_t c)
+{
+    return simd_find(p, n, c);
+}
+
+inline const char32_t *string_find_char(const char32_t *p, size_t n, char32_t c)
+{
+    return simd_find(p, n, c);
+}
+
+template <typename T>
+inline const T *string_rfind_char(const T *p, size_t n, T c)
+{
+    for (const T *q = p + n; q != p; --q) {
+        if (q[-1] == c) {
+            return q - 1;
+        }
+    }
+    return WALLE_NULL;
+}
+
+inline const char *string_rfind_char(const char *p, size_t n, char c)
+{
+    return simd_rfind(p, n, c);
+}
+
+template <typename T>
+inline const T *string_search(const T *p, size_t n, const T *needle, size_t m)
+{
+    const T *end = p + n;
+    const T *r = std::search(p, end, needle, needle + m);
+    return (r == end && m != 0) ? WALLE_NULL : r;
+}
+
+inline const char *string_search(const char *p, size_t n, const char *needle, size_t m)
+{
+    return simd_search(p, n, needle, m);
+}
+
+template <typename T>
+inline const T *string_rsearch(const T *p, size_t n, const T *needle, size_t m)
+{
+    if (m > n) {
+        return WALLE_NULL;
+    }
+    for (const T *q = p + (n - m) + 1; q != p; --q) {
+        if (std::equal(needle, needle + m, q - 1)) {
+            return q - 1;
+        }
+    }
+    return WALLE_NULL;
+}
+
+inline const char *string_rsearch(const char *p, size_t n, const char *needle, size_t m)
+{
+    return simd_rsearch(p, n, needle, m);
+}
+
+template <typename T>
+inline const T *string_find_first_of(const T *p, size_t n, const T *set, size_t m)
+{
+    const T *end = p + n;
+    const T *r = std::find_first_of(p, end, set, set + m);
+    return r == end ? WALLE_NULL : r;
+}
+
+inline const char *string_find_first_of(const char *p, size_t n, const char *set, size_t m)
+{
+    return simd_find_first_of(p, n, set, m);
+}
+
+template <typename T>
+inline const T *string_find_first_not_of(const T *p, size_t n, const T *set, size_t m)
+{
+    for (const T *end = p + n; p != end; ++p) {
+        if (std::find(set, set + m, *p) == set + m) {
+            return p;
+        }
+    }
+    return WALLE_NULL;
+}
+
+inline const char *string_find_first_not_of(const char *p, size_t n, const char *set, size_t m)
+{
+    return simd_find_first_not_of(p, n, set, m);
+}
+
+}
+}
+#endif //WALLE_WSL_INTERNAL_STRING_SEARCH_H_
@@ -0,0 +1,380 @@
+#ifndef WALLE_WSL_LRU_CACHE_H_
+#define WALLE_WSL_LRU_CACHE_H_
+#include <walle/config/base.h>
+#include <walle/math/power2.h>
+#include <walle/wsl/allocator.h>
+#include <walle/wsl/delegate.h>
+#include <walle/wsl/flat_hash_map.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace wsl {
+
+/**
+ * @brief  bounded cache shared by many threads, evicting the least
+ *         recently used entries first (approximately, see below).
+ * @note   keys are spread over 2^k cache line aligned shards, each behind
+ *         its own mutex with its own share of the capacity, so threads only
+ *         meet when they hit the same shard.
+ *         eviction is CLOCK: a hit only sets the entry's referenced bit, no
+ *         list is relinked, and a shard over capacity sweeps a hand over
+ *         its entries, clearing set bits and evicting the first entry
+ *         found clear. new entries start clear, a key read once is evicted
+ *         before keys read again.
+ *         every entry has a charge (1 by default, or its size in bytes)
+ *         and a shard holds entries up to its capacity in charge.
+ *         the eviction callback runs for entries pushed out by capacity,
+ *         after the shard lock is released, so it may use the cache; erase,
+ *         clear and replacing a value don't call it.
+ *         K and V are default constructible and movable, values are
+ *         returned by copy: hold big values by shared pointer.
+ */
+template <typename K,
+          typename V,
+          typename Hash = wsl::hash<K>,
+          typename Eq = wsl::hash_equal<K> >
+class lru_cache {
+public:
+    typedef K                               key_type;
+    typedef V                               mapped_type;
+    typedef size_t                          size_type;
+    typedef delegate<void(const K&, V&)>    evict_callback;
+
+    struct stats {
+        size_t  size;       // entries.
+        size_t  usage;      // their charges.
+        size_t  capacity;   // sum of the shard capacities.
+        size_t  hits;
+        size_t  misses;
+        size_t  inserts;    // new keys and replaced values.
+        size_t  evictions;  // entries pushed out by capacity.
+    };
+
+    /**
+     * @param  capacity: total charge held, split evenly over the shards.
+     * @param  shards: rounded up to a power of two, 0 for 4 per hardware
+     *         thread (at least 16), fewer when that leaves shards of less
+     *         than 32.
+     * @param  on_evict: called with each evicted key and value.
+     */
+    explicit lru_cache(size_t capacity, size_t shards = 0,
+                       const evict_callback &on_evict = evict_callback(),
+                       const Hash &hf = Hash(), const Eq &eq = Eq())
+    : _hash(hf),
+      _on_evict(on_evict)
+    {
+        if (shards == 0) {
+            shards = 4 * size_t(std::thread::hardware_concurrency());
+            shards = shards < 16 ? 16 : shards;
+            shards = walle::math::round_up_to_power_of_two(shards);
+            while (shards > 1 && capacity / shards < kMinShardCapacity) {
+                shards >>= 1;
+            }
+        }
+        shards = shards > kMaxShards ? kMaxShards : shards;
+        _shard_count = walle::math::round_up_to_power_of_two(shards);
+        _shard_mask = _shard_count - 1;
+        _shards = static_cast<shard*>(allocate_cache_aligned(_shard_count * sizeof(shard)));
+        const size_t per_shard = (capacity + _shard_count - 1) / _shard_count;
+        for (size_t i = 0; i < _shard_count; ++i) {
+            new (_shards + i) shard(per_shard, hf, eq);
+        }
+    }
+
+    ~lru_cache()
+    {
+        for (size_t i = 0; i < _shard_count; ++i) {
+            _shards[i].~shard();
+        }
+        deallocate_aligned(_shards);
+    }
+
+    WALLE_NON_COPYABLE(lru_cache);
+
+    /**
+     * @brief  copy the value of key into value and mark key used.
+     * @retval false when key is absent, value is left alone.
+     */
+    bool find(const K &key, V &value)
+    {
+        shard &s = shard_of(key);
+        std::lock_guard<std::mutex> guard(s.lock);
+        typename index_map::const_iterator it = s.index.find(key);
+        if (it == s.index.end()) {
+            ++s.misses;
+            return false;
+        }
+        node &n = s.nodes[it->second];
+        n.referenced = true;
+        value = n.value;
+        ++s.hits;
+        return true;
+    }
+
+    /**
+     * @brief  whether key is cached, without counting a hit or a miss or
+     *         marking it used.
+     */
+    bool contains(const K &key) const
+    {
+        shard &s = shard_of(key);
+        std::lock_guard<std::mutex> guard(s.lock);
+        return s.index.contains(key);
+    }
+
+    /**
+     * @brief  cache value for key, replacing any value it had, and evict
+     *         entries until its shard is within capacity again.
+     * @retval false when charge alone is over the shard capacity: nothing
+     *         is cached and a previous value of key is dropped.
+     */
+    bool insert(const K &key, const V &value, size_t charge = 1)
+    {
+        WALLE_ASSERT_MSG(charge > 0, "entries need a charge");
+        shard &s = shard_of(key);
+        std::vector<std::pair<K, V> > evicted;
+        {
+            std::lock_guard<std::mutex> guard(s.lock);
+            typename index_map::iterator it = s.index.find(key);
+            if (charge > s.capacity) {
+                if (it != s.index.end()) {
+                    const size_t i = it->second;
+                    s.index.erase(it);
+                    release(s, i);
+                }
+                return false;
+            }
+            size_t i;
+            if (it != s.index.end()) {
+                i = it->second;
+                node &n = s.nodes[i];
+                s.usage -= n.charge;
+                n.value = value;
+                n.charge = charge;
+            } else {
+                i = acquire(s);
+                node &n = s.nodes[i];
+                n.key = key;
+                n.value = value;
+                n.charge = charge;
+                n.referenced = false;
+                s.index.insert(std::make_pair(key, i));
+            }
+            s.usage += charge;
+            ++s.inserts;
+            while (s.usage > s.capacity) {
+                evict_one(s, i, evicted);
+            }
+        }
+        for (size_t j = 0; j < evicted.size(); ++j) {
+            _on_evict(evicted[j].first, evicted[j].second);
+        }
+        return true;
+    }
+
+    /**
+     * @retval true when key was cached.
+     */
+    bool erase(const K &key)
+    {
+        shard &s = shard_of(key);
+        std::lock_guard<std::mutex> guard(s.lock);
+        typename index_map::iterator it = s.index.find(key);
+        if (it == s.index.end()) {
+            return false;
+        }
+        const size_t i = it->second;
+        s.index.erase(it);
+        release(s, i);
+        return true;
+    }
+
+    /**
+     * @brief  drop every entry, the counters are kept.
+     */
+    void clear()
+    {
+        for (size_t i = 0; i < _shard_count; ++i) {
+            shard &s = _shards[i];
+            std::lock_guard<std::mutex> guard(s.lock);
+            s.index.clear();
+            s.nodes.clear();
+            s.free.clear();
+            s.hand = 0;
+            s.usage = 0;
+        }
+    }
+
+    /**
+     * @brief  the number of entries, exact only while no writer runs.
+     */
+    size_t size() const
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < _shard_count; ++i) {
+            shard &s = _shards[i];
+            std::lock_guard<std::mutex> guard(s.lock);
+            n += s.index.size();
+        }
+        return n;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    size_t shard_count() const
+    {
+        return _shard_count;
+    }
+
+    stats get_shard_stats(size_t i) const
+    {
+        WALLE_ASSERT_MSG(i < _shard_count, "shard out of range");
+        shard &s = _shards[i];
+        std::lock_guard<std::mutex> guard(s.lock);
+        stats st;
+        st.size = s.index.size();
+        st.usage = s.usage;
+        st.capacity = s.capacity;
+        st.hits = s.hits;
+        st.misses = s.misses;
+        st.inserts = s.inserts;
+        st.evictions = s.evictions;
+        return st;
+    }
+
+    /**
+     * @brief  the sum over all shards.
+     */
+    stats get_stats() const
+    {
+        stats total;
+        std::memset(&total, 0, sizeof(total));
+        for (size_t i = 0; i < _shard_count; ++i) {
+            const stats st = get_shard_stats(i);
+            total.size += st.size;
+            total.usage += st.usage;
+            total.capacity += st.capacity;
+            total.hits += st.hits;
+            total.misses += st.misses;
+            total.inserts += st.inserts;
+            total.evictions += st.evictions;
+        }
+        return total;
+    }
+
+private:
+    static const size_t kMaxShards = 1 << 16;
+    static const size_t kMinShardCapacity = 32;
+
+    typedef flat_hash_map<K, size_t, Hash, Eq> index_map;
+
+    struct node {
+        K       key;
+        V       value;
+        size_t  charge;     // 0 for a free node.
+        bool    referenced;
+    };
+
+    struct alignas(WALLE_CACHE_LINE_SIZE) shard {
+        std::mutex          lock;
+        index_map           index;  // key to its node.
+        std::vector<node>   nodes;
+        std::vector<size_t> free;   // free nodes.
+        size_t              hand;   // next node the clock looks at.
+        size_t              usage;
+        size_t              capacity;
+        size_t              hits;
+        size_t              misses;
+        size_t              inserts;
+        size_t              evictions;
+
+        shard(size_t cap, const Hash &hf, const Eq &eq)
+        : index(0, hf, eq),
+          hand(0),
+          usage(0),
+          capacity(cap),
+          hits(0),
+          misses(0),
+          inserts(0),
+          evictions(0)
+        {
+
+        }
+    };
+
+    // the top bits pick the shard, the table of the shard uses the low ones.
+    shard &shard_of(const K &key) const
+    {
+        return _shards[(uint64_t(_hash(key)) >> 40) & _shard_mask];
+    }
+
+    static size_t acquire(shard &s)
+    {
+        if (!s.free.empty()) {
+            const size_t i = s.free.back();
+            s.free.pop_back();
+            return i;
+        }
+        s.nodes.push_back(node());
+        return s.nodes.size() - 1;
+    }
+
+    // a node already out of the index; its key and value are reset so they
+    // don't hold on to memory.
+    static void release(shard &s, size_t i)
+    {
+        node &n = s.nodes[i];
+        s.usage -= n.charge;
+        n.key = K();
+        n.value = V();
+        n.charge = 0;
+        n.referenced = false;
+        s.free.push_back(i);
+    }
+
+    // one turn of the clock, never evicting keep. the shard is over
+    // capacity and keep alone is not, so another entry is there and the
+    // hand finds it clear within two sweeps.
+    void evict_one(shard &s, size_t keep, std::vector<std::pair<K, V> > &evicted)
+    {
+        for (;;) {
+            if (s.hand >= s.nodes.size()) {
+                s.hand = 0;
+            }
+            const size_t i = s.hand++;
+            node &n = s.nodes[i];
+            if (n.charge == 0 || i == keep) {
+                continue;
+            }
+            if (n.referenced) {
+                n.referenced = false;
+                continue;
+            }
+            s.index.erase(n.key);
+            if (_on_evict) {
+                evicted.push_back(std::make_pair(std::move(n.key), std::move(n.value)));
+            }
+            release(s, i);
+            ++s.evictions;
+            return;
+        }
+    }
+
+    Hash            _hash;
+    evict_callback  _on_evict;
+    shard           *_shards;
+    size_t          _shard_count;
+    size_t          _shard_mask;
+};
+
+}
+#endif //WALLE_WSL_LRU_CACHE_H_
@@ -0,0 +1,440 @@
+#ifndef WALLE_WSL_MPMC_QUEUE_H_
+#define WALLE_WSL_MPMC_QUEUE_H_
+#include <walle/config/base.h>
+#include <walle/math/power2.h>
+#include <walle/wsl/algorithm.h>
+#include <walle/wsl/internal/futex.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace wsl {
+
+namespace internal {
+
+/**
+ * @brief  futex backed wait list of one queue condition (not empty/not full).
+ * @note   notify() only enters the kernel when somebody registered as a
+ *         waiter, the uncontended path costs a fence and a load.
+ */
+struct queue_waiters {
+    std::atomic<uint32_t>   epoch;
+    std::atomic<uint32_t>   count;
+
+    queue_waiters() : epoch(0), count(0) {}
+
+    /**
+     * @brief  wake up to n waiters after the queue state was published.
+     */
+    void notify(int n)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (count.load(std::memory_order_relaxed)) {
+            epoch.fetch_add(1, std::memory_order_release);
+            futex_wake(&epoch, n);
+        }
+    }
+};
+
+}
+
+/**
+ * @brief  bounded multi producer multi consumer queue (Vyukov).
+ * @note   every slot carries a sequence number telling which lap may write
+ *         or read it next, so producers and consumers only contend on their
+ *         own position counter. slots are padded to whole cache lines.
+ *         try_* never block, the blocking and timed variants spin briefly
+ *         and then sleep on a futex that the opposite side signals only when
+ *         a waiter is registered. the capacity is rounded up to a power of two.
+ */
+template <typename T>
+class mpmc_queue {
+public:
+    typedef T           value_type;
+    typedef size_t      size_type;
+
+    explicit mpmc_queue(size_type capacity)
+    : _capacity(walle::math::round_up_to_power_of_two(
+          static_cast<unsigned long>(capacity < 2 ? 2 : capacity))),
+      _mask(_capacity - 1),
+      _memory(WALLE_NULL),
+      _slots(WALLE_NULL),
+      _enqueue_pos(0),
+      _dequeue_pos(0)
+    {
+        _memory = std::malloc(sizeof(slot) * _capacity + WALLE_CACHE_LINE_SIZE);
+        if (WALLE_UNLIKELY(!_memory)) {
+            throw std::bad_alloc();
+        }
+        _slots = reinterpret_cast<slot*>(
+            wsl::align_up(static_cast<char*>(_memory), WALLE_CACHE_LINE_SIZE));
+        for (size_type i = 0; i < _capacity; ++i) {
+            new (&_slots[i]) slot();
+            _slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~mpmc_queue()
+    {
+        const size_type tail = _enqueue_pos.load(std::memory_order_relaxed);
+        for (size_type pos = _dequeue_pos.load(std::memory_order_relaxed); pos != tail; ++pos) {
+            slot &s = _slots[pos & _mask];
+            if (s.seq.load(std::memory_order_relaxed) == pos + 1) {
+                s.value()->~T();
+            }
+        }
+        for (size_type i = 0; i < _capacity; ++i) {
+            _slots[i].~slot();
+        }
+        std::free(_memory);
+    }
+
+    WALLE_NON_COPYABLE(mpmc_queue);
+
+    size_type capacity() const
+    {
+        return _capacity;
+    }
+
+    /**
+     * @brief  number of queued elements, approximate under concurrency.
+     */
+    size_type size_approx() const
+    {
+        const size_type tail = _enqueue_pos.load(std::memory_order_relaxed);
+        const size_type head = _dequeue_pos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    template <typename... Args>
+    bool try_emplace(Args&&... args)
+    {
+        size_type pos = _enqueue_pos.load(std::memory_order_relaxed);
+        slot *s;
+        for (;;) {
+            s = &_slots[pos & _mask];
+            const size_type seq = s->seq.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        new (s->value()) T(std::forward<Args>(args)...);
+        s->seq.store(pos + 1, std::memory_order_release);
+        _not_empty.notify(1);
+        return true;
+    }
+
+    bool try_push(const T &value)
+    {
+        return try_emplace(value);
+    }
+
+    bool try_push(T &&value)
+    {
+        return try_emplace(std::move(value));
+    }
+
+    bool try_pop(T &out)
+    {
+        size_type pos = _dequeue_pos.load(std::memory_order_relaxed);
+        slot *s;
+        for (;;) {
+            s = &_slots[pos & _mask];
+            const size_type seq = s->seq.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        T *value = s->value();
+        out = std::move(*value);
+        value->~T();
+        s->seq.store(pos + _capacity, std::memory_order_release);
+        _not_full.notify(1);
+        return true;
+    }
+
+    /**
+     * @brief  push up to n items with a single claim of consecutive slots.
+     * @retval number of items pushed, 0 when the queue is full or n is 0.
+     */
+    size_type try_push_n(const T *items, size_type n)
+    {
+        if (n == 0) {
+            return 0;
+        }
+        size_type pos = _enqueue_pos.load(std::memory_order_relaxed);
+        size_type k;
+        for (;;) {
+            k = ready_run(pos, 0, n);
+            if (k == 0) {
+                if (static_cast<intptr_t>(_slots[pos & _mask].seq.load(std::memory_order_acquire)) -
+                    static_cast<intptr_t>(pos) < 0) {
+                    return 0;
+                }
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (_enqueue_pos.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (size_type i = 0; i < k; ++i) {
+            slot &s = _slots[(pos + i) & _mask];
+            new (s.value()) T(items[i]);
+            s.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        _not_empty.notify(static_cast<int>(k));
+        return k;
+    }
+
+    /**
+     * @brief  pop up to n items with a single claim of consecutive slots.
+     * @retval number of items popped, 0 when the queue is empty or n is 0.
+     */
+    size_type try_pop_n(T *out, size_type n)
+    {
+        if (n == 0) {
+            return 0;
+        }
+        size_type pos = _dequeue_pos.load(std::memory_order_relaxed);
+        size_type k;
+        for (;;) {
+            k = ready_run(pos, 1, n);
+            if (k == 0) {
+                if (static_cast<intptr_t>(_slots[pos & _mask].seq.load(std::memory_order_acquire)) -
+                    static_cast<intptr_t>(pos + 1) < 0) {
+                    return 0;
+                }
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (_dequeue_pos.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (size_type i = 0; i < k; ++i) {
+            slot &s = _slots[(pos + i) & _mask];
+            T *value = s.value();
+            out[i] = std::move(*value);
+            value->~T();
+            s.seq.store(pos + i + _capacity, std::memory_order_release);
+        }
+        _not_full.notify(static_cast<int>(k));
+        return k;
+    }
+
+    /**
+     * @brief  push, sleeping while the queue is full.
+     */
+    void push(const T &value)
+    {
+        wait(_not_full, push_op<const T&>(*this, value), -1);
+    }
+
+    void push(T &&value)
+    {
+        wait(_not_full, push_op<T&&>(*this, std::move(value)), -1);
+    }
+
+    /**
+     * @brief  pop, sleeping while the queue is empty.
+     */
+    void pop(T &out)
+    {
+        wait(_not_empty, pop_op(*this, out), -1);
+    }
+
+    /**
+     * @brief  push all n items, sleeping whenever the queue is full.
+     */
+    void push_n(const T *items, size_type n)
+    {
+        while (n) {
+            size_type k = 0;
+            wait(_not_full, push_n_op(*this, items, n, k), -1);
+            items += k;
+            n -= k;
+        }
+    }
+
+    /**
+     * @brief  pop between 1 and n items, sleeping while the queue is empty.
+     * @retval number of items popped, 0 only when n is 0.
+     */
+    size_type pop_n(T *out, size_type n)
+    {
+        if (n == 0) {
+            return 0;
+        }
+        size_type k = 0;
+        wait(_not_empty, pop_n_op(*this, out, n, k), -1);
+        return k;
+    }
+
+    /**
+     * @brief  push, sleeping at most timeout while the queue is full.
+     * @retval false on timeout.
+     */
+    template <typename Rep, typename Period>
+    bool push_for(const T &value, const std::chrono::duration<Rep, Period> &timeout)
+    {
+        return wait(_not_full, push_op<const T&>(*this, value), to_ns(timeout));
+    }
+
+    /**
+     * @brief  pop, sleeping at most timeout while the queue is empty.
+     * @retval false on timeout.
+     */
+    template <typename Rep, typename Period>
+    bool pop_for(T &out, const std::chrono::duration<Rep, Period> &timeout)
+    {
+        return wait(_not_empty, pop_op(*this, out), to_ns(timeout));
+    }
+
+private:
+    static const int kSpinCount = 64;
+
+    struct slot_base {
+        std::atomic<size_type>  seq;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    struct slot : public slot_base {
+        char pad[WALLE_CACHE_LINE_SIZE - sizeof(slot_base) % WALLE_CACHE_LINE_SIZE];
+
+        T *value()
+        {
+            return reinterpret_cast<T*>(&this->storage);
+        }
+    };
+
+    template <typename Arg>
+    struct push_op {
+        mpmc_queue &q;
+        Arg value;
+        push_op(mpmc_queue &queue, Arg v) : q(queue), value(std::forward<Arg>(v)) {}
+        bool operator()() { return q.try_push(std::forward<Arg>(value)); }
+    };
+
+    struct pop_op {
+        mpmc_queue &q;
+        T &out;
+        pop_op(mpmc_queue &queue, T &o) : q(queue), out(o) {}
+        bool operator()() { return q.try_pop(out); }
+    };
+
+    struct push_n_op {
+        mpmc_queue &q;
+        const T *items;
+        size_type n;
+        size_type &done;
+        push_n_op(mpmc_queue &queue, const T *i, size_type c, size_type &d)
+        : q(queue), items(i), n(c), done(d) {}
+        bool operator()() { done = q.try_push_n(items, n); return done != 0; }
+    };
+
+    struct pop_n_op {
+        mpmc_queue &q;
+        T *out;
+        size_type n;
+        size_type &done;
+        pop_n_op(mpmc_queue &queue, T *o, size_type c, size_type &d)
+        : q(queue), out(o), n(c), done(d) {}
+        bool operator()() { done = q.try_pop_n(out, n); return done != 0; }
+    };
+
+    template <typename Rep, typename Period>
+    static int64_t to_ns(const std::chrono::duration<Rep, Period> &d)
+    {
+        const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        return ns < 0 ? 0 : ns;
+    }
+
+    /**
+     * @brief  length of the run of slots from pos that are ready for the
+     *         lap pos + offset, at most n.
+     */
+    size_type ready_run(size_type pos, size_type offset, size_type n) const
+    {
+        if (n > _capacity) {
+            n = _capacity;
+        }
+        size_type k = 0;
+        while (k < n &&
+               _slots[(pos + k) & _mask].seq.load(std::memory_order_acquire) == pos + k + offset) {
+            ++k;
+        }
+        return k;
+    }
+
+    template <typename Op>
+    bool wait(internal::queue_waiters &w, Op op, int64_t timeout_ns)
+    {
+        for (int i = 0; i < kSpinCount; ++i) {
+            if (op()) {
+                return true;
+            }
+        }
+        typedef std::chrono::steady_clock clock;
+        const clock::time_point deadline = clock::now() + std::chrono::nanoseconds(timeout_ns);
+        for (;;) {
+            w.count.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const uint32_t epoch = w.epoch.load(std::memory_order_seq_cst);
+            if (op()) {
+                w.count.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            int64_t remaining = -1;
+            if (timeout_ns >= 0) {
+                remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    deadline - clock::now()).count();
+                if (remaining <= 0) {
+                    w.count.fetch_sub(1, std::memory_order_relaxed);
+                    return false;
+                }
+            }
+            internal::futex_wait(&w.epoch, epoch, remaining);
+            w.count.fetch_sub(1, std::memory_order_relaxed);
+            if (op()) {
+                return true;
+            }
+        }
+    }
+
+    const size_type             _capacity;
+    const size_type             _mask;
+    void                       *_memory;
+    slot                       *_slots;
+    char                        _pad0[WALLE_CACHE_LINE_SIZE];
+    std::atomic<size_type>      _enqueue_pos;
+    char                        _pad1[WALLE_CACHE_LINE_SIZE];
+    std::atomic<size_type>      _dequeue_pos;
+    char                        _pad2[WALLE_CACHE_LINE_SIZE];
+    internal::queue_waiters     _not_empty;
+    char                        _pad3[WALLE_CACHE_LINE_SIZE];
+    internal::queue_waiters     _not_full;
+    char                        _pad4[WALLE_CACHE_LINE_SIZE];
+};
+
+}
+#endif //WALLE_WSL_MPMC_QUEUE_H_
@@ -0,0 +1,214 @@
+#ifndef WALLE_WSL_MULTI_MATCHER_H_
+#define WALLE_WSL_MULTI_MATCHER_H_
+#include <walle/config/base.h>
+#include <walle/wsl/delegate.h>
+#include <walle/wsl/string_view.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace wsl {
+
+/**
+ * @brief  Aho-Corasick matcher for a set of patterns.
+ * @note   patterns are added, then compile() builds the automaton:
+ *         bytes are mapped to classes first, bytes in no pattern share
+ *         class 0 and case folded letters share a class in ignore case
+ *         mode. the trie is laid out as a double array, a state's child on
+ *         class c sits at base + c and is valid when its check names the
+ *         state, with failure links for the missing transitions. the
+ *         shallow states, where the automaton spends most of its time, get
+ *         full transition rows within kDenseBytes so a step from them is a
+ *         single load, and every failure chain ends in one of them. the
+ *         rest of the automaton is about 20 bytes per trie node.
+ *         inputs of at least kLaneBytes per lane are scanned as kLanes
+ *         interleaved lanes so their loads overlap, each lane after the
+ *         first starts max pattern size - 1 bytes early to reach the exact
+ *         state at its first byte. the lanes run over windows of
+ *         kWindowBytes, the hits of the later lanes are held back only
+ *         until the end of their window and a stop ends the scan there.
+ *         every occurrence of every pattern is reported, overlapping ones
+ *         included, in order of their end offsets. adding a pattern after
+ *         compile() needs another compile() before matching.
+ */
+class multi_matcher {
+public:
+    /**
+     * @brief  called with the pattern id and the offset of the first byte
+     *         of the occurrence, return false to stop matching.
+     */
+    typedef delegate<bool(uint32_t, size_t)> callback_type;
+
+    static const WALLE_CONSTEXPR size_t kDenseBytes = 256 * 1024;
+    static const WALLE_CONSTEXPR size_t kLanes = 4;
+    static const WALLE_CONSTEXPR size_t kLaneBytes = 4096;
+    static const WALLE_CONSTEXPR size_t kWindowBytes = 4 * kLanes * kLaneBytes;
+
+    explicit multi_matcher(bool ignore_case = false);
+
+    /**
+     * @brief  add a non empty pattern, ids count up from 0. a pattern added
+     *         twice is reported under both ids.
+     */
+    uint32_t add(string_view pattern);
+
+    void compile();
+
+    bool compiled() const
+    {
+        return _compiled;
+    }
+
+    bool ignore_case() const
+    {
+        return _ignore_case;
+    }
+
+    size_t size() const
+    {
+        return _pattern_ends.size();
+    }
+
+    string_view pattern(uint32_t id) const
+    {
+        const size_t begin = id ? _pattern_ends[id - 1] : 0;
+        return string_view(_patterns.data() + begin, _pattern_ends[id] - begin);
+    }
+
+    size_t state_count() const
+    {
+        return _state_count;
+    }
+
+    /**
+     * @brief  bytes held by the compiled automaton.
+     */
+    size_t memory_usage() const;
+
+    /**
+     * @brief  report the occurrences in text.
+     * @retval the number of occurrences reported.
+     */
+    size_t match(string_view text, const callback_type &on_match) const;
+
+    bool contains_any(string_view text) const;
+
+    /**
+     * @brief  matching over input split into chunks, occurrences spanning
+     *         chunk boundaries are found and offsets count from the start
+     *         of the first chunk. the matcher must outlive the stream and
+     *         stay compiled.
+     */
+    class stream {
+    public:
+        explicit stream(const multi_matcher &matcher)
+        : _matcher(&matcher),
+          _state(kRootState),
+          _offset(0),
+          _stopped(false)
+        {
+
+        }
+
+        /**
+         * @retval false once the callback asked to stop, later chunks are
+         *         ignored until reset().
+         */
+        bool feed(string_view chunk, const callback_type &on_match);
+
+        void reset()
+        {
+            _state = kRootState;
+            _offset = 0;
+            _stopped = false;
+        }
+
+        /**
+         * @brief  bytes fed so far.
+         */
+        size_t offset() const
+        {
+            return _offset;
+        }
+
+    private:
+        const multi_matcher *_matcher;
+        uint32_t             _state;
+        size_t               _offset;
+        bool                 _stopped;
+    };
+
+private:
+    struct node {
+        uint32_t base;      // kHasOutput | offset of the children.
+        uint32_t check;     // parent slot, kFree for an unused slot.
+    };
+
+    static const uint32_t kHasOutput = 0x80000000u;
+    static const uint32_t kBaseMask = 0x7fffffffu;
+    static const uint32_t kFree = 0xffffffffu;
+    static const uint32_t kLastOutput = 0x80000000u;
+
+    // a running state is a slot of the double array, or for dense states
+    // kDenseState and the offset of its row in _dense, tagged with
+    // kOutputState when some pattern ends there.
+    static const uint32_t kOutputState = 0x80000000u;
+    static const uint32_t kDenseState = 0x40000000u;
+    static const uint32_t kStateMask = 0x3fffffffu;
+    static const uint32_t kRootState = kDenseState;
+
+    // runs the automaton from state over [p, p + n), offset is the stream
+    // offset of p. stops early when the callback returns false.
+    size_t scan(uint32_t &state, const char *p, size_t n, size_t offset,
+                const callback_type &on_match, bool &stopped) const;
+
+    size_t scan_lanes(uint32_t &state, const char *p, size_t n, size_t offset,
+                      const callback_type &on_match, bool &stopped) const;
+
+    // reports the patterns ending in state s at end (exclusive), false when
+    // the callback asked to stop.
+    bool report(uint32_t s, size_t end, const callback_type &on_match, size_t &count) const;
+
+    uint32_t step(uint32_t s, uint8_t byte) const
+    {
+        const uint32_t c = _classes[byte];
+        for (;;) {
+            if (s & kDenseState) {
+                return _dense[(s & kStateMask) + c];
+            }
+            const uint32_t slot = s & kStateMask;
+            const uint32_t t = (_nodes[slot].base & kBaseMask) + c;
+            const node &child = _nodes[t];
+            if (child.check == slot) {
+                return t | (child.base & kHasOutput);
+            }
+            s = _fail[slot];
+        }
+    }
+
+    bool                    _ignore_case;
+    bool                    _compiled;
+    std::string             _patterns;
+    std::vector<size_t>     _pattern_ends;
+    size_t                  _state_count;
+    size_t                  _max_size;
+    uint32_t                _class_count;
+    uint16_t                _classes[256];
+    std::vector<node>       _nodes;
+    // class_count transitions per dense state, the root is row 0.
+    std::vector<uint32_t>   _dense;
+    // the slot of each dense row's state.
+    std::vector<uint32_t>   _dense_state;
+    // the failure state of each slot.
+    std::vector<uint32_t>   _fail;
+    // nearest state on the failure chain with an output, 0 for none.
+    std::vector<uint32_t>   _dict;
+    // index of the state's first pattern id in _outputs, the last id of a
+    // state has kLastOutput set.
+    std::vector<uint32_t>   _output_begin;
+    std::vector<uint32_t>   _outputs;
+};
+
+}
+#endif //WALLE_WSL_MULTI_MATCHER_H_
@@ -0,0 +1,101 @@
+#ifndef WALLE_WSL_SEARCHER_H_
+#define WALLE_WSL_SEARCHER_H_
+#include <walle/config/base.h>
+#include <walle/wsl/string_view.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace wsl {
+
+/**
+ * @brief  substring search with the needle preprocessed once, for searching
+ *         the same needle in many haystacks.
+ * @note   the algorithm is chosen from the needle:
+ *         - Horspool when its expected shift, taking the needle's own byte
+ *           distribution for the haystack's, is at least kHorspoolMinShift.
+ *           that takes a long needle over a wide alphabet.
+ *         - otherwise a vector prefilter on the two bytes of the needle
+ *           least frequent in typical text, candidates are verified in
+ *           full.
+ *         both charge every verification against the bytes they skipped
+ *         and hand the rest of the haystack to Two-Way (Crochemore-Perrin,
+ *         with a bad character shift) when verifications dominate, so
+ *         every search is linear in the haystack.
+ *         the needle is copied, find() is const and may run concurrently.
+ */
+class searcher {
+public:
+    typedef size_t size_type;
+
+    enum algorithm {
+        kAuto,
+        kEmpty,         // empty needle, matches at every position.
+        kByte,          // single byte, memchr like scan.
+        kPrefilter,
+        kHorspool,
+        kTwoWay
+    };
+
+    static const WALLE_CONSTEXPR size_t kHorspoolMinShift = 160;
+
+    searcher();
+
+    /**
+     * @param  algo: kAuto picks as described above, anything else forces an
+     *         algorithm (for tests and benchmarks). kEmpty and kByte are
+     *         always used for needles of size 0 and 1.
+     */
+    explicit searcher(string_view needle, algorithm algo = kAuto);
+
+    /**
+     * @brief  offset of the first occurrence starting at or after pos,
+     *         string_view::npos when there is none.
+     */
+    size_type find(string_view haystack, size_type pos = 0) const;
+
+    bool contains(string_view haystack) const
+    {
+        return find(haystack) != string_view::npos;
+    }
+
+    string_view needle() const
+    {
+        return string_view(_needle.data(), _needle.size());
+    }
+
+    algorithm get_algorithm() const
+    {
+        return _algo;
+    }
+
+private:
+    void init_two_way();
+
+    void init_horspool();
+
+    const char *find_prefilter(const char *p, size_t n) const;
+
+    const char *find_horspool(const char *p, size_t n) const;
+
+    const char *find_two_way(const char *p, size_t n) const;
+
+    std::string     _needle;
+    algorithm       _algo;
+    // prefilter: offsets of the two rare bytes.
+    size_t          _rare1;
+    size_t          _rare2;
+    // two-way: the critical factorization needle = [0, _split) [_split, m),
+    // the period and, for periodic needles, the prefix known to match after
+    // a period shift.
+    size_t          _split;
+    size_t          _period;
+    size_t          _memory;
+    // two-way: last position + 1 of each byte in the needle, 0 when absent.
+    // horspool: the shift for the byte under the window's last position.
+    size_t          _shift[256];
+    size_t          _skip[256];
+};
+
+}
+#endif //WALLE_WSL_SEARCHER_H_
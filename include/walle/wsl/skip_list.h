@@ -69,13 +69,13 @@ public:
     const_reference back() const;
 
 
-    iterator       begin()                  { return iterator(impl.front()); }
-    const_iterator begin() const            { return const_iterator(impl.front()); }
-    const_iterator cbegin() const           { return const_iterator(impl.front()); }
+    iterator       begin()                  { return iterator(&impl, impl.front()); }
+    const_iterator begin() const            { return const_iterator(&impl, impl.front()); }
+    const_iterator cbegin() const           { return const_iterator(&impl, impl.front()); }
 
-    iterator       end()                    { return iterator(impl.one_past_end()); }
-    const_iterator end() const              { return const_iterator( impl.one_past_end()); }
-    const_iterator cend() const             { return const_iterator(impl.one_past_end()); }
+    iterator       end()                    { return iterator(&impl, impl.one_past_end()); }
+    const_iterator end() const              { return const_iterator(&impl, impl.one_past_end()); }
+    const_iterator cend() const             { return const_iterator(&impl, impl.one_past_end()); }
 
     reverse_iterator       rbegin()         { return reverse_iterator(end()); }
     const_reverse_iterator rbegin() const   { return const_reverse_iterator(end()); }
@@ -134,13 +134,13 @@ protected:
     iterator to_iterator(node_type *node, const value_type &value)
     {
         return impl.is_valid(node) && sk_detail::equivalent(node->value, value, impl.less)
-            ? iterator(node)
+            ? iterator(&impl, node)
             : end();
     }
     const_iterator to_iterator(const node_type *node, const value_type &value) const
     {
         return impl.is_valid(node) && sk_detail::equivalent(node->value, value, impl.less)
-            ? const_iterator(node)
+            ? const_iterator(&impl, node)
             : end();
     }
 };
@@ -310,14 +310,14 @@ void skip_list<T,C,A,LG,D>::assign(InputIterator first, InputIterator last)
 }
 
 //==============================================================================
-#pragma mark element access
+// element access
 
 template <class T, class C, class A, class LG, bool D>
 inline
 typename skip_list<T,C,A,LG,D>::reference
 skip_list<T,C,A,LG,D>::front()
 {
-    assert_that(!empty());
+    WALLE_ASSERT(!empty());
     return impl.front()->value;
 }
 
@@ -326,7 +326,7 @@ inline
 typename skip_list<T,C,A,LG,D>::const_reference
 skip_list<T,C,A,LG,D>::front() const
 {
-    assert_that(!empty());
+    WALLE_ASSERT(!empty());
     return impl.front()->value;
 }
 
@@ -335,7 +335,7 @@ inline
 typename skip_list<T,C,A,LG,D>::reference
 skip_list<T,C,A,LG,D>::back()
 {
-    assert_that(!empty());
+    WALLE_ASSERT(!empty());
     return impl.one_past_end()->prev->value;
 }
 
@@ -344,7 +344,7 @@ inline
 typename skip_list<T,C,A,LG,D>::const_reference
 skip_list<T,C,A,LG,D>::back() const
 {
-    assert_that(!empty());
+    WALLE_ASSERT(!empty());
     return impl.one_past_end()->prev->value;
 }
 
@@ -361,7 +361,7 @@ typename skip_list<T,C,A,LG,D>::insert_by_value_result
 skip_list<T,C,A,LG,D>::insert(const value_type &value)
 {
     node_type *node = impl.insert(value);
-    return std::make_pair(iterator(node), impl.is_valid(node));
+    return std::make_pair(iterator(&impl, node), impl.is_valid(node));
 }
 
 template <class T, class C, class A, class LG, bool D>
@@ -369,14 +369,14 @@ inline
 typename skip_list<T,C,A,LG,D>::iterator
 skip_list<T,C,A,LG,D>::insert(const_iterator hint, const value_type &value)
 {
-    assert_that(hint.get_impl() == &impl);
-    
+    WALLE_ASSERT(hint.get_impl() == &impl);
+
     const node_type *hint_node = hint.get_node();
 
     if (impl.is_valid(hint_node) && sk_detail::less_or_equal(value, hint_node->value, impl.less))
-        return iterator(impl.insert(value)); // bad hint, resort to "normal" insert
+        return iterator(&impl, impl.insert(value)); // bad hint, resort to "normal" insert
     else
-        return iterator(impl.insert(value,const_cast<node_type*>(hint_node)));
+        return iterator(&impl, impl.insert(value,const_cast<node_type*>(hint_node)));
 }
 
 //C++11iterator insert const_iterator pos, value_type &&value);
@@ -419,12 +419,12 @@ inline
 typename skip_list<T,C,A,LG,D>::iterator
 skip_list<T,C,A,LG,D>::erase(const_iterator position)
 {
-    assert_that(position.get_impl() == &impl);
-    assert_that(impl.is_valid(position.get_node()));
+    WALLE_ASSERT(position.get_impl() == &impl);
+    WALLE_ASSERT(impl.is_valid(position.get_node()));
     node_type *node = const_cast<node_type*>(position.get_node());
     node_type *next = node->next[0];
     impl.remove(node);
-    return iterator(next);
+    return iterator(&impl, next);
 }
 
 template <class T, class C, class A, class LG, bool D>
@@ -432,8 +432,8 @@ inline
 typename skip_list<T,C,A,LG,D>::iterator
 skip_list<T,C,A,LG,D>::erase(const_iterator first, const_iterator last)
 {
-    assert_that(first.get_impl() == &impl);
-    assert_that(last.get_impl() == &impl);
+    WALLE_ASSERT(first.get_impl() == &impl);
+    WALLE_ASSERT(last.get_impl() == &impl);
 
     if (first != last)
     {
@@ -442,11 +442,11 @@ skip_list<T,C,A,LG,D>::erase(const_iterator first, const_iterator last)
         impl.remove_between(first_node, last_node);
     }
     
-    return iterator(const_cast<node_type*>(last.get_node()));
+    return iterator(&impl, const_cast<node_type*>(last.get_node()));
 }
   
 //==============================================================================
-#pragma mark lookup
+// lookup
 
 template <class T, class C, class A, class LG, bool D>
 inline
@@ -491,7 +491,7 @@ multi_skip_list<T,C,A,LG>::lower_bound(const value_type &value)
 {
     node_type *node = impl.find_first(value);
     if (node == impl.one_past_front()) node = node->next[0];
-    return iterator(node);
+    return iterator(&impl, node);
 }
 
 template <class T, class C, class A, class LG>
@@ -501,7 +501,7 @@ multi_skip_list<T,C,A,LG>::lower_bound(const value_type &value) const
 {
     const node_type *node = impl.find_first(value);
     if (node == impl.one_past_front()) node = node->next[0];
-    return const_iterator(node);
+    return const_iterator(&impl, node);
 }
 
 template <class T, class C, class A, class LG>
@@ -515,7 +515,7 @@ multi_skip_list<T,C,A,LG>::upper_bound(const value_type &value)
     {
         node = node->next[0];
     }
-    return iterator( node);
+    return iterator(&impl, node);
 }
 
 template <class T, class C, class A, class LG>
@@ -529,7 +529,7 @@ multi_skip_list<T,C,A,LG>::upper_bound(const value_type &value) const
     {
         node = node->next[0];
     }
-    return const_iterator(node);
+    return const_iterator(&impl, node);
 }
 
 template <class T, class C, class A, class LG>
@@ -579,9 +579,9 @@ inline
 typename multi_skip_list<T,C,A,LG>::iterator
 multi_skip_list<T,C,A,LG>::erase(const_iterator first, const_iterator last)
 {
-    assert_that(first.get_impl() == &impl);
-    assert_that(last.get_impl() == &impl);
-    
+    WALLE_ASSERT(first.get_impl() == &impl);
+    WALLE_ASSERT(last.get_impl() == &impl);
+
     while (first != last)
     {
         const_iterator to_remove = first++;
@@ -589,7 +589,7 @@ multi_skip_list<T,C,A,LG>::erase(const_iterator first, const_iterator last)
         impl.remove(node);
     }
 
-    return iterator( const_cast<node_type*>(last.get_node()));
+    return iterator(&impl, const_cast<node_type*>(last.get_node()));
 }
 
 }
@@ -0,0 +1,221 @@
+#ifndef WALLE_WSL_SPLIT_H_
+#define WALLE_WSL_SPLIT_H_
+#include <walle/config/base.h>
+#include <walle/wsl/internal/string_search.h>
+#include <walle/wsl/string_view.h>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+namespace wsl {
+
+/**
+ * @brief  lazy range of the pieces of a text between delimiter bytes.
+ * @note   the pieces are views into the text, nothing is allocated or
+ *         copied. the text is scanned 64 bytes at a time into a bitmask of
+ *         delimiter positions (a compare for a single delimiter, a pshufb
+ *         nibble table lookup for a set) and the pieces are cut off the mask
+ *         one bit at a time.
+ *         - keeping empty pieces, n delimiters give n + 1 pieces, so an
+ *           empty text is one empty piece.
+ *         - skipping empty pieces, runs of delimiters act as one and leading
+ *           or trailing ones give nothing.
+ *         - after max_split pieces were cut off, the rest of the text is the
+ *           last piece, delimiters included. skipped empty pieces do not
+ *           count, and neither do the delimiters leading the rest.
+ *         the text and the range must outlive the iterators.
+ */
+class split_range {
+public:
+    class iterator {
+    public:
+        typedef std::forward_iterator_tag   iterator_category;
+        typedef string_view                 value_type;
+        typedef std::ptrdiff_t              difference_type;
+        typedef const string_view*          pointer;
+        typedef const string_view&          reference;
+
+        iterator()
+        : _text(WALLE_NULL),
+          _size(0),
+          _delims(WALLE_NULL),
+          _pos(string_view::npos),
+          _next(string_view::npos),
+          _block(0),
+          _mask(0),
+          _splits_left(0),
+          _skip_empty(false)
+        {
+
+        }
+
+        reference operator*() const
+        {
+            return _piece;
+        }
+
+        pointer operator->() const
+        {
+            return &_piece;
+        }
+
+        iterator &operator++()
+        {
+            advance();
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator tmp(*this);
+            advance();
+            return tmp;
+        }
+
+        bool operator==(const iterator &rhs) const
+        {
+            return _pos == rhs._pos;
+        }
+
+        bool operator!=(const iterator &rhs) const
+        {
+            return _pos != rhs._pos;
+        }
+
+    private:
+        friend class split_range;
+
+        explicit iterator(const split_range &range)
+        : _text(range._text.data()),
+          _size(range._text.size()),
+          _delims(&range._delims),
+          _pos(0),
+          _next(0),
+          _block(0),
+          _mask(0),
+          _splits_left(range._max_split),
+          _skip_empty(range._skip_empty)
+        {
+            if (_size) {
+                _mask = internal::simd_delimiter_mask(_text, _size < 64 ? _size : 64, *_delims);
+            }
+            advance();
+        }
+
+        // offset of the next unconsumed delimiter, the text size when there
+        // is none.
+        size_t next_delimiter()
+        {
+            while (_mask == 0) {
+                _block += 64;
+                if (_block >= _size) {
+                    _block = _size;
+                    return _size;
+                }
+                const size_t left = _size - _block;
+                _mask = internal::simd_delimiter_mask(_text + _block, left < 64 ? left : 64, *_delims);
+            }
+            const size_t d = _block + static_cast<size_t>(__builtin_ctzll(_mask));
+            _mask &= _mask - 1;
+            return d;
+        }
+
+        void advance()
+        {
+            for (;;) {
+                _pos = _next;
+                if (_pos == string_view::npos) {
+                    return;
+                }
+                size_t end = _size;
+                if (_splits_left == 0) {
+                    if (_skip_empty) {
+                        while (_pos < _size && _delims->contains(_text[_pos])) {
+                            ++_pos;
+                        }
+                    }
+                    _next = string_view::npos;
+                } else {
+                    end = next_delimiter();
+                    if (end == _size) {
+                        _next = string_view::npos;
+                    } else {
+                        _next = end + 1;
+                        if (_skip_empty && end == _pos) {
+                            continue;
+                        }
+                        --_splits_left;
+                    }
+                }
+                if (_skip_empty && _pos == end) {
+                    // only the last piece gets here.
+                    _pos = string_view::npos;
+                    return;
+                }
+                _piece = string_view(_text + _pos, end - _pos);
+                return;
+            }
+        }
+
+        const char                      *_text;
+        size_t                           _size;
+        const internal::delimiter_set   *_delims;
+        string_view                      _piece;
+        size_t                           _pos;          // offset of _piece, npos at the end.
+        size_t                           _next;         // offset of the next piece, npos after the last.
+        size_t                           _block;        // offset of the block _mask covers.
+        uint64_t                         _mask;         // unconsumed delimiters in the block.
+        size_t                           _splits_left;
+        bool                             _skip_empty;
+    };
+
+    typedef iterator const_iterator;
+
+    split_range(string_view text, string_view delims, bool skip_empty = false,
+                size_t max_split = string_view::npos)
+    : _text(text),
+      _skip_empty(skip_empty),
+      _max_split(delims.empty() ? 0 : max_split)
+    {
+        internal::make_delimiter_set(delims.data(), delims.size(), _delims);
+    }
+
+    iterator begin() const
+    {
+        return iterator(*this);
+    }
+
+    iterator end() const
+    {
+        return iterator();
+    }
+
+    string_view text() const
+    {
+        return _text;
+    }
+
+private:
+    string_view                 _text;
+    bool                        _skip_empty;
+    size_t                      _max_split;
+    internal::delimiter_set     _delims;
+};
+
+/**
+ * @brief  split text on any byte of delims, see split_range.
+ */
+inline split_range split(string_view text, string_view delims, bool skip_empty = false,
+                         size_t max_split = string_view::npos)
+{
+    return split_range(text, delims, skip_empty, max_split);
+}
+
+inline split_range split(string_view text, char delim, bool skip_empty = false,
+                         size_t max_split = string_view::npos)
+{
+    return split_range(text, string_view(&delim, 1), skip_empty, max_split);
+}
+
+}
+#endif //WALLE_WSL_SPLIT_H_
@@ -0,0 +1,274 @@
+#ifndef WALLE_WSL_SPSC_RING_H_
+#define WALLE_WSL_SPSC_RING_H_
+#include <walle/config/base.h>
+#include <walle/math/power2.h>
+#include <walle/wsl/buffer_view.h>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace wsl {
+
+/**
+ * @brief  bounded lock free single producer single consumer ring.
+ * @note   the capacity is rounded up to a power of two. the producer owns
+ *         the tail index and the consumer the head index, each on its own
+ *         cache line next to a cached copy of the opposite index, so the
+ *         shared line is only read when the cached copy says full/empty.
+ *         push_n(n)/pop_n(n) hand out contiguous spans of the storage for
+ *         zero copy access, they are completed with produce()/consume().
+ *         exactly one thread may push and one thread may pop.
+ */
+template <typename T, typename Allocator = std::allocator<T> >
+class spsc_ring {
+public:
+    typedef T           value_type;
+    typedef size_t      size_type;
+    typedef Allocator   allocator_type;
+
+    explicit spsc_ring(size_type capacity, const allocator_type &alloc = allocator_type())
+    : _alloc(alloc),
+      _capacity(walle::math::round_up_to_power_of_two(
+          static_cast<unsigned long>(capacity < 2 ? 2 : capacity))),
+      _mask(_capacity - 1),
+      _slots(_alloc.allocate(_capacity)),
+      _tail(0),
+      _head_cache(0),
+      _head(0),
+      _tail_cache(0)
+    {
+
+    }
+
+    ~spsc_ring()
+    {
+        size_type head = _head.load(std::memory_order_relaxed);
+        const size_type tail = _tail.load(std::memory_order_relaxed);
+        for (; head != tail; ++head) {
+            _slots[head & _mask].~T();
+        }
+        _alloc.deallocate(_slots, _capacity);
+    }
+
+    WALLE_NON_COPYABLE(spsc_ring);
+
+    size_type capacity() const
+    {
+        return _capacity;
+    }
+
+    /**
+     * @brief  number of queued elements, exact only on the producer or
+     *         consumer thread while the other side is idle.
+     */
+    size_type size() const
+    {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    // producer side
+
+    template <typename... Args>
+    bool try_emplace(Args&&... args)
+    {
+        const size_type tail = _tail.load(std::memory_order_relaxed);
+        if (WALLE_UNLIKELY(tail - _head_cache == _capacity)) {
+            _head_cache = _head.load(std::memory_order_acquire);
+            if (tail - _head_cache == _capacity) {
+                return false;
+            }
+        }
+        new (&_slots[tail & _mask]) T(std::forward<Args>(args)...);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(const T &value)
+    {
+        return try_emplace(value);
+    }
+
+    bool try_push(T &&value)
+    {
+        return try_emplace(std::move(value));
+    }
+
+    /**
+     * @brief  contiguous free slots at the tail, at most n, for the producer
+     *         to write in place. empty when the ring is full.
+     * @note   the span ends at the end of the storage, a second call after
+     *         produce() continues at the front. the slots are raw storage,
+     *         T must be trivially copyable.
+     */
+    buffer_view<T> push_n(size_type n)
+    {
+        WALLE_STATIC_ASSERT(std::is_trivially_copyable<T>::value,
+                            "spsc_ring spans need a trivially copyable T");
+        const size_type tail = _tail.load(std::memory_order_relaxed);
+        size_type free_slots = _capacity - (tail - _head_cache);
+        if (free_slots < n) {
+            _head_cache = _head.load(std::memory_order_acquire);
+            free_slots = _capacity - (tail - _head_cache);
+        }
+        const size_type index = tail & _mask;
+        const size_type contiguous = _capacity - index;
+        if (n > free_slots) {
+            n = free_slots;
+        }
+        if (n > contiguous) {
+            n = contiguous;
+        }
+        return buffer_view<T>(_slots + index, n);
+    }
+
+    /**
+     * @brief  publish the first n slots of the last push_n() span.
+     */
+    void produce(size_type n)
+    {
+        _tail.store(_tail.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    /**
+     * @brief  copy up to n items in, wrapping around the storage end.
+     * @retval number of items pushed.
+     */
+    size_type push_n(const T *items, size_type n)
+    {
+        size_type done = 0;
+        while (done < n) {
+            buffer_view<T> span = push_n(n - done);
+            if (span.size() == 0) {
+                break;
+            }
+            std::memcpy(static_cast<void*>(span.data()), items + done, span.size() * sizeof(T));
+            produce(span.size());
+            done += span.size();
+        }
+        return done;
+    }
+
+    // consumer side
+
+    /**
+     * @brief  the oldest element or null when empty.
+     */
+    T *front()
+    {
+        const size_type head = _head.load(std::memory_order_relaxed);
+        if (WALLE_UNLIKELY(head == _tail_cache)) {
+            _tail_cache = _tail.load(std::memory_order_acquire);
+            if (head == _tail_cache) {
+                return WALLE_NULL;
+            }
+        }
+        return &_slots[head & _mask];
+    }
+
+    /**
+     * @brief  remove the element returned by front().
+     */
+    void pop()
+    {
+        const size_type head = _head.load(std::memory_order_relaxed);
+        WALLE_ASSERT_MSG(head != _tail_cache, "pop on an empty spsc_ring");
+        _slots[head & _mask].~T();
+        _head.store(head + 1, std::memory_order_release);
+    }
+
+    bool try_pop(T &out)
+    {
+        T *value = front();
+        if (!value) {
+            return false;
+        }
+        out = std::move(*value);
+        pop();
+        return true;
+    }
+
+    /**
+     * @brief  contiguous queued elements at the head, at most n, for the
+     *         consumer to read in place. empty when the ring is empty.
+     */
+    buffer_view<T> pop_n(size_type n)
+    {
+        WALLE_STATIC_ASSERT(std::is_trivially_copyable<T>::value,
+                            "spsc_ring spans need a trivially copyable T");
+        const size_type head = _head.load(std::memory_order_relaxed);
+        size_type ready = _tail_cache - head;
+        if (ready < n) {
+            _tail_cache = _tail.load(std::memory_order_acquire);
+            ready = _tail_cache - head;
+        }
+        const size_type index = head & _mask;
+        const size_type contiguous = _capacity - index;
+        if (n > ready) {
+            n = ready;
+        }
+        if (n > contiguous) {
+            n = contiguous;
+        }
+        return buffer_view<T>(_slots + index, n);
+    }
+
+    /**
+     * @brief  release the first n elements of the last pop_n() span.
+     */
+    void consume(size_type n)
+    {
+        _head.store(_head.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    /**
+     * @brief  copy up to n items out, wrapping around the storage end.
+     * @retval number of items popped.
+     */
+    size_type pop_n(T *out, size_type n)
+    {
+        size_type done = 0;
+        while (done < n) {
+            buffer_view<T> span = pop_n(n - done);
+            if (span.size() == 0) {
+                break;
+            }
+            std::memcpy(static_cast<void*>(out + done), span.data(), span.size() * sizeof(T));
+            consume(span.size());
+            done += span.size();
+        }
+        return done;
+    }
+
+private:
+    // every group is followed by a whole line of padding, which keeps the
+    // groups on distinct cache lines without relying on over aligned new.
+
+    // read only after construction, shared by both sides.
+    allocator_type              _alloc;
+    const size_type             _capacity;
+    const size_type             _mask;
+    T * const                   _slots;
+    char                        _pad0[WALLE_CACHE_LINE_SIZE];
+
+    // producer line.
+    std::atomic<size_type>      _tail;
+    size_type                   _head_cache;
+    char                        _pad1[WALLE_CACHE_LINE_SIZE];
+
+    // consumer line.
+    std::atomic<size_type>      _head;
+    size_type                   _tail_cache;
+    char                        _pad2[WALLE_CACHE_LINE_SIZE];
+};
+
+}
+#endif //WALLE_WSL_SPSC_RING_H_
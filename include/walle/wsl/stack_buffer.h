@@ -1,14 +1,25 @@
 #ifndef WALLE_WSL_STACK_BUFFER_H_
 #define WALLE_WSL_STACK_BUFFER_H_
 #include <walle/wsl/internal/basic_buffer.h>
+#include <walle/wsl/allocator.h>
+#include <walle/wsl/growth_policy.h>
+#include <type_traits>
 
 namespace wsl {
 
-template<typename T, size_t SIZE, typename Allocator = std::allocator<T>>
-class stack_buffer :public wsl::internal::basic_buffer<T>{
+/**
+ * @brief  buffer with SIZE inline elements that spills to the heap.
+ * @note   GrowthPolicy picks the heap capacity (see growth_policy.h).
+ *         trivially copyable elements are relocated with memcpy, and when
+ *         Allocator has reallocate() (malloc_allocator does) a heap block is
+ *         resized in place, which is a mremap for large blocks.
+ */
+template<typename T, size_t SIZE, typename Allocator = wsl::malloc_allocator<T>,
+         typename GrowthPolicy = wsl::grow_by_half>
+class stack_buffer :public wsl::internal::buffer_base<T, stack_buffer<T, SIZE, Allocator, GrowthPolicy> >{
 public:
-    typedef wsl::internal::basic_buffer<T>              base_type;
-    typedef stack_buffer<T, SIZE, Allocator>		    this_type;
+    typedef stack_buffer<T, SIZE, Allocator, GrowthPolicy> this_type;
+    typedef wsl::internal::buffer_base<T, this_type>    base_type;
     typedef T 											value_type;
     typedef T* 											pointer;
     typedef const T* 									const_pointer;
@@ -21,6 +32,7 @@ public:
     typedef size_t 										size_type;
     typedef ptrdiff_t 									difference_type;
     typedef Allocator                                   allocator_type;
+    typedef GrowthPolicy                                growth_policy;
 
     static const WALLE_CONSTEXPR size_type npos = size_type(-1); 
 public:
@@ -30,14 +42,14 @@ public:
     }
     stack_buffer(stack_buffer &&other)
     {
-        move(std::forward(other));
+        move(std::move(other));
     }
 
     stack_buffer &operator=(stack_buffer &&other)
     {
         WALLE_ASSERT_MSG(this != &other, "this = this");
         deallocate();
-        move(std::forward(other));
+        move(std::move(other));
         return *this;
     }
 
@@ -51,10 +63,50 @@ public:
         return this->_ptr == _data;
     }
 
+    ~stack_buffer()
+    {
+        deallocate();
+    }
+
 protected:
+    friend class wsl::internal::buffer_base<T, this_type>;
+
     void grow(std::size_t size);
 
 private:
+    typedef std::integral_constant<bool, std::is_trivially_copyable<T>::value>  is_trivial;
+    typedef std::integral_constant<bool, std::is_trivially_copyable<T>::value &&
+                                         wsl::has_reallocate<Allocator>::value>  can_reallocate;
+
+    static void relocate(const T *from, size_type n, T *to, std::true_type)
+    {
+        if (n) {
+            std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+        }
+    }
+
+    static void relocate(const T *from, size_type n, T *to, std::false_type)
+    {
+        std::uninitialized_copy(from, from + n, to);
+    }
+
+    T *reallocate(size_type new_capacity, std::true_type)
+    {
+        return _alloc.reallocate(this->_ptr, this->_capacity, new_capacity);
+    }
+
+    T *reallocate(size_type new_capacity, std::false_type)
+    {
+        T *new_ptr = _alloc.allocate(new_capacity);
+        // The following code doesn't throw, so the raw pointer above doesn't leak.
+        relocate(this->_ptr, this->_size, new_ptr, is_trivial());
+        // deallocate may throw (at least in principle), but it doesn't matter since
+        // the buffer already uses the new storage and will deallocate it in case
+        // of exception.
+        _alloc.deallocate(this->_ptr, this->_capacity);
+        return new_ptr;
+    }
+
     void deallocate()
     {
         if (this->_ptr != _data) {
@@ -71,13 +123,16 @@ private:
         this->_capacity = other._capacity;
         if (other._ptr == other._data) {
             this->_ptr = _data;
-            std::uninitialized_copy(other._data, other._data + this->_size, _data);
+            relocate(other._data, this->_size, _data, is_trivial());
         } else {
             this->_ptr = other._ptr;
             // Set pointer to the inline array so that delete is not called
             // when deallocating.
             other._ptr = other._data;
         }
+        // the moved from buffer is empty and back on its inline array.
+        other._size = 0;
+        other._capacity = SIZE;
     }
 
 private:
@@ -86,25 +141,20 @@ private:
 
 };
 
-template <typename T, std::size_t SIZE, typename Allocator>
-void stack_buffer<T, SIZE, Allocator>::grow(std::size_t len)
+template <typename T, std::size_t SIZE, typename Allocator, typename GrowthPolicy>
+void stack_buffer<T, SIZE, Allocator, GrowthPolicy>::grow(std::size_t len)
 {
-    std::size_t new_capacity = this->_capacity + this->_capacity / 2;
-    if (len > new_capacity)
+    std::size_t new_capacity = GrowthPolicy::next_capacity(this->_capacity, len);
+    if (new_capacity < len)
         new_capacity = len;
-    T *new_ptr = this->_alloc.allocate(new_capacity);
-    // The following code doesn't throw, so the raw pointer above doesn't leak.
-    std::uninitialized_copy(this->_ptr, this->_ptr + this->_size, new_ptr);
-    std::size_t old_capacity = this->_capacity;
-    T *old_ptr = this->_ptr;
-    this->_capacity = new_capacity;
-    this->_ptr = new_ptr;
-    // deallocate may throw (at least in principle), but it doesn't matter since
-    // the buffer already uses the new storage and will deallocate it in case
-    // of exception.
-    if (old_ptr != _data) {
-        _alloc.deallocate(old_ptr, old_capacity);
+    T *new_ptr;
+    if (this->_ptr == _data) {
+        new_ptr = _alloc.allocate(new_capacity);
+        relocate(_data, this->_size, new_ptr, is_trivial());
+    } else {
+        new_ptr = reallocate(new_capacity, can_reallocate());
     }
+    this->set(new_ptr, new_capacity);
 }
 
 }
@@ -0,0 +1,247 @@
+#ifndef WALLE_WSL_STATIC_STRING_MAP_H_
+#define WALLE_WSL_STATIC_STRING_MAP_H_
+#include <walle/config/base.h>
+#include <walle/hash/hash.h>
+#include <walle/wsl/string_view.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace wsl {
+
+/**
+ * @brief  immutable map from a fixed set of strings to V through a
+ *         perfect hash, for dispatching on command names, header names,
+ *         config keys.
+ * @note   lookup is one hash64(), one read of a 16 bit pilot, one slot
+ *         and one final compare, hits and misses alike, no probing.
+ *         the table is built once by hash and displace (PTHash): keys are
+ *         grouped in buckets of about two, and the buckets, largest first,
+ *         get the first pilot that moves all their keys to free slots of a
+ *         power of two table at most 80% full. the keys are copied into
+ *         the map, a duplicate key keeps its first value. V must be default
+ *         constructible, empty slots hold V().
+ *         typically a function local static built from literals:
+ *             static const wsl::static_string_map<int> commands({
+ *                 {"get", kGet}, {"set", kSet}, {"del", kDel}});
+ */
+template <typename V>
+class static_string_map {
+public:
+    typedef V                                   mapped_type;
+    typedef std::pair<string_view, V>           value_type;
+    typedef size_t                              size_type;
+
+    static_string_map(std::initializer_list<value_type> init)
+    {
+        build(init.begin(), init.end());
+    }
+
+    template <typename Iterator>
+    static_string_map(Iterator first, Iterator last)
+    {
+        build(first, last);
+    }
+
+    /**
+     * @retval the value of key, null when key is not in the map.
+     */
+    const V *find(string_view key) const
+    {
+        const uint64_t h = walle::hash64(key.data(), key.size(), _seed);
+        const slot &s = _slots[position(h, _pilots[bucket(h)])];
+        // an empty key may have a null data(), it is only compared by size.
+        if (s.size == key.size() &&
+            (key.empty() || std::memcmp(&_chars[s.offset], key.data(), key.size()) == 0)) {
+            return &s.value;
+        }
+        return WALLE_NULL;
+    }
+
+    bool contains(string_view key) const
+    {
+        return find(key) != WALLE_NULL;
+    }
+
+    /**
+     * @retval the value of key, or missing.
+     */
+    V get(string_view key, const V &missing = V()) const
+    {
+        const V *v = find(key);
+        return v ? *v : missing;
+    }
+
+    size_type size() const
+    {
+        return _size;
+    }
+
+    size_type table_size() const
+    {
+        return _slots.size();
+    }
+
+private:
+    // the key by offset into _chars, a copied map keeps pointing into its
+    // own copy.
+    struct slot {
+        size_t      offset;
+        size_t      size;
+        V           value;
+    };
+
+    size_t bucket(uint64_t h) const
+    {
+        return size_t((uint64_t(uint32_t(h)) * _buckets) >> 32);
+    }
+
+    size_t position(uint64_t h, uint16_t pilot) const
+    {
+        return size_t(uint32_t(h >> 32) ^ uint32_t((pilot * 0x9e3779b97f4a7c15ull) >> 32)) & _mask;
+    }
+
+    template <typename Iterator>
+    void build(Iterator first, Iterator last);
+
+    std::vector<slot>       _slots;
+    std::vector<uint16_t>   _pilots;
+    std::vector<char>       _chars;
+    size_t                  _size;
+    size_t                  _mask;
+    size_t                  _buckets;
+    uint64_t                _seed;
+};
+
+template <typename V>
+template <typename Iterator>
+void static_string_map<V>::build(Iterator first, Iterator last)
+{
+    std::vector<value_type> items(first, last);
+    // a duplicate key can't be placed, keep its first value.
+    std::vector<size_t> by_key(items.size());
+    for (size_t i = 0; i < by_key.size(); ++i) {
+        by_key[i] = i;
+    }
+    std::stable_sort(by_key.begin(), by_key.end(), [&items](size_t a, size_t b) {
+        const string_view &ka = items[a].first;
+        const string_view &kb = items[b].first;
+        return std::lexicographical_compare(ka.begin(), ka.end(), kb.begin(), kb.end());
+    });
+    std::vector<bool> duplicate(items.size());
+    for (size_t i = 1; i < by_key.size(); ++i) {
+        if (items[by_key[i]].first == items[by_key[i - 1]].first) {
+            WALLE_ASSERT_MSG(false, "duplicate key in static_string_map");
+            duplicate[by_key[i]] = true;
+        }
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (!duplicate[i]) {
+            items[kept++] = items[i];
+        }
+    }
+    items.resize(kept);
+    _size = items.size();
+    size_t table = 1;
+    while (table * 4 < _size * 5) {
+        table <<= 1;
+    }
+    _mask = table - 1;
+    _buckets = _size / 2 ? _size / 2 : 1;
+
+    // one contiguous copy of the keys.
+    size_t bytes = 0;
+    for (size_t i = 0; i < _size; ++i) {
+        bytes += items[i].first.size() + 1;
+    }
+    _chars.resize(bytes);
+    std::vector<size_t> offsets(_size);
+    size_t at = 0;
+    for (size_t i = 0; i < _size; ++i) {
+        offsets[i] = at;
+        if (items[i].first.size()) {
+            std::memcpy(&_chars[at], items[i].first.data(), items[i].first.size());
+        }
+        at += items[i].first.size();
+        _chars[at++] = '\0';
+    }
+
+    std::vector<uint64_t> hashes(_size);
+    std::vector<size_t> order(_size);
+    std::vector<size_t> targets;
+    std::vector<bool> taken(table);
+    for (_seed = 0;; ++_seed) {
+        for (size_t i = 0; i < _size; ++i) {
+            hashes[i] = walle::hash64(items[i].first.data(), items[i].first.size(), _seed);
+            order[i] = i;
+        }
+        // keys grouped by bucket, the largest buckets placed first.
+        std::vector<size_t> bucket_sizes(_buckets);
+        for (size_t i = 0; i < _size; ++i) {
+            ++bucket_sizes[bucket(hashes[i])];
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            const size_t ba = bucket(hashes[a]);
+            const size_t bb = bucket(hashes[b]);
+            if (bucket_sizes[ba] != bucket_sizes[bb]) {
+                return bucket_sizes[ba] > bucket_sizes[bb];
+            }
+            return ba != bb ? ba < bb : a < b;
+        });
+
+        _pilots.assign(_buckets, 0);
+        std::fill(taken.begin(), taken.end(), false);
+        bool placed = true;
+        for (size_t begin = 0; begin < _size && placed;) {
+            const size_t b = bucket(hashes[order[begin]]);
+            size_t end = begin + 1;
+            while (end < _size && bucket(hashes[order[end]]) == b) {
+                ++end;
+            }
+            placed = false;
+            for (uint32_t pilot = 0; pilot <= 0xffff && !placed; ++pilot) {
+                targets.clear();
+                size_t k = begin;
+                for (; k < end; ++k) {
+                    const size_t pos = position(hashes[order[k]], uint16_t(pilot));
+                    if (taken[pos] || std::find(targets.begin(), targets.end(), pos) != targets.end()) {
+                        break;
+                    }
+                    targets.push_back(pos);
+                }
+                if (k == end) {
+                    for (size_t j = 0; j < targets.size(); ++j) {
+                        taken[targets[j]] = true;
+                    }
+                    _pilots[b] = uint16_t(pilot);
+                    placed = true;
+                }
+            }
+            begin = end;
+        }
+        // the keys are distinct, a bucket that fits no pilot (or a 64 bit
+        // hash collision) is retried with the next seed.
+        if (placed) {
+            break;
+        }
+    }
+
+    slot empty;
+    empty.offset = 0;
+    empty.size = size_t(-1);
+    empty.value = V();
+    _slots.assign(table, empty);
+    for (size_t i = 0; i < _size; ++i) {
+        slot &s = _slots[position(hashes[i], _pilots[bucket(hashes[i])])];
+        s.offset = offsets[i];
+        s.size = items[i].first.size();
+        s.value = items[i].second;
+    }
+}
+
+}
+#endif //WALLE_WSL_STATIC_STRING_MAP_H_
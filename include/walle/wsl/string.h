@@ -0,0 +1,816 @@
+#ifndef WALLE_WSL_STRING_H_
+#define WALLE_WSL_STRING_H_
+#include <walle/config/base.h>
+#include <walle/wsl/allocator.h>
+#include <walle/wsl/growth_policy.h>
+#include <walle/wsl/string_view.h>
+#include <walle/wsl/internal/char_traits.h>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace wsl {
+
+/**
+ * @brief  owning, always nul terminated string with N inline characters.
+ * @note   the default N fills 32 bytes (31 chars, std::string keeps 15),
+ *         enough for most keys and identifiers without touching the heap.
+ *         _ptr points at the inline array while the string is small, so
+ *         data() and size() never branch; the heap capacity shares storage
+ *         with the inline array. heap blocks grow by GrowthPolicy and are
+ *         resized in place when Allocator has reallocate().
+ *         resize_uninitialized(), append_uninitialized() and
+ *         resize_and_overwrite() size the string without filling it, for
+ *         code that writes the characters itself (formatting, decoding,
+ *         reading from a socket).
+ */
+template <typename T, typename Allocator = wsl::malloc_allocator<T>,
+          size_t N = 32 / sizeof(T) - 1, typename GrowthPolicy = wsl::grow_by_half>
+class basic_string : private Allocator {
+public:
+    typedef basic_string<T, Allocator, N, GrowthPolicy> this_type;
+    typedef basic_string_view<T>                        view_type;
+    typedef T 											value_type;
+    typedef T* 											pointer;
+    typedef const T* 									const_pointer;
+    typedef T& 											reference;
+    typedef const T& 									const_reference;
+    typedef T* 											iterator;
+    typedef const T* 									const_iterator;
+    typedef std::reverse_iterator<iterator> 			reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> 	    const_reverse_iterator;
+    typedef size_t 										size_type;
+    typedef ptrdiff_t 									difference_type;
+    typedef Allocator                                   allocator_type;
+    typedef GrowthPolicy                                growth_policy;
+
+    static const WALLE_CONSTEXPR size_type npos = size_type(-1);
+    static const WALLE_CONSTEXPR size_type inline_capacity = N;
+
+    WALLE_STATIC_ASSERT(std::is_trivially_copyable<T>::value, "basic_string holds trivial character types");
+    WALLE_STATIC_ASSERT(N > 0, "basic_string needs inline storage");
+
+public:
+    basic_string() WALLE_NOEXCEPT
+    : _ptr(_inline),
+      _size(0)
+    {
+        _inline[0] = T();
+    }
+
+    explicit basic_string(const allocator_type &alloc)
+    : Allocator(alloc),
+      _ptr(_inline),
+      _size(0)
+    {
+        _inline[0] = T();
+    }
+
+    basic_string(const T *s, const allocator_type &alloc = allocator_type())
+    : Allocator(alloc),
+      _ptr(_inline),
+      _size(0)
+    {
+        init(s, wsl::internal::char_strlen(s));
+    }
+
+    basic_string(const T *s, size_type n, const allocator_type &alloc = allocator_type())
+    : Allocator(alloc),
+      _ptr(_inline),
+      _size(0)
+    {
+        init(s, n);
+    }
+
+    explicit basic_string(view_type v, const allocator_type &alloc = allocator_type())
+    : Allocator(alloc),
+      _ptr(_inline),
+      _size(0)
+    {
+        init(v.data(), v.size());
+    }
+
+    explicit basic_string(const std::basic_string<T> &s, const allocator_type &alloc = allocator_type())
+    : Allocator(alloc),
+      _ptr(_inline),
+      _size(0)
+    {
+        init(s.data(), s.size());
+    }
+
+    basic_string(size_type n, T c, const allocator_type &alloc = allocator_type())
+    : Allocator(alloc),
+      _ptr(_inline),
+      _size(0)
+    {
+        resize(n, c);
+    }
+
+    basic_string(const basic_string &other)
+    : Allocator(other.get_allocator()),
+      _ptr(_inline),
+      _size(0)
+    {
+        init(other._ptr, other._size);
+    }
+
+    basic_string(basic_string &&other) WALLE_NOEXCEPT
+    : Allocator(std::move(other.allocator())),
+      _ptr(_inline),
+      _size(0)
+    {
+        take(other);
+    }
+
+    ~basic_string()
+    {
+        deallocate();
+    }
+
+    basic_string &operator=(const basic_string &other)
+    {
+        if (this != &other) {
+            assign(other._ptr, other._size);
+        }
+        return *this;
+    }
+
+    basic_string &operator=(basic_string &&other) WALLE_NOEXCEPT
+    {
+        WALLE_ASSERT_MSG(this != &other, "this = this");
+        deallocate();
+        _ptr = _inline;
+        allocator() = std::move(other.allocator());
+        take(other);
+        return *this;
+    }
+
+    basic_string &operator=(view_type v)
+    {
+        return assign(v.data(), v.size());
+    }
+
+    basic_string &operator=(const T *s)
+    {
+        return assign(s, wsl::internal::char_strlen(s));
+    }
+
+    allocator_type get_allocator() const
+    {
+        return *this;
+    }
+
+    iterator begin() WALLE_NOEXCEPT { return _ptr; }
+    const_iterator begin() const WALLE_NOEXCEPT { return _ptr; }
+    const_iterator cbegin() const WALLE_NOEXCEPT { return _ptr; }
+    iterator end() WALLE_NOEXCEPT { return _ptr + _size; }
+    const_iterator end() const WALLE_NOEXCEPT { return _ptr + _size; }
+    const_iterator cend() const WALLE_NOEXCEPT { return _ptr + _size; }
+    reverse_iterator rbegin() WALLE_NOEXCEPT { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const WALLE_NOEXCEPT { return const_reverse_iterator(end()); }
+    reverse_iterator rend() WALLE_NOEXCEPT { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const WALLE_NOEXCEPT { return const_reverse_iterator(begin()); }
+
+    T *data() WALLE_NOEXCEPT
+    {
+        return _ptr;
+    }
+
+    const T *data() const WALLE_NOEXCEPT
+    {
+        return _ptr;
+    }
+
+    const T *c_str() const WALLE_NOEXCEPT
+    {
+        return _ptr;
+    }
+
+    size_type size() const WALLE_NOEXCEPT
+    {
+        return _size;
+    }
+
+    size_type length() const WALLE_NOEXCEPT
+    {
+        return _size;
+    }
+
+    bool empty() const WALLE_NOEXCEPT
+    {
+        return _size == 0;
+    }
+
+    size_type capacity() const WALLE_NOEXCEPT
+    {
+        return is_inline() ? N : _capacity;
+    }
+
+    /**
+     * @brief  true while the characters live inside the object.
+     */
+    bool is_inline() const WALLE_NOEXCEPT
+    {
+        return _ptr == _inline;
+    }
+
+    view_type view() const WALLE_NOEXCEPT
+    {
+        return view_type(_ptr, _size);
+    }
+
+    operator view_type() const WALLE_NOEXCEPT
+    {
+        return view_type(_ptr, _size);
+    }
+
+    std::basic_string<T> str() const
+    {
+        return std::basic_string<T>(_ptr, _size);
+    }
+
+    T &operator[](size_type pos)
+    {
+        WALLE_ASSERT_MSG(pos <= _size, "out of range");
+        return _ptr[pos];
+    }
+
+    const T &operator[](size_type pos) const
+    {
+        WALLE_ASSERT_MSG(pos <= _size, "out of range");
+        return _ptr[pos];
+    }
+
+    T &front()
+    {
+        WALLE_ASSERT_MSG(!empty(), "empty");
+        return _ptr[0];
+    }
+
+    const T &front() const
+    {
+        WALLE_ASSERT_MSG(!empty(), "empty");
+        return _ptr[0];
+    }
+
+    T &back()
+    {
+        WALLE_ASSERT_MSG(!empty(), "empty");
+        return _ptr[_size - 1];
+    }
+
+    const T &back() const
+    {
+        WALLE_ASSERT_MSG(!empty(), "empty");
+        return _ptr[_size - 1];
+    }
+
+    /**
+     * @brief  make room for n characters, exactly n when it reallocates.
+     */
+    void reserve(size_type n)
+    {
+        if (n > capacity()) {
+            reallocate(n);
+        }
+    }
+
+    /**
+     * @brief  give back heap memory the string no longer needs, moving it
+     *         inline when it fits.
+     */
+    void shrink_to_fit()
+    {
+        if (is_inline() || _capacity == _size) {
+            return;
+        }
+        if (_size <= N) {
+            T *old = _ptr;
+            const size_type old_capacity = _capacity;
+            std::memcpy(_inline, old, (_size + 1) * sizeof(T));
+            _ptr = _inline;
+            allocator().deallocate(old, old_capacity + 1);
+        } else {
+            reallocate(_size);
+        }
+    }
+
+    void clear() WALLE_NOEXCEPT
+    {
+        _size = 0;
+        _ptr[0] = T();
+    }
+
+    void resize(size_type n, T c = T())
+    {
+        if (n > _size) {
+            T *p = append_uninitialized(n - _size);
+            std::fill(p, _ptr + n, c);
+        } else {
+            set_size(n);
+        }
+    }
+
+    /**
+     * @brief  resize to n characters, the ones past the old size are left
+     *         unspecified for the caller to overwrite.
+     */
+    void resize_uninitialized(size_type n)
+    {
+        if (n > capacity()) {
+            grow(n);
+        }
+        set_size(n);
+    }
+
+    /**
+     * @brief  grow by n unspecified characters.
+     * @retval the first of them.
+     */
+    T *append_uninitialized(size_type n)
+    {
+        const size_type old_size = _size;
+        resize_uninitialized(old_size + n);
+        return _ptr + old_size;
+    }
+
+    /**
+     * @brief  resize to at most n characters written by op(data(), n),
+     *         which returns the final size (<= n). no character is filled
+     *         before op runs.
+     */
+    template <typename Operation>
+    void resize_and_overwrite(size_type n, Operation op)
+    {
+        reserve(n);
+        const size_type r = static_cast<size_type>(op(_ptr, n));
+        WALLE_ASSERT_MSG(r <= n, "resize_and_overwrite wrote past n");
+        set_size(r);
+    }
+
+    void push_back(T c)
+    {
+        if (WALLE_UNLIKELY(_size == capacity())) {
+            grow(_size + 1);
+        }
+        _ptr[_size] = c;
+        _ptr[++_size] = T();
+    }
+
+    void pop_back()
+    {
+        WALLE_ASSERT_MSG(!empty(), "empty");
+        _ptr[--_size] = T();
+    }
+
+    basic_string &append(const T *s, size_type n)
+    {
+        if (WALLE_LIKELY(n <= capacity() - _size)) {
+            // s may point into this string, but never at the characters
+            // being written.
+            copy(_ptr + _size, s, n);
+            set_size(_size + n);
+            return *this;
+        }
+        return replace_slow(_size, 0, s, n);
+    }
+
+    basic_string &append(view_type v)
+    {
+        return append(v.data(), v.size());
+    }
+
+    basic_string &append(const T *s)
+    {
+        return append(s, wsl::internal::char_strlen(s));
+    }
+
+    basic_string &append(size_type n, T c)
+    {
+        T *p = append_uninitialized(n);
+        std::fill(p, p + n, c);
+        return *this;
+    }
+
+    basic_string &operator+=(view_type v)
+    {
+        return append(v.data(), v.size());
+    }
+
+    basic_string &operator+=(const T *s)
+    {
+        return append(s);
+    }
+
+    basic_string &operator+=(T c)
+    {
+        push_back(c);
+        return *this;
+    }
+
+    basic_string &assign(const T *s, size_type n)
+    {
+        if (n <= capacity()) {
+            move_chars(_ptr, s, n);
+            set_size(n);
+            return *this;
+        }
+        // s can't be part of this string, it is longer than the capacity.
+        T *p = allocate(n);
+        copy(p, s, n);
+        deallocate();
+        _ptr = p;
+        _capacity = n;
+        set_size(n);
+        return *this;
+    }
+
+    basic_string &assign(view_type v)
+    {
+        return assign(v.data(), v.size());
+    }
+
+    /**
+     * @brief  replace count characters at pos (clamped to the end) with s.
+     */
+    basic_string &replace(size_type pos, size_type count, const T *s, size_type n)
+    {
+        WALLE_ASSERT_MSG(pos <= _size, "out of range");
+        count = std::min(count, _size - pos);
+        const size_type new_size = _size - count + n;
+        if (new_size > capacity()) {
+            return replace_slow(pos, count, s, n);
+        }
+        if (WALLE_UNLIKELY(s + n > _ptr && s < _ptr + _size)) {
+            const this_type tmp(s, n);
+            return replace(pos, count, tmp._ptr, n);
+        }
+        move_chars(_ptr + pos + n, _ptr + pos + count, _size - pos - count);
+        copy(_ptr + pos, s, n);
+        set_size(new_size);
+        return *this;
+    }
+
+    basic_string &replace(size_type pos, size_type count, view_type v)
+    {
+        return replace(pos, count, v.data(), v.size());
+    }
+
+    basic_string &insert(size_type pos, view_type v)
+    {
+        return replace(pos, 0, v.data(), v.size());
+    }
+
+    basic_string &insert(size_type pos, size_type n, T c)
+    {
+        WALLE_ASSERT_MSG(pos <= _size, "out of range");
+        const size_type old_size = _size;
+        append_uninitialized(n);
+        move_chars(_ptr + pos + n, _ptr + pos, old_size - pos);
+        std::fill(_ptr + pos, _ptr + pos + n, c);
+        return *this;
+    }
+
+    basic_string &erase(size_type pos = 0, size_type count = npos)
+    {
+        return replace(pos, count, _ptr, 0);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        const size_type pos = static_cast<size_type>(first - _ptr);
+        replace(pos, static_cast<size_type>(last - first), _ptr, 0);
+        return _ptr + pos;
+    }
+
+    basic_string substr(size_type pos = 0, size_type count = npos) const
+    {
+        WALLE_ASSERT_MSG(pos <= _size, "out of range");
+        return basic_string(_ptr + pos, std::min(count, _size - pos), get_allocator());
+    }
+
+    void swap(basic_string &other)
+    {
+        if (this == &other) {
+            return;
+        }
+        this_type tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    int compare(view_type v) const WALLE_NOEXCEPT
+    {
+        const int r = wsl::internal::compare(_ptr, v.data(), std::min(_size, v.size()));
+        if (r != 0) {
+            return r;
+        }
+        return _size < v.size() ? -1 : (_size > v.size() ? 1 : 0);
+    }
+
+    bool starts_with(view_type v) const WALLE_NOEXCEPT
+    {
+        return _size >= v.size() && wsl::internal::compare(_ptr, v.data(), v.size()) == 0;
+    }
+
+    bool ends_with(view_type v) const WALLE_NOEXCEPT
+    {
+        return _size >= v.size() && wsl::internal::compare(_ptr + _size - v.size(), v.data(), v.size()) == 0;
+    }
+
+    size_type find(view_type v, size_type pos = 0) const WALLE_NOEXCEPT
+    {
+        return view().find(v, pos);
+    }
+
+    size_type find(T c, size_type pos = 0) const WALLE_NOEXCEPT
+    {
+        return view().find(c, pos);
+    }
+
+    size_type rfind(view_type v, size_type pos = npos) const WALLE_NOEXCEPT
+    {
+        return view().rfind(v, pos);
+    }
+
+    size_type rfind(T c, size_type pos = npos) const WALLE_NOEXCEPT
+    {
+        return view().rfind(c, pos);
+    }
+
+    size_type find_first_of(view_type v, size_type pos = 0) const WALLE_NOEXCEPT
+    {
+        return view().find_first_of(v, pos);
+    }
+
+    size_type find_last_of(view_type v, size_type pos = npos) const WALLE_NOEXCEPT
+    {
+        return view().find_last_of(v, pos);
+    }
+
+    size_type find_first_not_of(view_type v, size_type pos = 0) const WALLE_NOEXCEPT
+    {
+        return view().find_first_not_of(v, pos);
+    }
+
+    size_type find_last_not_of(view_type v, size_type pos = npos) const WALLE_NOEXCEPT
+    {
+        return view().find_last_not_of(v, pos);
+    }
+
+private:
+    typedef std::integral_constant<bool, wsl::has_reallocate<Allocator>::value> can_reallocate;
+
+    allocator_type &allocator() WALLE_NOEXCEPT
+    {
+        return *this;
+    }
+
+    static void copy(T *to, const T *from, size_type n)
+    {
+        if (n) {
+            std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+        }
+    }
+
+    static void move_chars(T *to, const T *from, size_type n)
+    {
+        if (n) {
+            std::memmove(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+        }
+    }
+
+    // heap blocks carry one more element for the terminator.
+    T *allocate(size_type capacity)
+    {
+        return allocator().allocate(capacity + 1);
+    }
+
+    void deallocate()
+    {
+        if (!is_inline()) {
+            allocator().deallocate(_ptr, _capacity + 1);
+        }
+    }
+
+    void set_size(size_type n) WALLE_NOEXCEPT
+    {
+        _size = n;
+        _ptr[n] = T();
+    }
+
+    void init(const T *s, size_type n)
+    {
+        if (n > N) {
+            _ptr = allocate(n);
+            _capacity = n;
+        }
+        copy(_ptr, s, n);
+        set_size(n);
+    }
+
+    void take(basic_string &other) WALLE_NOEXCEPT
+    {
+        if (other.is_inline()) {
+            copy(_inline, other._inline, other._size + 1);
+        } else {
+            _ptr = other._ptr;
+            _capacity = other._capacity;
+            other._ptr = other._inline;
+        }
+        _size = other._size;
+        other.set_size(0);
+    }
+
+    void grow(size_type required)
+    {
+        reallocate(GrowthPolicy::next_capacity(capacity(), required));
+    }
+
+    T *resize_block(size_type new_capacity, std::true_type)
+    {
+        return allocator().reallocate(_ptr, _capacity + 1, new_capacity + 1);
+    }
+
+    T *resize_block(size_type new_capacity, std::false_type)
+    {
+        T *p = allocate(new_capacity);
+        copy(p, _ptr, _size + 1);
+        allocator().deallocate(_ptr, _capacity + 1);
+        return p;
+    }
+
+    void reallocate(size_type new_capacity)
+    {
+        T *p;
+        if (is_inline()) {
+            p = allocate(new_capacity);
+            copy(p, _inline, _size + 1);
+        } else {
+            p = resize_block(new_capacity, can_reallocate());
+        }
+        _ptr = p;
+        _capacity = new_capacity;
+    }
+
+    // builds the result in a new block, so s may point into this string.
+    basic_string &replace_slow(size_type pos, size_type count, const T *s, size_type n)
+    {
+        const size_type new_size = _size - count + n;
+        const size_type new_capacity = GrowthPolicy::next_capacity(capacity(), new_size);
+        T *p = allocate(new_capacity);
+        copy(p, _ptr, pos);
+        copy(p + pos, s, n);
+        copy(p + pos + n, _ptr + pos + count, _size - pos - count);
+        deallocate();
+        _ptr = p;
+        _capacity = new_capacity;
+        set_size(new_size);
+        return *this;
+    }
+
+private:
+    T           *_ptr;
+    size_type   _size;
+    union {
+        size_type   _capacity;
+        T           _inline[N + 1];
+    };
+};
+
+template <typename T, typename A, size_t N, typename G>
+const WALLE_CONSTEXPR size_t basic_string<T, A, N, G>::npos;
+
+template <typename T, typename A, size_t N, typename G>
+const WALLE_CONSTEXPR size_t basic_string<T, A, N, G>::inline_capacity;
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator==(const basic_string<T, A, N, G> &lhs, const basic_string<T, A, N, G> &rhs)
+{
+    return lhs.size() == rhs.size() && wsl::internal::compare(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator==(const basic_string<T, A, N, G> &lhs, basic_string_view<T> rhs)
+{
+    return lhs.size() == rhs.size() && wsl::internal::compare(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator==(basic_string_view<T> lhs, const basic_string<T, A, N, G> &rhs)
+{
+    return rhs == lhs;
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator==(const basic_string<T, A, N, G> &lhs, const T *rhs)
+{
+    return lhs == basic_string_view<T>(rhs);
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator==(const T *lhs, const basic_string<T, A, N, G> &rhs)
+{
+    return rhs == basic_string_view<T>(lhs);
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator!=(const basic_string<T, A, N, G> &lhs, const basic_string<T, A, N, G> &rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator!=(const basic_string<T, A, N, G> &lhs, basic_string_view<T> rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator!=(basic_string_view<T> lhs, const basic_string<T, A, N, G> &rhs)
+{
+    return !(rhs == lhs);
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator!=(const basic_string<T, A, N, G> &lhs, const T *rhs)
+{
+    return !(lhs == rhs);
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator!=(const T *lhs, const basic_string<T, A, N, G> &rhs)
+{
+    return !(rhs == lhs);
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator<(const basic_string<T, A, N, G> &lhs, const basic_string<T, A, N, G> &rhs)
+{
+    return lhs.compare(rhs) < 0;
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator<=(const basic_string<T, A, N, G> &lhs, const basic_string<T, A, N, G> &rhs)
+{
+    return lhs.compare(rhs) <= 0;
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator>(const basic_string<T, A, N, G> &lhs, const basic_string<T, A, N, G> &rhs)
+{
+    return lhs.compare(rhs) > 0;
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline bool operator>=(const basic_string<T, A, N, G> &lhs, const basic_string<T, A, N, G> &rhs)
+{
+    return lhs.compare(rhs) >= 0;
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline basic_string<T, A, N, G> operator+(const basic_string<T, A, N, G> &lhs, basic_string_view<T> rhs)
+{
+    basic_string<T, A, N, G> r(lhs.get_allocator());
+    r.reserve(lhs.size() + rhs.size());
+    r.append(lhs.data(), lhs.size());
+    r.append(rhs.data(), rhs.size());
+    return r;
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline basic_string<T, A, N, G> operator+(basic_string<T, A, N, G> &&lhs, basic_string_view<T> rhs)
+{
+    lhs.append(rhs.data(), rhs.size());
+    return std::move(lhs);
+}
+
+template <typename T, typename A, size_t N, typename G>
+inline void swap(basic_string<T, A, N, G> &lhs, basic_string<T, A, N, G> &rhs)
+{
+    lhs.swap(rhs);
+}
+
+typedef basic_string<char> string;
+typedef basic_string<char16_t> u16string;
+typedef basic_string<char32_t> u32string;
+
+/**
+ * @brief  same hash as the string's view, so a string keyed table can be
+ *         probed with a view.
+ */
+template <typename T, typename A, size_t N, typename G>
+struct hash<basic_string<T, A, N, G> > : public string_view_hash<T> {
+    using string_view_hash<T>::operator();
+
+    size_t operator()(const basic_string<T, A, N, G> &x) const
+    {
+        return string_view_hash<T>()(x.view());
+    }
+};
+
+}
+#endif //WALLE_WSL_STRING_H_
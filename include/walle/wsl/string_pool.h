@@ -0,0 +1,172 @@
+#ifndef WALLE_WSL_STRING_POOL_H_
+#define WALLE_WSL_STRING_POOL_H_
+#include <walle/config/base.h>
+#include <walle/wsl/string_view.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace wsl {
+
+/**
+ * @brief  interns strings: each distinct string is stored once and gets a
+ *         dense 32 bit symbol and a stable, nul terminated view, so equal
+ *         strings compare by symbol or by view data() pointer.
+ * @note   the characters live in append only arenas and are never moved
+ *         or freed before the pool. the symbols index a segmented array
+ *         that never moves either, and the hash table (open addressing on
+ *         wsl::hash<string_view>, 32 hash bits and the symbol per slot) is
+ *         published with release stores, so find(), view() and intern() of
+ *         a string already in the pool never lock, even with writers
+ *         running. intern() of a new string takes a mutex. tables left
+ *         behind by a growth stay alive until the pool is destroyed, a
+ *         late reader may still be probing them.
+ *         freeze() makes the pool read only: intern() of an unknown string
+ *         then fails instead of locking, every call is lock free.
+ */
+class string_pool {
+public:
+    typedef uint32_t symbol;
+
+    static const WALLE_CONSTEXPR symbol kNoSymbol = symbol(-1);
+
+    struct stats {
+        size_t  symbols;        // distinct strings.
+        size_t  string_bytes;   // their characters, without terminators.
+        size_t  arena_bytes;    // bytes allocated for characters.
+        size_t  table_bytes;    // current table, symbol index and retired tables.
+    };
+
+    /**
+     * @param  arena_size: size of the character blocks, strings longer
+     *         than a quarter of it get a block of their own.
+     */
+    explicit string_pool(size_t arena_size = 64 * 1024);
+
+    ~string_pool();
+
+    WALLE_NON_COPYABLE(string_pool);
+
+    /**
+     * @brief  the symbol of s, adding it when it is new.
+     * @retval kNoSymbol when s is new and the pool is frozen.
+     */
+    symbol intern(string_view s);
+
+    /**
+     * @brief  the pool's copy of s, adding it when it is new.
+     * @retval an empty view with a null data() when s is new and the pool
+     *         is frozen.
+     */
+    string_view intern_view(string_view s)
+    {
+        const symbol id = intern(s);
+        return id == kNoSymbol ? string_view() : view(id);
+    }
+
+    /**
+     * @brief  the symbol of s without adding it.
+     * @retval kNoSymbol when s is not in the pool.
+     */
+    symbol find(string_view s) const
+    {
+        return find(s, hash_of(s));
+    }
+
+    /**
+     * @brief  the string of a symbol, valid as long as the pool.
+     */
+    string_view view(symbol id) const
+    {
+        const entry &e = entry_at(id);
+        return string_view(e.data, e.size);
+    }
+
+    const char *c_str(symbol id) const
+    {
+        return entry_at(id).data;
+    }
+
+    /**
+     * @brief  number of symbols, symbols are [0, size()).
+     */
+    size_t size() const
+    {
+        return _count.load(std::memory_order_acquire);
+    }
+
+    void freeze()
+    {
+        _frozen.store(true, std::memory_order_release);
+    }
+
+    bool frozen() const
+    {
+        return _frozen.load(std::memory_order_acquire);
+    }
+
+    stats get_stats() const;
+
+private:
+    struct entry {
+        const char  *data;
+        size_t      size;
+    };
+
+    // slots hold (hash >> 32) << 32 | (symbol + 1), zero is empty.
+    struct table {
+        size_t                  mask;
+        std::atomic<uint64_t>   *slots;
+    };
+
+    // segment k holds kFirstSegment << k entries.
+    static const WALLE_CONSTEXPR size_t kFirstSegmentShift = 10;
+    static const WALLE_CONSTEXPR size_t kSegments = 32 - kFirstSegmentShift + 1;
+
+    static uint64_t hash_of(string_view s)
+    {
+        return wsl::hash<string_view>()(s);
+    }
+
+    static void locate(symbol id, size_t &segment, size_t &offset)
+    {
+        const uint64_t n = (uint64_t(id) >> kFirstSegmentShift) + 1;
+        segment = 63 - __builtin_clzll(n);
+        offset = size_t(id) - ((size_t(1) << (segment + kFirstSegmentShift)) - (size_t(1) << kFirstSegmentShift));
+    }
+
+    const entry &entry_at(symbol id) const
+    {
+        WALLE_ASSERT_MSG(id < size(), "unknown symbol");
+        size_t segment;
+        size_t offset;
+        locate(id, segment, offset);
+        return _segments[segment].load(std::memory_order_acquire)[offset];
+    }
+
+    symbol find(string_view s, uint64_t h) const;
+    symbol add(string_view s, uint64_t h);
+    const char *store(string_view s);
+    void grow_table();
+    static table *make_table(size_t capacity);
+    static void insert_slot(table *t, uint64_t slot);
+
+    const size_t                        _arena_size;
+    std::atomic<table*>                 _table;
+    std::atomic<entry*>                 _segments[kSegments];
+    std::atomic<size_t>                 _count;
+    std::atomic<bool>                   _frozen;
+    // the rest is only touched under _lock.
+    mutable std::mutex                  _lock;
+    std::vector<table*>                 _retired;
+    std::vector<char*>                  _arenas;
+    char                                *_cursor;
+    size_t                              _left;
+    size_t                              _arena_bytes;
+    size_t                              _string_bytes;
+};
+
+}
+#endif //WALLE_WSL_STRING_POOL_H_
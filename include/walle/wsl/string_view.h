@@ -1,7 +1,9 @@
 #ifndef WALLE_WSL_STRING_VIEW_H_
 #define WALLE_WSL_STRING_VIEW_H_
 #include <walle/config/base.h>
+#include <walle/hash/hash.h>
 #include <walle/wsl/internal/char_traits.h>
+#include <walle/wsl/internal/string_search.h>
 #include <walle/wsl/algorithm.h>
 #include <iterator>
 #include <cassert>
@@ -190,19 +192,27 @@ public:
 
     WALLE_CPP14_CONSTEXPR size_type find(basic_string_view sw, size_type pos = 0) const WALLE_NOEXCEPT
     {
-        auto* pEnd = _begin + _count;
-        if (WALLE_LIKELY(((npos - sw.size()) >= pos) && (pos + sw.size()) <= _count)) {
-            const value_type* const pTemp = std::search(_begin + pos, pEnd, sw.data(), sw.data() + sw.size());
-
-            if ((pTemp != pEnd) || (sw.size() == 0))
-                return (size_type)(pTemp - _begin);
+        if (WALLE_LIKELY(pos <= _count)) {
+            // an empty needle matches at pos, also in a default view whose
+            // null data() the search can't tell from not found.
+            if (sw.size() == 0)
+                return pos;
+            const value_type* const pResult = wsl::internal::string_search(_begin + pos, _count - pos,
+                                                                           sw.data(), sw.size());
+            if (pResult)
+                return (size_type)(pResult - _begin);
         }
         return npos;
     }
 
 	WALLE_CPP14_CONSTEXPR size_type find(T c, size_type pos = 0) const WALLE_NOEXCEPT
     {
-        return find(basic_string_view(&c, 1), pos);
+        if (WALLE_LIKELY(pos < _count)) {
+            const value_type* const pResult = wsl::internal::string_find_char(_begin + pos, _count - pos, c);
+            if (pResult)
+                return (size_type)(pResult - _begin);
+        }
+        return npos;
     }
 
     WALLE_CPP14_CONSTEXPR size_type find(const T* s, size_type pos, size_type count) const
@@ -224,11 +234,10 @@ public:
     {
         if (WALLE_LIKELY(_count))
         {
-            const value_type* const pEnd = _begin + std::min(_count - 1, pos) + 1;
-            const value_type* const pResult = CharTypeStringRFind(pEnd, _begin, c);
+            const value_type* const pResult = wsl::internal::string_rfind_char(_begin, std::min(_count - 1, pos) + 1, c);
 
-            if (pResult != _begin)
-                return (size_type)((pResult - 1) - _begin);
+            if (pResult)
+                return (size_type)(pResult - _begin);
         }
         return npos;
     }
@@ -236,27 +245,25 @@ public:
     WALLE_CPP14_CONSTEXPR size_type rfind(const T* s, size_type pos, size_type n) const
     {
         if (WALLE_LIKELY(n <= _count)) {
-            if (WALLE_LIKELY(n)) {
-                const const_iterator pEnd = _begin + std::min(_count - n, pos) + n;
-                const const_iterator pResult = char_type_string_rsearch(_begin, pEnd, s, s + n);
-
-                if (pResult != pEnd)
-                    return (size_type)(pResult - _begin);
-            } else {
+            // an empty needle matches at min(_count, pos).
+            if (n == 0)
                 return std::min(_count, pos);
-            }
+            const value_type* const pResult = wsl::internal::string_rsearch(_begin, std::min(_count - n, pos) + n, s, n);
+
+            if (pResult)
+                return (size_type)(pResult - _begin);
         }
         return npos;
     }
 
     WALLE_CPP14_CONSTEXPR size_type rfind(const T* s, size_type pos = npos) const
     {
-        return rfind(s, pos, (size_type)char_strlen(s));
+        return rfind(s, pos, (size_type)wsl::internal::char_strlen(s));
     }
 
     WALLE_CPP14_CONSTEXPR size_type find_first_of(basic_string_view sw, size_type pos = 0) const WALLE_NOEXCEPT
     {
-        return find_first_of(sw._begin, pos, _count);
+        return find_first_of(sw._begin, pos, sw._count);
     }
 
 	WALLE_CPP14_CONSTEXPR size_type find_first_of(T c, size_type pos = 0) const WALLE_NOEXCEPT 
@@ -268,11 +275,9 @@ public:
     {
         // If position is >= size, we return npos.
         if (WALLE_LIKELY((pos < _count))) {
-            const value_type* const pBegin = _begin + pos;
-            const value_type* const pEnd = _begin + _count;
-            const const_iterator pResult = char_type_string_find_first_of(pBegin, pEnd, s, s + n);
+            const value_type* const pResult = wsl::internal::string_find_first_of(_begin + pos, _count - pos, s, n);
 
-            if (pResult != pEnd) {
+            if (pResult) {
                 return (size_type)(pResult - _begin);
             }
         }
@@ -281,7 +286,7 @@ public:
 
     WALLE_CPP14_CONSTEXPR size_type find_first_of(const T* s, size_type pos = 0) const
     {
-        return find_first_of(s, pos, (size_type)char_strlen(s));
+        return find_first_of(s, pos, (size_type)wsl::internal::char_strlen(s));
     }
 
     WALLE_CPP14_CONSTEXPR size_type find_last_of(basic_string_view sw, size_type pos = npos) const WALLE_NOEXCEPT
@@ -299,7 +304,7 @@ public:
         // If n is zero or position is >= size, we return npos.
         if (WALLE_LIKELY(_count)) {
             const value_type* const pEnd = _begin + std::min(_count - 1, pos) + 1;
-            const value_type* const pResult = CharTypeStringRFindFirstOf(pEnd, _begin, s, s + n);
+            const value_type* const pResult = wsl::internal::char_type_string_rfind_first_of(pEnd, _begin, s, s + n);
 
             if (pResult != _begin)
                 return (size_type)((pResult - 1) - _begin);
@@ -309,7 +314,7 @@ public:
 
     WALLE_CPP14_CONSTEXPR size_type find_last_of(const T* s, size_type pos = npos) const
     {
-        return find_last_of(s, pos, (size_type)char_strlen(s));
+        return find_last_of(s, pos, (size_type)wsl::internal::char_strlen(s));
     }
 
     WALLE_CPP14_CONSTEXPR size_type find_first_not_of(basic_string_view sw, size_type pos = 0) const WALLE_NOEXCEPT
@@ -319,25 +324,15 @@ public:
 
     WALLE_CPP14_CONSTEXPR size_type find_first_not_of(T c, size_type pos = 0) const WALLE_NOEXCEPT
     {
-        if (WALLE_LIKELY(pos <= _count)) {
-            const auto pEnd = _begin + _count;
-            // Todo: Possibly make a specialized version of CharTypeStringFindFirstNotOf(pBegin, pEnd, c).
-            const const_iterator pResult = char_type_string_find_first_not_of(_begin + pos, pEnd, &c, &c + 1);
-
-            if (pResult != pEnd) {
-                return (size_type)(pResult - _begin);
-            }
-        }
-        return npos;
+        return find_first_not_of(&c, pos, 1);
     }
 
     WALLE_CPP14_CONSTEXPR size_type find_first_not_of(const T* s, size_type pos, size_type n) const
     {
-        if (WALLE_LIKELY(pos <= _count)) {
-            const auto pEnd = _begin + _count;
-            const const_iterator pResult = char_type_string_findFirst_not_of(_begin + pos, pEnd, s, s + n);
+        if (WALLE_LIKELY(pos < _count)) {
+            const value_type* const pResult = wsl::internal::string_find_first_not_of(_begin + pos, _count - pos, s, n);
 
-            if (pResult != pEnd)
+            if (pResult)
                 return (size_type)(pResult - _begin);
         }
         return npos;
@@ -345,7 +340,7 @@ public:
 
 	WALLE_CPP14_CONSTEXPR size_type find_first_not_of(const T* s, size_type pos = 0) const
     {
-        return find_first_not_of(s, pos, (size_type)CharStrlen(s));
+        return find_first_not_of(s, pos, (size_type)wsl::internal::char_strlen(s));
     }
 
     WALLE_CPP14_CONSTEXPR size_type find_last_not_of(basic_string_view sw, size_type pos = npos) const WALLE_NOEXCEPT
@@ -358,7 +353,7 @@ public:
         if (WALLE_LIKELY(_count)) {
             // Todo: Possibly make a specialized version of CharTypeStringRFindFirstNotOf(pBegin, pEnd, c).
             const value_type* const pEnd = _begin + std::min(_count - 1, pos) + 1;
-            const value_type* const pResult = char_type_string_rfind_first_not_of(pEnd, _begin, &c, &c + 1);
+            const value_type* const pResult = wsl::internal::char_type_string_rfind_first_not_of(pEnd, _begin, &c, &c + 1);
 
             if (pResult != _begin)
                 return (size_type)((pResult - 1) - _begin);
@@ -371,7 +366,7 @@ public:
         if (WALLE_LIKELY(_count))
         {
             const value_type* const pEnd = _begin + std::min(_count - 1, pos) + 1;
-            const value_type* const pResult = char_type_string_rfind_first_not_of(pEnd, _begin, s, s + n);
+            const value_type* const pResult = wsl::internal::char_type_string_rfind_first_not_of(pEnd, _begin, s, s + n);
 
             if (pResult != _begin)
                 return (size_type)((pResult - 1) - _begin);
@@ -381,7 +376,7 @@ public:
 
     WALLE_CPP14_CONSTEXPR size_type find_last_not_of(const T* s, size_type pos = npos) const
     {
-        return find_last_not_of(s, pos, (size_type)char_strlen(s));
+        return find_last_not_of(s, pos, (size_type)wsl::internal::char_strlen(s));
     }
 };
 
@@ -412,7 +407,7 @@ public:
         WALLE_ASSERT_MSG(_begin[_count] == '\0', "not \0 terminal");
     }
 
-    const_pointer* c_str() const
+    const_pointer c_str() const
     {
         return supper_type::_begin;
     }
@@ -478,7 +473,7 @@ public:
     using supper_type::find_first_of;
     WALLE_CPP14_CONSTEXPR size_type find_first_of(basic_cstring_view sw, size_type pos = 0) const WALLE_NOEXCEPT
     {
-        return find_first_of(sw._begin, pos, _count);
+        return find_first_of(sw._begin, pos, sw._count);
     }
 
     using supper_type::find_last_of;
@@ -504,6 +499,28 @@ public:
     
 };
 
+/**
+ * @brief  lexicographical comparison ignoring ascii case, a shorter view
+ *         orders before a longer one it is a prefix of.
+ */
+template <class CharT>
+inline int compare_i(basic_string_view<CharT> lhs, basic_string_view<CharT> rhs)
+{
+    const int r = wsl::internal::compare_i(lhs.data(), rhs.data(), std::min(lhs.size(), rhs.size()));
+    if (r != 0)
+        return r;
+    return lhs.size() < rhs.size() ? -1 : (lhs.size() > rhs.size() ? 1 : 0);
+}
+
+/**
+ * @brief  equality ignoring ascii case, e.g. for http header names.
+ */
+template <class CharT>
+inline bool equals_i(basic_string_view<CharT> lhs, basic_string_view<CharT> rhs)
+{
+    return lhs.size() == rhs.size() && wsl::internal::equals_i(lhs.data(), rhs.data(), lhs.size());
+}
+
 template <class CharT>
 inline WALLE_CPP14_CONSTEXPR bool operator==(basic_string_view<CharT> lhs, basic_string_view<CharT> rhs)
 {
@@ -590,50 +607,79 @@ typedef basic_cstring_view<char16_t> u16cstring_view;
 typedef basic_cstring_view<char32_t> u32cstring_view;
 
 template <typename T> struct hash;
-template<> struct hash<string_view> {
-    size_t operator()(const string_view& x) const
+
+/**
+ * @brief  hashes every character of the view with walle::hash64.
+ * @note   transparent: views, std strings and c strings of the same
+ *         characters hash alike, so string keyed tables can be probed
+ *         without building a key.
+ */
+template <typename T>
+struct string_view_hash {
+    typedef void is_transparent;
+
+    size_t operator()(const basic_string_view<T>& x) const
     {
-        const unsigned char* p = (const unsigned char*)x.data(); // To consider: limit p to at most 256 chars.
-        unsigned int c, result = 2166136261U; // We implement an FNV-like string hash. 
-        while((c = *p++) != 0) // Using '!=' disables compiler warnings.
-            result = (result * 16777619) ^ c;
-        return (size_t)result;
+        return (size_t)walle::hash64(x.data(), x.size() * sizeof(T));
     }
-};
 
-template<> struct hash<u16string_view> {
-    size_t operator()(const u16string_view& x) const
+    size_t operator()(const std::basic_string<T>& x) const
     {
-        const char16_t* p = x.data();
-        unsigned int c, result = 2166136261U;
-        while((c = *p++) != 0)
-            result = (result * 16777619) ^ c;
-        return (size_t)result;
+        return (size_t)walle::hash64(x.data(), x.size() * sizeof(T));
+    }
+
+    size_t operator()(const T* x) const
+    {
+        return (size_t)walle::hash64(x, wsl::internal::char_strlen(x) * sizeof(T));
     }
 };
 
-template<> struct hash<u32string_view> {
-    size_t operator()(const u32string_view& x) const
+/**
+ * @brief  integers and pointers through walle::hash_int, every bit of the
+ *         result depends on every bit of the key.
+ */
+template <typename T>
+struct integral_hash {
+    size_t operator()(T x) const
     {
-        const char32_t* p = x.data();
-        unsigned int c, result = 2166136261U;
-        while((c = (unsigned int)*p++) != 0)
-            result = (result * 16777619) ^ c;
-        return (size_t)result;
+        return (size_t)walle::hash_int((uint64_t)x);
+    }
+};
+
+template<> struct hash<string_view> : public string_view_hash<char> { };
+template<> struct hash<u16string_view> : public string_view_hash<char16_t> { };
+template<> struct hash<u32string_view> : public string_view_hash<char32_t> { };
+template<> struct hash<cstring_view> : public string_view_hash<char> { };
+template<> struct hash<u16cstring_view> : public string_view_hash<char16_t> { };
+template<> struct hash<u32cstring_view> : public string_view_hash<char32_t> { };
+template<typename T> struct hash<std::basic_string<T> > : public string_view_hash<T> { };
+
+template<> struct hash<bool> : public integral_hash<bool> { };
+template<> struct hash<char> : public integral_hash<char> { };
+template<> struct hash<signed char> : public integral_hash<signed char> { };
+template<> struct hash<unsigned char> : public integral_hash<unsigned char> { };
+template<> struct hash<char16_t> : public integral_hash<char16_t> { };
+template<> struct hash<char32_t> : public integral_hash<char32_t> { };
+template<> struct hash<wchar_t> : public integral_hash<wchar_t> { };
+template<> struct hash<short> : public integral_hash<short> { };
+template<> struct hash<unsigned short> : public integral_hash<unsigned short> { };
+template<> struct hash<int> : public integral_hash<int> { };
+template<> struct hash<unsigned int> : public integral_hash<unsigned int> { };
+template<> struct hash<long> : public integral_hash<long> { };
+template<> struct hash<unsigned long> : public integral_hash<unsigned long> { };
+template<> struct hash<long long> : public integral_hash<long long> { };
+template<> struct hash<unsigned long long> : public integral_hash<unsigned long long> { };
+
+template<typename T>
+struct hash<T*> {
+    size_t operator()(T* x) const
+    {
+        return (size_t)walle::hash_int((uint64_t)(uintptr_t)x);
     }
 };
 
 #if defined(WALLE_WCHAR_UNIQUE) && WALLE_WCHAR_UNIQUE
-    template<> struct hash<wstring_view> {
-        size_t operator()(const wstring_view& x) const
-        {
-            const wchar_t* p = x.data();
-            unsigned int c, result = 2166136261U;
-            while((c = (unsigned int)*p++) != 0)
-                result = (result * 16777619) ^ c;
-            return (size_t)result;
-        }
-    };
+    template<> struct hash<wstring_view> : public string_view_hash<wchar_t> { };
 #endif //defined(WALLE_WCHAR_UNIQUE) && WALLE_WCHAR_UNIQUE
 
 }
@@ -1,6 +1,7 @@
 #ifndef WALLE_WSL_TYPE_TRAITS_H_
 #define WALLE_WSL_TYPE_TRAITS_H_
 #include <walle/config/base.h>
+#include <array>
 #include <type_traits>
 #include <utility>
 
@@ -0,0 +1,122 @@
+#include <walle/hash/hash.h>
+
+namespace walle {
+
+namespace hash_detail {
+
+uint64_t hash_long(const unsigned char *p, size_t len, uint64_t seed)
+{
+    size_t i = len;
+    if (WALLE_UNLIKELY(i > 48)) {
+        uint64_t see1 = seed;
+        uint64_t see2 = seed;
+        do {
+            seed = mix(read8(p) ^ kSecret1, read8(p + 8) ^ seed);
+            see1 = mix(read8(p + 16) ^ kSecret2, read8(p + 24) ^ see1);
+            see2 = mix(read8(p + 32) ^ kSecret3, read8(p + 40) ^ see2);
+            p += 48;
+            i -= 48;
+        } while (WALLE_LIKELY(i > 48));
+        seed ^= see1 ^ see2;
+    }
+    while (WALLE_UNLIKELY(i > 16)) {
+        seed = mix(read8(p) ^ kSecret1, read8(p + 8) ^ seed);
+        i -= 16;
+        p += 16;
+    }
+    // the last 16 bytes, overlapping already hashed ones for short tails.
+    return finish(read8(p + i - 16), read8(p + i - 8), seed, len);
+}
+
+}
+
+hasher::hasher(uint64_t seed)
+{
+    reset(seed);
+}
+
+void hasher::reset(uint64_t seed)
+{
+    _seed = hash_detail::seed_state(seed);
+    _see1 = _seed;
+    _see2 = _seed;
+    _length = 0;
+    _buffered = 0;
+    _bulk = false;
+}
+
+void hasher::consume(const unsigned char *block)
+{
+    using namespace hash_detail;
+    _seed = mix(read8(block) ^ kSecret1, read8(block + 8) ^ _seed);
+    _see1 = mix(read8(block + 16) ^ kSecret2, read8(block + 24) ^ _see1);
+    _see2 = mix(read8(block + 32) ^ kSecret3, read8(block + 40) ^ _see2);
+    _bulk = true;
+}
+
+void hasher::update(const void *data, size_t len)
+{
+    const unsigned char *p = static_cast<const unsigned char*>(data);
+    _length += len;
+    unsigned char *pending = _buffer + kHistorySize;
+    if (_buffered) {
+        const size_t take = len < kBlockSize - _buffered ? len : kBlockSize - _buffered;
+        std::memcpy(pending + _buffered, p, take);
+        _buffered += take;
+        p += take;
+        len -= take;
+        // a full block is only hashed once input follows it, the last block
+        // belongs to the tail handling of digest().
+        if (len == 0) {
+            return;
+        }
+        consume(pending);
+        std::memcpy(_buffer, pending + kBlockSize - kHistorySize, kHistorySize);
+        _buffered = 0;
+    }
+    if (len > kBlockSize) {
+        do {
+            consume(p);
+            p += kBlockSize;
+            len -= kBlockSize;
+        } while (len > kBlockSize);
+        std::memcpy(_buffer, p - kHistorySize, kHistorySize);
+    }
+    std::memcpy(pending, p, len);
+    _buffered = len;
+}
+
+uint64_t hasher::digest() const
+{
+    using namespace hash_detail;
+    const unsigned char *p = _buffer + kHistorySize;
+    if (_length <= 16) {
+        // nothing was consumed, the whole key is pending.
+        uint64_t a, b;
+        const size_t len = static_cast<size_t>(_length);
+        if (len >= 4) {
+            const size_t step = (len >> 3) << 2;
+            a = (read4(p) << 32) | read4(p + step);
+            b = (read4(p + len - 4) << 32) | read4(p + len - 4 - step);
+        } else if (len > 0) {
+            a = read3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+        return finish(a, b, _seed, _length);
+    }
+    uint64_t seed = _seed;
+    if (_bulk) {
+        seed ^= _see1 ^ _see2;
+    }
+    size_t i = _buffered;
+    while (i > 16) {
+        seed = mix(read8(p) ^ kSecret1, read8(p + 8) ^ seed);
+        i -= 16;
+        p += 16;
+    }
+    return finish(read8(p + i - 16), read8(p + i - 8), seed, _length);
+}
+
+}
@@ -0,0 +1,242 @@
+#include <walle/timer/timer_wheel.h>
+#include <walle/math/ffs.h>
+#include <limits>
+
+namespace walle {
+
+timer_wheel::timer_wheel(uint64_t resolution, uint64_t now, unsigned levels, unsigned slot_bits)
+: _resolution(resolution),
+  _now(now),
+  _tick(0),
+  _levels(levels),
+  _slot_bits(slot_bits),
+  _slot_mask((uint64_t(1) << slot_bits) - 1),
+  _words_per_level(slot_bits > 6 ? (size_t(1) << (slot_bits - 6)) : 1),
+  _count(0),
+  _slots(size_t(levels) << slot_bits),
+  _bitmap(size_t(levels) * _words_per_level, 0)
+{
+    WALLE_ASSERT_MSG(resolution > 0, "timer_wheel resolution must be > 0");
+    WALLE_ASSERT_MSG(levels > 0, "timer_wheel needs at least one level");
+    WALLE_ASSERT_MSG(slot_bits > 0 && slot_bits <= kMaxSlotBits, "timer_wheel slot_bits out of range");
+    _tick = to_tick(now);
+}
+
+timer_wheel::~timer_wheel()
+{
+    for (size_t i = 0; i < _slots.size(); ++i) {
+        list_type &slot = _slots[i];
+        while (!slot.empty()) {
+            timer_entry *t = static_cast<timer_entry*>(slot.next);
+            t->unlink();
+            t->_wheel = WALLE_NULL;
+        }
+    }
+}
+
+uint64_t timer_wheel::range() const
+{
+    const unsigned bits = _levels * _slot_bits;
+    if (bits >= 64) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    const uint64_t ticks = uint64_t(1) << bits;
+    if (ticks > std::numeric_limits<uint64_t>::max() / _resolution) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    return ticks * _resolution;
+}
+
+void timer_wheel::schedule(timer_entry &t, uint64_t deadline)
+{
+    if (t._wheel) {
+        t._wheel->unlink(t);
+    }
+    uint64_t expires = to_tick_ceil(deadline);
+    if (expires <= _tick) {
+        expires = _tick + 1;
+    }
+    t._deadline = deadline;
+    t._expires = expires;
+    t._wheel = this;
+    ++_count;
+    link(t);
+}
+
+bool timer_wheel::cancel(timer_entry &t)
+{
+    if (t._wheel != this) {
+        return false;
+    }
+    unlink(t);
+    return true;
+}
+
+void timer_wheel::link(timer_entry &t)
+{
+    const uint64_t delta = t._expires - _tick;
+    unsigned level = 0;
+    uint64_t expires = t._expires;
+    for (;;) {
+        const unsigned shift = (level + 1) * _slot_bits;
+        if (shift >= 64 || delta < (uint64_t(1) << shift)) {
+            break;
+        }
+        if (level + 1 == _levels) {
+            // beyond the wheel range: park in the top level slot that is
+            // cascaded last, the entry is re-linked from there.
+            expires = _tick + (uint64_t(1) << shift) - 1;
+            break;
+        }
+        ++level;
+    }
+    const uint32_t slot = slot_index(level, expires);
+    _slots[slot].link_back(&t);
+    t._slot = slot;
+    mark(slot);
+}
+
+void timer_wheel::unlink(timer_entry &t)
+{
+    t.unlink();
+    if (_slots[t._slot].empty()) {
+        clear(t._slot);
+    }
+    t._wheel = WALLE_NULL;
+    --_count;
+}
+
+void timer_wheel::mark(uint32_t slot)
+{
+    const size_t level = slot >> _slot_bits;
+    const size_t index = slot & _slot_mask;
+    _bitmap[level * _words_per_level + (index >> 6)] |= uint64_t(1) << (index & 63);
+}
+
+void timer_wheel::clear(uint32_t slot)
+{
+    const size_t level = slot >> _slot_bits;
+    const size_t index = slot & _slot_mask;
+    _bitmap[level * _words_per_level + (index >> 6)] &= ~(uint64_t(1) << (index & 63));
+}
+
+void timer_wheel::cascade(unsigned level)
+{
+    if (level >= _levels || level * _slot_bits >= 64) {
+        return;
+    }
+    const uint32_t slot = slot_index(level, _tick);
+    if ((slot & _slot_mask) == 0) {
+        cascade(level + 1);
+    }
+    list_type &head = _slots[slot];
+    if (head.empty()) {
+        return;
+    }
+    list_type pending;
+    pending.splice_back(head);
+    clear(slot);
+    while (!pending.empty()) {
+        timer_entry *t = static_cast<timer_entry*>(pending.next);
+        t->unlink();
+        link(*t);
+    }
+}
+
+size_t timer_wheel::expire(uint32_t slot)
+{
+    list_type &head = _slots[slot];
+    if (head.empty()) {
+        return 0;
+    }
+    list_type pending;
+    pending.splice_back(head);
+    clear(slot);
+    size_t fired = 0;
+    while (!pending.empty()) {
+        timer_entry *t = static_cast<timer_entry*>(pending.next);
+        t->unlink();
+        if (t->_expires > _tick) {
+            // parked beyond the range of a single level wheel.
+            link(*t);
+            continue;
+        }
+        t->_wheel = WALLE_NULL;
+        --_count;
+        ++fired;
+        if (t->_callback) {
+            t->_callback(*t);
+        }
+    }
+    return fired;
+}
+
+uint64_t timer_wheel::next_tick(uint64_t limit) const
+{
+    // the lowest level holding timers decides: the next of its slots in
+    // this turn of the level, else the level's wrap. the levels below are
+    // empty, nothing happens at the ticks in between, so a long jump with
+    // only far timers doesn't step through every level 0 wrap.
+    for (unsigned level = 0; level < _levels; ++level) {
+        const unsigned shift = level * _slot_bits;
+        if (shift >= 64) {
+            break;
+        }
+        const uint64_t *bitmap = &_bitmap[level * _words_per_level];
+        size_t used = 0;
+        while (used < _words_per_level && bitmap[used] == 0) {
+            ++used;
+        }
+        if (used == _words_per_level) {
+            continue;
+        }
+        const unsigned span = shift + _slot_bits;
+        if (span >= 64) {
+            return limit;
+        }
+        const uint64_t base = _tick & ~((uint64_t(1) << span) - 1);
+        uint64_t next = base + (uint64_t(1) << span);
+        const uint64_t start = ((_tick >> shift) & _slot_mask) + 1;
+        if (start <= _slot_mask) {
+            size_t word = start >> 6;
+            uint64_t bits = bitmap[word] & (~uint64_t(0) << (start & 63));
+            for (;;) {
+                if (bits) {
+                    const uint64_t index = (word << 6) + math::ffs(static_cast<unsigned long long>(bits)) - 1;
+                    next = base + (index << shift);
+                    break;
+                }
+                if (++word == _words_per_level) {
+                    break;
+                }
+                bits = bitmap[word];
+            }
+        }
+        return next < limit ? next : limit;
+    }
+    return limit;
+}
+
+size_t timer_wheel::advance(uint64_t now)
+{
+    if (now < _now) {
+        return 0;
+    }
+    _now = now;
+    const uint64_t target = to_tick(now);
+    size_t fired = 0;
+    while (_tick < target) {
+        if (_count == 0) {
+            _tick = target;
+            break;
+        }
+        _tick = next_tick(target);
+        if ((_tick & _slot_mask) == 0) {
+            cascade(1);
+        }
+        fired += expire(slot_index(0, _tick));
+    }
+    return fired;
+}
+
+} //namespace walle
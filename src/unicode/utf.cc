@@ -0,0 +1,1077 @@
+#include <walle/unicode/utf.h>
+#include <atomic>
+#include <cstring>
+#include <immintrin.h>
+
+namespace walle {
+
+namespace {
+
+using wsl::internal::simd_isa;
+using wsl::internal::kSimdSse2;
+using wsl::internal::kSimdAvx2;
+
+inline uint32_t popcount(uint32_t v)
+{
+    return static_cast<uint32_t>(__builtin_popcount(v));
+}
+
+inline uint64_t load8(const unsigned char *p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline bool is_surrogate(uint32_t c)
+{
+    return (c & 0xfffff800u) == 0xd800u;
+}
+
+// scalar code point at a time pieces, shared by every path.
+
+// decodes the sequence at p[pos], pos < n. returns its size, 0 on error.
+inline size_t decode_utf8(const unsigned char *p, size_t n, size_t pos, uint32_t &cp, utf_error &error)
+{
+    const uint32_t b = p[pos];
+    size_t len;
+    uint32_t min;
+    if (b < 0x80) {
+        cp = b;
+        return 1;
+    } else if ((b & 0xe0) == 0xc0) {
+        len = 2;
+        cp = b & 0x1f;
+        min = 0x80;
+    } else if ((b & 0xf0) == 0xe0) {
+        len = 3;
+        cp = b & 0x0f;
+        min = 0x800;
+    } else if ((b & 0xf8) == 0xf0) {
+        len = 4;
+        cp = b & 0x07;
+        min = 0x10000;
+    } else {
+        error = (b & 0xc0) == 0x80 ? kUtfTooLong : kUtfHeaderBits;
+        return 0;
+    }
+    if (n - pos < len) {
+        error = kUtfTooShort;
+        return 0;
+    }
+    for (size_t i = 1; i < len; ++i) {
+        const uint32_t c = p[pos + i];
+        if ((c & 0xc0) != 0x80) {
+            error = kUtfTooShort;
+            return 0;
+        }
+        cp = (cp << 6) | (c & 0x3f);
+    }
+    if (cp < min) {
+        error = kUtfOverlong;
+        return 0;
+    }
+    if (cp > 0x10ffff) {
+        error = kUtfTooLarge;
+        return 0;
+    }
+    if (is_surrogate(cp)) {
+        error = kUtfSurrogate;
+        return 0;
+    }
+    return len;
+}
+
+// decodes the unit(s) at p[pos], pos < n. returns 1 or 2, 0 for an
+// unpaired surrogate.
+inline size_t decode_utf16(const char16_t *p, size_t n, size_t pos, uint32_t &cp)
+{
+    const uint32_t u = p[pos];
+    if (!is_surrogate(u)) {
+        cp = u;
+        return 1;
+    }
+    if (u >= 0xdc00 || pos + 1 == n) {
+        return 0;
+    }
+    const uint32_t l = p[pos + 1];
+    if ((l & 0xfc00) != 0xdc00) {
+        return 0;
+    }
+    cp = 0x10000 + ((u - 0xd800) << 10) + (l - 0xdc00);
+    return 2;
+}
+
+inline utf_error check_utf32(uint32_t c)
+{
+    if (c > 0x10ffff) {
+        return kUtfTooLarge;
+    }
+    return is_surrogate(c) ? kUtfSurrogate : kUtfOk;
+}
+
+inline char *encode_utf8(uint32_t cp, char *out)
+{
+    if (cp < 0x80) {
+        *out++ = static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        *out++ = static_cast<char>(0xc0 | (cp >> 6));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+    } else if (cp < 0x10000) {
+        *out++ = static_cast<char>(0xe0 | (cp >> 12));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+    } else {
+        *out++ = static_cast<char>(0xf0 | (cp >> 18));
+        *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    return out;
+}
+
+inline char16_t *encode_utf16(uint32_t cp, char16_t *out)
+{
+    if (cp < 0x10000) {
+        *out++ = static_cast<char16_t>(cp);
+    } else {
+        cp -= 0x10000;
+        *out++ = static_cast<char16_t>(0xd800 + (cp >> 10));
+        *out++ = static_cast<char16_t>(0xdc00 + (cp & 0x3ff));
+    }
+    return out;
+}
+
+utf_result validate_utf8_scalar(const unsigned char *p, size_t n, size_t pos)
+{
+    while (pos < n) {
+        if (n - pos >= 8 && (load8(p + pos) & 0x8080808080808080ull) == 0) {
+            pos += 8;
+            continue;
+        }
+        uint32_t cp;
+        utf_error error = kUtfOk;
+        const size_t len = decode_utf8(p, n, pos, cp, error);
+        if (!len) {
+            return utf_result(error, pos);
+        }
+        pos += len;
+    }
+    return utf_result(kUtfOk, n);
+}
+
+// utf-8 validation by table lookups, see utf.h. the lookups give an error
+// bit set for each invalid (previous byte, byte) pattern:
+const uint8_t kTooShort = 1 << 0;       // 11______ 0_______ or 11______ 11______
+const uint8_t kTooLong = 1 << 1;        // 0_______ 10______
+const uint8_t kOverlong3 = 1 << 2;      // 11100000 100_____
+const uint8_t kTooLarge = 1 << 3;       // 11110100 1001____ and above
+const uint8_t kSurrogate = 1 << 4;      // 11101101 101_____
+const uint8_t kOverlong2 = 1 << 5;      // 1100000_ 10______
+const uint8_t kTooLarge1000 = 1 << 6;   // 11110101 1000____ and above
+const uint8_t kOverlong4 = 1 << 6;      // 11110000 1000____
+const uint8_t kTwoConts = 1 << 7;       // 10______ 10______
+const uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+// indexed by the high nibble of the previous byte.
+const uint8_t kByte1High[16] = {
+    kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+    kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+    kTooShort | kOverlong2,
+    kTooShort,
+    kTooShort | kOverlong3 | kSurrogate,
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4
+};
+
+// indexed by the low nibble of the previous byte.
+const uint8_t kByte1Low[16] = {
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+    kCarry | kOverlong2,
+    kCarry,
+    kCarry,
+    kCarry | kTooLarge,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000
+};
+
+// indexed by the high nibble of the byte.
+const uint8_t kByte2High[16] = {
+    kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooShort, kTooShort, kTooShort, kTooShort
+};
+
+// bytes of a block's last three positions that start a sequence the block
+// does not finish. subtracted with saturation, they leave a non zero byte.
+const uint8_t kIncomplete[32] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1
+};
+
+// the kernels return the offset of the 64 byte block where an error was
+// found, n when the input is valid.
+
+WALLE_TARGET_SSSE3 inline __m128i nibble_lookup_ssse3(const uint8_t *table, __m128i index)
+{
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)), index);
+}
+
+struct utf8_checker_ssse3 {
+    __m128i error;
+    __m128i prev_input;
+    __m128i prev_incomplete;
+
+    WALLE_TARGET_SSSE3 utf8_checker_ssse3()
+    : error(_mm_setzero_si128()),
+      prev_input(_mm_setzero_si128()),
+      prev_incomplete(_mm_setzero_si128())
+    {
+
+    }
+
+    WALLE_TARGET_SSSE3 void check_block(__m128i input)
+    {
+        const __m128i nibble = _mm_set1_epi8(0x0f);
+        const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 16 - 1);
+        const __m128i special = _mm_and_si128(
+            _mm_and_si128(nibble_lookup_ssse3(kByte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                          nibble_lookup_ssse3(kByte1Low, _mm_and_si128(prev1, nibble))),
+            nibble_lookup_ssse3(kByte2High, _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+        // third and fourth bytes of a sequence must be continuations, the
+        // only case where two continuations in a row are fine.
+        const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 16 - 2);
+        const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 16 - 3);
+        const __m128i is_third = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xe0 - 0x80)));
+        const __m128i is_fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xf0 - 0x80)));
+        const __m128i must23 = _mm_and_si128(_mm_or_si128(is_third, is_fourth),
+                                             _mm_set1_epi8(static_cast<char>(0x80)));
+        error = _mm_or_si128(error, _mm_xor_si128(must23, special));
+        prev_incomplete = _mm_subs_epu8(input, _mm_loadu_si128(reinterpret_cast<const __m128i*>(kIncomplete + 16)));
+        prev_input = input;
+    }
+
+    WALLE_TARGET_SSSE3 bool check_chunk(const char *p)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48));
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) == 0) {
+            error = _mm_or_si128(error, prev_incomplete);
+        } else {
+            check_block(a);
+            check_block(b);
+            check_block(c);
+            check_block(d);
+        }
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xffff;
+    }
+};
+
+WALLE_TARGET_SSSE3 size_t validate_utf8_ssse3(const char *p, size_t n)
+{
+    utf8_checker_ssse3 checker;
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        if (!checker.check_chunk(p + i)) {
+            return i;
+        }
+    }
+    if (i < n) {
+        // zero padding, a sequence cut by the end is followed by ascii.
+        char tmp[64];
+        std::memset(tmp, 0, sizeof(tmp));
+        std::memcpy(tmp, p + i, n - i);
+        return checker.check_chunk(tmp) ? n : i;
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(checker.prev_incomplete, _mm_setzero_si128())) != 0xffff) {
+        return n - 64;
+    }
+    return n;
+}
+
+WALLE_TARGET_AVX2 inline __m256i nibble_lookup_avx2(const uint8_t *table, __m256i index)
+{
+    return _mm256_shuffle_epi8(
+        _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table))), index);
+}
+
+// the bytes of input shifted right by k positions, prev's last bytes
+// shifted in.
+template <int K>
+WALLE_TARGET_AVX2 inline __m256i prev_bytes(__m256i input, __m256i prev)
+{
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21), 16 - K);
+}
+
+struct utf8_checker_avx2 {
+    __m256i error;
+    __m256i prev_input;
+    __m256i prev_incomplete;
+
+    WALLE_TARGET_AVX2 utf8_checker_avx2()
+    : error(_mm256_setzero_si256()),
+      prev_input(_mm256_setzero_si256()),
+      prev_incomplete(_mm256_setzero_si256())
+    {
+
+    }
+
+    WALLE_TARGET_AVX2 void check_block(__m256i input)
+    {
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+        const __m256i prev1 = prev_bytes<1>(input, prev_input);
+        const __m256i special = _mm256_and_si256(
+            _mm256_and_si256(nibble_lookup_avx2(kByte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                             nibble_lookup_avx2(kByte1Low, _mm256_and_si256(prev1, nibble))),
+            nibble_lookup_avx2(kByte2High, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+        const __m256i is_third = _mm256_subs_epu8(prev_bytes<2>(input, prev_input),
+                                                  _mm256_set1_epi8(static_cast<char>(0xe0 - 0x80)));
+        const __m256i is_fourth = _mm256_subs_epu8(prev_bytes<3>(input, prev_input),
+                                                   _mm256_set1_epi8(static_cast<char>(0xf0 - 0x80)));
+        const __m256i must23 = _mm256_and_si256(_mm256_or_si256(is_third, is_fourth),
+                                                _mm256_set1_epi8(static_cast<char>(0x80)));
+        error = _mm256_or_si256(error, _mm256_xor_si256(must23, special));
+        prev_incomplete = _mm256_subs_epu8(input, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kIncomplete)));
+        prev_input = input;
+    }
+
+    WALLE_TARGET_AVX2 bool check_chunk(const char *p)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+        if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0) {
+            error = _mm256_or_si256(error, prev_incomplete);
+        } else {
+            check_block(a);
+            check_block(b);
+        }
+        return _mm256_testz_si256(error, error);
+    }
+};
+
+WALLE_TARGET_AVX2 size_t validate_utf8_avx2(const char *p, size_t n)
+{
+    utf8_checker_avx2 checker;
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        if (!checker.check_chunk(p + i)) {
+            return i;
+        }
+    }
+    if (i < n) {
+        char tmp[64];
+        std::memset(tmp, 0, sizeof(tmp));
+        std::memcpy(tmp, p + i, n - i);
+        return checker.check_chunk(tmp) ? n : i;
+    }
+    if (!_mm256_testz_si256(checker.prev_incomplete, checker.prev_incomplete)) {
+        return n - 64;
+    }
+    return n;
+}
+
+size_t validate_utf8_sse2(const char *p, size_t n)
+{
+    if (wsl::internal::cpu_has_ssse3()) {
+        return validate_utf8_ssse3(p, n);
+    }
+    const utf_result r = validate_utf8_scalar(reinterpret_cast<const unsigned char*>(p), n, 0);
+    return r.ok() ? n : r.count;
+}
+
+struct utf_kernels {
+    simd_isa    isa;
+    size_t    (*validate_utf8)(const char *, size_t);
+};
+
+const utf_kernels kSse2Kernels = { kSimdSse2, validate_utf8_sse2 };
+const utf_kernels kAvx2Kernels = { kSimdAvx2, validate_utf8_avx2 };
+
+std::atomic<const utf_kernels*> g_kernels(WALLE_NULL);
+
+inline const utf_kernels *kernels()
+{
+    const utf_kernels *k = g_kernels.load(std::memory_order_acquire);
+    if (WALLE_UNLIKELY(!k)) {
+        k = wsl::internal::cpu_has_avx2() ? &kAvx2Kernels : &kSse2Kernels;
+        g_kernels.store(k, std::memory_order_release);
+    }
+    return k;
+}
+
+// sse2 block tests for the conversions and lengths.
+
+inline bool all_ascii16(__m128i v)
+{
+    return _mm_movemask_epi8(v) == 0;
+}
+
+// 8 utf-16 units below 0x80.
+inline bool all_ascii_units16(__m128i v)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xff80))),
+                                             _mm_setzero_si128())) == 0xffff;
+}
+
+// 8 utf-16 units, none a surrogate.
+inline bool no_surrogates16(__m128i v)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xf800))),
+                                             _mm_set1_epi16(static_cast<short>(0xd800)))) == 0;
+}
+
+inline __m128i load16(const void *p)
+{
+    return _mm_loadu_si128(static_cast<const __m128i*>(p));
+}
+
+inline void store16(void *p, __m128i v)
+{
+    _mm_storeu_si128(static_cast<__m128i*>(p), v);
+}
+
+}
+
+namespace utf_detail {
+
+simd_isa current_isa()
+{
+    return kernels()->isa;
+}
+
+bool set_isa(simd_isa isa)
+{
+    if (!wsl::internal::cpu_supports(isa)) {
+        return false;
+    }
+    g_kernels.store(isa == kSimdAvx2 ? &kAvx2Kernels : &kSse2Kernels, std::memory_order_release);
+    return true;
+}
+
+}
+
+bool validate_utf8(const char *p, size_t n)
+{
+    return kernels()->validate_utf8(p, n) == n;
+}
+
+utf_result validate_utf8_with_errors(const char *p, size_t n)
+{
+    size_t pos = kernels()->validate_utf8(p, n);
+    if (pos == n) {
+        return utf_result(kUtfOk, n);
+    }
+    // a sequence cut by the block's start is only found wrong in the block,
+    // rescan from the previous one, backed up to a lead byte.
+    const unsigned char *u = reinterpret_cast<const unsigned char*>(p);
+    pos = pos >= 64 ? pos - 64 : 0;
+    for (size_t k = 0; k < 3 && pos > 0 && (u[pos] & 0xc0) == 0x80; ++k) {
+        --pos;
+    }
+    return validate_utf8_scalar(u, n, pos);
+}
+
+bool validate_utf16(const char16_t *p, size_t n)
+{
+    return validate_utf16_with_errors(p, n).ok();
+}
+
+utf_result validate_utf16_with_errors(const char16_t *p, size_t n)
+{
+    size_t i = 0;
+    while (i < n) {
+        if (n - i >= 16 && no_surrogates16(load16(p + i)) && no_surrogates16(load16(p + i + 8))) {
+            i += 16;
+            continue;
+        }
+        const size_t end = n - i >= 16 ? i + 16 : n;
+        while (i < end) {
+            uint32_t cp;
+            const size_t len = decode_utf16(p, n, i, cp);
+            if (!len) {
+                return utf_result(kUtfSurrogate, i);
+            }
+            i += len;
+        }
+    }
+    return utf_result(kUtfOk, n);
+}
+
+bool validate_utf32(const char32_t *p, size_t n)
+{
+    return validate_utf32_with_errors(p, n).ok();
+}
+
+utf_result validate_utf32_with_errors(const char32_t *p, size_t n)
+{
+    const __m128i limit = _mm_set1_epi32(0x10);
+    const __m128i surrogate_mask = _mm_set1_epi32(static_cast<int>(0xfffff800u));
+    const __m128i surrogate = _mm_set1_epi32(0xd800);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i v = load16(p + i);
+        const __m128i bad = _mm_or_si128(_mm_cmpgt_epi32(_mm_srli_epi32(v, 16), limit),
+                                         _mm_cmpeq_epi32(_mm_and_si128(v, surrogate_mask), surrogate));
+        if (_mm_movemask_epi8(bad)) {
+            break;
+        }
+    }
+    for (; i < n; ++i) {
+        const utf_error error = check_utf32(p[i]);
+        if (error != kUtfOk) {
+            return utf_result(error, i);
+        }
+    }
+    return utf_result(kUtfOk, n);
+}
+
+size_t utf32_length_from_utf8(const char *p, size_t n)
+{
+    // every byte but the continuation bytes starts a code point.
+    size_t count = 0;
+    size_t i = 0;
+    const __m128i last_cont = _mm_set1_epi8(static_cast<char>(0xbf));
+    for (; i + 16 <= n; i += 16) {
+        count += popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(load16(p + i), last_cont))));
+    }
+    for (; i < n; ++i) {
+        count += static_cast<signed char>(p[i]) > -65;
+    }
+    return count;
+}
+
+size_t utf16_length_from_utf8(const char *p, size_t n)
+{
+    // a code point, and one more unit for the 4 byte ones.
+    size_t count = 0;
+    size_t i = 0;
+    const __m128i last_cont = _mm_set1_epi8(static_cast<char>(0xbf));
+    const __m128i four_lead = _mm_set1_epi8(static_cast<char>(0xf0));
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = load16(p + i);
+        count += popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(v, last_cont))));
+        count += popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, four_lead), v))));
+    }
+    for (; i < n; ++i) {
+        const unsigned char b = static_cast<unsigned char>(p[i]);
+        count += ((b & 0xc0) != 0x80) + (b >= 0xf0);
+    }
+    return count;
+}
+
+size_t utf8_length_from_utf16(const char16_t *p, size_t n)
+{
+    // 1 byte, +1 from 0x80, +1 from 0x800 unless a surrogate, a pair is
+    // 2 + 2 bytes.
+    size_t bits = 0;
+    size_t i = 0;
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+        const __m128i v = load16(p + i);
+        const __m128i ge80 = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xff80))), zero);
+        const __m128i high = _mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xf800)));
+        const __m128i ge800 = _mm_or_si128(_mm_cmpeq_epi16(high, zero),
+                                           _mm_cmpeq_epi16(high, _mm_set1_epi16(static_cast<short>(0xd800))));
+        // the masks are set where a byte is not added, 2 bits per unit.
+        bits += 32 - popcount(static_cast<uint32_t>(_mm_movemask_epi8(ge80))) -
+                popcount(static_cast<uint32_t>(_mm_movemask_epi8(ge800)));
+    }
+    size_t count = i + bits / 2;
+    for (; i < n; ++i) {
+        const uint32_t u = p[i];
+        count += 1 + (u >= 0x80) + (u >= 0x800 && !is_surrogate(u));
+    }
+    return count;
+}
+
+size_t utf32_length_from_utf16(const char16_t *p, size_t n)
+{
+    // every unit but the low surrogates.
+    size_t lows = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i low = _mm_cmpeq_epi16(_mm_and_si128(load16(p + i), _mm_set1_epi16(static_cast<short>(0xfc00))),
+                                            _mm_set1_epi16(static_cast<short>(0xdc00)));
+        lows += popcount(static_cast<uint32_t>(_mm_movemask_epi8(low)));
+    }
+    lows /= 2;
+    for (; i < n; ++i) {
+        lows += (p[i] & 0xfc00) == 0xdc00;
+    }
+    return n - lows;
+}
+
+size_t utf8_length_from_utf32(const char32_t *p, size_t n)
+{
+    size_t bits = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i v = load16(p + i);
+        bits += popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi32(v, _mm_set1_epi32(0x7f))))) +
+                popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi32(v, _mm_set1_epi32(0x7ff))))) +
+                popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi32(v, _mm_set1_epi32(0xffff)))));
+    }
+    size_t count = i + bits / 4;
+    for (; i < n; ++i) {
+        const uint32_t c = p[i];
+        count += 1 + (c >= 0x80) + (c >= 0x800) + (c >= 0x10000);
+    }
+    return count;
+}
+
+size_t utf16_length_from_utf32(const char32_t *p, size_t n)
+{
+    size_t bits = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        bits += popcount(static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_cmpgt_epi32(load16(p + i), _mm_set1_epi32(0xffff)))));
+    }
+    size_t count = i + bits / 4;
+    for (; i < n; ++i) {
+        count += 1 + (p[i] > 0xffff);
+    }
+    return count;
+}
+
+namespace {
+
+// utf-8 is validated first by the vector kernels, so its conversion loop
+// only branches on the sequence length.
+
+inline void put(uint32_t cp, char16_t *&out)
+{
+    out = encode_utf16(cp, out);
+}
+
+inline void put(uint32_t cp, char32_t *&out)
+{
+    *out++ = cp;
+}
+
+inline void widen_ascii(__m128i v, char16_t *out)
+{
+    store16(out, _mm_unpacklo_epi8(v, _mm_setzero_si128()));
+    store16(out + 8, _mm_unpackhi_epi8(v, _mm_setzero_si128()));
+}
+
+inline void widen_ascii(__m128i v, char32_t *out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = _mm_unpacklo_epi8(v, zero);
+    const __m128i hi = _mm_unpackhi_epi8(v, zero);
+    store16(out, _mm_unpacklo_epi16(lo, zero));
+    store16(out + 4, _mm_unpackhi_epi16(lo, zero));
+    store16(out + 8, _mm_unpacklo_epi16(hi, zero));
+    store16(out + 12, _mm_unpackhi_epi16(hi, zero));
+}
+
+// the sequence at p[i], returns the offset after it.
+template <typename Out>
+inline size_t convert_valid_sequence(const unsigned char *p, size_t i, Out *&out)
+{
+    const uint32_t b = p[i];
+    if (b < 0x80) {
+        *out++ = static_cast<Out>(b);
+        return i + 1;
+    } else if (b < 0xe0) {
+        *out++ = static_cast<Out>(((b & 0x1f) << 6) | (p[i + 1] & 0x3f));
+        return i + 2;
+    } else if (b < 0xf0) {
+        *out++ = static_cast<Out>(((b & 0x0f) << 12) | ((p[i + 1] & 0x3f) << 6) | (p[i + 2] & 0x3f));
+        return i + 3;
+    }
+    put(((b & 0x07) << 18) | ((p[i + 1] & 0x3f) << 12) | ((p[i + 2] & 0x3f) << 6) | (p[i + 3] & 0x3f), out);
+    return i + 4;
+}
+
+template <typename Out>
+Out *convert_valid_utf8_sse2(const unsigned char *p, size_t n, Out *out)
+{
+    size_t i = 0;
+    while (i < n) {
+        if (n - i >= 16) {
+            const __m128i v = load16(p + i);
+            if (all_ascii16(v)) {
+                widen_ascii(v, out);
+                out += 16;
+                i += 16;
+                continue;
+            }
+        }
+        const size_t end = n - i >= 16 ? i + 16 : n;
+        while (i < end) {
+            i = convert_valid_sequence(p, i, out);
+        }
+    }
+    return out;
+}
+
+// pshufb masks moving the 16 bit lanes picked by an 8 bit mask to the
+// front.
+struct lane_compaction {
+    uint8_t shuffle[256][16];
+
+    lane_compaction()
+    {
+        std::memset(shuffle, 0x80, sizeof(shuffle));
+        for (uint32_t m = 0; m < 256; ++m) {
+            uint8_t k = 0;
+            for (uint8_t j = 0; j < 8; ++j) {
+                if (m & (1u << j)) {
+                    shuffle[m][k++] = static_cast<uint8_t>(2 * j);
+                    shuffle[m][k++] = static_cast<uint8_t>(2 * j + 1);
+                }
+            }
+        }
+    }
+};
+
+inline void store_units(__m128i v, char16_t *out)
+{
+    store16(out, v);
+}
+
+inline void store_units(__m128i v, char32_t *out)
+{
+    store16(out, _mm_unpacklo_epi16(v, _mm_setzero_si128()));
+    store16(out + 4, _mm_unpackhi_epi16(v, _mm_setzero_si128()));
+}
+
+// besides ascii blocks, blocks of 1 and 2 byte sequences (latin, greek,
+// cyrillic, hebrew, arabic...) are decoded in every 16 bit lane at once and
+// the lanes of continuation bytes squeezed out, and 3 byte sequences (most
+// of the bmp, cjk) are decoded four at a time. both store whole vectors,
+// their surplus lanes are overwritten next, which the 48 bytes of input left
+// make room for in an output sized for the whole input.
+template <typename Out>
+WALLE_TARGET_SSSE3 Out *convert_valid_utf8_ssse3(const unsigned char *p, size_t n, Out *out)
+{
+    static const lane_compaction compaction;
+    const __m128i three_shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    const __m128i low_halves = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    while (i < n) {
+        if (n - i >= 48) {
+            const __m128i v = load16(p + i);
+            const uint32_t high = static_cast<uint32_t>(_mm_movemask_epi8(v));
+            if (high == 0) {
+                widen_ascii(v, out);
+                out += 16;
+                i += 16;
+                continue;
+            }
+            const __m128i e0 = _mm_set1_epi8(static_cast<char>(0xe0));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, e0), v)) == 0) {
+                const uint32_t cont = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+                    _mm_and_si128(v, _mm_set1_epi8(static_cast<char>(0xc0))), _mm_set1_epi8(static_cast<char>(0x80)))));
+                // a lead in the last byte is left for the next block.
+                const uint32_t take = (high & ~cont & 0x8000) ? 0x7fff : 0xffff;
+                const uint32_t keep = ~cont & take;
+                const __m128i next = _mm_srli_si128(v, 1);
+                __m128i halves[2];
+                for (int h = 0; h < 2; ++h) {
+                    const __m128i b = h ? _mm_unpackhi_epi8(v, zero) : _mm_unpacklo_epi8(v, zero);
+                    const __m128i c = h ? _mm_unpackhi_epi8(next, zero) : _mm_unpacklo_epi8(next, zero);
+                    const __m128i two = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(b, _mm_set1_epi16(0x1f)), 6),
+                                                     _mm_and_si128(c, _mm_set1_epi16(0x3f)));
+                    const __m128i lead = _mm_cmpgt_epi16(b, _mm_set1_epi16(0xbf));
+                    halves[h] = _mm_or_si128(_mm_and_si128(lead, two), _mm_andnot_si128(lead, b));
+                }
+                const uint32_t keep_lo = keep & 0xff;
+                const uint32_t keep_hi = (keep >> 8) & 0xff;
+                store_units(_mm_shuffle_epi8(halves[0], load16(compaction.shuffle[keep_lo])), out);
+                out += popcount(keep_lo);
+                store_units(_mm_shuffle_epi8(halves[1], load16(compaction.shuffle[keep_hi])), out);
+                out += popcount(keep_hi);
+                i += take == 0xffff ? 16 : 15;
+                continue;
+            }
+            const uint32_t three_leads = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+                _mm_and_si128(v, _mm_set1_epi8(static_cast<char>(0xf0))), e0)));
+            if ((three_leads & 0x249) == 0x249) {
+                // valid input has continuation bytes between the leads.
+                const __m128i x = _mm_shuffle_epi8(v, three_shuffle);
+                const __m128i cp = _mm_or_si128(
+                    _mm_and_si128(x, _mm_set1_epi32(0x3f)),
+                    _mm_or_si128(_mm_and_si128(_mm_srli_epi32(x, 2), _mm_set1_epi32(0xfc0)),
+                                 _mm_and_si128(_mm_srli_epi32(x, 4), _mm_set1_epi32(0xf000))));
+                store_units(_mm_shuffle_epi8(cp, low_halves), out);
+                out += 4;
+                i += 12;
+                continue;
+            }
+        }
+        const size_t end = n - i >= 16 ? i + 16 : n;
+        while (i < end) {
+            i = convert_valid_sequence(p, i, out);
+        }
+    }
+    return out;
+}
+
+// utf-16 and utf-32 are checked while converting, their checks are cheap
+// and rarely taken. both return the end of the output, null on error with
+// the error's offset in pos.
+
+char *convert_utf16(const char16_t *p, size_t n, char *out, size_t &pos)
+{
+    size_t i = 0;
+    while (i < n) {
+        if (n - i >= 16) {
+            const __m128i a = load16(p + i);
+            const __m128i b = load16(p + i + 8);
+            if (all_ascii_units16(_mm_or_si128(a, b))) {
+                store16(out, _mm_packus_epi16(a, b));
+                out += 16;
+                i += 16;
+                continue;
+            }
+        }
+        const size_t end = n - i >= 16 ? i + 16 : n;
+        while (i < end) {
+            const uint32_t u = p[i];
+            if (u < 0x80) {
+                *out++ = static_cast<char>(u);
+                ++i;
+            } else if (!is_surrogate(u)) {
+                out = encode_utf8(u, out);
+                ++i;
+            } else {
+                uint32_t cp;
+                if (!decode_utf16(p, n, i, cp)) {
+                    pos = i;
+                    return WALLE_NULL;
+                }
+                out = encode_utf8(cp, out);
+                i += 2;
+            }
+        }
+    }
+    return out;
+}
+
+char32_t *convert_utf16(const char16_t *p, size_t n, char32_t *out, size_t &pos)
+{
+    size_t i = 0;
+    while (i < n) {
+        if (n - i >= 8) {
+            const __m128i v = load16(p + i);
+            if (no_surrogates16(v)) {
+                store16(out, _mm_unpacklo_epi16(v, _mm_setzero_si128()));
+                store16(out + 4, _mm_unpackhi_epi16(v, _mm_setzero_si128()));
+                out += 8;
+                i += 8;
+                continue;
+            }
+        }
+        const size_t end = n - i >= 8 ? i + 8 : n;
+        while (i < end) {
+            uint32_t cp;
+            const size_t len = decode_utf16(p, n, i, cp);
+            if (!len) {
+                pos = i;
+                return WALLE_NULL;
+            }
+            *out++ = cp;
+            i += len;
+        }
+    }
+    return out;
+}
+
+char *convert_utf32(const char32_t *p, size_t n, char *out, size_t &pos)
+{
+    size_t i = 0;
+    while (i < n) {
+        if (n - i >= 16) {
+            const __m128i a = load16(p + i);
+            const __m128i b = load16(p + i + 4);
+            const __m128i c = load16(p + i + 8);
+            const __m128i d = load16(p + i + 12);
+            const __m128i any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(any, _mm_set1_epi32(~0x7f)),
+                                                  _mm_setzero_si128())) == 0xffff) {
+                store16(out, _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+                out += 16;
+                i += 16;
+                continue;
+            }
+        }
+        const size_t end = n - i >= 16 ? i + 16 : n;
+        for (; i < end; ++i) {
+            if (check_utf32(p[i]) != kUtfOk) {
+                pos = i;
+                return WALLE_NULL;
+            }
+            out = encode_utf8(p[i], out);
+        }
+    }
+    return out;
+}
+
+char16_t *convert_utf32(const char32_t *p, size_t n, char16_t *out, size_t &pos)
+{
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    const __m128i high_bits = _mm_set1_epi32(0xf800);
+    const __m128i surrogate = _mm_set1_epi32(0xd800);
+    size_t i = 0;
+    while (i < n) {
+        if (n - i >= 8) {
+            // below 0x10000 and not a surrogate, packs saturates signed
+            // values so they are packed biased.
+            const __m128i a = load16(p + i);
+            const __m128i b = load16(p + i + 4);
+            const __m128i wide = _mm_cmpgt_epi32(_mm_srli_epi32(_mm_or_si128(a, b), 16), _mm_setzero_si128());
+            const __m128i sur = _mm_or_si128(_mm_cmpeq_epi32(_mm_and_si128(a, high_bits), surrogate),
+                                             _mm_cmpeq_epi32(_mm_and_si128(b, high_bits), surrogate));
+            if (_mm_movemask_epi8(_mm_or_si128(wide, sur)) == 0) {
+                const __m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias));
+                store16(out, _mm_add_epi16(packed, _mm_set1_epi16(static_cast<short>(0x8000))));
+                out += 8;
+                i += 8;
+                continue;
+            }
+        }
+        const size_t end = n - i >= 8 ? i + 8 : n;
+        for (; i < end; ++i) {
+            if (check_utf32(p[i]) != kUtfOk) {
+                pos = i;
+                return WALLE_NULL;
+            }
+            out = encode_utf16(p[i], out);
+        }
+    }
+    return out;
+}
+
+template <typename From, typename To>
+utf_result convert_checked(const From *p, size_t n, To *out,
+                           To *(*convert)(const From *, size_t, To *, size_t &),
+                           utf_result (*validate)(const From *, size_t))
+{
+    size_t pos = 0;
+    To *const last = convert(p, n, out, pos);
+    if (!last) {
+        // the error kind, at the offset found.
+        return utf_result(validate(p + pos, n - pos).error, pos);
+    }
+    return utf_result(kUtfOk, last - out);
+}
+
+// converts the valid input, or the part before the error.
+template <typename From, typename To>
+utf_result convert(const From *p, size_t n, To *out, const utf_result &valid,
+                   To *(*convert_valid)(const From *, size_t, To *))
+{
+    To *const last = convert_valid(p, valid.ok() ? n : valid.count, out);
+    return valid.ok() ? utf_result(kUtfOk, last - out) : valid;
+}
+
+char16_t *convert_valid_utf8_to_utf16(const unsigned char *p, size_t n, char16_t *out)
+{
+    return wsl::internal::cpu_has_ssse3() ? convert_valid_utf8_ssse3(p, n, out) : convert_valid_utf8_sse2(p, n, out);
+}
+
+char32_t *convert_valid_utf8_to_utf32(const unsigned char *p, size_t n, char32_t *out)
+{
+    return wsl::internal::cpu_has_ssse3() ? convert_valid_utf8_ssse3(p, n, out) : convert_valid_utf8_sse2(p, n, out);
+}
+
+}
+
+utf_result convert_utf8_to_utf16(const char *p, size_t n, char16_t *out)
+{
+    return convert(reinterpret_cast<const unsigned char*>(p), n, out, validate_utf8_with_errors(p, n),
+                   convert_valid_utf8_to_utf16);
+}
+
+utf_result convert_utf8_to_utf32(const char *p, size_t n, char32_t *out)
+{
+    return convert(reinterpret_cast<const unsigned char*>(p), n, out, validate_utf8_with_errors(p, n),
+                   convert_valid_utf8_to_utf32);
+}
+
+utf_result convert_utf16_to_utf8(const char16_t *p, size_t n, char *out)
+{
+    return convert_checked<char16_t, char>(p, n, out, convert_utf16, validate_utf16_with_errors);
+}
+
+utf_result convert_utf16_to_utf32(const char16_t *p, size_t n, char32_t *out)
+{
+    return convert_checked<char16_t, char32_t>(p, n, out, convert_utf16, validate_utf16_with_errors);
+}
+
+utf_result convert_utf32_to_utf8(const char32_t *p, size_t n, char *out)
+{
+    return convert_checked<char32_t, char>(p, n, out, convert_utf32, validate_utf32_with_errors);
+}
+
+utf_result convert_utf32_to_utf16(const char32_t *p, size_t n, char16_t *out)
+{
+    return convert_checked<char32_t, char16_t>(p, n, out, convert_utf32, validate_utf32_with_errors);
+}
+
+namespace {
+
+// converts into the worst case space after out's elements.
+template <typename From, typename To>
+utf_result append_converted(const From *p, size_t n, wsl::internal::basic_buffer<To> &out, size_t factor,
+                            utf_result (*convert)(const From *, size_t, To *))
+{
+    const size_t size = out.size();
+    out.reserve(size + n * factor);
+    const utf_result r = convert(p, n, out.data() + size);
+    if (r.ok()) {
+        out.resize(size + r.count);
+    }
+    return r;
+}
+
+}
+
+utf_result utf8_to_utf16(wsl::string_view s, wsl::internal::basic_buffer<char16_t> &out)
+{
+    return append_converted(s.data(), s.size(), out, 1, convert_utf8_to_utf16);
+}
+
+utf_result utf8_to_utf32(wsl::string_view s, wsl::internal::basic_buffer<char32_t> &out)
+{
+    return append_converted(s.data(), s.size(), out, 1, convert_utf8_to_utf32);
+}
+
+utf_result utf16_to_utf8(wsl::u16string_view s, wsl::internal::basic_buffer<char> &out)
+{
+    return append_converted(s.data(), s.size(), out, 3, convert_utf16_to_utf8);
+}
+
+utf_result utf16_to_utf32(wsl::u16string_view s, wsl::internal::basic_buffer<char32_t> &out)
+{
+    return append_converted(s.data(), s.size(), out, 1, convert_utf16_to_utf32);
+}
+
+utf_result utf32_to_utf8(wsl::u32string_view s, wsl::internal::basic_buffer<char> &out)
+{
+    return append_converted(s.data(), s.size(), out, 4, convert_utf32_to_utf8);
+}
+
+utf_result utf32_to_utf16(wsl::u32string_view s, wsl::internal::basic_buffer<char16_t> &out)
+{
+    return append_converted(s.data(), s.size(), out, 2, convert_utf32_to_utf16);
+}
+
+}
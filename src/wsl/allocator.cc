@@ -0,0 +1,53 @@
+#include <walle/wsl/allocator.h>
+#include <sys/mman.h>
+
+namespace wsl {
+namespace internal {
+
+void *huge_page_map(size_t bytes, bool hugetlb)
+{
+    // room for the rounding and the extra huge page below.
+    if (bytes > SIZE_MAX - 2 * kHugePageSize) {
+        throw std::bad_alloc();
+    }
+    const size_t size = wsl::align_up(bytes, kHugePageSize);
+#ifdef MAP_HUGETLB
+    if (hugetlb) {
+        void *p = ::mmap(WALLE_NULL, size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            return p;
+        }
+        // no reserved huge pages, fall back to transparent ones.
+    }
+#endif
+    // over map by one huge page and cut the unaligned head and tail off, so
+    // the range can be backed by whole huge pages.
+    char *raw = static_cast<char*>(::mmap(WALLE_NULL, size + kHugePageSize, PROT_READ | PROT_WRITE,
+                                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (raw == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    char *p = wsl::align_up(raw, kHugePageSize);
+    if (p != raw) {
+        ::munmap(raw, p - raw);
+    }
+    const size_t tail = (raw + size + kHugePageSize) - (p + size);
+    if (tail) {
+        ::munmap(p + size, tail);
+    }
+#ifdef MADV_HUGEPAGE
+    ::madvise(p, size, MADV_HUGEPAGE);
+#endif
+    return p;
+}
+
+void huge_page_unmap(void *p, size_t bytes)
+{
+    if (p) {
+        ::munmap(p, wsl::align_up(bytes, kHugePageSize));
+    }
+}
+
+}
+}
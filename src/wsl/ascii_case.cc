@@ -0,0 +1,301 @@
+#include <walle/wsl/ascii.h>
+#include <walle/wsl/internal/cpu.h>
+#include <atomic>
+#include <cstring>
+#include <immintrin.h>
+
+namespace wsl {
+
+namespace {
+
+// 'A'..'Z' (or 'a'..'z') moved to the bottom of the signed byte range, so a
+// single signed compare finds them and every byte >= 0x80 stays above.
+const char kUpperBias = static_cast<char>(0x80 - 'A');
+const char kLowerBias = static_cast<char>(0x80 - 'a');
+const char kAlphaLimit = static_cast<char>(-128 + 26);
+
+inline unsigned char fold(unsigned char c)
+{
+    return static_cast<unsigned char>(c + ((static_cast<unsigned>(c - 'A') < 26u) << 5));
+}
+
+inline unsigned char unfold(unsigned char c)
+{
+    return static_cast<unsigned char>(c - ((static_cast<unsigned>(c - 'a') < 26u) << 5));
+}
+
+inline uint64_t load8(const char *p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+// lowercase 8 bytes at once: the 0x80 bit of is_upper marks 'A'..'Z'.
+inline uint64_t fold8(uint64_t x)
+{
+    const uint64_t heptets = x & 0x7f7f7f7f7f7f7f7full;
+    const uint64_t ge_a = heptets + 0x3f3f3f3f3f3f3f3full;      // >= 'A'
+    const uint64_t gt_z = heptets + 0x2525252525252525ull;      // > 'Z'
+    const uint64_t is_upper = ge_a & ~gt_z & ~x & 0x8080808080808080ull;
+    return x | (is_upper >> 2);
+}
+
+template <bool Lower>
+void convert_scalar(const char *src, size_t n, char *dst)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const unsigned char c = static_cast<unsigned char>(src[i]);
+        dst[i] = static_cast<char>(Lower ? fold(c) : unfold(c));
+    }
+}
+
+int compare_i_scalar(const char *a, const char *b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const unsigned char ca = fold(static_cast<unsigned char>(a[i]));
+        const unsigned char cb = fold(static_cast<unsigned char>(b[i]));
+        if (ca != cb) {
+            return ca < cb ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+bool equals_i_short(const char *a, const char *b, size_t n)
+{
+    if (n >= 8) {
+        // two overlapping words cover 8..15 bytes.
+        return ((fold8(load8(a)) ^ fold8(load8(b))) |
+                (fold8(load8(a + n - 8)) ^ fold8(load8(b + n - 8)))) == 0;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (fold(static_cast<unsigned char>(a[i])) != fold(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// sse2, 16 bytes per step.
+
+template <bool Lower>
+inline __m128i convert_sse2(__m128i x)
+{
+    const __m128i t = _mm_add_epi8(x, _mm_set1_epi8(Lower ? kUpperBias : kLowerBias));
+    const __m128i hit = _mm_cmplt_epi8(t, _mm_set1_epi8(kAlphaLimit));
+    return _mm_xor_si128(x, _mm_and_si128(hit, _mm_set1_epi8(0x20)));
+}
+
+template <bool Lower>
+void convert_sse2(const char *src, size_t n, char *dst)
+{
+    if (n < 16) {
+        convert_scalar<Lower>(src, n, dst);
+        return;
+    }
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), convert_sse2<Lower>(x));
+    }
+    if (i < n) {
+        // converting a byte twice gives the same result, so the last block
+        // may overlap the previous one, also when converting in place.
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + n - 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n - 16), convert_sse2<Lower>(x));
+    }
+}
+
+// mask of the bytes equal after folding.
+inline uint32_t equal_i_mask_sse2(const char *a, const char *b)
+{
+    const __m128i la = convert_sse2<true>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)));
+    const __m128i lb = convert_sse2<true>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(la, lb)));
+}
+
+inline int byte_order(const char *a, const char *b, size_t i)
+{
+    return fold(static_cast<unsigned char>(a[i])) < fold(static_cast<unsigned char>(b[i])) ? -1 : 1;
+}
+
+int compare_i_sse2(const char *a, const char *b, size_t n)
+{
+    if (n < 16) {
+        return compare_i_scalar(a, b, n);
+    }
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint32_t eq = equal_i_mask_sse2(a + i, b + i);
+        if (eq != 0xffffu) {
+            return byte_order(a, b, i + __builtin_ctz(~eq));
+        }
+    }
+    if (i < n) {
+        // the overlapping bytes are known equal, the first difference is new.
+        const uint32_t eq = equal_i_mask_sse2(a + n - 16, b + n - 16);
+        if (eq != 0xffffu) {
+            return byte_order(a, b, n - 16 + __builtin_ctz(~eq));
+        }
+    }
+    return 0;
+}
+
+bool equals_i_sse2(const char *a, const char *b, size_t n)
+{
+    if (n < 16) {
+        return equals_i_short(a, b, n);
+    }
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        if (equal_i_mask_sse2(a + i, b + i) != 0xffffu) {
+            return false;
+        }
+    }
+    return i == n || equal_i_mask_sse2(a + n - 16, b + n - 16) == 0xffffu;
+}
+
+// avx2, 32 bytes per step.
+
+template <bool Lower>
+WALLE_TARGET_AVX2 inline __m256i convert_avx2(__m256i x)
+{
+    const __m256i t = _mm256_add_epi8(x, _mm256_set1_epi8(Lower ? kUpperBias : kLowerBias));
+    const __m256i hit = _mm256_cmpgt_epi8(_mm256_set1_epi8(kAlphaLimit), t);
+    return _mm256_xor_si256(x, _mm256_and_si256(hit, _mm256_set1_epi8(0x20)));
+}
+
+template <bool Lower>
+WALLE_TARGET_AVX2 void convert_avx2(const char *src, size_t n, char *dst)
+{
+    if (n < 32) {
+        convert_sse2<Lower>(src, n, dst);
+        return;
+    }
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), convert_avx2<Lower>(x));
+    }
+    if (i < n) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + n - 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + n - 32), convert_avx2<Lower>(x));
+    }
+}
+
+WALLE_TARGET_AVX2 inline uint32_t equal_i_mask_avx2(const char *a, const char *b)
+{
+    const __m256i la = convert_avx2<true>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a)));
+    const __m256i lb = convert_avx2<true>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(la, lb)));
+}
+
+WALLE_TARGET_AVX2 int compare_i_avx2(const char *a, const char *b, size_t n)
+{
+    if (n < 32) {
+        return compare_i_sse2(a, b, n);
+    }
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const uint32_t eq = equal_i_mask_avx2(a + i, b + i);
+        if (eq != 0xffffffffu) {
+            return byte_order(a, b, i + __builtin_ctz(~eq));
+        }
+    }
+    if (i < n) {
+        const uint32_t eq = equal_i_mask_avx2(a + n - 32, b + n - 32);
+        if (eq != 0xffffffffu) {
+            return byte_order(a, b, n - 32 + __builtin_ctz(~eq));
+        }
+    }
+    return 0;
+}
+
+WALLE_TARGET_AVX2 bool equals_i_avx2(const char *a, const char *b, size_t n)
+{
+    if (n < 32) {
+        return equals_i_sse2(a, b, n);
+    }
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        if (equal_i_mask_avx2(a + i, b + i) != 0xffffffffu) {
+            return false;
+        }
+    }
+    return i == n || equal_i_mask_avx2(a + n - 32, b + n - 32) == 0xffffffffu;
+}
+
+struct case_kernels {
+    internal::simd_isa  isa;
+    void              (*to_lower)(const char *, size_t, char *);
+    void              (*to_upper)(const char *, size_t, char *);
+    int               (*compare_i)(const char *, const char *, size_t);
+    bool              (*equals_i)(const char *, const char *, size_t);
+};
+
+const case_kernels kSse2Kernels = {
+    internal::kSimdSse2, convert_sse2<true>, convert_sse2<false>, compare_i_sse2, equals_i_sse2
+};
+
+const case_kernels kAvx2Kernels = {
+    internal::kSimdAvx2, convert_avx2<true>, convert_avx2<false>, compare_i_avx2, equals_i_avx2
+};
+
+std::atomic<const case_kernels*> g_kernels(WALLE_NULL);
+
+inline const case_kernels *kernels()
+{
+    const case_kernels *k = g_kernels.load(std::memory_order_acquire);
+    if (WALLE_UNLIKELY(!k)) {
+        k = internal::cpu_has_avx2() ? &kAvx2Kernels : &kSse2Kernels;
+        g_kernels.store(k, std::memory_order_release);
+    }
+    return k;
+}
+
+}
+
+namespace internal {
+
+simd_isa current_ascii_isa()
+{
+    return kernels()->isa;
+}
+
+bool set_ascii_isa(simd_isa isa)
+{
+    if (!cpu_supports(isa)) {
+        return false;
+    }
+    g_kernels.store(isa == kSimdAvx2 ? &kAvx2Kernels : &kSse2Kernels, std::memory_order_release);
+    return true;
+}
+
+}
+
+void ascii::to_lower(const char *src, size_t n, char *dst)
+{
+    kernels()->to_lower(src, n, dst);
+}
+
+void ascii::to_upper(const char *src, size_t n, char *dst)
+{
+    kernels()->to_upper(src, n, dst);
+}
+
+int ascii::compare_i(const char *a, const char *b, size_t n)
+{
+    return kernels()->compare_i(a, b, n);
+}
+
+bool ascii::equals_i(const char *a, const char *b, size_t n)
+{
+    if (n < 16) {
+        // header names and the like, skip the indirect call.
+        return equals_i_short(a, b, n);
+    }
+    return kernels()->equals_i(a, b, n);
+}
+
+}
@@ -0,0 +1,384 @@
+#include <walle/wsl/ascii.h>
+#include <walle/wsl/internal/cpu.h>
+#include <cstring>
+#include <immintrin.h>
+
+namespace wsl {
+
+namespace {
+
+const int kAllProperties = 0x3ff;
+
+// a set of ASCII bytes as a nibble table: bit h of lo[l] is set when byte
+// (h << 4 | l) is in the set. one pshufb on the low nibbles and one on the
+// high nibbles (1 << h, 0 past 7) and an and test 16 or 32 bytes at once;
+// pshufb gives 0 for bytes >= 0x80, they are never in a set.
+struct alignas(16) byte_set {
+    uint8_t lo[16];
+};
+
+struct property_sets {
+    byte_set    of[10];     // the bytes of each single property.
+
+    property_sets()
+    {
+        std::memset(of, 0, sizeof(of));
+        for (int c = 0; c < 128; ++c) {
+            const int props = ascii::properties(c);
+            for (int p = 0; p < 10; ++p) {
+                if (props & (1 << p)) {
+                    of[p].lo[c & 15] = static_cast<uint8_t>(of[p].lo[c & 15] | (1u << (c >> 4)));
+                }
+            }
+        }
+    }
+};
+
+// the bytes having all of props.
+byte_set make_set(int props)
+{
+    WALLE_ASSERT_MSG(props != 0 && (props & ~kAllProperties) == 0, "bad character properties");
+    static const property_sets sets;
+    uint64_t w[2] = {~uint64_t(0), ~uint64_t(0)};
+    for (int p = 0; p < 10; ++p) {
+        if (props & (1 << p)) {
+            uint64_t s[2];
+            std::memcpy(s, sets.of[p].lo, sizeof(s));
+            w[0] &= s[0];
+            w[1] &= s[1];
+        }
+    }
+    byte_set r;
+    std::memcpy(r.lo, w, sizeof(w));
+    return r;
+}
+
+inline bool in_set(const byte_set &s, char ch)
+{
+    const unsigned char c = static_cast<unsigned char>(ch);
+    return c < 0x80 && ((s.lo[c & 15] >> (c >> 4)) & 1);
+}
+
+// scalar, also the tails of the vector kernels.
+
+bool all_ascii_scalar(const char *p, size_t n)
+{
+    uint64_t high = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        high |= w;
+    }
+    for (; i < n; ++i) {
+        high |= static_cast<unsigned char>(p[i]);
+    }
+    return (high & 0x8080808080808080ull) == 0;
+}
+
+size_t find_scalar(const char *p, size_t n, const byte_set &s, bool want)
+{
+    for (size_t i = 0; i < n; ++i) {
+        if (in_set(s, p[i]) == want) {
+            return i;
+        }
+    }
+    return n;
+}
+
+size_t count_scalar(const char *p, size_t n, const byte_set &s)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        count += in_set(s, p[i]);
+    }
+    return count;
+}
+
+// bits of p[from, n) into out, from a multiple of 64.
+void classify_scalar(const char *p, size_t from, size_t n, const byte_set &s, uint64_t *out)
+{
+    for (size_t i = from; i < n; i += 64) {
+        const size_t end = n - i < 64 ? n : i + 64;
+        uint64_t bits = 0;
+        for (size_t j = i; j < end; ++j) {
+            bits |= uint64_t(in_set(s, p[j])) << (j - i);
+        }
+        out[i / 64] = bits;
+    }
+}
+
+void classify_scalar(const char *p, size_t n, const byte_set &s, uint64_t *out)
+{
+    classify_scalar(p, 0, n, s, out);
+}
+
+// sse2 / ssse3, 16 bytes per step.
+
+bool all_ascii_sse2(const char *p, size_t n)
+{
+    if (n < 16) {
+        return all_ascii_scalar(p, n);
+    }
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 32));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 48));
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)))) {
+            return false;
+        }
+    }
+    for (; i + 16 <= n; i += 16) {
+        if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)))) {
+            return false;
+        }
+    }
+    return i == n || _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n - 16))) == 0;
+}
+
+WALLE_TARGET_SSSE3 inline uint32_t match_ssse3(const char *p, __m128i lo_table)
+{
+    const __m128i hi_table = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), _mm_set1_epi8(0x0f));
+    const __m128i hit = _mm_and_si128(_mm_shuffle_epi8(lo_table, x), _mm_shuffle_epi8(hi_table, hi));
+    return ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(hit, _mm_setzero_si128()))) & 0xffffu;
+}
+
+WALLE_TARGET_SSSE3 size_t find_ssse3(const char *p, size_t n, const byte_set &s, bool want)
+{
+    if (n < 16) {
+        return find_scalar(p, n, s, want);
+    }
+    const __m128i t = _mm_load_si128(reinterpret_cast<const __m128i*>(s.lo));
+    const uint32_t flip = want ? 0 : 0xffffu;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint32_t m = match_ssse3(p + i, t) ^ flip;
+        if (m) {
+            return i + __builtin_ctz(m);
+        }
+    }
+    if (i < n) {
+        // the overlapping bytes are known not to be it.
+        const uint32_t m = match_ssse3(p + n - 16, t) ^ flip;
+        if (m) {
+            return n - 16 + __builtin_ctz(m);
+        }
+    }
+    return n;
+}
+
+WALLE_TARGET_SSSE3 size_t count_ssse3(const char *p, size_t n, const byte_set &s)
+{
+    if (n < 16) {
+        return count_scalar(p, n, s);
+    }
+    const __m128i t = _mm_load_si128(reinterpret_cast<const __m128i*>(s.lo));
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        count += __builtin_popcount(match_ssse3(p + i, t));
+    }
+    if (i < n) {
+        // drop the bits of the overlapping bytes, counted already.
+        count += __builtin_popcount(match_ssse3(p + n - 16, t) >> (16 - (n - i)));
+    }
+    return count;
+}
+
+WALLE_TARGET_SSSE3 void classify_ssse3(const char *p, size_t n, const byte_set &s, uint64_t *out)
+{
+    const __m128i t = _mm_load_si128(reinterpret_cast<const __m128i*>(s.lo));
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        out[i / 64] = uint64_t(match_ssse3(p + i, t)) |
+                      uint64_t(match_ssse3(p + i + 16, t)) << 16 |
+                      uint64_t(match_ssse3(p + i + 32, t)) << 32 |
+                      uint64_t(match_ssse3(p + i + 48, t)) << 48;
+    }
+    classify_scalar(p, i, n, s, out);
+}
+
+bool have_ssse3()
+{
+    static const bool ssse3 = internal::cpu_has_ssse3();
+    return ssse3;
+}
+
+size_t find_sse2(const char *p, size_t n, const byte_set &s, bool want)
+{
+    return have_ssse3() ? find_ssse3(p, n, s, want) : find_scalar(p, n, s, want);
+}
+
+size_t count_sse2(const char *p, size_t n, const byte_set &s)
+{
+    return have_ssse3() ? count_ssse3(p, n, s) : count_scalar(p, n, s);
+}
+
+void classify_sse2(const char *p, size_t n, const byte_set &s, uint64_t *out)
+{
+    if (have_ssse3()) {
+        classify_ssse3(p, n, s, out);
+    } else {
+        classify_scalar(p, n, s, out);
+    }
+}
+
+// avx2, 32 bytes per step.
+
+WALLE_TARGET_AVX2 bool all_ascii_avx2(const char *p, size_t n)
+{
+    if (n < 32) {
+        return all_ascii_sse2(p, n);
+    }
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 32));
+        if (_mm256_movemask_epi8(_mm256_or_si256(a, b))) {
+            return false;
+        }
+    }
+    if (i + 32 <= n) {
+        if (_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)))) {
+            return false;
+        }
+        i += 32;
+    }
+    return i == n || _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + n - 32))) == 0;
+}
+
+WALLE_TARGET_AVX2 inline uint32_t match_avx2(const char *p, __m256i lo_table)
+{
+    const __m256i hi_table = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0,
+                                              1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), _mm256_set1_epi8(0x0f));
+    const __m256i hit = _mm256_and_si256(_mm256_shuffle_epi8(lo_table, x), _mm256_shuffle_epi8(hi_table, hi));
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hit, _mm256_setzero_si256())));
+}
+
+WALLE_TARGET_AVX2 inline __m256i load_set_avx2(const byte_set &s)
+{
+    return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(s.lo)));
+}
+
+WALLE_TARGET_AVX2 size_t find_avx2(const char *p, size_t n, const byte_set &s, bool want)
+{
+    if (n < 32) {
+        return find_sse2(p, n, s, want);
+    }
+    const __m256i t = load_set_avx2(s);
+    const uint32_t flip = want ? 0 : 0xffffffffu;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const uint32_t m = match_avx2(p + i, t) ^ flip;
+        if (m) {
+            return i + __builtin_ctz(m);
+        }
+    }
+    if (i < n) {
+        const uint32_t m = match_avx2(p + n - 32, t) ^ flip;
+        if (m) {
+            return n - 32 + __builtin_ctz(m);
+        }
+    }
+    return n;
+}
+
+WALLE_TARGET_AVX2 size_t count_avx2(const char *p, size_t n, const byte_set &s)
+{
+    if (n < 32) {
+        return count_sse2(p, n, s);
+    }
+    const __m256i t = load_set_avx2(s);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        count += __builtin_popcount(match_avx2(p + i, t));
+    }
+    if (i < n) {
+        count += __builtin_popcount(match_avx2(p + n - 32, t) >> (32 - (n - i)));
+    }
+    return count;
+}
+
+WALLE_TARGET_AVX2 void classify_avx2(const char *p, size_t n, const byte_set &s, uint64_t *out)
+{
+    const __m256i t = load_set_avx2(s);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        out[i / 64] = uint64_t(match_avx2(p + i, t)) | uint64_t(match_avx2(p + i + 32, t)) << 32;
+    }
+    classify_scalar(p, i, n, s, out);
+}
+
+struct class_kernels {
+    bool      (*all_ascii)(const char *, size_t);
+    size_t    (*find)(const char *, size_t, const byte_set &, bool);
+    size_t    (*count)(const char *, size_t, const byte_set &);
+    void      (*classify)(const char *, size_t, const byte_set &, uint64_t *);
+};
+
+const class_kernels kSse2Kernels = {
+    all_ascii_sse2, find_sse2, count_sse2, classify_sse2
+};
+
+const class_kernels kAvx2Kernels = {
+    all_ascii_avx2, find_avx2, count_avx2, classify_avx2
+};
+
+// follows the kernel set of the case functions, set_ascii_isa() picks both.
+inline const class_kernels *kernels()
+{
+    return internal::current_ascii_isa() == internal::kSimdAvx2 ? &kAvx2Kernels : &kSse2Kernels;
+}
+
+}
+
+bool ascii::all_ascii(buffer_view<const char> buf)
+{
+    if (buf.size() < 16) {
+        return all_ascii_scalar(buf.data(), buf.size());
+    }
+    return kernels()->all_ascii(buf.data(), buf.size());
+}
+
+size_t ascii::find_first_with_properties(buffer_view<const char> buf, int properties)
+{
+    const byte_set s = make_set(properties);
+    if (buf.size() < 16) {
+        return find_scalar(buf.data(), buf.size(), s, true);
+    }
+    return kernels()->find(buf.data(), buf.size(), s, true);
+}
+
+size_t ascii::find_first_without_properties(buffer_view<const char> buf, int properties)
+{
+    const byte_set s = make_set(properties);
+    if (buf.size() < 16) {
+        return find_scalar(buf.data(), buf.size(), s, false);
+    }
+    return kernels()->find(buf.data(), buf.size(), s, false);
+}
+
+size_t ascii::count_properties(buffer_view<const char> buf, int properties)
+{
+    const byte_set s = make_set(properties);
+    if (buf.size() < 16) {
+        return count_scalar(buf.data(), buf.size(), s);
+    }
+    return kernels()->count(buf.data(), buf.size(), s);
+}
+
+void ascii::classify_into(buffer_view<const char> buf, int properties, buffer_view<uint64_t> out)
+{
+    WALLE_ASSERT_MSG(out.size() >= (buf.size() + 63) / 64, "classify_into output too small");
+    const byte_set s = make_set(properties);
+    kernels()->classify(buf.data(), buf.size(), s, out.data());
+}
+
+}
@@ -0,0 +1,409 @@
+#include <walle/wsl/buffer_pool.h>
+#include <cstdlib>
+#include <new>
+
+namespace wsl {
+
+namespace internal {
+
+static std::atomic<uint64_t> g_pool_ids(1);
+// guards pool_thread_cache::pool between thread exit and pool destruction.
+static std::mutex g_registry_lock;
+
+struct pool_thread_cache {
+    typedef buffer_pool::free_block free_block;
+    typedef buffer_pool::free_list  free_list;
+
+    explicit pool_thread_cache(buffer_pool *p)
+    : pool(p),
+      pool_id(p->_id),
+      allocations(0),
+      thread_hits(0),
+      depot_hits(0),
+      misses(0),
+      bytes_cached(0)
+    {
+        for (size_t i = 0; i < buffer_pool::kClassCount; ++i) {
+            lists[i].head = WALLE_NULL;
+            lists[i].count = 0;
+        }
+    }
+
+    // only the owning thread writes the counters, a plain load/add/store
+    // keeps locked instructions off the fast path.
+    static void bump(std::atomic<uint64_t> &counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void add_cached(ptrdiff_t bytes)
+    {
+        bytes_cached.store(bytes_cached.load(std::memory_order_relaxed) + bytes,
+                           std::memory_order_relaxed);
+    }
+
+    void free_all()
+    {
+        for (size_t i = 0; i < buffer_pool::kClassCount; ++i) {
+            free_block *b = lists[i].head;
+            while (b) {
+                free_block *next = b->next;
+                std::free(b);
+                b = next;
+            }
+            lists[i].head = WALLE_NULL;
+            lists[i].count = 0;
+        }
+        bytes_cached.store(0, std::memory_order_relaxed);
+    }
+
+    std::atomic<buffer_pool*>   pool;
+    const uint64_t              pool_id;
+    free_list                   lists[buffer_pool::kClassCount];
+    std::atomic<uint64_t>       allocations;
+    std::atomic<uint64_t>       thread_hits;
+    std::atomic<uint64_t>       depot_hits;
+    std::atomic<uint64_t>       misses;
+    std::atomic<size_t>         bytes_cached;
+};
+
+/**
+ * @brief  the caches of the current thread, one per pool it used.
+ */
+struct thread_cache_table {
+    static const size_t kMaxPools = 8;
+
+    pool_thread_cache *entries[kMaxPools];
+
+    thread_cache_table()
+    {
+        for (size_t i = 0; i < kMaxPools; ++i) {
+            entries[i] = WALLE_NULL;
+        }
+    }
+
+    ~thread_cache_table()
+    {
+        for (size_t i = 0; i < kMaxPools; ++i) {
+            release(i);
+        }
+    }
+
+    void release(size_t i)
+    {
+        pool_thread_cache *tc = entries[i];
+        if (!tc) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> guard(g_registry_lock);
+            buffer_pool *pool = tc->pool.load(std::memory_order_relaxed);
+            if (pool) {
+                pool->release_thread_cache(tc);
+            }
+        }
+        // a live pool took the blocks, those of a destroyed one go to free.
+        tc->free_all();
+        delete tc;
+        entries[i] = WALLE_NULL;
+    }
+};
+
+static thread_local thread_cache_table t_caches;
+
+}
+
+buffer_pool::buffer_pool(size_t thread_cache_bytes)
+: _id(internal::g_pool_ids.fetch_add(1, std::memory_order_relaxed)),
+  _thread_cache_bytes(thread_cache_bytes),
+  _uncached_allocations(0),
+  _uncached_depot_hits(0),
+  _uncached_misses(0),
+  _oversized(0),
+  _depot_bytes(0)
+{
+    for (size_t i = 0; i < kClassCount; ++i) {
+        _depot[i].list.head = WALLE_NULL;
+        _depot[i].list.count = 0;
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        _retired[i] = 0;
+    }
+}
+
+buffer_pool::~buffer_pool()
+{
+    {
+        std::lock_guard<std::mutex> guard(internal::g_registry_lock);
+        std::lock_guard<std::mutex> caches_guard(_caches_lock);
+        // caches of live threads are only detached: their thread may be
+        // using them right now, it frees the blocks when it exits.
+        for (size_t i = 0; i < _caches.size(); ++i) {
+            _caches[i]->pool.store(WALLE_NULL, std::memory_order_relaxed);
+        }
+        _caches.clear();
+    }
+    trim();
+}
+
+buffer_pool &buffer_pool::global()
+{
+    static buffer_pool *pool = new buffer_pool();
+    return *pool;
+}
+
+internal::pool_thread_cache *buffer_pool::thread_cache()
+{
+    internal::thread_cache_table &table = internal::t_caches;
+    size_t free_slot = internal::thread_cache_table::kMaxPools;
+    for (size_t i = 0; i < internal::thread_cache_table::kMaxPools; ++i) {
+        internal::pool_thread_cache *tc = table.entries[i];
+        if (tc) {
+            if (tc->pool_id == _id) {
+                return tc;
+            }
+            if (!tc->pool.load(std::memory_order_relaxed)) {
+                // orphaned by a destroyed pool.
+                table.release(i);
+                free_slot = i;
+            }
+        } else if (free_slot == internal::thread_cache_table::kMaxPools) {
+            free_slot = i;
+        }
+    }
+    if (free_slot == internal::thread_cache_table::kMaxPools) {
+        // the thread uses too many pools, go to the depot directly.
+        return WALLE_NULL;
+    }
+    internal::pool_thread_cache *tc = new internal::pool_thread_cache(this);
+    {
+        std::lock_guard<std::mutex> guard(_caches_lock);
+        _caches.push_back(tc);
+    }
+    table.entries[free_slot] = tc;
+    return tc;
+}
+
+void *buffer_pool::allocate(size_t size)
+{
+    if (WALLE_UNLIKELY(size > kMaxBlockSize)) {
+        _oversized.fetch_add(1, std::memory_order_relaxed);
+        void *p = std::malloc(size);
+        if (!p) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+    const size_t cls = size_class(size);
+    internal::pool_thread_cache *tc = thread_cache();
+    if (WALLE_LIKELY(tc != WALLE_NULL)) {
+        internal::pool_thread_cache::bump(tc->allocations);
+        free_list &list = tc->lists[cls];
+        if (list.head) {
+            free_block *b = list.head;
+            list.head = b->next;
+            --list.count;
+            internal::pool_thread_cache::bump(tc->thread_hits);
+            tc->add_cached(-static_cast<ptrdiff_t>(kMinBlockSize << cls));
+            return b;
+        }
+    } else {
+        _uncached_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return refill(tc, cls);
+}
+
+void *buffer_pool::refill(internal::pool_thread_cache *tc, size_t cls)
+{
+    const size_t bytes = kMinBlockSize << cls;
+    const size_t batch = tc ? (class_limit(cls) + 1) / 2 : 1;
+    free_block *first = WALLE_NULL;
+    size_t taken = 0;
+    {
+        depot_class &d = _depot[cls];
+        std::lock_guard<std::mutex> guard(d.lock);
+        if (d.list.head) {
+            first = d.list.head;
+            free_block *last = first;
+            taken = 1;
+            while (taken < batch && last->next) {
+                last = last->next;
+                ++taken;
+            }
+            d.list.head = last->next;
+            d.list.count -= taken;
+            last->next = WALLE_NULL;
+        }
+    }
+    if (first) {
+        _depot_bytes.fetch_sub(taken * bytes, std::memory_order_relaxed);
+        if (tc) {
+            internal::pool_thread_cache::bump(tc->depot_hits);
+            free_list &list = tc->lists[cls];
+            list.head = first->next;
+            list.count = taken - 1;
+            tc->add_cached(static_cast<ptrdiff_t>((taken - 1) * bytes));
+        } else {
+            _uncached_depot_hits.fetch_add(1, std::memory_order_relaxed);
+        }
+        return first;
+    }
+    if (tc) {
+        internal::pool_thread_cache::bump(tc->misses);
+    } else {
+        _uncached_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    void *p = std::malloc(bytes);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void buffer_pool::deallocate(void *p, size_t size)
+{
+    if (!p) {
+        return;
+    }
+    if (WALLE_UNLIKELY(size > kMaxBlockSize)) {
+        std::free(p);
+        return;
+    }
+    const size_t cls = size_class(size);
+    free_block *b = static_cast<free_block*>(p);
+    internal::pool_thread_cache *tc = thread_cache();
+    if (WALLE_UNLIKELY(!tc)) {
+        b->next = WALLE_NULL;
+        push_depot(cls, b, b, 1);
+        return;
+    }
+    free_list &list = tc->lists[cls];
+    b->next = list.head;
+    list.head = b;
+    ++list.count;
+    tc->add_cached(static_cast<ptrdiff_t>(kMinBlockSize << cls));
+    const size_t limit = class_limit(cls);
+    if (list.count > limit) {
+        spill(tc, cls, limit / 2);
+    }
+}
+
+void buffer_pool::spill(internal::pool_thread_cache *tc, size_t cls, size_t keep)
+{
+    free_list &list = tc->lists[cls];
+    if (list.count <= keep) {
+        return;
+    }
+    free_block **link = &list.head;
+    for (size_t i = 0; i < keep; ++i) {
+        link = &(*link)->next;
+    }
+    free_block *first = *link;
+    free_block *last = first;
+    while (last->next) {
+        last = last->next;
+    }
+    const size_t count = list.count - keep;
+    *link = WALLE_NULL;
+    list.count = keep;
+    tc->add_cached(-static_cast<ptrdiff_t>(count * (kMinBlockSize << cls)));
+    push_depot(cls, first, last, count);
+}
+
+void buffer_pool::push_depot(size_t cls, free_block *first, free_block *last, size_t count)
+{
+    depot_class &d = _depot[cls];
+    {
+        std::lock_guard<std::mutex> guard(d.lock);
+        last->next = d.list.head;
+        d.list.head = first;
+        d.list.count += count;
+    }
+    _depot_bytes.fetch_add(count * (kMinBlockSize << cls), std::memory_order_relaxed);
+}
+
+void buffer_pool::flush_thread_cache()
+{
+    internal::thread_cache_table &table = internal::t_caches;
+    for (size_t i = 0; i < internal::thread_cache_table::kMaxPools; ++i) {
+        internal::pool_thread_cache *tc = table.entries[i];
+        if (tc && tc->pool_id == _id) {
+            for (size_t cls = 0; cls < kClassCount; ++cls) {
+                spill(tc, cls, 0);
+            }
+        }
+    }
+}
+
+void buffer_pool::release_thread_cache(internal::pool_thread_cache *tc)
+{
+    for (size_t cls = 0; cls < kClassCount; ++cls) {
+        spill(tc, cls, 0);
+    }
+    std::lock_guard<std::mutex> guard(_caches_lock);
+    for (size_t i = 0; i < _caches.size(); ++i) {
+        if (_caches[i] == tc) {
+            _caches[i] = _caches.back();
+            _caches.pop_back();
+            break;
+        }
+    }
+    _retired[0] += tc->allocations.load(std::memory_order_relaxed);
+    _retired[1] += tc->thread_hits.load(std::memory_order_relaxed);
+    _retired[2] += tc->depot_hits.load(std::memory_order_relaxed);
+    _retired[3] += tc->misses.load(std::memory_order_relaxed);
+    tc->pool.store(WALLE_NULL, std::memory_order_relaxed);
+}
+
+size_t buffer_pool::trim()
+{
+    flush_thread_cache();
+    size_t released = 0;
+    for (size_t cls = 0; cls < kClassCount; ++cls) {
+        free_block *b;
+        {
+            depot_class &d = _depot[cls];
+            std::lock_guard<std::mutex> guard(d.lock);
+            b = d.list.head;
+            d.list.head = WALLE_NULL;
+            d.list.count = 0;
+        }
+        while (b) {
+            free_block *next = b->next;
+            std::free(b);
+            released += kMinBlockSize << cls;
+            b = next;
+        }
+    }
+    _depot_bytes.fetch_sub(released, std::memory_order_relaxed);
+    return released;
+}
+
+buffer_pool::stats buffer_pool::get_stats() const
+{
+    stats s;
+    std::lock_guard<std::mutex> guard(_caches_lock);
+    s.allocations = _retired[0];
+    s.thread_hits = _retired[1];
+    s.depot_hits = _retired[2];
+    s.misses = _retired[3];
+    s.bytes_cached = 0;
+    for (size_t i = 0; i < _caches.size(); ++i) {
+        const internal::pool_thread_cache *tc = _caches[i];
+        s.allocations += tc->allocations.load(std::memory_order_relaxed);
+        s.thread_hits += tc->thread_hits.load(std::memory_order_relaxed);
+        s.depot_hits += tc->depot_hits.load(std::memory_order_relaxed);
+        s.misses += tc->misses.load(std::memory_order_relaxed);
+        s.bytes_cached += tc->bytes_cached.load(std::memory_order_relaxed);
+    }
+    s.allocations += _uncached_allocations.load(std::memory_order_relaxed);
+    s.depot_hits += _uncached_depot_hits.load(std::memory_order_relaxed);
+    s.misses += _uncached_misses.load(std::memory_order_relaxed);
+    s.oversized = _oversized.load(std::memory_order_relaxed);
+    s.allocations += s.oversized;
+    s.bytes_in_depot = _depot_bytes.load(std::memory_order_relaxed);
+    s.bytes_cached += s.bytes_in_depot;
+    return s;
+}
+
+}
@@ -0,0 +1,324 @@
+#include <walle/wsl/chain_buffer.h>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace wsl {
+
+namespace internal {
+
+chain_block *chain_block::create(size_t capacity)
+{
+    void *p = std::malloc(sizeof(chain_block) + capacity);
+    if (WALLE_UNLIKELY(!p)) {
+        throw std::bad_alloc();
+    }
+    return new (p) chain_block(capacity);
+}
+
+void chain_block::unref()
+{
+    if (_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        this->~chain_block();
+        std::free(this);
+    }
+}
+
+}
+
+chain_buffer::chain_buffer(size_t block_size)
+: _size(0),
+  _block_size(block_size),
+  _spare(WALLE_NULL),
+  _prepared_spare(false)
+{
+    WALLE_ASSERT_MSG(block_size > 0, "chain_buffer block size must be > 0");
+}
+
+chain_buffer::chain_buffer(const chain_buffer &other)
+: _segments(other._segments),
+  _size(other._size),
+  _block_size(other._block_size),
+  _spare(WALLE_NULL),
+  _prepared_spare(false)
+{
+    for (size_t i = 0; i < _segments.size(); ++i) {
+        _segments[i].block->ref();
+    }
+}
+
+chain_buffer::chain_buffer(chain_buffer &&other)
+: _segments(std::move(other._segments)),
+  _size(other._size),
+  _block_size(other._block_size),
+  _spare(other._spare),
+  _prepared_spare(other._prepared_spare)
+{
+    other._segments.clear();
+    other._size = 0;
+    other._spare = WALLE_NULL;
+    other._prepared_spare = false;
+}
+
+chain_buffer &chain_buffer::operator=(const chain_buffer &other)
+{
+    if (this != &other) {
+        chain_buffer tmp(other);
+        *this = std::move(tmp);
+    }
+    return *this;
+}
+
+chain_buffer &chain_buffer::operator=(chain_buffer &&other)
+{
+    if (this != &other) {
+        release();
+        _segments = std::move(other._segments);
+        _size = other._size;
+        _block_size = other._block_size;
+        _spare = other._spare;
+        _prepared_spare = other._prepared_spare;
+        other._segments.clear();
+        other._size = 0;
+        other._spare = WALLE_NULL;
+        other._prepared_spare = false;
+    }
+    return *this;
+}
+
+chain_buffer::~chain_buffer()
+{
+    release();
+}
+
+void chain_buffer::release()
+{
+    for (size_t i = 0; i < _segments.size(); ++i) {
+        _segments[i].block->unref();
+    }
+    _segments.clear();
+    _size = 0;
+    if (_spare) {
+        _spare->unref();
+        _spare = WALLE_NULL;
+    }
+    _prepared_spare = false;
+}
+
+void chain_buffer::clear()
+{
+    release();
+}
+
+size_t chain_buffer::tail_room() const
+{
+    if (_segments.empty()) {
+        return 0;
+    }
+    const segment_type &s = _segments.back();
+    if (!s.block->unique()) {
+        return 0;
+    }
+    return s.block->capacity() - s.offset - s.length;
+}
+
+void chain_buffer::append(const void *data, size_t len)
+{
+    const char *src = static_cast<const char*>(data);
+    _prepared_spare = false;
+    size_t room = tail_room();
+    if (room) {
+        segment_type &s = _segments.back();
+        const size_t n = len < room ? len : room;
+        std::memcpy(s.block->data() + s.offset + s.length, src, n);
+        s.length += n;
+        _size += n;
+        src += n;
+        len -= n;
+    }
+    while (len) {
+        internal::chain_block *b;
+        if (_spare) {
+            b = _spare;
+            _spare = WALLE_NULL;
+        } else {
+            b = internal::chain_block::create(len > _block_size ? len : _block_size);
+        }
+        const size_t n = len < b->capacity() ? len : b->capacity();
+        std::memcpy(b->data(), src, n);
+        segment_type seg = {b, 0, n};
+        _segments.push_back(seg);
+        _size += n;
+        src += n;
+        len -= n;
+    }
+}
+
+void chain_buffer::append(const chain_buffer &other)
+{
+    if (&other == this) {
+        chain_buffer tmp(other);
+        append(std::move(tmp));
+        return;
+    }
+    _prepared_spare = false;
+    for (size_t i = 0; i < other._segments.size(); ++i) {
+        other._segments[i].block->ref();
+        _segments.push_back(other._segments[i]);
+    }
+    _size += other._size;
+}
+
+void chain_buffer::append(chain_buffer &&other)
+{
+    if (&other == this) {
+        append(static_cast<const chain_buffer&>(other));
+        return;
+    }
+    _prepared_spare = false;
+    for (size_t i = 0; i < other._segments.size(); ++i) {
+        _segments.push_back(other._segments[i]);
+    }
+    _size += other._size;
+    other._segments.clear();
+    other._size = 0;
+}
+
+buffer_view<char> chain_buffer::prepare(size_t len)
+{
+    const size_t room = tail_room();
+    if (room && room >= len) {
+        _prepared_spare = false;
+        segment_type &s = _segments.back();
+        return buffer_view<char>(s.block->data() + s.offset + s.length, room);
+    }
+    if (_spare && _spare->capacity() < len) {
+        _spare->unref();
+        _spare = WALLE_NULL;
+    }
+    if (!_spare) {
+        _spare = internal::chain_block::create(len > _block_size ? len : _block_size);
+    }
+    _prepared_spare = true;
+    return buffer_view<char>(_spare->data(), _spare->capacity());
+}
+
+void chain_buffer::commit(size_t len)
+{
+    if (len == 0) {
+        return;
+    }
+    if (_prepared_spare) {
+        WALLE_ASSERT_MSG(_spare && len <= _spare->capacity(), "commit overflows the prepared space");
+        segment_type seg = {_spare, 0, len};
+        _segments.push_back(seg);
+        _spare = WALLE_NULL;
+        _prepared_spare = false;
+    } else {
+        WALLE_ASSERT_MSG(len <= tail_room(), "commit overflows the prepared space");
+        _segments.back().length += len;
+    }
+    _size += len;
+}
+
+void chain_buffer::trim_front(size_t len)
+{
+    WALLE_ASSERT_MSG(len <= _size, "trim_front overflows the chain");
+    _size -= len;
+    while (len) {
+        segment_type &s = _segments.front();
+        if (len < s.length) {
+            s.offset += len;
+            s.length -= len;
+            break;
+        }
+        len -= s.length;
+        s.block->unref();
+        _segments.pop_front();
+    }
+}
+
+void chain_buffer::trim_back(size_t len)
+{
+    WALLE_ASSERT_MSG(len <= _size, "trim_back overflows the chain");
+    _size -= len;
+    _prepared_spare = false;
+    while (len) {
+        segment_type &s = _segments.back();
+        if (len < s.length) {
+            s.length -= len;
+            break;
+        }
+        len -= s.length;
+        s.block->unref();
+        _segments.pop_back();
+    }
+}
+
+chain_buffer chain_buffer::split(size_t len)
+{
+    WALLE_ASSERT_MSG(len <= _size, "split overflows the chain");
+    chain_buffer head(_block_size);
+    head._size = len;
+    _size -= len;
+    while (len) {
+        segment_type &s = _segments.front();
+        if (len < s.length) {
+            s.block->ref();
+            segment_type part = {s.block, s.offset, len};
+            head._segments.push_back(part);
+            s.offset += len;
+            s.length -= len;
+            break;
+        }
+        len -= s.length;
+        head._segments.push_back(s);
+        _segments.pop_front();
+    }
+    return head;
+}
+
+size_t chain_buffer::to_iovec(struct iovec *iov, size_t max) const
+{
+    const size_t n = _segments.size() < max ? _segments.size() : max;
+    for (size_t i = 0; i < n; ++i) {
+        const segment_type &s = _segments[i];
+        iov[i].iov_base = s.block->data() + s.offset;
+        iov[i].iov_len = s.length;
+    }
+    return n;
+}
+
+size_t chain_buffer::copy_to(void *out, size_t len) const
+{
+    char *dst = static_cast<char*>(out);
+    size_t copied = 0;
+    for (size_t i = 0; i < _segments.size() && copied < len; ++i) {
+        const segment_type &s = _segments[i];
+        const size_t n = len - copied < s.length ? len - copied : s.length;
+        std::memcpy(dst + copied, s.block->data() + s.offset, n);
+        copied += n;
+    }
+    return copied;
+}
+
+buffer_view<const char> chain_buffer::linearize()
+{
+    if (_segments.empty()) {
+        return buffer_view<const char>();
+    }
+    if (_segments.size() > 1) {
+        internal::chain_block *b = internal::chain_block::create(_size);
+        copy_to(b->data(), _size);
+        for (size_t i = 0; i < _segments.size(); ++i) {
+            _segments[i].block->unref();
+        }
+        _segments.clear();
+        segment_type seg = {b, 0, _size};
+        _segments.push_back(seg);
+    }
+    return segment(0);
+}
+
+}
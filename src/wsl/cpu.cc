@@ -0,0 +1,50 @@
+#include <walle/wsl/internal/cpu.h>
+
+namespace wsl {
+namespace internal {
+
+namespace {
+
+struct cpu_features {
+    bool ssse3;
+    bool avx2;
+
+    cpu_features()
+    {
+        __builtin_cpu_init();
+        ssse3 = __builtin_cpu_supports("ssse3");
+        // the features of WALLE_TARGET_AVX2.
+        avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi");
+    }
+};
+
+const cpu_features &features()
+{
+    static const cpu_features f;
+    return f;
+}
+
+}
+
+bool cpu_has_ssse3()
+{
+    return features().ssse3;
+}
+
+bool cpu_has_avx2()
+{
+    return features().avx2;
+}
+
+bool cpu_supports(simd_isa isa)
+{
+    return isa == kSimdSse2 || (isa == kSimdAvx2 && cpu_has_avx2());
+}
+
+simd_isa best_simd_isa()
+{
+    return cpu_has_avx2() ? kSimdAvx2 : kSimdSse2;
+}
+
+}
+}
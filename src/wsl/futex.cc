@@ -0,0 +1,35 @@
+#include <walle/wsl/internal/futex.h>
+#include <cerrno>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace wsl {
+namespace internal {
+
+WALLE_STATIC_ASSERT(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                    "futex words must be plain 32 bit integers");
+
+bool futex_wait(std::atomic<uint32_t> *word, uint32_t expected, int64_t timeout_ns)
+{
+    struct timespec ts;
+    struct timespec *pts = WALLE_NULL;
+    if (timeout_ns >= 0) {
+        ts.tv_sec = timeout_ns / 1000000000;
+        ts.tv_nsec = timeout_ns % 1000000000;
+        pts = &ts;
+    }
+    const long rc = syscall(SYS_futex, reinterpret_cast<uint32_t*>(word),
+                            FUTEX_WAIT_PRIVATE, expected, pts, WALLE_NULL, 0);
+    return rc == 0 || errno != ETIMEDOUT;
+}
+
+void futex_wake(std::atomic<uint32_t> *word, int count)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word),
+            FUTEX_WAKE_PRIVATE, count, WALLE_NULL, WALLE_NULL, 0);
+}
+
+}
+}
@@ -0,0 +1,516 @@
+#include <walle/wsl/multi_matcher.h>
+#include <walle/wsl/ascii.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace wsl {
+
+namespace {
+
+// free slot / no output, the same value as multi_matcher::kFree.
+const uint32_t kNone = 0xffffffffu;
+
+// the trie before it is laid out, children in ascending class order.
+struct trie_node {
+    uint32_t first_child;
+    uint32_t last_child;
+    uint32_t next_sibling;
+    uint32_t cls;
+    uint32_t outputs;       // first index in the sorted pattern ids, kNone.
+    uint32_t output_count;
+};
+
+struct folded_less {
+    const std::string *text;
+    const std::vector<size_t> *ends;
+
+    string_view at(uint32_t id) const
+    {
+        const size_t begin = id ? (*ends)[id - 1] : 0;
+        return string_view(text->data() + begin, (*ends)[id] - begin);
+    }
+
+    bool operator()(uint32_t a, uint32_t b) const
+    {
+        const string_view x = at(a);
+        const string_view y = at(b);
+        const int r = std::memcmp(x.data(), y.data(), std::min(x.size(), y.size()));
+        return r < 0 || (r == 0 && (x.size() < y.size() || (x.size() == y.size() && a < b)));
+    }
+};
+
+// slots not holding a state yet, in a doubly linked list so placement only
+// visits free slots. a slot that was probed often without fitting is taken
+// off the list for good, it stays an unused hole.
+class slot_allocator {
+public:
+    static const uint32_t kMaxProbes = 256;
+    static const uint8_t kRetireAfter = 32;
+
+    explicit slot_allocator(std::vector<uint32_t> &check)
+    : _check(check),
+      _head(kNone),
+      _tail(kNone)
+    {
+
+    }
+
+    void grow(size_t size)
+    {
+        const size_t old = _check.size();
+        if (size <= old) {
+            return;
+        }
+        _check.resize(size, kNone);
+        _next.resize(size, kNone);
+        _prev.resize(size, kNone);
+        _probes.resize(size, 0);
+        for (size_t i = old; i < size; ++i) {
+            link(static_cast<uint32_t>(i));
+        }
+    }
+
+    void take(uint32_t slot, uint32_t parent)
+    {
+        _check[slot] = parent;
+        unlink(slot);
+    }
+
+    // a base for children on the given ascending classes.
+    uint32_t find_base(const uint32_t *classes, size_t k)
+    {
+        uint32_t probes = 0;
+        for (uint32_t pos = _head; pos != kNone && probes < kMaxProbes; ++probes) {
+            const uint32_t next = _next[pos];
+            if (pos >= classes[0]) {
+                const uint32_t base = pos - classes[0];
+                if (fits(base, classes, k)) {
+                    return base;
+                }
+            }
+            if (++_probes[pos] >= kRetireAfter) {
+                unlink(pos);
+            }
+            pos = next;
+        }
+        // past the end, the new slots are free.
+        const uint32_t base = static_cast<uint32_t>(_check.size());
+        grow(base + classes[k - 1] + 1);
+        return base;
+    }
+
+private:
+    bool fits(uint32_t base, const uint32_t *classes, size_t k)
+    {
+        grow(base + classes[k - 1] + 1);
+        for (size_t i = 0; i < k; ++i) {
+            if (_check[base + classes[i]] != kNone) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void link(uint32_t slot)
+    {
+        _prev[slot] = _tail;
+        _next[slot] = kNone;
+        if (_tail != kNone) {
+            _next[_tail] = slot;
+        } else {
+            _head = slot;
+        }
+        _tail = slot;
+    }
+
+    void unlink(uint32_t slot)
+    {
+        if (_prev[slot] == kNone && _head != slot) {
+            return;
+        }
+        if (_prev[slot] != kNone) {
+            _next[_prev[slot]] = _next[slot];
+        } else {
+            _head = _next[slot];
+        }
+        if (_next[slot] != kNone) {
+            _prev[_next[slot]] = _prev[slot];
+        } else {
+            _tail = _prev[slot];
+        }
+        _prev[slot] = _next[slot] = kNone;
+    }
+
+    std::vector<uint32_t>  &_check;
+    std::vector<uint32_t>   _next;
+    std::vector<uint32_t>   _prev;
+    std::vector<uint8_t>    _probes;
+    uint32_t                _head;
+    uint32_t                _tail;
+};
+
+}
+
+multi_matcher::multi_matcher(bool ignore_case)
+: _ignore_case(ignore_case),
+  _compiled(false),
+  _state_count(0),
+  _max_size(0),
+  _class_count(1)
+{
+    std::memset(_classes, 0, sizeof(_classes));
+}
+
+const uint32_t multi_matcher::kRootState;
+
+uint32_t multi_matcher::add(string_view pattern)
+{
+    WALLE_ASSERT_MSG(!pattern.empty(), "empty pattern");
+    _patterns.append(pattern.data(), pattern.size());
+    _pattern_ends.push_back(_patterns.size());
+    _compiled = false;
+    return static_cast<uint32_t>(_pattern_ends.size() - 1);
+}
+
+void multi_matcher::compile()
+{
+    // byte classes, in byte order so sorting folded patterns by bytes sorts
+    // them by classes too.
+    std::string folded(_patterns);
+    if (_ignore_case && !folded.empty()) {
+        ascii::to_lower(buffer_view<char>(&folded[0], folded.size()));
+    }
+    bool present[256] = {false};
+    for (size_t i = 0; i < folded.size(); ++i) {
+        present[static_cast<uint8_t>(folded[i])] = true;
+    }
+    uint32_t class_of[256];
+    uint32_t class_count = 1;
+    for (int b = 0; b < 256; ++b) {
+        class_of[b] = present[b] ? class_count++ : 0;
+    }
+    for (int b = 0; b < 256; ++b) {
+        _classes[b] = static_cast<uint16_t>(class_of[_ignore_case ? ascii::to_lower(b) : b]);
+    }
+
+    // the trie, built from the sorted patterns so each new node is the last
+    // child of its parent.
+    std::vector<uint32_t> order(_pattern_ends.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    folded_less less = {&folded, &_pattern_ends};
+    std::sort(order.begin(), order.end(), less);
+
+    std::vector<trie_node> trie;
+    const trie_node empty = {kNone, kNone, kNone, 0, kNone, 0};
+    trie.push_back(empty);
+    std::vector<uint32_t> path(1, 0);
+    string_view prev;
+    for (size_t i = 0; i < order.size(); ++i) {
+        const string_view p = less.at(order[i]);
+        size_t common = 0;
+        while (common < p.size() && common < prev.size() && p[common] == prev[common]) {
+            ++common;
+        }
+        path.resize(common + 1);
+        for (size_t d = common; d < p.size(); ++d) {
+            trie_node n = empty;
+            n.cls = class_of[static_cast<uint8_t>(p[d])];
+            const uint32_t id = static_cast<uint32_t>(trie.size());
+            trie_node &parent = trie[path[d]];
+            if (parent.last_child == kNone) {
+                parent.first_child = id;
+            } else {
+                trie[parent.last_child].next_sibling = id;
+            }
+            parent.last_child = id;
+            trie.push_back(n);
+            path.push_back(id);
+        }
+        trie_node &leaf = trie[path[p.size()]];
+        if (leaf.outputs == kNone) {
+            leaf.outputs = static_cast<uint32_t>(i);
+        }
+        ++leaf.output_count;
+        prev = p;
+    }
+    _state_count = trie.size();
+    _max_size = 0;
+    for (size_t i = 0; i < _pattern_ends.size(); ++i) {
+        _max_size = std::max(_max_size, pattern(static_cast<uint32_t>(i)).size());
+    }
+
+    // double array layout in breadth first order, failure links follow the
+    // same order since a failure target is always shallower.
+    std::vector<uint32_t> check;
+    std::vector<uint32_t> base;
+    slot_allocator slots(check);
+    slots.grow(trie.size() + class_count + 1);
+    slots.take(0, 0);
+    _fail.assign(check.size(), 0);
+    _dict.assign(check.size(), 0);
+    _output_begin.assign(check.size(), kNone);
+    _outputs.clear();
+    _outputs.reserve(order.size());
+    base.assign(check.size(), 0);
+    uint32_t root_child[257] = {0};
+
+    std::vector<uint32_t> queue(1, 0);        // trie nodes
+    std::vector<uint32_t> state_of(trie.size(), 0);
+    std::vector<uint32_t> classes;
+    for (size_t q = 0; q < queue.size(); ++q) {
+        const uint32_t u = queue[q];
+        const uint32_t su = state_of[u];
+        classes.clear();
+        for (uint32_t v = trie[u].first_child; v != kNone; v = trie[v].next_sibling) {
+            classes.push_back(trie[v].cls);
+        }
+        uint32_t b = 0;
+        if (!classes.empty()) {
+            b = su == 0 ? 0 : slots.find_base(classes.data(), classes.size());
+            if (check.size() > _fail.size()) {
+                _fail.resize(check.size(), 0);
+                _dict.resize(check.size(), 0);
+                _output_begin.resize(check.size(), kNone);
+                base.resize(check.size(), 0);
+            }
+        }
+        base[su] = b;
+        for (uint32_t v = trie[u].first_child; v != kNone; v = trie[v].next_sibling) {
+            const uint32_t c = trie[v].cls;
+            const uint32_t sv = b + c;
+            slots.take(sv, su);
+            state_of[v] = sv;
+            queue.push_back(v);
+            uint32_t f = 0;
+            if (su == 0) {
+                root_child[c] = sv;
+            } else {
+                for (uint32_t g = _fail[su];; g = _fail[g]) {
+                    if (g == 0) {
+                        f = root_child[c];
+                        break;
+                    }
+                    const uint32_t t = base[g] + c;
+                    if (t < check.size() && check[t] == g) {
+                        f = t;
+                        break;
+                    }
+                }
+            }
+            _fail[sv] = f;
+            _dict[sv] = _output_begin[f] != kNone ? f : _dict[f];
+            if (trie[v].outputs != kNone) {
+                _output_begin[sv] = static_cast<uint32_t>(_outputs.size());
+                for (uint32_t k = 0; k < trie[v].output_count; ++k) {
+                    _outputs.push_back(order[trie[v].outputs + k]);
+                }
+                _outputs.back() |= kLastOutput;
+            }
+        }
+    }
+
+    // every base + class lookup stays inside the array.
+    uint32_t max_base = 0;
+    for (size_t i = 0; i < base.size(); ++i) {
+        max_base = std::max(max_base, base[i]);
+    }
+    const size_t size = std::max(check.size(), size_t(max_base) + class_count);
+    _class_count = class_count;
+    check.resize(size, kNone);
+    _fail.resize(size, 0);
+    _dict.resize(size, 0);
+    _output_begin.resize(size, kNone);
+    base.resize(size, 0);
+    _nodes.resize(size);
+    for (size_t s = 0; s < size; ++s) {
+        const bool output = check[s] != kNone && s != 0 &&
+                            (_output_begin[s] != kNone || _dict[s] != 0);
+        _nodes[s].base = base[s] | (output ? kHasOutput : 0);
+        _nodes[s].check = s == 0 ? kNone : check[s];
+    }
+
+    // full rows for the first states in breadth first order. a failure
+    // target is shallower than its state so it has a row already.
+    const size_t rows = std::max<size_t>(1, std::min(queue.size(), kDenseBytes / (class_count * 4)));
+    std::vector<uint32_t> row_of(size, kNone);
+    _dense_state.resize(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        _dense_state[r] = state_of[queue[r]];
+        row_of[_dense_state[r]] = static_cast<uint32_t>(r);
+    }
+    std::vector<uint32_t> tagged(size);
+    for (size_t s = 0; s < size; ++s) {
+        const uint32_t output = _nodes[s].base & kHasOutput;
+        tagged[s] = row_of[s] != kNone ? output | kDenseState | (row_of[s] * class_count)
+                                       : output | static_cast<uint32_t>(s);
+    }
+    _dense.assign(rows * class_count, tagged[0]);
+    for (size_t r = 0; r < rows; ++r) {
+        const uint32_t s = _dense_state[r];
+        uint32_t *row = &_dense[r * class_count];
+        const uint32_t *fallback = s == 0 ? WALLE_NULL : &_dense[row_of[_fail[s]] * class_count];
+        for (uint32_t c = 1; c < class_count; ++c) {
+            const uint32_t t = base[s] + c;
+            row[c] = check[t] == s ? tagged[t] : fallback ? fallback[c] : tagged[0];
+        }
+    }
+    for (size_t s = 0; s < size; ++s) {
+        _fail[s] = tagged[_fail[s]];
+    }
+    std::vector<uint32_t>(_fail).swap(_fail);
+    std::vector<uint32_t>(_dense_state).swap(_dense_state);
+    std::vector<uint32_t>(_dict).swap(_dict);
+    std::vector<uint32_t>(_output_begin).swap(_output_begin);
+    _compiled = true;
+}
+
+size_t multi_matcher::memory_usage() const
+{
+    return _nodes.capacity() * sizeof(node) +
+           (_dense.capacity() + _fail.capacity() + _dict.capacity() + _output_begin.capacity() +
+            _outputs.capacity()) * sizeof(uint32_t) + sizeof(_classes);
+}
+
+bool multi_matcher::report(uint32_t s, size_t end, const callback_type &on_match, size_t &count) const
+{
+    const uint32_t u = s & kDenseState ? _dense_state[(s & kStateMask) / _class_count] : s & kStateMask;
+    for (uint32_t t = _output_begin[u] != kNone ? u : _dict[u]; t; t = _dict[t]) {
+        for (uint32_t k = _output_begin[t];; ++k) {
+            const uint32_t id = _outputs[k] & ~kLastOutput;
+            const size_t begin = id ? _pattern_ends[id - 1] : 0;
+            ++count;
+            if (!on_match(id, end - (_pattern_ends[id] - begin))) {
+                return false;
+            }
+            if (_outputs[k] & kLastOutput) {
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+size_t multi_matcher::scan(uint32_t &state, const char *p, size_t n, size_t offset,
+                           const callback_type &on_match, bool &stopped) const
+{
+    size_t count = 0;
+    size_t i = 0;
+    if (n >= kLanes * kLaneBytes && _max_size != 0 && _max_size <= kLaneBytes) {
+        // window by window, a short rest joins the last window.
+        while (i < n) {
+            const size_t w = n - i < kWindowBytes + kLanes * kLaneBytes ? n - i : kWindowBytes;
+            count += scan_lanes(state, p + i, w, offset + i, on_match, stopped);
+            if (stopped) {
+                return count;
+            }
+            i += w;
+        }
+        return count;
+    }
+    uint32_t s = state;
+    for (; i < n; ++i) {
+        s = step(s, static_cast<uint8_t>(p[i]));
+        if (WALLE_UNLIKELY(s & kOutputState) && !report(s, offset + i + 1, on_match, count)) {
+            stopped = true;
+            break;
+        }
+    }
+    state = s;
+    return count;
+}
+
+size_t multi_matcher::scan_lanes(uint32_t &state, const char *p, size_t n, size_t offset,
+                                 const callback_type &on_match, bool &stopped) const
+{
+    // lane j covers [begin[j], begin[j] + lane), the last one also the rest.
+    // the first lane reports as it goes, the others keep their hits until
+    // the lanes before them are done. n is one window, so are the hits.
+    const size_t lane = n / kLanes;
+    size_t begin[kLanes];
+    uint32_t s[kLanes];
+    std::vector<std::pair<size_t, uint32_t> > hits[kLanes];
+    for (size_t j = 0; j < kLanes; ++j) {
+        begin[j] = j * lane;
+        s[j] = j == 0 ? state : kRootState;
+        for (size_t i = j == 0 ? begin[j] : begin[j] - (_max_size - 1); i < begin[j]; ++i) {
+            s[j] = step(s[j], static_cast<uint8_t>(p[i]));
+        }
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < lane; ++i) {
+        for (size_t j = 0; j < kLanes; ++j) {
+            s[j] = step(s[j], static_cast<uint8_t>(p[begin[j] + i]));
+        }
+        uint32_t any = 0;
+        for (size_t j = 0; j < kLanes; ++j) {
+            any |= s[j];
+        }
+        if (WALLE_UNLIKELY(any & kOutputState)) {
+            if ((s[0] & kOutputState) && !report(s[0], offset + begin[0] + i + 1, on_match, count)) {
+                state = s[0];
+                stopped = true;
+                return count;
+            }
+            for (size_t j = 1; j < kLanes; ++j) {
+                if (s[j] & kOutputState) {
+                    hits[j].push_back(std::make_pair(begin[j] + i + 1, s[j]));
+                }
+            }
+        }
+    }
+    uint32_t &last = s[kLanes - 1];
+    for (size_t i = begin[kLanes - 1] + lane; i < n; ++i) {
+        last = step(last, static_cast<uint8_t>(p[i]));
+        if (last & kOutputState) {
+            hits[kLanes - 1].push_back(std::make_pair(i + 1, last));
+        }
+    }
+    for (size_t j = 1; j < kLanes; ++j) {
+        for (size_t k = 0; k < hits[j].size(); ++k) {
+            if (!report(hits[j][k].second, offset + hits[j][k].first, on_match, count)) {
+                state = hits[j][k].second;
+                stopped = true;
+                return count;
+            }
+        }
+    }
+    state = last;
+    return count;
+}
+
+size_t multi_matcher::match(string_view text, const callback_type &on_match) const
+{
+    WALLE_ASSERT_MSG(_compiled, "multi_matcher used before compile()");
+    uint32_t state = kRootState;
+    bool stopped = false;
+    return scan(state, text.data(), text.size(), 0, on_match, stopped);
+}
+
+bool multi_matcher::contains_any(string_view text) const
+{
+    WALLE_ASSERT_MSG(_compiled, "multi_matcher used before compile()");
+    uint32_t s = kRootState;
+    for (size_t i = 0; i < text.size(); ++i) {
+        s = step(s, static_cast<uint8_t>(text[i]));
+        if (s & kOutputState) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool multi_matcher::stream::feed(string_view chunk, const callback_type &on_match)
+{
+    WALLE_ASSERT_MSG(_matcher->_compiled, "multi_matcher used before compile()");
+    if (_stopped) {
+        return false;
+    }
+    _matcher->scan(_state, chunk.data(), chunk.size(), _offset, on_match, _stopped);
+    _offset += chunk.size();
+    return !_stopped;
+}
+
+}
@@ -0,0 +1,12 @@
+#include <walle/wsl/internal/raw_hash_table.h>
+
+namespace wsl {
+namespace internal {
+
+const ctrl_t kEmptyGroup[16] = {
+    kCtrlSentinel, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty,
+    kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty, kCtrlEmpty
+};
+
+}
+}
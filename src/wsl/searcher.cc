@@ -0,0 +1,464 @@
+#include <walle/wsl/searcher.h>
+#include <walle/wsl/internal/string_search.h>
+#include <algorithm>
+#include <cstring>
+#include <immintrin.h>
+
+namespace wsl {
+
+namespace {
+
+// a verification charges kVerifyCost plus the bytes it compared, scanning
+// earns kScanCredit per byte skipped. running out of fuel means candidates
+// are too frequent for the skip loop to pay off and the rest goes to
+// two-way. the verification work is bounded by kScanCredit * n plus the
+// initial fuel either way.
+const int64_t kScanCredit = 4;
+const int64_t kVerifyCost = 16;
+const int64_t kInitialFuel = 4096;
+
+// rough frequency of each byte in text and logs, higher is more common.
+struct byte_ranks {
+    uint8_t rank[256];
+
+    byte_ranks()
+    {
+        static const char kLetters[] = "etaoinshrdlcumwfgypbvkjxqz";
+        for (int c = 0; c < 256; ++c) {
+            if (c >= 0x80) {
+                rank[c] = 16;
+            } else if (c >= 'A' && c <= 'Z') {
+                rank[c] = 96;
+            } else if (c >= '0' && c <= '9') {
+                rank[c] = 128;
+            } else if (c > ' ' && c < 0x7f) {
+                rank[c] = 64;
+            } else {
+                rank[c] = 0;
+            }
+        }
+        for (size_t i = 0; i < sizeof(kLetters) - 1; ++i) {
+            rank[static_cast<uint8_t>(kLetters[i])] = static_cast<uint8_t>(250 - 3 * i);
+        }
+        static const char kCommonPunct[] = ".:-/_,=\"[]()";
+        for (size_t i = 0; i < sizeof(kCommonPunct) - 1; ++i) {
+            rank[static_cast<uint8_t>(kCommonPunct[i])] = 140;
+        }
+        rank[static_cast<uint8_t>(' ')] = 255;
+        rank[static_cast<uint8_t>('\n')] = 120;
+        rank[static_cast<uint8_t>('\t')] = 100;
+    }
+};
+
+const byte_ranks &ranks()
+{
+    static const byte_ranks r;
+    return r;
+}
+
+inline uint32_t ctz(uint32_t v)
+{
+    return static_cast<uint32_t>(__builtin_ctz(v));
+}
+
+// bytes of needle matching at p, m for a match.
+inline size_t match_length(const char *p, const char *needle, size_t m)
+{
+    size_t i = 0;
+    for (; i + 8 <= m; i += 8) {
+        uint64_t a, b;
+        std::memcpy(&a, p + i, 8);
+        std::memcpy(&b, needle + i, 8);
+        if (a != b) {
+            return i + (static_cast<size_t>(__builtin_ctzll(a ^ b)) >> 3);
+        }
+    }
+    for (; i < m && p[i] == needle[i]; ++i) {
+    }
+    return i;
+}
+
+struct prefilter_args {
+    const char *needle;
+    size_t      m;
+    size_t      rare1;
+    size_t      rare2;
+};
+
+// candidate scan over [i, last], the results of the vector kernels.
+// returns the match, or null with *resume set when fuel runs out.
+const char *prefilter_scalar(const char *p, size_t i, size_t last, const prefilter_args &a,
+                             int64_t &fuel, const char **resume)
+{
+    const char c1 = a.needle[a.rare1];
+    const char c2 = a.needle[a.rare2];
+    for (; i <= last; ++i) {
+        if (p[i + a.rare1] == c1 && p[i + a.rare2] == c2) {
+            const size_t matched = match_length(p + i, a.needle, a.m);
+            if (matched == a.m) {
+                return p + i;
+            }
+            fuel -= kVerifyCost + static_cast<int64_t>(matched);
+            if (fuel < 0) {
+                *resume = p + i + 1;
+                return WALLE_NULL;
+            }
+        }
+        fuel += kScanCredit;
+    }
+    return WALLE_NULL;
+}
+
+inline uint32_t eq_mask_sse2(const char *p, __m128i v)
+{
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), v)));
+}
+
+// verify the candidates of a block, false when fuel runs out.
+inline bool verify_block(const char *p, size_t i, uint32_t mask, const prefilter_args &a,
+                         int64_t &fuel, const char **match)
+{
+    while (mask) {
+        const char *candidate = p + i + ctz(mask);
+        const size_t matched = match_length(candidate, a.needle, a.m);
+        if (matched == a.m) {
+            *match = candidate;
+            return true;
+        }
+        fuel -= kVerifyCost + static_cast<int64_t>(matched);
+        mask &= mask - 1;
+    }
+    return fuel >= 0;
+}
+
+const char *prefilter_sse2(const char *p, size_t n, const prefilter_args &a, const char **resume)
+{
+    const size_t last = n - a.m;
+    int64_t fuel = kInitialFuel;
+    if (last + 1 < 16) {
+        return prefilter_scalar(p, 0, last, a, fuel, resume);
+    }
+    const __m128i v1 = _mm_set1_epi8(a.needle[a.rare1]);
+    const __m128i v2 = _mm_set1_epi8(a.needle[a.rare2]);
+    const char *match = WALLE_NULL;
+    size_t i = 0;
+    for (; i + 16 <= last + 1; i += 16) {
+        const uint32_t mask = eq_mask_sse2(p + i + a.rare1, v1) & eq_mask_sse2(p + i + a.rare2, v2);
+        if (!verify_block(p, i, mask, a, fuel, &match)) {
+            *resume = p + i + 16;
+            return WALLE_NULL;
+        }
+        if (match) {
+            return match;
+        }
+        fuel += kScanCredit * 16;
+    }
+    if (i <= last) {
+        // the last block overlaps candidates already checked, mask them off.
+        const size_t s = last + 1 - 16;
+        const uint32_t mask = eq_mask_sse2(p + s + a.rare1, v1) & eq_mask_sse2(p + s + a.rare2, v2) &
+                              (0xffffu << (i - s));
+        verify_block(p, s, mask, a, fuel, &match);
+    }
+    return match;
+}
+
+WALLE_TARGET_AVX2 inline uint32_t eq_mask_avx2(const char *p, __m256i v)
+{
+    return static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), v)));
+}
+
+WALLE_TARGET_AVX2 const char *prefilter_avx2(const char *p, size_t n, const prefilter_args &a,
+                                             const char **resume)
+{
+    const size_t last = n - a.m;
+    if (last + 1 < 32) {
+        return prefilter_sse2(p, n, a, resume);
+    }
+    int64_t fuel = kInitialFuel;
+    const __m256i v1 = _mm256_set1_epi8(a.needle[a.rare1]);
+    const __m256i v2 = _mm256_set1_epi8(a.needle[a.rare2]);
+    const char *match = WALLE_NULL;
+    size_t i = 0;
+    for (; i + 32 <= last + 1; i += 32) {
+        const uint32_t mask = eq_mask_avx2(p + i + a.rare1, v1) & eq_mask_avx2(p + i + a.rare2, v2);
+        if (mask) {
+            if (!verify_block(p, i, mask, a, fuel, &match)) {
+                *resume = p + i + 32;
+                return WALLE_NULL;
+            }
+            if (match) {
+                return match;
+            }
+        }
+        fuel += kScanCredit * 32;
+    }
+    if (i <= last) {
+        const size_t s = last + 1 - 32;
+        const uint32_t mask = eq_mask_avx2(p + s + a.rare1, v1) & eq_mask_avx2(p + s + a.rare2, v2) &
+                              (0xffffffffu << (i - s));
+        verify_block(p, s, mask, a, fuel, &match);
+    }
+    return match;
+}
+
+}
+
+searcher::searcher()
+: _algo(kEmpty),
+  _rare1(0),
+  _rare2(0),
+  _split(0),
+  _period(0),
+  _memory(0)
+{
+
+}
+
+searcher::searcher(string_view needle, algorithm algo)
+: _needle(needle.data(), needle.size()),
+  _algo(algo),
+  _rare1(0),
+  _rare2(0),
+  _split(0),
+  _period(0),
+  _memory(0)
+{
+    const size_t m = _needle.size();
+    if (m == 0) {
+        _algo = kEmpty;
+        return;
+    }
+    if (m == 1) {
+        _algo = kByte;
+        return;
+    }
+    init_horspool();
+    if (_algo == kAuto || _algo == kEmpty || _algo == kByte) {
+        size_t shift = 0;
+        for (size_t i = 0; i < m; ++i) {
+            shift += _skip[static_cast<uint8_t>(_needle[i])];
+        }
+        _algo = shift >= kHorspoolMinShift * m ? kHorspool : kPrefilter;
+    }
+    // two-way is the fallback of the other algorithms.
+    init_two_way();
+    if (_algo == kPrefilter) {
+        // rarity is the byte's rank, ties go to the byte repeated least in
+        // the needle itself.
+        const byte_ranks &r = ranks();
+        const uint8_t *s = reinterpret_cast<const uint8_t*>(_needle.data());
+        uint32_t score[256];
+        std::memset(score, 0, sizeof(score));
+        for (size_t i = 0; i < m; ++i) {
+            score[s[i]] = (uint32_t(r.rank[s[i]]) << 16) | ((score[s[i]] & 0xffff) + (score[s[i]] < 0xffff));
+        }
+        for (size_t i = 1; i < m; ++i) {
+            if (score[s[i]] < score[s[_rare1]]) {
+                _rare1 = i;
+            }
+        }
+        // the second rare byte must sit elsewhere and should differ in value.
+        _rare2 = _rare1 == 0 ? 1 : 0;
+        for (size_t i = 0; i < m; ++i) {
+            if (i == _rare1) {
+                continue;
+            }
+            const bool same = s[i] == s[_rare1];
+            const bool cur_same = s[_rare2] == s[_rare1];
+            if ((cur_same && !same) || (same == cur_same && score[s[i]] < score[s[_rare2]])) {
+                _rare2 = i;
+            }
+        }
+    }
+}
+
+void searcher::init_two_way()
+{
+    const uint8_t *x = reinterpret_cast<const uint8_t*>(_needle.data());
+    const size_t m = _needle.size();
+    // maximal suffix for both byte orders, the later one starts the right
+    // half of a critical factorization. ip is one before the suffix start,
+    // size_t(-1) for the whole needle.
+    size_t ip = size_t(-1), jp = 0, k = 1, p = 1;
+    while (jp + k < m) {
+        if (x[ip + k] == x[jp + k]) {
+            if (k == p) {
+                jp += p;
+                k = 1;
+            } else {
+                ++k;
+            }
+        } else if (x[ip + k] > x[jp + k]) {
+            jp += k;
+            k = 1;
+            p = jp - ip;
+        } else {
+            ip = jp++;
+            k = p = 1;
+        }
+    }
+    const size_t ms1 = ip;
+    const size_t p1 = p;
+    ip = size_t(-1);
+    jp = 0;
+    k = p = 1;
+    while (jp + k < m) {
+        if (x[ip + k] == x[jp + k]) {
+            if (k == p) {
+                jp += p;
+                k = 1;
+            } else {
+                ++k;
+            }
+        } else if (x[ip + k] < x[jp + k]) {
+            jp += k;
+            k = 1;
+            p = jp - ip;
+        } else {
+            ip = jp++;
+            k = p = 1;
+        }
+    }
+    if (ip + 1 <= ms1 + 1) {
+        ip = ms1;
+        p = p1;
+    }
+    _split = ip + 1;
+    if (std::memcmp(x, x + p, _split) == 0) {
+        // periodic: after a shift by the period the first m - p bytes match.
+        _period = p;
+        _memory = m - p;
+    } else {
+        _period = std::max(_split - 1, m - _split) + 1;
+        _memory = 0;
+    }
+    std::memset(_shift, 0, sizeof(_shift));
+    for (size_t i = 0; i < m; ++i) {
+        _shift[x[i]] = i + 1;
+    }
+}
+
+void searcher::init_horspool()
+{
+    const size_t m = _needle.size();
+    for (size_t c = 0; c < 256; ++c) {
+        _skip[c] = m;
+    }
+    for (size_t i = 0; i + 1 < m; ++i) {
+        _skip[static_cast<uint8_t>(_needle[i])] = m - 1 - i;
+    }
+}
+
+searcher::size_type searcher::find(string_view haystack, size_type pos) const
+{
+    if (pos > haystack.size()) {
+        return string_view::npos;
+    }
+    const char *p = haystack.data() + pos;
+    const size_t n = haystack.size() - pos;
+    const size_t m = _needle.size();
+    if (m > n) {
+        return string_view::npos;
+    }
+    const char *r;
+    switch (_algo) {
+    case kEmpty:
+        return pos;
+    case kByte:
+        r = internal::simd_find(p, n, _needle[0]);
+        break;
+    case kPrefilter:
+        r = find_prefilter(p, n);
+        break;
+    case kHorspool:
+        r = find_horspool(p, n);
+        break;
+    default:
+        r = find_two_way(p, n);
+        break;
+    }
+    return r ? static_cast<size_type>(r - haystack.data()) : string_view::npos;
+}
+
+const char *searcher::find_prefilter(const char *p, size_t n) const
+{
+    prefilter_args a;
+    a.needle = _needle.data();
+    a.m = _needle.size();
+    a.rare1 = _rare1;
+    a.rare2 = _rare2;
+    const char *resume = WALLE_NULL;
+    const char *r = internal::current_search_isa() == internal::kSimdAvx2 ?
+                    prefilter_avx2(p, n, a, &resume) : prefilter_sse2(p, n, a, &resume);
+    if (resume) {
+        return find_two_way(resume, static_cast<size_t>(p + n - resume));
+    }
+    return r;
+}
+
+const char *searcher::find_horspool(const char *p, size_t n) const
+{
+    const size_t m = _needle.size();
+    const char last = _needle[m - 1];
+    int64_t fuel = kInitialFuel;
+    size_t i = 0;
+    while (i + m <= n) {
+        const char c = p[i + m - 1];
+        if (c == last) {
+            const size_t matched = match_length(p + i, _needle.data(), m - 1);
+            if (matched == m - 1) {
+                return p + i;
+            }
+            fuel -= kVerifyCost + static_cast<int64_t>(matched);
+            if (fuel < 0) {
+                return find_two_way(p + i, n - i);
+            }
+        }
+        const size_t s = _skip[static_cast<uint8_t>(c)];
+        i += s;
+        fuel += kScanCredit * static_cast<int64_t>(s);
+    }
+    return WALLE_NULL;
+}
+
+const char *searcher::find_two_way(const char *p, size_t n) const
+{
+    const uint8_t *x = reinterpret_cast<const uint8_t*>(_needle.data());
+    const uint8_t *h = reinterpret_cast<const uint8_t*>(p);
+    const size_t m = _needle.size();
+    // bytes of the window known to match from the previous shift.
+    size_t mem = 0;
+    size_t i = 0;
+    while (n - i >= m) {
+        const uint8_t *w = h + i;
+        // bad character shift on the window's last byte first.
+        size_t k = m - _shift[w[m - 1]];
+        if (k) {
+            i += k < mem ? mem : k;
+            mem = 0;
+            continue;
+        }
+        // right half, left to right.
+        for (k = std::max(_split, mem); k < m && x[k] == w[k]; ++k) {
+        }
+        if (k < m) {
+            i += k - _split + 1;
+            mem = 0;
+            continue;
+        }
+        // left half, right to left.
+        for (k = _split; k > mem && x[k - 1] == w[k - 1]; --k) {
+        }
+        if (k <= mem) {
+            return p + i;
+        }
+        i += _period;
+        mem = _memory;
+    }
+    return WALLE_NULL;
+}
+
+}
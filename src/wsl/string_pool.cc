@@ -0,0 +1,197 @@
+#include <walle/wsl/string_pool.h>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace wsl {
+
+const WALLE_CONSTEXPR string_pool::symbol string_pool::kNoSymbol;
+
+static const size_t kInitialTableSize = 1024;
+
+string_pool::string_pool(size_t arena_size)
+: _arena_size(arena_size < 256 ? 256 : arena_size),
+  _table(make_table(kInitialTableSize)),
+  _count(0),
+  _frozen(false),
+  _cursor(WALLE_NULL),
+  _left(0),
+  _arena_bytes(0),
+  _string_bytes(0)
+{
+    for (size_t i = 0; i < kSegments; ++i) {
+        _segments[i].store(WALLE_NULL, std::memory_order_relaxed);
+    }
+}
+
+string_pool::~string_pool()
+{
+    _retired.push_back(_table.load(std::memory_order_relaxed));
+    for (size_t i = 0; i < _retired.size(); ++i) {
+        delete [] _retired[i]->slots;
+        delete _retired[i];
+    }
+    for (size_t i = 0; i < kSegments; ++i) {
+        delete [] _segments[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < _arenas.size(); ++i) {
+        std::free(_arenas[i]);
+    }
+}
+
+string_pool::table *string_pool::make_table(size_t capacity)
+{
+    table *t = new table;
+    t->mask = capacity - 1;
+    t->slots = new std::atomic<uint64_t>[capacity];
+    for (size_t i = 0; i < capacity; ++i) {
+        t->slots[i].store(0, std::memory_order_relaxed);
+    }
+    return t;
+}
+
+void string_pool::insert_slot(table *t, uint64_t slot)
+{
+    size_t i = size_t(slot >> 32) & t->mask;
+    while (t->slots[i].load(std::memory_order_relaxed) != 0) {
+        i = (i + 1) & t->mask;
+    }
+    t->slots[i].store(slot, std::memory_order_release);
+}
+
+string_pool::symbol string_pool::find(string_view s, uint64_t h) const
+{
+    const table *t = _table.load(std::memory_order_acquire);
+    const uint64_t tag = h >> 32;
+    size_t i = size_t(tag) & t->mask;
+    for (;;) {
+        const uint64_t slot = t->slots[i].load(std::memory_order_acquire);
+        if (slot == 0) {
+            return kNoSymbol;
+        }
+        if ((slot >> 32) == tag) {
+            const symbol id = symbol(slot) - 1;
+            const string_view v = view(id);
+            // a default view has no data, memcmp must not see it.
+            if (v.size() == s.size() && (s.empty() || std::memcmp(v.data(), s.data(), s.size()) == 0)) {
+                return id;
+            }
+        }
+        i = (i + 1) & t->mask;
+    }
+}
+
+string_pool::symbol string_pool::intern(string_view s)
+{
+    const uint64_t h = hash_of(s);
+    const symbol id = find(s, h);
+    if (WALLE_LIKELY(id != kNoSymbol) || frozen()) {
+        return id;
+    }
+    return add(s, h);
+}
+
+string_pool::symbol string_pool::add(string_view s, uint64_t h)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    // another writer may have added it, or grown the table, meanwhile.
+    symbol id = find(s, h);
+    if (id != kNoSymbol || frozen()) {
+        return id;
+    }
+    const size_t n = _count.load(std::memory_order_relaxed);
+    WALLE_ASSERT_MSG(n < size_t(kNoSymbol), "string_pool is full");
+    id = symbol(n);
+
+    size_t segment;
+    size_t offset;
+    locate(id, segment, offset);
+    entry *entries = _segments[segment].load(std::memory_order_relaxed);
+    if (!entries) {
+        entries = new entry[size_t(1) << (segment + kFirstSegmentShift)];
+        _segments[segment].store(entries, std::memory_order_release);
+    }
+    entries[offset].data = store(s);
+    entries[offset].size = s.size();
+
+    table *t = _table.load(std::memory_order_relaxed);
+    if ((n + 1) * 2 > t->mask + 1) {
+        grow_table();
+        t = _table.load(std::memory_order_relaxed);
+    }
+    // the entry is written before the slot that leads readers to it.
+    _count.store(n + 1, std::memory_order_release);
+    insert_slot(t, ((h >> 32) << 32) | (uint64_t(id) + 1));
+    return id;
+}
+
+const char *string_pool::store(string_view s)
+{
+    const size_t need = s.size() + 1;
+    char *p;
+    if (need > _arena_size / 4) {
+        p = static_cast<char*>(std::malloc(need));
+        if (WALLE_UNLIKELY(!p)) {
+            throw std::bad_alloc();
+        }
+        _arenas.push_back(p);
+        _arena_bytes += need;
+    } else {
+        if (need > _left) {
+            _cursor = static_cast<char*>(std::malloc(_arena_size));
+            if (WALLE_UNLIKELY(!_cursor)) {
+                _left = 0;
+                throw std::bad_alloc();
+            }
+            _arenas.push_back(_cursor);
+            _left = _arena_size;
+            _arena_bytes += _arena_size;
+        }
+        p = _cursor;
+        _cursor += need;
+        _left -= need;
+    }
+    if (s.size()) {
+        std::memcpy(p, s.data(), s.size());
+    }
+    p[s.size()] = '\0';
+    _string_bytes += s.size();
+    return p;
+}
+
+void string_pool::grow_table()
+{
+    table *old = _table.load(std::memory_order_relaxed);
+    table *t = make_table((old->mask + 1) * 2);
+    for (size_t i = 0; i <= old->mask; ++i) {
+        const uint64_t slot = old->slots[i].load(std::memory_order_relaxed);
+        if (slot) {
+            insert_slot(t, slot);
+        }
+    }
+    _table.store(t, std::memory_order_release);
+    _retired.push_back(old);
+}
+
+string_pool::stats string_pool::get_stats() const
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    stats s;
+    s.symbols = _count.load(std::memory_order_relaxed);
+    s.string_bytes = _string_bytes;
+    s.arena_bytes = _arena_bytes;
+    s.table_bytes = 0;
+    const table *t = _table.load(std::memory_order_relaxed);
+    s.table_bytes += (t->mask + 1) * sizeof(uint64_t);
+    for (size_t i = 0; i < _retired.size(); ++i) {
+        s.table_bytes += (_retired[i]->mask + 1) * sizeof(uint64_t);
+    }
+    for (size_t i = 0; i < kSegments; ++i) {
+        if (_segments[i].load(std::memory_order_relaxed)) {
+            s.table_bytes += (size_t(1) << (i + kFirstSegmentShift)) * sizeof(entry);
+        }
+    }
+    return s;
+}
+
+}
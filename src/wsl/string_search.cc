@@ -0,0 +1,740 @@
+#include <walle/wsl/internal/string_search.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+
+namespace wsl {
+namespace internal {
+
+namespace {
+
+inline uint32_t ctz(uint32_t v)
+{
+    return static_cast<uint32_t>(__builtin_ctz(v));
+}
+
+inline uint32_t top_bit(uint32_t v)
+{
+    return 31 - static_cast<uint32_t>(__builtin_clz(v));
+}
+
+// pshufb tables for a byte set: b is in the set when
+//   (lo_low[b & 15] & hi_low[b >> 4]) | (lo_high[b & 15] & hi_high[b >> 4])
+// is non zero. hi nibbles 0-7 are bits of the low tables, 8-15 of the high
+// ones, so any set of bytes is represented exactly.
+struct byte_set_tables {
+    uint8_t lo_low[16];
+    uint8_t lo_high[16];
+    bool    has_high;
+};
+
+static const uint8_t kHiLow[16] = {
+    1, 2, 4, 8, 16, 32, 64, 128, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static const uint8_t kHiHigh[16] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 8, 16, 32, 64, 128
+};
+
+void build_byte_set(const char *set, size_t m, byte_set_tables &t)
+{
+    std::memset(&t, 0, sizeof(t));
+    for (size_t i = 0; i < m; ++i) {
+        const uint8_t b = static_cast<uint8_t>(set[i]);
+        const uint8_t hi = b >> 4;
+        if (hi < 8) {
+            t.lo_low[b & 15] |= static_cast<uint8_t>(1u << hi);
+        } else {
+            t.lo_high[b & 15] |= static_cast<uint8_t>(1u << (hi - 8));
+            t.has_high = true;
+        }
+    }
+}
+
+// scalar pieces shared by every kernel set.
+
+const char *scalar_find(const char *p, size_t n, char c)
+{
+    for (size_t i = 0; i < n; ++i) {
+        if (p[i] == c) {
+            return p + i;
+        }
+    }
+    return WALLE_NULL;
+}
+
+const char *scalar_rfind(const char *p, size_t n, char c)
+{
+    while (n) {
+        --n;
+        if (p[n] == c) {
+            return p + n;
+        }
+    }
+    return WALLE_NULL;
+}
+
+inline bool match_at(const char *p, const char *needle, size_t m)
+{
+    return p[0] == needle[0] && p[m - 1] == needle[m - 1] &&
+           std::memcmp(p + 1, needle + 1, m - 2) == 0;
+}
+
+const char *scalar_set_search(const char *p, size_t n, const char *set, size_t m, bool in_set)
+{
+    bool table[256];
+    std::memset(table, 0, sizeof(table));
+    for (size_t i = 0; i < m; ++i) {
+        table[static_cast<uint8_t>(set[i])] = true;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (table[static_cast<uint8_t>(p[i])] == in_set) {
+            return p + i;
+        }
+    }
+    return WALLE_NULL;
+}
+
+template <typename T>
+const T *scalar_find_wide(const T *p, size_t n, T c)
+{
+    for (size_t i = 0; i < n; ++i) {
+        if (p[i] == c) {
+            return p + i;
+        }
+    }
+    return WALLE_NULL;
+}
+
+// sse2 kernels, 16 bytes per step.
+
+inline uint32_t eq_mask_sse2(const char *p, __m128i v)
+{
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), v)));
+}
+
+const char *find_sse2(const char *p, size_t n, char c)
+{
+    if (n < 16) {
+        return scalar_find(p, n, c);
+    }
+    const __m128i v = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint32_t mask = eq_mask_sse2(p + i, v);
+        if (mask) {
+            return p + i + ctz(mask);
+        }
+    }
+    if (i < n) {
+        // the last block overlaps bytes already checked, drop them.
+        const size_t start = n - 16;
+        const uint32_t mask = eq_mask_sse2(p + start, v) & (0xffffu << (i - start));
+        if (mask) {
+            return p + start + ctz(mask);
+        }
+    }
+    return WALLE_NULL;
+}
+
+const char *rfind_sse2(const char *p, size_t n, char c)
+{
+    if (n < 16) {
+        return scalar_rfind(p, n, c);
+    }
+    const __m128i v = _mm_set1_epi8(c);
+    size_t i = n;
+    for (; i >= 16; i -= 16) {
+        const uint32_t mask = eq_mask_sse2(p + i - 16, v);
+        if (mask) {
+            return p + i - 16 + top_bit(mask);
+        }
+    }
+    if (i) {
+        const uint32_t mask = eq_mask_sse2(p, v) & ((1u << i) - 1);
+        if (mask) {
+            return p + top_bit(mask);
+        }
+    }
+    return WALLE_NULL;
+}
+
+const char *search_sse2(const char *p, size_t n, const char *needle, size_t m)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+    size_t i = 0;
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        uint32_t mask = eq_mask_sse2(p + i, first) & eq_mask_sse2(p + i + m - 1, last);
+        while (mask) {
+            const char *candidate = p + i + ctz(mask);
+            if (std::memcmp(candidate + 1, needle + 1, m - 2) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    for (; i + m <= n; ++i) {
+        if (match_at(p + i, needle, m)) {
+            return p + i;
+        }
+    }
+    return WALLE_NULL;
+}
+
+const char *rsearch_sse2(const char *p, size_t n, const char *needle, size_t m)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+    // candidates are [0, j), scanned a block at a time from the back.
+    size_t j = n - m + 1;
+    for (; j >= 16; j -= 16) {
+        const size_t s = j - 16;
+        uint32_t mask = eq_mask_sse2(p + s, first) & eq_mask_sse2(p + s + m - 1, last);
+        while (mask) {
+            const uint32_t bit = top_bit(mask);
+            if (std::memcmp(p + s + bit + 1, needle + 1, m - 2) == 0) {
+                return p + s + bit;
+            }
+            mask &= ~(1u << bit);
+        }
+    }
+    while (j) {
+        --j;
+        if (match_at(p + j, needle, m)) {
+            return p + j;
+        }
+    }
+    return WALLE_NULL;
+}
+
+const char16_t *find16_sse2(const char16_t *p, size_t n, char16_t c)
+{
+    const __m128i v = _mm_set1_epi16(static_cast<short>(c));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), v)));
+        if (mask) {
+            return p + i + ctz(mask) / 2;
+        }
+    }
+    return scalar_find_wide(p + i, n - i, c);
+}
+
+const char32_t *find32_sse2(const char32_t *p, size_t n, char32_t c)
+{
+    const __m128i v = _mm_set1_epi32(static_cast<int>(c));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), v)));
+        if (mask) {
+            return p + i + ctz(mask) / 4;
+        }
+    }
+    return scalar_find_wide(p + i, n - i, c);
+}
+
+// bit i set when byte i of the block is in the set.
+WALLE_TARGET_SSSE3 inline uint32_t set_mask_ssse3(__m128i block, const __m128i lo_low,
+                                                  const __m128i lo_high, bool has_high)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i lo = _mm_and_si128(block, nibble);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(block, 4), nibble);
+    __m128i hit = _mm_and_si128(_mm_shuffle_epi8(lo_low, lo),
+                                _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(kHiLow)), hi));
+    if (has_high) {
+        hit = _mm_or_si128(hit, _mm_and_si128(_mm_shuffle_epi8(lo_high, lo),
+              _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(kHiHigh)), hi)));
+    }
+    return ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(hit, _mm_setzero_si128()))) & 0xffffu;
+}
+
+WALLE_TARGET_SSSE3 const char *set_search_ssse3(const char *p, size_t n, const char *set,
+                                                size_t m, bool in_set)
+{
+    byte_set_tables t;
+    build_byte_set(set, m, t);
+    const __m128i lo_low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.lo_low));
+    const __m128i lo_high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.lo_high));
+    const uint32_t flip = in_set ? 0 : 0xffffu;
+    if (n < 16) {
+        char tmp[16] = {0};
+        std::memcpy(tmp, p, n);
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tmp));
+        const uint32_t mask = (set_mask_ssse3(block, lo_low, lo_high, t.has_high) ^ flip) & ((1u << n) - 1);
+        return mask ? p + ctz(mask) : WALLE_NULL;
+    }
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const uint32_t mask = set_mask_ssse3(block, lo_low, lo_high, t.has_high) ^ flip;
+        if (mask) {
+            return p + i + ctz(mask);
+        }
+    }
+    if (i < n) {
+        const size_t start = n - 16;
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + start));
+        const uint32_t mask = (set_mask_ssse3(block, lo_low, lo_high, t.has_high) ^ flip) &
+                              (0xffffu << (i - start));
+        if (mask) {
+            return p + start + ctz(mask);
+        }
+    }
+    return WALLE_NULL;
+}
+
+const char *find_first_of_sse2(const char *p, size_t n, const char *set, size_t m)
+{
+    if (m == 1) {
+        return find_sse2(p, n, set[0]);
+    }
+    return cpu_has_ssse3() ? set_search_ssse3(p, n, set, m, true) : scalar_set_search(p, n, set, m, true);
+}
+
+const char *find_first_not_of_sse2(const char *p, size_t n, const char *set, size_t m)
+{
+    return cpu_has_ssse3() ? set_search_ssse3(p, n, set, m, false) : scalar_set_search(p, n, set, m, false);
+}
+
+uint64_t scalar_delimiter_mask(const char *p, size_t n, const delimiter_set &set)
+{
+    uint64_t mask = 0;
+    for (size_t i = 0; i < n; ++i) {
+        mask |= static_cast<uint64_t>(set.contains(p[i])) << i;
+    }
+    return mask;
+}
+
+inline uint64_t low_bits(size_t n)
+{
+    return n < 64 ? (uint64_t(1) << n) - 1 : ~uint64_t(0);
+}
+
+inline uint64_t eq_mask64_sse2(const char *p, char c)
+{
+    const __m128i v = _mm_set1_epi8(c);
+    uint64_t mask = 0;
+    for (size_t i = 0; i < 64; i += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, v)))) << i;
+    }
+    return mask;
+}
+
+WALLE_TARGET_SSSE3 uint64_t set_mask64_ssse3(const char *p, const delimiter_set &set)
+{
+    const __m128i lo_low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set.lo_low));
+    const __m128i lo_high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set.lo_high));
+    uint64_t mask = 0;
+    for (size_t i = 0; i < 64; i += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        mask |= static_cast<uint64_t>(set_mask_ssse3(block, lo_low, lo_high, set.has_high)) << i;
+    }
+    return mask;
+}
+
+uint64_t delimiter_mask_sse2(const char *p, size_t n, const delimiter_set &set)
+{
+    if (set.size != 1 && !cpu_has_ssse3()) {
+        return scalar_delimiter_mask(p, n, set);
+    }
+    char tmp[64];
+    if (n < 64) {
+        // the last piece of a text, padded to a whole block.
+        std::memset(tmp, 0, sizeof(tmp));
+        std::memcpy(tmp, p, n);
+        p = tmp;
+    }
+    const uint64_t mask = set.size == 1 ? eq_mask64_sse2(p, set.first) : set_mask64_ssse3(p, set);
+    return mask & low_bits(n);
+}
+
+// avx2 kernels, 32 bytes per step.
+
+WALLE_TARGET_AVX2 inline uint32_t eq_mask_avx2(const char *p, __m256i v)
+{
+    return static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), v)));
+}
+
+WALLE_TARGET_AVX2 const char *find_avx2(const char *p, size_t n, char c)
+{
+    if (n < 32) {
+        return find_sse2(p, n, c);
+    }
+    const __m256i v = _mm256_set1_epi8(c);
+    size_t i = 0;
+    // four vectors per step, resolved only when one of them has a match.
+    for (; i + 128 <= n; i += 128) {
+        const __m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), v);
+        const __m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 32)), v);
+        const __m256i c2 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 64)), v);
+        const __m256i d = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 96)), v);
+        if (!_mm256_testz_si256(_mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c2, d)),
+                                _mm256_set1_epi8(-1))) {
+            const uint64_t lo = static_cast<uint32_t>(_mm256_movemask_epi8(a)) |
+                                (uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(b))) << 32);
+            if (lo) {
+                return p + i + __builtin_ctzll(lo);
+            }
+            const uint64_t hi = static_cast<uint32_t>(_mm256_movemask_epi8(c2)) |
+                                (uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(d))) << 32);
+            return p + i + 64 + __builtin_ctzll(hi);
+        }
+    }
+    for (; i + 32 <= n; i += 32) {
+        const uint32_t mask = eq_mask_avx2(p + i, v);
+        if (mask) {
+            return p + i + ctz(mask);
+        }
+    }
+    if (i < n) {
+        const size_t start = n - 32;
+        const uint32_t mask = eq_mask_avx2(p + start, v) & (0xffffffffu << (i - start));
+        if (mask) {
+            return p + start + ctz(mask);
+        }
+    }
+    return WALLE_NULL;
+}
+
+WALLE_TARGET_AVX2 const char *rfind_avx2(const char *p, size_t n, char c)
+{
+    if (n < 32) {
+        return rfind_sse2(p, n, c);
+    }
+    const __m256i v = _mm256_set1_epi8(c);
+    size_t i = n;
+    for (; i >= 32; i -= 32) {
+        const uint32_t mask = eq_mask_avx2(p + i - 32, v);
+        if (mask) {
+            return p + i - 32 + top_bit(mask);
+        }
+    }
+    if (i) {
+        const uint32_t mask = eq_mask_avx2(p, v) & ((1u << i) - 1);
+        if (mask) {
+            return p + top_bit(mask);
+        }
+    }
+    return WALLE_NULL;
+}
+
+WALLE_TARGET_AVX2 const char *search_avx2(const char *p, size_t n, const char *needle, size_t m)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+    size_t i = 0;
+    for (; i + m - 1 + 32 <= n; i += 32) {
+        uint32_t mask = eq_mask_avx2(p + i, first) & eq_mask_avx2(p + i + m - 1, last);
+        while (mask) {
+            const char *candidate = p + i + ctz(mask);
+            if (std::memcmp(candidate + 1, needle + 1, m - 2) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    const char *r = search_sse2(p + i, n - i, needle, m);
+    return r;
+}
+
+WALLE_TARGET_AVX2 const char *rsearch_avx2(const char *p, size_t n, const char *needle, size_t m)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+    size_t j = n - m + 1;
+    for (; j >= 32; j -= 32) {
+        const size_t s = j - 32;
+        uint32_t mask = eq_mask_avx2(p + s, first) & eq_mask_avx2(p + s + m - 1, last);
+        while (mask) {
+            const uint32_t bit = top_bit(mask);
+            if (std::memcmp(p + s + bit + 1, needle + 1, m - 2) == 0) {
+                return p + s + bit;
+            }
+            mask &= ~(1u << bit);
+        }
+    }
+    // candidates [0, j) remain, they fit in the first j + m - 1 bytes.
+    return j ? rsearch_sse2(p, j + m - 1, needle, m) : WALLE_NULL;
+}
+
+WALLE_TARGET_AVX2 const char16_t *find16_avx2(const char16_t *p, size_t n, char16_t c)
+{
+    const __m256i v = _mm256_set1_epi16(static_cast<short>(c));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), v)));
+        if (mask) {
+            return p + i + ctz(mask) / 2;
+        }
+    }
+    return find16_sse2(p + i, n - i, c);
+}
+
+WALLE_TARGET_AVX2 const char32_t *find32_avx2(const char32_t *p, size_t n, char32_t c)
+{
+    const __m256i v = _mm256_set1_epi32(static_cast<int>(c));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), v)));
+        if (mask) {
+            return p + i + ctz(mask) / 4;
+        }
+    }
+    return find32_sse2(p + i, n - i, c);
+}
+
+WALLE_TARGET_AVX2 inline uint32_t set_mask_avx2(__m256i block, const __m256i lo_low, const __m256i lo_high,
+                                                const __m256i hi_low, const __m256i hi_high, bool has_high)
+{
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i lo = _mm256_and_si256(block, nibble);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble);
+    __m256i hit = _mm256_and_si256(_mm256_shuffle_epi8(lo_low, lo), _mm256_shuffle_epi8(hi_low, hi));
+    if (has_high) {
+        hit = _mm256_or_si256(hit, _mm256_and_si256(_mm256_shuffle_epi8(lo_high, lo),
+                                                    _mm256_shuffle_epi8(hi_high, hi)));
+    }
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hit, _mm256_setzero_si256())));
+}
+
+WALLE_TARGET_AVX2 inline __m256i broadcast_table(const uint8_t *table)
+{
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+WALLE_TARGET_AVX2 const char *set_search_avx2(const char *p, size_t n, const char *set,
+                                              size_t m, bool in_set)
+{
+    if (n < 32) {
+        return set_search_ssse3(p, n, set, m, in_set);
+    }
+    byte_set_tables t;
+    build_byte_set(set, m, t);
+    // vpshufb looks up within each 128 bit lane, so the tables are
+    // repeated in both lanes.
+    const __m256i lo_low = broadcast_table(t.lo_low);
+    const __m256i lo_high = broadcast_table(t.lo_high);
+    const __m256i hi_low = broadcast_table(kHiLow);
+    const __m256i hi_high = broadcast_table(kHiHigh);
+    const uint32_t flip = in_set ? 0 : 0xffffffffu;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const uint32_t mask = set_mask_avx2(block, lo_low, lo_high, hi_low, hi_high, t.has_high) ^ flip;
+        if (mask) {
+            return p + i + ctz(mask);
+        }
+    }
+    if (i < n) {
+        const size_t start = n - 32;
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + start));
+        const uint32_t mask = (set_mask_avx2(block, lo_low, lo_high, hi_low, hi_high, t.has_high) ^ flip) &
+                              (0xffffffffu << (i - start));
+        if (mask) {
+            return p + start + ctz(mask);
+        }
+    }
+    return WALLE_NULL;
+}
+
+WALLE_TARGET_AVX2 const char *find_first_of_avx2(const char *p, size_t n, const char *set, size_t m)
+{
+    if (m == 1) {
+        return find_avx2(p, n, set[0]);
+    }
+    return set_search_avx2(p, n, set, m, true);
+}
+
+WALLE_TARGET_AVX2 const char *find_first_not_of_avx2(const char *p, size_t n, const char *set, size_t m)
+{
+    return set_search_avx2(p, n, set, m, false);
+}
+
+WALLE_TARGET_AVX2 uint64_t delimiter_mask_avx2(const char *p, size_t n, const delimiter_set &set)
+{
+    char tmp[64];
+    if (n < 64) {
+        std::memset(tmp, 0, sizeof(tmp));
+        std::memcpy(tmp, p, n);
+        p = tmp;
+    }
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    uint32_t lo;
+    uint32_t hi;
+    if (set.size == 1) {
+        const __m256i v = _mm256_set1_epi8(set.first);
+        lo = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, v)));
+        hi = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, v)));
+    } else {
+        const __m256i lo_low = broadcast_table(set.lo_low);
+        const __m256i lo_high = broadcast_table(set.lo_high);
+        const __m256i hi_low = broadcast_table(kHiLow);
+        const __m256i hi_high = broadcast_table(kHiHigh);
+        lo = set_mask_avx2(a, lo_low, lo_high, hi_low, hi_high, set.has_high);
+        hi = set_mask_avx2(b, lo_low, lo_high, hi_low, hi_high, set.has_high);
+    }
+    return ((static_cast<uint64_t>(hi) << 32) | lo) & low_bits(n);
+}
+
+struct search_kernels {
+    simd_isa            isa;
+    const char         *(*find)(const char *, size_t, char);
+    const char         *(*rfind)(const char *, size_t, char);
+    const char         *(*search)(const char *, size_t, const char *, size_t);
+    const char         *(*rsearch)(const char *, size_t, const char *, size_t);
+    const char         *(*find_first_of)(const char *, size_t, const char *, size_t);
+    const char         *(*find_first_not_of)(const char *, size_t, const char *, size_t);
+    const char16_t     *(*find16)(const char16_t *, size_t, char16_t);
+    const char32_t     *(*find32)(const char32_t *, size_t, char32_t);
+    uint64_t            (*delimiter_mask)(const char *, size_t, const delimiter_set &);
+};
+
+const search_kernels kSse2Kernels = {
+    kSimdSse2, find_sse2, rfind_sse2, search_sse2, rsearch_sse2,
+    find_first_of_sse2, find_first_not_of_sse2, find16_sse2, find32_sse2,
+    delimiter_mask_sse2
+};
+
+const search_kernels kAvx2Kernels = {
+    kSimdAvx2, find_avx2, rfind_avx2, search_avx2, rsearch_avx2,
+    find_first_of_avx2, find_first_not_of_avx2, find16_avx2, find32_avx2,
+    delimiter_mask_avx2
+};
+
+std::atomic<const search_kernels*> g_kernels(WALLE_NULL);
+
+const search_kernels *select_kernels()
+{
+    const search_kernels *k = cpu_has_avx2() ? &kAvx2Kernels : &kSse2Kernels;
+    g_kernels.store(k, std::memory_order_release);
+    return k;
+}
+
+inline const search_kernels *kernels()
+{
+    const search_kernels *k = g_kernels.load(std::memory_order_acquire);
+    if (WALLE_UNLIKELY(!k)) {
+        k = select_kernels();
+    }
+    return k;
+}
+
+}
+
+simd_isa current_search_isa()
+{
+    return kernels()->isa;
+}
+
+bool set_search_isa(simd_isa isa)
+{
+    if (!cpu_supports(isa)) {
+        return false;
+    }
+    g_kernels.store(isa == kSimdAvx2 ? &kAvx2Kernels : &kSse2Kernels, std::memory_order_release);
+    return true;
+}
+
+const char *simd_find(const char *p, size_t n, char c)
+{
+    return kernels()->find(p, n, c);
+}
+
+const char16_t *simd_find(const char16_t *p, size_t n, char16_t c)
+{
+    return kernels()->find16(p, n, c);
+}
+
+const char32_t *simd_find(const char32_t *p, size_t n, char32_t c)
+{
+    return kernels()->find32(p, n, c);
+}
+
+const char *simd_rfind(const char *p, size_t n, char c)
+{
+    return kernels()->rfind(p, n, c);
+}
+
+const char *simd_search(const char *p, size_t n, const char *needle, size_t m)
+{
+    if (m == 0) {
+        return p;
+    }
+    if (m > n) {
+        return WALLE_NULL;
+    }
+    if (m == 1) {
+        return kernels()->find(p, n, needle[0]);
+    }
+    return kernels()->search(p, n, needle, m);
+}
+
+const char *simd_rsearch(const char *p, size_t n, const char *needle, size_t m)
+{
+    if (m == 0) {
+        return p + n;
+    }
+    if (m > n) {
+        return WALLE_NULL;
+    }
+    if (m == 1) {
+        return kernels()->rfind(p, n, needle[0]);
+    }
+    return kernels()->rsearch(p, n, needle, m);
+}
+
+const char *simd_find_first_of(const char *p, size_t n, const char *set, size_t m)
+{
+    if (m == 0 || n == 0) {
+        return WALLE_NULL;
+    }
+    return kernels()->find_first_of(p, n, set, m);
+}
+
+const char *simd_find_first_not_of(const char *p, size_t n, const char *set, size_t m)
+{
+    if (n == 0) {
+        return WALLE_NULL;
+    }
+    if (m == 0) {
+        return p;
+    }
+    return kernels()->find_first_not_of(p, n, set, m);
+}
+
+void make_delimiter_set(const char *set, size_t m, delimiter_set &out)
+{
+    std::memset(&out, 0, sizeof(out));
+    for (size_t i = 0; i < m; ++i) {
+        const uint8_t b = static_cast<uint8_t>(set[i]);
+        if (!out.contains(set[i])) {
+            out.bits[b >> 6] |= uint64_t(1) << (b & 63);
+            out.first = set[i];
+            ++out.size;
+        }
+    }
+    byte_set_tables t;
+    build_byte_set(set, m, t);
+    std::memcpy(out.lo_low, t.lo_low, sizeof(out.lo_low));
+    std::memcpy(out.lo_high, t.lo_high, sizeof(out.lo_high));
+    out.has_high = t.has_high;
+}
+
+uint64_t simd_delimiter_mask(const char *p, size_t n, const delimiter_set &set)
+{
+    return kernels()->delimiter_mask(p, n, set);
+}
+
+}
+}
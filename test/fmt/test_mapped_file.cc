@@ -0,0 +1,91 @@
+#include <google/gtest/gtest.h>
+#include <walle/fmt/posix.h>
+#include <cstdio>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class mapped_file_test : public ::testing::Test {
+protected:
+    void SetUp()
+    {
+        char name[] = "/tmp/walle_mapped_XXXXXX";
+        int fd = mkstemp(name);
+        ASSERT_NE(-1, fd);
+        _path = name;
+        // a bit more than two pages, so windows cross page boundaries.
+        for (int i = 0; i < 9000; ++i) {
+            _content.push_back(static_cast<char>('a' + i % 26));
+        }
+        ASSERT_EQ(static_cast<ssize_t>(_content.size()), write(fd, _content.data(), _content.size()));
+        ::close(fd);
+    }
+
+    void TearDown()
+    {
+        unlink(_path.c_str());
+    }
+
+    std::string _path;
+    std::string _content;
+};
+
+TEST_F(mapped_file_test, whole_file)
+{
+    walle::mapped_file mf(_path, walle::mapped_file::READ_ONLY, walle::mapped_file::POPULATE);
+    EXPECT_EQ(_content.size(), mf.size());
+    EXPECT_EQ(_content.size(), mf.file_size());
+    EXPECT_EQ(_content, std::string(mf.data(), mf.size()));
+    wsl::buffer_view<const char> view = mf.view();
+    EXPECT_EQ('a', view[0]);
+    EXPECT_EQ(_content.size(), mf.str().size());
+    EXPECT_TRUE(mf.advise(walle::mapped_file::SEQUENTIAL));
+}
+
+TEST_F(mapped_file_test, windows)
+{
+    walle::mapped_file mf(_path, walle::mapped_file::READ_ONLY, 5000, 100);
+    EXPECT_EQ(5000, mf.offset());
+    EXPECT_EQ(_content.substr(5000, 100), std::string(mf.data(), mf.size()));
+    mf.map(8990, 100);
+    EXPECT_EQ(10, mf.size());
+    EXPECT_EQ(_content.substr(8990), std::string(mf.data(), mf.size()));
+    walle::mapped_file moved(std::move(mf));
+    EXPECT_TRUE(mf.empty());
+    EXPECT_EQ(10, moved.size());
+}
+
+TEST_F(mapped_file_test, read_write)
+{
+    {
+        walle::mapped_file mf(_path, walle::mapped_file::READ_WRITE);
+        mf.mutable_data()[1] = 'Z';
+        mf.sync();
+    }
+    walle::mapped_file mf(_path);
+    EXPECT_EQ('Z', mf.data()[1]);
+}
+
+TEST(mapped_file, missing)
+{
+    EXPECT_THROW(walle::mapped_file("/nonexistent/walle"), fmt::system_error);
+}
+
+TEST(mapped_file, map_failure_closes)
+{
+    // a directory opens and has a size, but can't be mapped.
+    struct stat st;
+    ASSERT_EQ(0, ::stat("/tmp", &st));
+    if (st.st_size == 0) {
+        return;
+    }
+    const int next_fd = ::dup(0);
+    ASSERT_NE(-1, next_fd);
+    ::close(next_fd);
+    EXPECT_THROW(walle::mapped_file("/tmp"), fmt::system_error);
+    EXPECT_THROW(walle::mapped_file("/tmp", walle::mapped_file::READ_ONLY, 0, 10), fmt::system_error);
+    // the descriptor was closed, the same number comes back.
+    const int fd = ::dup(0);
+    EXPECT_EQ(next_fd, fd);
+    ::close(fd);
+}
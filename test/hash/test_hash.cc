@@ -0,0 +1,159 @@
+#include <google/gtest/gtest.h>
+#include <walle/hash/hash.h>
+#include <walle/wsl/string_view.h>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+TEST(hash, deterministic_and_seeded)
+{
+    const std::string key = "the quick brown fox jumps over the lazy dog";
+    for (size_t len = 0; len <= key.size(); ++len) {
+        EXPECT_EQ(walle::hash64(key.data(), len), walle::hash64(key.data(), len));
+        EXPECT_NE(walle::hash64(key.data(), len, 1), walle::hash64(key.data(), len, 2));
+    }
+    EXPECT_EQ(walle::hash64(key.data(), key.size()),
+              walle::hash64(wsl::buffer_view<const char>(key.data(), key.size())));
+}
+
+TEST(hash, every_length_and_byte_matters)
+{
+    // flipping any single bit of keys up to 200 bytes changes the hash.
+    std::mt19937 rng(1);
+    std::vector<unsigned char> key(200);
+    for (size_t i = 0; i < key.size(); ++i) {
+        key[i] = static_cast<unsigned char>(rng());
+    }
+    std::set<uint64_t> seen;
+    for (size_t len = 0; len <= key.size(); ++len) {
+        const uint64_t h = walle::hash64(key.data(), len);
+        EXPECT_TRUE(seen.insert(h).second) << len;
+        for (size_t i = 0; i < len; ++i) {
+            key[i] ^= 0x10;
+            EXPECT_NE(h, walle::hash64(key.data(), len)) << len << " " << i;
+            key[i] ^= 0x10;
+        }
+    }
+}
+
+TEST(hash, streaming_matches_one_shot)
+{
+    std::mt19937 rng(2);
+    std::vector<char> data(400);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>(rng());
+    }
+    for (size_t len = 0; len <= data.size(); len += 1 + len / 16) {
+        const uint64_t expected = walle::hash64(data.data(), len, 7);
+        for (int round = 0; round < 20; ++round) {
+            walle::hasher h(7);
+            size_t done = 0;
+            while (done < len) {
+                const size_t n = std::min<size_t>(len - done, rng() % 70);
+                h.update(data.data() + done, n);
+                done += n;
+            }
+            ASSERT_EQ(expected, h.digest()) << len;
+            ASSERT_EQ(len, h.length());
+        }
+    }
+    walle::hasher h;
+    h.update(wsl::string_view("abc"));
+    h.reset();
+    h.update(wsl::string_view("xyz"));
+    EXPECT_EQ(walle::hash64("xyz", 3), h.digest());
+}
+
+TEST(hash, integers)
+{
+    std::set<uint64_t> seen;
+    size_t low_buckets[64] = {0};
+    for (uint64_t i = 0; i < 64 * 1024; ++i) {
+        const uint64_t h = walle::hash_int(i);
+        EXPECT_TRUE(seen.insert(h).second);
+        ++low_buckets[h & 63];
+    }
+    // sequential keys spread over the low bits a hash table masks with.
+    for (size_t b = 0; b < 64; ++b) {
+        EXPECT_GT(low_buckets[b], 800u);
+        EXPECT_LT(low_buckets[b], 1250u);
+    }
+    EXPECT_NE(walle::hash_int(1, 1), walle::hash_int(1, 2));
+    EXPECT_NE(walle::hash_combine(1, 2), walle::hash_combine(2, 1));
+}
+
+TEST(hash, string_view_specializations)
+{
+    wsl::hash<wsl::string_view> h;
+    // the whole view is hashed, not up to the first nul.
+    EXPECT_NE(h(wsl::string_view("a\0b", 3)), h(wsl::string_view("a\0c", 3)));
+    EXPECT_NE(h(wsl::string_view("abcdef", 3)), h(wsl::string_view("abcdef", 4)));
+    EXPECT_EQ(h(wsl::string_view("hello")), walle::hash64(wsl::string_view("hello")));
+
+    const char16_t u16[] = u"hello";
+    const char32_t u32[] = U"hello";
+    EXPECT_EQ(wsl::hash<wsl::u16string_view>()(wsl::u16string_view(u16, 5)),
+              walle::hash64(u16, 10));
+    EXPECT_EQ(wsl::hash<wsl::u32string_view>()(wsl::u32string_view(u32, 5)),
+              walle::hash64(u32, 20));
+}
+
+static int dispatch(wsl::string_view cmd)
+{
+    switch (walle::hash_const(cmd.data(), cmd.size())) {
+    case walle::hash_const("get"):
+        return 1;
+    case walle::hash_const("set"):
+        return 2;
+    case walle::hash_const("delete_if_present"):
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+TEST(hash, const_hash)
+{
+    // a constant expression, and equal to the runtime value.
+    static_assert(walle::hash_const("get") != walle::hash_const("set"), "hash_const");
+    static_assert(walle::hash_const("abc") != walle::hash_const("abcd"), "hash_const");
+    EXPECT_EQ(walle::hash_const("abc"), walle::hash_const("abcd", 3));
+    const std::string get("get");
+    EXPECT_EQ(walle::hash_const("get"), walle::hash_const(get.data(), get.size()));
+    EXPECT_EQ(walle::hash_const("delete_if_present"), walle::hash_const("delete_if_present", 17));
+    // the runtime loop agrees with the literal recursion past many steps.
+    static WALLE_CONSTEXPR char kLong[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                          "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                          "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    static_assert(walle::hash_const(kLong) != 0, "hash_const");
+    EXPECT_EQ(walle::hash_const(kLong), walle::hash_const(kLong, sizeof(kLong) - 1));
+
+    // a megabyte: one loop, no recursion per 8 bytes.
+    std::string big(1 << 20, 'x');
+    const uint64_t big_hash = walle::hash_const(big.data(), big.size());
+    big[big.size() - 1] = 'y';
+    EXPECT_NE(big_hash, walle::hash_const(big.data(), big.size()));
+
+    EXPECT_EQ(1, dispatch("get"));
+    EXPECT_EQ(2, dispatch("set"));
+    EXPECT_EQ(3, dispatch("delete_if_present"));
+    EXPECT_EQ(0, dispatch("put"));
+
+    std::mt19937 rng(2);
+    std::vector<char> key(100);
+    for (size_t i = 0; i < key.size(); ++i) {
+        key[i] = static_cast<char>(rng());
+    }
+    std::set<uint64_t> seen;
+    for (size_t len = 0; len <= key.size(); ++len) {
+        const uint64_t h = walle::hash_const(key.data(), len);
+        EXPECT_TRUE(seen.insert(h).second) << len;
+        EXPECT_NE(h, walle::hash_const(key.data(), len, 1));
+        for (size_t i = 0; i < len; ++i) {
+            key[i] ^= 0x01;
+            EXPECT_NE(h, walle::hash_const(key.data(), len)) << len << " " << i;
+            key[i] ^= 0x01;
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include <google/gtest/gtest.h>
+#include <walle/timer/timer_wheel.h>
+#include <vector>
+
+struct recorder {
+    std::vector<uint64_t> fired;
+    walle::timer_wheel   *wheel;
+
+    void on_timer(walle::timer_entry &t)
+    {
+        fired.push_back(wheel->now());
+    }
+};
+
+TEST(timer_wheel, fire_in_order)
+{
+    walle::timer_wheel wheel(1, 0, 3, 4);
+    recorder r;
+    r.wheel = &wheel;
+    walle::timer_entry::callback_type cb(&r, &recorder::on_timer);
+    walle::timer_entry a(cb), b(cb), c(cb);
+    wheel.schedule(a, 5);
+    wheel.schedule(b, 300);
+    wheel.schedule(c, 17);
+    EXPECT_EQ(3, wheel.size());
+
+    EXPECT_EQ(0, wheel.advance(4));
+    EXPECT_EQ(1, wheel.advance(5));
+    EXPECT_EQ(1, wheel.advance(299));
+    EXPECT_TRUE(b.armed());
+    EXPECT_EQ(1, wheel.advance(1000));
+    EXPECT_TRUE(wheel.empty());
+    ASSERT_EQ(3, r.fired.size());
+    EXPECT_EQ(5, r.fired[0]);
+    EXPECT_EQ(299, r.fired[1]);
+    EXPECT_EQ(1000, r.fired[2]);
+}
+
+TEST(timer_wheel, cancel_and_rearm)
+{
+    walle::timer_wheel wheel(10);
+    int count = 0;
+    walle::timer_entry a([&count](walle::timer_entry &) { ++count; });
+    wheel.schedule(a, 100);
+    EXPECT_TRUE(wheel.cancel(a));
+    EXPECT_FALSE(wheel.cancel(a));
+    EXPECT_EQ(0, wheel.advance(200));
+
+    wheel.schedule(a, 250);
+    wheel.schedule(a, 405);
+    EXPECT_EQ(1, wheel.size());
+    EXPECT_EQ(0, wheel.advance(400));
+    EXPECT_EQ(1, wheel.advance(410));
+    EXPECT_EQ(1, count);
+}
+
+TEST(timer_wheel, beyond_range)
+{
+    walle::timer_wheel wheel(1, 0, 2, 2);
+    EXPECT_EQ(16u, wheel.range());
+    int count = 0;
+    walle::timer_entry a([&count](walle::timer_entry &) { ++count; });
+    wheel.schedule(a, 1000);
+    EXPECT_EQ(0, wheel.advance(999));
+    EXPECT_EQ(1, wheel.advance(1000));
+    EXPECT_EQ(1, count);
+}
+
+TEST(timer_wheel, periodic_from_callback)
+{
+    walle::timer_wheel wheel;
+    std::vector<uint64_t> seen;
+    walle::timer_entry a([&](walle::timer_entry &t) {
+        seen.push_back(wheel.now());
+        if (seen.size() < 4) {
+            wheel.schedule_after(t, 100);
+        }
+    });
+    wheel.schedule(a, 100);
+    for (uint64_t now = 0; now <= 1000; now += 50) {
+        wheel.advance(now);
+    }
+    ASSERT_EQ(4, seen.size());
+    EXPECT_EQ(400, seen[3]);
+    EXPECT_FALSE(a.armed());
+}
+
+// one big advance over far timers fires the same ones as many small steps.
+TEST(timer_wheel, long_jumps)
+{
+    walle::timer_wheel stepped(1, 0, 4, 4);
+    walle::timer_wheel jumped(1, 0, 4, 4);
+    std::vector<uint64_t> deadlines;
+    deadlines.push_back(70000);     // beyond the range, parked on top.
+    deadlines.push_back(40000);
+    deadlines.push_back(4097);
+    deadlines.push_back(4096);
+    deadlines.push_back(300);
+    deadlines.push_back(17);
+    std::vector<uint64_t> a_fired;
+    std::vector<uint64_t> b_fired;
+    std::vector<walle::timer_entry*> entries;
+    for (size_t i = 0; i < deadlines.size(); ++i) {
+        const uint64_t d = deadlines[i];
+        entries.push_back(new walle::timer_entry([&a_fired, d](walle::timer_entry &) { a_fired.push_back(d); }));
+        stepped.schedule(*entries.back(), d);
+        entries.push_back(new walle::timer_entry([&b_fired, d](walle::timer_entry &) { b_fired.push_back(d); }));
+        jumped.schedule(*entries.back(), d);
+    }
+    for (uint64_t now = 0; now <= 80000; now += 7) {
+        stepped.advance(now);
+    }
+    EXPECT_EQ(0, jumped.advance(16));
+    EXPECT_EQ(2, jumped.advance(4095));
+    EXPECT_EQ(2, jumped.advance(39999));
+    EXPECT_EQ(1, jumped.advance(69999));
+    EXPECT_EQ(1, jumped.advance(80000));
+    EXPECT_TRUE(stepped.empty());
+    EXPECT_TRUE(jumped.empty());
+    std::vector<uint64_t> expected(deadlines.rbegin(), deadlines.rend());
+    EXPECT_EQ(expected, a_fired);
+    EXPECT_EQ(expected, b_fired);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        delete entries[i];
+    }
+}
@@ -0,0 +1,339 @@
+#include <google/gtest/gtest.h>
+#include <walle/unicode/utf.h>
+#include <walle/wsl/stack_buffer.h>
+#include <random>
+#include <string>
+
+static const wsl::internal::simd_isa kIsas[] = {
+    wsl::internal::kSimdSse2, wsl::internal::kSimdAvx2
+};
+
+static const size_t kValid = size_t(-1);
+
+// well formed byte sequences as listed in the unicode standard, table 3-7.
+static size_t reference_error(const std::string &s)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(s.data());
+    const size_t n = s.size();
+    size_t i = 0;
+    while (i < n) {
+        const unsigned char b = p[i];
+        unsigned char lo = 0x80;
+        unsigned char hi = 0xbf;
+        size_t len;
+        if (b < 0x80) {
+            ++i;
+            continue;
+        } else if (b >= 0xc2 && b <= 0xdf) {
+            len = 2;
+        } else if (b >= 0xe0 && b <= 0xef) {
+            len = 3;
+            lo = b == 0xe0 ? 0xa0 : 0x80;
+            hi = b == 0xed ? 0x9f : 0xbf;
+        } else if (b >= 0xf0 && b <= 0xf4) {
+            len = 4;
+            lo = b == 0xf0 ? 0x90 : 0x80;
+            hi = b == 0xf4 ? 0x8f : 0xbf;
+        } else {
+            return i;
+        }
+        if (n - i < len || p[i + 1] < lo || p[i + 1] > hi) {
+            return i;
+        }
+        for (size_t k = 2; k < len; ++k) {
+            if (p[i + k] < 0x80 || p[i + k] > 0xbf) {
+                return i;
+            }
+        }
+        i += len;
+    }
+    return kValid;
+}
+
+static void append_utf8(std::string &s, uint32_t cp)
+{
+    if (cp < 0x80) {
+        s += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        s += static_cast<char>(0xc0 | (cp >> 6));
+        s += static_cast<char>(0x80 | (cp & 0x3f));
+    } else if (cp < 0x10000) {
+        s += static_cast<char>(0xe0 | (cp >> 12));
+        s += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        s += static_cast<char>(0x80 | (cp & 0x3f));
+    } else {
+        s += static_cast<char>(0xf0 | (cp >> 18));
+        s += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+        s += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        s += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+}
+
+// profile 0: mostly ascii with every sequence length mixed in, 1: latin
+// text with 2 byte letters, 2: only 3 byte sequences.
+static std::u32string random_code_points(std::mt19937 &rng, size_t n, int profile = 0)
+{
+    std::u32string cps;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t cp;
+        if (profile == 1) {
+            cps += static_cast<char32_t>(rng() % 4 ? 'a' + rng() % 26 : 0xc0 + rng() % 0x180);
+            continue;
+        }
+        if (profile == 2) {
+            cps += static_cast<char32_t>(0x800 + rng() % (0xd800 - 0x800));
+            continue;
+        }
+        switch (rng() % 8) {
+        case 0:
+            cp = 0x80 + rng() % (0x800 - 0x80);
+            break;
+        case 1:
+            cp = 0x800 + rng() % (0x10000 - 0x800);
+            if (cp >= 0xd800 && cp < 0xe000) {
+                cp -= 0x800;
+            }
+            break;
+        case 2:
+            cp = 0x10000 + rng() % (0x110000 - 0x10000);
+            break;
+        default:
+            cp = rng() % 0x80;
+            break;
+        }
+        cps += static_cast<char32_t>(cp);
+    }
+    return cps;
+}
+
+static std::string to_utf8(const std::u32string &cps)
+{
+    std::string s;
+    for (size_t i = 0; i < cps.size(); ++i) {
+        append_utf8(s, cps[i]);
+    }
+    return s;
+}
+
+static size_t error_at(const std::string &s)
+{
+    const walle::utf_result r = walle::validate_utf8_with_errors(s.data(), s.size());
+    EXPECT_EQ(r.ok(), walle::validate_utf8(s.data(), s.size()));
+    return r.ok() ? kValid : r.count;
+}
+
+TEST(utf, validate_utf8_errors)
+{
+    struct error_case {
+        const char         *bytes;
+        walle::utf_error    error;
+    };
+    static const error_case kCases[] = {
+        { "\xc0\x80", walle::kUtfOverlong },
+        { "\xe0\x9f\xbf", walle::kUtfOverlong },
+        { "\xf0\x8f\xbf\xbf", walle::kUtfOverlong },
+        { "\x80", walle::kUtfTooLong },
+        { "\xe2\x82", walle::kUtfTooShort },
+        { "\xe2\x82x", walle::kUtfTooShort },
+        { "\xf0\x9f\x98", walle::kUtfTooShort },
+        { "\xed\xa0\x80", walle::kUtfSurrogate },
+        { "\xf4\x90\x80\x80", walle::kUtfTooLarge },
+        { "\xf8\x88\x80\x80\x80", walle::kUtfHeaderBits }
+    };
+    for (size_t k = 0; k < sizeof(kIsas) / sizeof(kIsas[0]); ++k) {
+        if (!walle::utf_detail::set_isa(kIsas[k])) {
+            continue;
+        }
+        // every error at offsets around the 64 byte blocks, after ascii and
+        // after a multibyte sequence.
+        for (size_t c = 0; c < sizeof(kCases) / sizeof(kCases[0]); ++c) {
+            for (size_t at = 0; at < 140; ++at) {
+                std::string s(at, 'a');
+                if (at >= 3 && at % 2) {
+                    s.replace(at - 3, 3, "\xe2\x82\xac");
+                }
+                s += kCases[c].bytes;
+                const walle::utf_result r = walle::validate_utf8_with_errors(s.data(), s.size());
+                EXPECT_EQ(kCases[c].error, r.error) << c << " at " << at;
+                EXPECT_EQ(at, r.count) << c << " at " << at;
+                EXPECT_FALSE(walle::validate_utf8(s.data(), s.size()));
+                s += "bbb";
+                EXPECT_EQ(at, error_at(s)) << c << " at " << at;
+            }
+        }
+        EXPECT_TRUE(walle::validate_utf8(wsl::string_view("")));
+        EXPECT_TRUE(walle::validate_utf8(wsl::string_view("z\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80")));
+    }
+    walle::utf_detail::set_isa(wsl::internal::best_simd_isa());
+}
+
+TEST(utf, validate_utf8_random)
+{
+    std::mt19937 rng(42);
+    for (size_t k = 0; k < sizeof(kIsas) / sizeof(kIsas[0]); ++k) {
+        if (!walle::utf_detail::set_isa(kIsas[k])) {
+            continue;
+        }
+        for (size_t round = 0; round < 2000; ++round) {
+            std::string s = to_utf8(random_code_points(rng, rng() % 200));
+            EXPECT_EQ(kValid, error_at(s));
+            // corrupt a few bytes, or cut the text inside a sequence.
+            if (s.empty()) {
+                continue;
+            }
+            if (round % 4 == 0) {
+                s.resize(rng() % s.size());
+            } else {
+                for (size_t m = rng() % 3 + 1; m > 0; --m) {
+                    s[rng() % s.size()] = static_cast<char>(rng());
+                }
+            }
+            EXPECT_EQ(reference_error(s), error_at(s)) << round;
+        }
+    }
+    walle::utf_detail::set_isa(wsl::internal::best_simd_isa());
+}
+
+TEST(utf, validate_utf16_utf32)
+{
+    std::u16string s(40, u'a');
+    EXPECT_TRUE(walle::validate_utf16(s.data(), s.size()));
+    s[20] = 0xd83d;
+    s[21] = 0xde00;
+    EXPECT_TRUE(walle::validate_utf16(s.data(), s.size()));
+    s[21] = u'a';
+    walle::utf_result r = walle::validate_utf16_with_errors(s.data(), s.size());
+    EXPECT_EQ(walle::kUtfSurrogate, r.error);
+    EXPECT_EQ(20u, r.count);
+    s[20] = 0xde00;
+    EXPECT_EQ(20u, walle::validate_utf16_with_errors(s.data(), s.size()).count);
+    s[20] = u'a';
+    s.back() = 0xd800;
+    EXPECT_EQ(39u, walle::validate_utf16_with_errors(s.data(), s.size()).count);
+
+    std::u32string w(20, U'a');
+    w[7] = 0x10ffff;
+    EXPECT_TRUE(walle::validate_utf32(w.data(), w.size()));
+    w[9] = 0x110000;
+    r = walle::validate_utf32_with_errors(w.data(), w.size());
+    EXPECT_EQ(walle::kUtfTooLarge, r.error);
+    EXPECT_EQ(9u, r.count);
+    w[9] = 0xffffffffu;
+    EXPECT_EQ(walle::kUtfTooLarge, walle::validate_utf32_with_errors(w.data(), w.size()).error);
+    w[9] = U'a';
+    w[18] = 0xdfff;
+    r = walle::validate_utf32_with_errors(w.data(), w.size());
+    EXPECT_EQ(walle::kUtfSurrogate, r.error);
+    EXPECT_EQ(18u, r.count);
+}
+
+TEST(utf, round_trip)
+{
+    std::mt19937 rng(7);
+    for (size_t round = 0; round < 600; ++round) {
+        const std::u32string cps = random_code_points(rng, rng() % 300, static_cast<int>(round % 3));
+        const std::string u8 = to_utf8(cps);
+
+        std::u16string u16(u8.size() + 1, 0);
+        walle::utf_result r = walle::convert_utf8_to_utf16(u8.data(), u8.size(), &u16[0]);
+        ASSERT_TRUE(r.ok());
+        EXPECT_EQ(walle::utf16_length_from_utf8(u8.data(), u8.size()), r.count);
+        u16.resize(r.count);
+        EXPECT_TRUE(walle::validate_utf16(u16.data(), u16.size()));
+
+        std::u32string u32(u8.size() + 1, 0);
+        r = walle::convert_utf8_to_utf32(u8.data(), u8.size(), &u32[0]);
+        ASSERT_TRUE(r.ok());
+        EXPECT_EQ(walle::utf32_length_from_utf8(u8.data(), u8.size()), r.count);
+        u32.resize(r.count);
+        EXPECT_EQ(cps, u32);
+
+        std::u32string from16(u16.size() + 1, 0);
+        r = walle::convert_utf16_to_utf32(u16.data(), u16.size(), &from16[0]);
+        ASSERT_TRUE(r.ok());
+        EXPECT_EQ(walle::utf32_length_from_utf16(u16.data(), u16.size()), r.count);
+        from16.resize(r.count);
+        EXPECT_EQ(cps, from16);
+
+        std::string back8(u16.size() * 3 + 1, 0);
+        r = walle::convert_utf16_to_utf8(u16.data(), u16.size(), &back8[0]);
+        ASSERT_TRUE(r.ok());
+        EXPECT_EQ(walle::utf8_length_from_utf16(u16.data(), u16.size()), r.count);
+        back8.resize(r.count);
+        EXPECT_EQ(u8, back8);
+
+        std::string from32(cps.size() * 4 + 1, 0);
+        r = walle::convert_utf32_to_utf8(cps.data(), cps.size(), &from32[0]);
+        ASSERT_TRUE(r.ok());
+        EXPECT_EQ(walle::utf8_length_from_utf32(cps.data(), cps.size()), r.count);
+        from32.resize(r.count);
+        EXPECT_EQ(u8, from32);
+
+        std::u16string to16(cps.size() * 2 + 1, 0);
+        r = walle::convert_utf32_to_utf16(cps.data(), cps.size(), &to16[0]);
+        ASSERT_TRUE(r.ok());
+        EXPECT_EQ(walle::utf16_length_from_utf32(cps.data(), cps.size()), r.count);
+        to16.resize(r.count);
+        EXPECT_EQ(u16, to16);
+    }
+}
+
+TEST(utf, convert_errors)
+{
+    std::mt19937 rng(9);
+    for (int profile = 0; profile < 3; ++profile) {
+        for (size_t at = 0; at < 200; at += 13) {
+            const std::string head = to_utf8(random_code_points(rng, at, profile));
+            const std::string text = head + "\xed\xa0\x80" + to_utf8(random_code_points(rng, 100, profile));
+            std::u32string out(text.size(), 0);
+            const walle::utf_result r = walle::convert_utf8_to_utf32(text.data(), text.size(), &out[0]);
+            EXPECT_EQ(walle::kUtfSurrogate, r.error);
+            EXPECT_EQ(head.size(), r.count);
+            // the input before the error is converted.
+            std::u32string expect(head.size(), 0);
+            expect.resize(walle::convert_utf8_to_utf32(head.data(), head.size(), &expect[0]).count);
+            EXPECT_EQ(expect, out.substr(0, expect.size()));
+        }
+    }
+    const std::u16string u16(u"abc\xd800" u"def");
+    std::string out(u16.size() * 3, 0);
+    walle::utf_result r = walle::convert_utf16_to_utf8(u16.data(), u16.size(), &out[0]);
+    EXPECT_EQ(walle::kUtfSurrogate, r.error);
+    EXPECT_EQ(3u, r.count);
+    const std::u32string u32(U"abcdefgh\x110000");
+    r = walle::convert_utf32_to_utf8(u32.data(), u32.size(), &out[0]);
+    EXPECT_EQ(walle::kUtfTooLarge, r.error);
+    EXPECT_EQ(8u, r.count);
+}
+
+TEST(utf, buffers)
+{
+    typedef wsl::stack_buffer<char16_t, 16> u16_buffer;
+    u16_buffer buf;
+    const std::string text = std::string(40, 'x') + "\xe2\x82\xac" + "\xf0\x9f\x98\x80";
+    {
+        wsl::internal::buffer_adapter<u16_buffer> out(buf);
+        walle::utf_result r = walle::utf8_to_utf16(wsl::string_view(text.data(), text.size()), out);
+        EXPECT_TRUE(r.ok());
+        EXPECT_EQ(43u, r.count);
+        // appends, and leaves the buffer alone on error.
+        r = walle::utf8_to_utf16(wsl::string_view("ab\xff"), out);
+        EXPECT_EQ(walle::kUtfHeaderBits, r.error);
+        EXPECT_EQ(2u, r.count);
+        r = walle::utf8_to_utf16(wsl::string_view("!"), out);
+        EXPECT_TRUE(r.ok());
+    }
+    ASSERT_EQ(44u, buf.size());
+    EXPECT_EQ(u'x', buf[39]);
+    EXPECT_EQ(0x20ac, buf[40]);
+    EXPECT_EQ(0xd83d, buf[41]);
+    EXPECT_EQ(0xde00, buf[42]);
+    EXPECT_EQ(u'!', buf[43]);
+
+    wsl::stack_buffer<char, 8> bytes;
+    {
+        wsl::internal::buffer_adapter<wsl::stack_buffer<char, 8> > out(bytes);
+        EXPECT_TRUE(walle::utf16_to_utf8(wsl::u16string_view(buf.data(), buf.size()), out).ok());
+    }
+    EXPECT_EQ(text + "!", std::string(bytes.data(), bytes.size()));
+}
@@ -0,0 +1,104 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/allocator.h>
+#include <walle/wsl/stack_buffer.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+static bool aligned_to(const void *p, size_t align)
+{
+    return (reinterpret_cast<uintptr_t>(p) & (align - 1)) == 0;
+}
+
+TEST(allocator, allocate_aligned)
+{
+    const size_t aligns[] = {8, 64, 4096, 1 << 16};
+    for (size_t i = 0; i < sizeof(aligns) / sizeof(aligns[0]); ++i) {
+        void *p = wsl::allocate_aligned(100, aligns[i]);
+        EXPECT_TRUE(aligned_to(p, aligns[i]));
+        std::memset(p, 0xab, 100);
+        wsl::deallocate_aligned(p);
+    }
+    void *c = wsl::allocate_cache_aligned(1);
+    EXPECT_TRUE(aligned_to(c, WALLE_CACHE_LINE_SIZE));
+    wsl::deallocate_aligned(c);
+    void *g = wsl::allocate_page_aligned(10000);
+    EXPECT_TRUE(aligned_to(g, wsl::kPageSize));
+    wsl::deallocate_aligned(g);
+    wsl::deallocate_aligned(WALLE_NULL);
+
+    // sizes whose padding would wrap around are refused.
+    EXPECT_THROW(wsl::allocate_aligned(SIZE_MAX, 64), std::bad_alloc);
+    EXPECT_THROW(wsl::allocate_aligned(SIZE_MAX - 8, 8), std::bad_alloc);
+    EXPECT_THROW(wsl::allocate_cache_aligned(SIZE_MAX - 1), std::bad_alloc);
+    EXPECT_THROW(wsl::allocate_page_aligned(SIZE_MAX - 4096), std::bad_alloc);
+}
+
+TEST(allocator, aligned_allocator_vector)
+{
+    std::vector<int, wsl::aligned_allocator<int, 256> > v;
+    for (int i = 0; i < 1000; ++i) {
+        v.push_back(i);
+        EXPECT_TRUE(aligned_to(v.data(), 256));
+    }
+    EXPECT_EQ(999, v.back());
+}
+
+TEST(allocator, huge_page_map)
+{
+    const size_t sizes[] = {1, wsl::kHugePageSize, 3 * wsl::kHugePageSize + 5};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        char *p = static_cast<char*>(wsl::internal::huge_page_map(sizes[i], false));
+        EXPECT_TRUE(aligned_to(p, wsl::kHugePageSize));
+        p[0] = 1;
+        p[sizes[i] - 1] = 2;
+        wsl::internal::huge_page_unmap(p, sizes[i]);
+    }
+    // without reserved hugetlb pages this falls back to normal mappings.
+    char *p = static_cast<char*>(wsl::internal::huge_page_map(wsl::kHugePageSize, true));
+    EXPECT_TRUE(aligned_to(p, wsl::kHugePageSize));
+    p[wsl::kHugePageSize - 1] = 1;
+    wsl::internal::huge_page_unmap(p, wsl::kHugePageSize);
+}
+
+TEST(allocator, huge_page_allocator)
+{
+    wsl::huge_page_allocator<uint64_t> alloc;
+    uint64_t *small = alloc.allocate(16);
+    EXPECT_TRUE(aligned_to(small, WALLE_CACHE_LINE_SIZE));
+    alloc.deallocate(small, 16);
+
+    const size_t n = (4 << 20) / sizeof(uint64_t);
+    uint64_t *big = alloc.allocate(n);
+    EXPECT_TRUE(aligned_to(big, wsl::kHugePageSize));
+    for (size_t i = 0; i < n; i += 512) {
+        big[i] = i;
+    }
+    EXPECT_EQ(n - 512, big[n - 512]);
+    alloc.deallocate(big, n);
+
+    wsl::huge_page_allocator<char>::rebind<int>::other rebound(alloc);
+    EXPECT_TRUE(rebound == wsl::huge_page_allocator<int>());
+
+    // counts whose byte size doesn't fit are refused.
+    EXPECT_THROW(alloc.allocate(SIZE_MAX / 4), std::bad_alloc);
+    EXPECT_THROW(wsl::huge_page_allocator<char>().allocate(SIZE_MAX - 1), std::bad_alloc);
+    EXPECT_THROW((wsl::aligned_allocator<uint64_t, 64>().allocate(SIZE_MAX / 4)), std::bad_alloc);
+}
+
+TEST(allocator, huge_page_allocator_containers)
+{
+    std::vector<uint32_t, wsl::huge_page_allocator<uint32_t> > v;
+    for (uint32_t i = 0; i < (1 << 20); ++i) {
+        v.push_back(i);
+    }
+    EXPECT_EQ((1u << 20) - 1, v.back());
+
+    wsl::stack_buffer<char, 64, wsl::huge_page_allocator<char> > buf;
+    std::vector<char> chunk(1 << 20, 'x');
+    for (int i = 0; i < 3; ++i) {
+        buf.append(chunk.data(), chunk.data() + chunk.size());
+    }
+    EXPECT_EQ(size_t(3 << 20), buf.size());
+    EXPECT_EQ('x', buf[(3 << 20) - 1]);
+}
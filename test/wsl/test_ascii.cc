@@ -0,0 +1,200 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/ascii.h>
+#include <walle/wsl/string_view.h>
+#include <random>
+#include <string>
+#include <vector>
+
+static const wsl::internal::simd_isa kIsas[] = {
+    wsl::internal::kSimdSse2, wsl::internal::kSimdAvx2
+};
+
+static std::string random_bytes(std::mt19937 &rng, size_t n)
+{
+    std::string s;
+    for (size_t i = 0; i < n; ++i) {
+        s.push_back(static_cast<char>(rng()));
+    }
+    return s;
+}
+
+static int reference_compare_i(const std::string &a, const std::string &b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const int ca = wsl::ascii::to_lower(static_cast<unsigned char>(a[i]));
+        const int cb = wsl::ascii::to_lower(static_cast<unsigned char>(b[i]));
+        if (ca != cb) {
+            return ca < cb ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+TEST(ascii, bulk_case_matches_scalar)
+{
+    std::mt19937 rng(11);
+    for (size_t isa = 0; isa < 2; ++isa) {
+        if (!wsl::internal::set_ascii_isa(kIsas[isa])) {
+            continue;
+        }
+        for (size_t n = 0; n < 200; ++n) {
+            const std::string src = random_bytes(rng, n);
+            std::string lower(n, '\0');
+            std::string upper(n, '\0');
+            wsl::ascii::to_lower(src.data(), n, &lower[0]);
+            wsl::ascii::to_upper(src.data(), n, &upper[0]);
+            std::string in_place = src;
+            wsl::ascii::to_lower(wsl::buffer_view<char>(&in_place[0], n));
+            for (size_t i = 0; i < n; ++i) {
+                const int c = static_cast<unsigned char>(src[i]);
+                ASSERT_EQ(wsl::ascii::to_lower(c), static_cast<unsigned char>(lower[i])) << n << " " << i;
+                ASSERT_EQ(wsl::ascii::to_upper(c), static_cast<unsigned char>(upper[i])) << n << " " << i;
+            }
+            ASSERT_EQ(lower, in_place);
+        }
+    }
+}
+
+TEST(ascii, all_bytes)
+{
+    std::string all;
+    for (int c = 0; c < 256; ++c) {
+        all.push_back(static_cast<char>(c));
+    }
+    for (size_t isa = 0; isa < 2; ++isa) {
+        if (!wsl::internal::set_ascii_isa(kIsas[isa])) {
+            continue;
+        }
+        std::string lower = all;
+        std::string upper = all;
+        wsl::ascii::to_lower(wsl::buffer_view<char>(&lower[0], lower.size()));
+        wsl::ascii::to_upper(wsl::buffer_view<char>(&upper[0], upper.size()));
+        for (int c = 0; c < 256; ++c) {
+            EXPECT_EQ(wsl::ascii::to_lower(c), static_cast<unsigned char>(lower[c]));
+            EXPECT_EQ(wsl::ascii::to_upper(c), static_cast<unsigned char>(upper[c]));
+        }
+        EXPECT_TRUE(wsl::ascii::equals_i(lower.data(), upper.data(), 256));
+    }
+}
+
+TEST(ascii, compare_and_equals_i)
+{
+    std::mt19937 rng(12);
+    for (size_t isa = 0; isa < 2; ++isa) {
+        if (!wsl::internal::set_ascii_isa(kIsas[isa])) {
+            continue;
+        }
+        for (int round = 0; round < 2000; ++round) {
+            const size_t n = rng() % 100;
+            std::string a = random_bytes(rng, n);
+            std::string b = a;
+            // flip the case of some letters, and sometimes change one byte.
+            for (size_t i = 0; i < n; ++i) {
+                if (rng() % 3 == 0) {
+                    b[i] = static_cast<char>(wsl::ascii::is_lower(static_cast<unsigned char>(b[i]))
+                        ? wsl::ascii::to_upper(static_cast<unsigned char>(b[i]))
+                        : wsl::ascii::to_lower(static_cast<unsigned char>(b[i])));
+                }
+            }
+            if (n && rng() % 2) {
+                b[rng() % n] = static_cast<char>(rng());
+            }
+            const int expected = reference_compare_i(a, b, n);
+            ASSERT_EQ(expected, wsl::ascii::compare_i(a.data(), b.data(), n));
+            ASSERT_EQ(expected == 0, wsl::ascii::equals_i(a.data(), b.data(), n));
+        }
+    }
+    EXPECT_TRUE(wsl::equals_i(wsl::string_view("Content-Length"), wsl::string_view("content-length")));
+    EXPECT_FALSE(wsl::equals_i(wsl::string_view("Content-Length"), wsl::string_view("content-lengt")));
+    EXPECT_FALSE(wsl::equals_i(wsl::string_view("\xc0"), wsl::string_view("\xe0")));
+    EXPECT_GT(0, wsl::compare_i(wsl::string_view("abc"), wsl::string_view("ABCD")));
+    EXPECT_LT(0, wsl::compare_i(wsl::string_view("abd"), wsl::string_view("ABCD")));
+    EXPECT_EQ(0, wsl::compare_i(wsl::string_view("Host"), wsl::string_view("hOST")));
+}
+
+static const int kMasks[] = {
+    wsl::ascii::eAcpControl, wsl::ascii::eAcpSpace, wsl::ascii::eAcpDigit,
+    wsl::ascii::eAcpHexDigit | wsl::ascii::eAcpAlpha, wsl::ascii::eAcpLower,
+    wsl::ascii::eAcpPrint, wsl::ascii::eAcpGraph | wsl::ascii::eAcpPunct
+};
+
+// every length and alignment up to a few vectors, all ascii bytes and
+// bytes above it, against the per character functions.
+TEST(ascii, bulk_classify_matches_scalar)
+{
+    std::mt19937 rng(50);
+    for (size_t isa = 0; isa < 2; ++isa) {
+        if (!wsl::internal::set_ascii_isa(kIsas[isa])) {
+            continue;
+        }
+        for (int round = 0; round < 3000; ++round) {
+            const size_t n = rng() % 200;
+            std::string s(n, '\0');
+            for (size_t i = 0; i < n; ++i) {
+                // mostly ascii, so the finds don't all stop at once.
+                s[i] = static_cast<char>(rng() % 16 ? rng() % 128 : rng());
+            }
+            const size_t offset = rng() % 4;
+            const wsl::buffer_view<const char> buf(s.data() + offset, n < offset ? 0 : n - offset);
+
+            bool ascii = true;
+            for (size_t i = 0; i < buf.size(); ++i) {
+                ascii = ascii && wsl::ascii::is_ascii(static_cast<unsigned char>(buf[i]));
+            }
+            ASSERT_EQ(ascii, wsl::ascii::all_ascii(buf));
+
+            for (size_t m = 0; m < sizeof(kMasks) / sizeof(kMasks[0]); ++m) {
+                size_t first_with = buf.size();
+                size_t first_without = buf.size();
+                size_t count = 0;
+                std::vector<uint64_t> expected((buf.size() + 63) / 64, 0);
+                for (size_t i = 0; i < buf.size(); ++i) {
+                    if (wsl::ascii::has_properties(static_cast<unsigned char>(buf[i]), kMasks[m])) {
+                        first_with = first_with == buf.size() ? i : first_with;
+                        ++count;
+                        expected[i / 64] |= uint64_t(1) << (i % 64);
+                    } else {
+                        first_without = first_without == buf.size() ? i : first_without;
+                    }
+                }
+                ASSERT_EQ(first_with, wsl::ascii::find_first_with_properties(buf, kMasks[m])) << n;
+                ASSERT_EQ(first_without, wsl::ascii::find_first_without_properties(buf, kMasks[m])) << n;
+                ASSERT_EQ(count, wsl::ascii::count_properties(buf, kMasks[m])) << n;
+                std::vector<uint64_t> bits(expected.size() + 1, ~uint64_t(0));
+                wsl::ascii::classify_into(buf, kMasks[m], wsl::buffer_view<uint64_t>(bits.data(), bits.size()));
+                bits.pop_back();
+                ASSERT_EQ(expected, bits) << n;
+            }
+        }
+    }
+}
+
+TEST(ascii, bulk_classify)
+{
+    const std::string header("Content-Length: 1234\r\n");
+    const wsl::buffer_view<const char> buf(header.data(), header.size());
+    EXPECT_TRUE(wsl::ascii::all_ascii(buf));
+    EXPECT_EQ(7u, wsl::ascii::find_first_with_properties(buf, wsl::ascii::eAcpPunct));
+    EXPECT_EQ(16u, wsl::ascii::find_first_with_properties(buf, wsl::ascii::eAcpDigit));
+    EXPECT_EQ(15u, wsl::ascii::find_first_without_properties(buf, wsl::ascii::eAcpGraph));
+    EXPECT_EQ(20u, wsl::ascii::find_first_without_properties(buf, wsl::ascii::eAcpPrint));
+    EXPECT_EQ(4u, wsl::ascii::count_properties(buf, wsl::ascii::eAcpDigit));
+    EXPECT_EQ(2u, wsl::ascii::count_properties(buf, wsl::ascii::eAcpUpper));
+    EXPECT_EQ(2u, wsl::ascii::count_properties(buf, wsl::ascii::eAcpControl | wsl::ascii::eAcpSpace));
+    EXPECT_EQ(buf.size(), wsl::ascii::find_first_with_properties(buf, wsl::ascii::eAcpLower | wsl::ascii::eAcpUpper));
+
+    // a byte above ascii never has a property.
+    std::string text(1000, 'a');
+    text[777] = static_cast<char>(0xe9);
+    const wsl::buffer_view<const char> t(text.data(), text.size());
+    EXPECT_FALSE(wsl::ascii::all_ascii(t));
+    EXPECT_EQ(777u, wsl::ascii::find_first_without_properties(t, wsl::ascii::eAcpLower));
+    EXPECT_EQ(999u, wsl::ascii::count_properties(t, wsl::ascii::eAcpAlpha));
+    EXPECT_TRUE(wsl::ascii::all_ascii(wsl::buffer_view<const char>(text.data(), 777)));
+
+    uint64_t bits[16];
+    wsl::ascii::classify_into(t, wsl::ascii::eAcpAlpha, wsl::buffer_view<uint64_t>(bits, 16));
+    EXPECT_EQ(~(uint64_t(1) << (777 % 64)), bits[777 / 64]);
+    EXPECT_EQ(~uint64_t(0), bits[0]);
+    EXPECT_EQ((uint64_t(1) << (1000 % 64)) - 1, bits[15]);
+}
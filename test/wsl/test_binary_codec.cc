@@ -0,0 +1,142 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/binary_codec.h>
+#include <walle/wsl/container_buffer.h>
+#include <walle/wsl/stack_buffer.h>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+TEST(binary_codec, fixed_width_byte_order)
+{
+    wsl::stack_buffer<char, 16> buf;
+    {
+        wsl::binary_writer<wsl::stack_buffer<char, 16> > w(buf);
+        w.write_le(uint32_t(0x01020304));
+        w.write_be(uint32_t(0x01020304));
+        w.write_be(uint16_t(0xa1b2));
+        w.write_le(1.5);
+    }
+    ASSERT_EQ(size_t(18), buf.size());
+    EXPECT_EQ(std::string("\x04\x03\x02\x01\x01\x02\x03\x04\xa1\xb2", 10),
+              std::string(buf.data(), 10));
+
+    wsl::binary_reader r(buf.data(), buf.size());
+    uint32_t a, b;
+    uint16_t c;
+    double d;
+    EXPECT_TRUE(r.read_le(a));
+    EXPECT_TRUE(r.read_be(b));
+    EXPECT_TRUE(r.read_be(c));
+    EXPECT_TRUE(r.read_le(d));
+    EXPECT_EQ(0x01020304u, a);
+    EXPECT_EQ(0x01020304u, b);
+    EXPECT_EQ(0xa1b2, c);
+    EXPECT_EQ(1.5, d);
+    EXPECT_TRUE(r.empty());
+    EXPECT_FALSE(r.read_le(a));
+}
+
+TEST(binary_codec, varint_zigzag)
+{
+    const uint64_t values[] = {0, 1, 127, 128, 300, 16383, 16384,
+                               uint64_t(1) << 35, std::numeric_limits<uint64_t>::max()};
+    const size_t sizes[] = {1, 1, 1, 2, 2, 2, 3, 6, 10};
+    std::string out;
+    wsl::container_buffer<std::string> buf(out);
+    wsl::binary_writer<wsl::container_buffer<std::string> > w(buf);
+    size_t total = 0;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        EXPECT_EQ(sizes[i], wsl::varint_size(values[i]));
+        w.write_varint(values[i]);
+        total += sizes[i];
+        EXPECT_EQ(total, w.size());
+    }
+    w.write_zigzag(-1);
+    w.write_zigzag(std::numeric_limits<int64_t>::min());
+    w.flush();
+    EXPECT_EQ(std::string("\xac\x02", 2), out.substr(5, 2));
+
+    wsl::binary_reader r(out.data(), out.size());
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        uint64_t v;
+        ASSERT_TRUE(r.read_varint(v));
+        EXPECT_EQ(values[i], v);
+    }
+    int64_t z;
+    ASSERT_TRUE(r.read_zigzag(z));
+    EXPECT_EQ(-1, z);
+    ASSERT_TRUE(r.read_zigzag(z));
+    EXPECT_EQ(std::numeric_limits<int64_t>::min(), z);
+    EXPECT_TRUE(r.empty());
+
+    EXPECT_EQ(0u, wsl::zigzag_encode(0));
+    EXPECT_EQ(1u, wsl::zigzag_encode(-1));
+    EXPECT_EQ(2u, wsl::zigzag_encode(1));
+}
+
+TEST(binary_codec, malformed_input)
+{
+    uint64_t v = 7;
+    // truncated varint leaves the reader where it was.
+    wsl::binary_reader truncated("\x80\x80", 2);
+    EXPECT_FALSE(truncated.read_varint(v));
+    EXPECT_EQ(size_t(2), truncated.remaining());
+    EXPECT_EQ(7u, v);
+
+    // eleven bytes, or a tenth byte above 1, overflow 64 bits.
+    wsl::binary_reader too_long("\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01", 11);
+    EXPECT_FALSE(too_long.read_varint(v));
+    wsl::binary_reader overflow("\xff\xff\xff\xff\xff\xff\xff\xff\xff\x02", 10);
+    EXPECT_FALSE(overflow.read_varint(v));
+
+    // string length past the end.
+    wsl::binary_reader short_string("\x05" "abc", 4);
+    wsl::string_view s;
+    EXPECT_FALSE(short_string.read_string(s));
+    EXPECT_EQ(size_t(4), short_string.remaining());
+}
+
+TEST(binary_codec, strings_and_unchecked)
+{
+    wsl::stack_buffer<char, 8> buf;
+    std::string payload(300, 'p');
+    {
+        wsl::binary_writer<wsl::stack_buffer<char, 8> > w(buf);
+        w.reserve(2 * wsl::kMaxVarintSize + 5 + payload.size() + 4);
+        const size_t room = w.available();
+        w.write_string_unchecked(wsl::string_view("hello"));
+        w.write_string_unchecked(wsl::string_view(payload.data(), payload.size()));
+        w.write_le_unchecked(int32_t(-2));
+        EXPECT_EQ(room - (1 + 5 + 2 + 300 + 4), w.available());
+    }
+    EXPECT_EQ(size_t(1 + 5 + 2 + 300 + 4), buf.size());
+
+    wsl::binary_reader r(wsl::buffer_view<const char>(buf.data(), buf.size()));
+    wsl::string_view a, b;
+    ASSERT_TRUE(r.read_string(a));
+    ASSERT_TRUE(r.read_string(b));
+    EXPECT_EQ(std::string("hello"), std::string(a.data(), a.size()));
+    EXPECT_EQ(payload, std::string(b.data(), b.size()));
+    EXPECT_EQ(buf.data() + 1, a.data());
+    ASSERT_EQ(size_t(4), r.remaining());
+    EXPECT_EQ(-2, r.read_le_unchecked<int32_t>());
+}
+
+TEST(binary_codec, type_erased_buffer)
+{
+    wsl::stack_buffer<char, 4> buf;
+    wsl::internal::buffer_adapter<wsl::stack_buffer<char, 4> > adapter(buf);
+    wsl::internal::basic_buffer<char> &erased = adapter;
+    {
+        wsl::binary_writer<wsl::internal::basic_buffer<char> > w(erased);
+        for (uint32_t i = 0; i < 1000; ++i) {
+            w.write_le(i);
+        }
+    }
+    adapter.sync();
+    ASSERT_EQ(size_t(4000), buf.size());
+    wsl::binary_reader r(buf.data(), buf.size());
+    for (uint32_t i = 0; i < 1000; ++i) {
+        EXPECT_EQ(i, r.read_le_unchecked<uint32_t>());
+    }
+}
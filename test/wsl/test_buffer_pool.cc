@@ -0,0 +1,125 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/buffer_pool.h>
+#include <walle/wsl/container_buffer.h>
+#include <walle/wsl/stack_buffer.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(buffer_pool, size_classes)
+{
+    EXPECT_EQ(64, wsl::buffer_pool::block_size(1));
+    EXPECT_EQ(4096, wsl::buffer_pool::block_size(4096));
+    EXPECT_EQ(8192, wsl::buffer_pool::block_size(4097));
+    EXPECT_EQ(3 << 20, wsl::buffer_pool::block_size(3 << 20));
+}
+
+TEST(buffer_pool, reuse_and_stats)
+{
+    wsl::buffer_pool pool;
+    void *a = pool.allocate(5000);
+    pool.deallocate(a, 5000);
+    void *b = pool.allocate(8000);
+    EXPECT_EQ(a, b);
+    pool.deallocate(b, 8000);
+
+    wsl::buffer_pool::stats s = pool.get_stats();
+    EXPECT_EQ(2, s.allocations);
+    EXPECT_EQ(1, s.thread_hits);
+    EXPECT_EQ(1, s.misses);
+    EXPECT_EQ(8192, s.bytes_cached);
+    EXPECT_DOUBLE_EQ(0.5, s.hit_rate());
+
+    pool.flush_thread_cache();
+    EXPECT_EQ(8192, pool.get_stats().bytes_in_depot);
+    void *c = pool.allocate(8192);
+    EXPECT_EQ(a, c);
+    EXPECT_EQ(1, pool.get_stats().depot_hits);
+    pool.deallocate(c, 8192);
+    EXPECT_EQ(8192, pool.trim());
+    EXPECT_EQ(0, pool.get_stats().bytes_cached);
+}
+
+TEST(buffer_pool, cross_thread)
+{
+    wsl::buffer_pool pool(16 * 1024);
+    std::vector<void*> blocks;
+    for (int i = 0; i < 100; ++i) {
+        blocks.push_back(pool.allocate(4096));
+    }
+    // freed on another thread, which hands its cache back when it exits.
+    std::thread t([&pool, &blocks]() {
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            pool.deallocate(blocks[i], 4096);
+        }
+    });
+    t.join();
+    wsl::buffer_pool::stats s = pool.get_stats();
+    EXPECT_EQ(100 * 4096, s.bytes_in_depot);
+    EXPECT_EQ(100, s.allocations);
+    EXPECT_EQ(100 * 4096, pool.trim());
+}
+
+TEST(buffer_pool, destroyed_before_thread_exit)
+{
+    wsl::buffer_pool *pool = new wsl::buffer_pool();
+    std::atomic<int> step(0);
+    std::thread t([pool, &step]() {
+        void *p = pool->allocate(4096);
+        pool->deallocate(p, 4096);
+        step.store(1);
+        while (step.load() != 2) {
+            std::this_thread::yield();
+        }
+        // the cache was detached, not freed under the thread; a new pool
+        // gets a fresh one and the old one's blocks go back on exit.
+        wsl::buffer_pool other;
+        void *q = other.allocate(4096);
+        other.deallocate(q, 4096);
+        EXPECT_EQ(1, other.get_stats().misses);
+    });
+    while (step.load() != 1) {
+        std::this_thread::yield();
+    }
+    delete pool;
+    step.store(2);
+    t.join();
+}
+
+TEST(buffer_pool, uncached_stats)
+{
+    // a thread has caches for a few pools only, the rest go to the depot
+    // directly and still count.
+    std::vector<wsl::buffer_pool*> pools;
+    for (int i = 0; i < 9; ++i) {
+        pools.push_back(new wsl::buffer_pool());
+        void *p = pools.back()->allocate(100);
+        pools.back()->deallocate(p, 100);
+    }
+    wsl::buffer_pool &last = *pools.back();
+    void *p = last.allocate(100);
+    wsl::buffer_pool::stats s = last.get_stats();
+    EXPECT_EQ(2, s.allocations);
+    EXPECT_EQ(1, s.misses);
+    EXPECT_EQ(1, s.depot_hits);
+    last.deallocate(p, 100);
+    for (size_t i = 0; i < pools.size(); ++i) {
+        delete pools[i];
+    }
+}
+
+TEST(buffer_pool, allocator)
+{
+    wsl::buffer_pool pool;
+    wsl::stack_buffer<char, 16, wsl::pool_allocator<char> > sb;
+    for (int i = 0; i < 10000; ++i) {
+        sb.push_back(static_cast<char>(i));
+    }
+    EXPECT_EQ(static_cast<char>(9999), sb[9999]);
+
+    std::vector<char, wsl::pool_allocator<char> > v(16, 'a', wsl::pool_allocator<char>(pool));
+    wsl::container_buffer<std::vector<char, wsl::pool_allocator<char> > > cb(v);
+    cb.append("bcd", 3);
+    EXPECT_EQ(19, v.size());
+    EXPECT_LT(0, pool.get_stats().allocations);
+}
@@ -0,0 +1,84 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/chain_buffer.h>
+#include <string>
+
+static std::string to_string(const wsl::chain_buffer &cb)
+{
+    std::string out(cb.size(), '\0');
+    cb.copy_to(&out[0], out.size());
+    return out;
+}
+
+TEST(chain_buffer, append_and_trim)
+{
+    wsl::chain_buffer cb(8);
+    cb.append("hello, ", 7);
+    cb.append(wsl::buffer_view<const char>("chained world", 13));
+    EXPECT_EQ(20, cb.size());
+    EXPECT_EQ(2, cb.segment_count());
+    EXPECT_EQ("hello, chained world", to_string(cb));
+
+    cb.trim_front(9);
+    cb.trim_back(2);
+    EXPECT_EQ("ained wor", to_string(cb));
+    EXPECT_EQ("ained wor", std::string(cb.linearize().data(), cb.size()));
+    EXPECT_EQ(1, cb.segment_count());
+}
+
+TEST(chain_buffer, share_without_copy)
+{
+    wsl::chain_buffer a(16);
+    a.append("0123456789", 10);
+    wsl::chain_buffer b(a);
+    EXPECT_EQ(a.segment(0).data(), b.segment(0).data());
+
+    // a shared tail is never written in place.
+    a.append("abc", 3);
+    EXPECT_EQ("0123456789abc", to_string(a));
+    EXPECT_EQ("0123456789", to_string(b));
+    EXPECT_EQ(2, a.segment_count());
+
+    wsl::chain_buffer c;
+    c.append(b);
+    c.append(std::move(a));
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ("01234567890123456789abc", to_string(c));
+}
+
+TEST(chain_buffer, split)
+{
+    wsl::chain_buffer cb(4);
+    cb.append("abcd", 4);
+    cb.append("efgh", 4);
+    cb.append("ij", 2);
+    EXPECT_EQ(3, cb.segment_count());
+    wsl::chain_buffer head = cb.split(6);
+    EXPECT_EQ("abcdef", to_string(head));
+    EXPECT_EQ("ghij", to_string(cb));
+    EXPECT_EQ(head.segment(1).data() + 2, cb.segment(0).data());
+    head.append("XY", 2);
+    EXPECT_EQ("abcdefXY", to_string(head));
+    EXPECT_EQ("ghij", to_string(cb));
+}
+
+TEST(chain_buffer, prepare_commit_iovec)
+{
+    wsl::chain_buffer cb(16);
+    wsl::buffer_view<char> space = cb.prepare(4);
+    ASSERT_GE(space.size(), 4);
+    memcpy(space.data(), "read", 4);
+    cb.commit(4);
+    space = cb.prepare(4);
+    memcpy(space.data(), "more", 4);
+    cb.commit(4);
+    EXPECT_EQ(1, cb.segment_count());
+    space = cb.prepare(100);
+    ASSERT_GE(space.size(), 100);
+    memcpy(space.data(), "!", 1);
+    cb.commit(1);
+
+    struct iovec iov[4];
+    ASSERT_EQ(2, cb.to_iovec(iov, 4));
+    EXPECT_EQ(std::string("readmore"), std::string(static_cast<char*>(iov[0].iov_base), iov[0].iov_len));
+    EXPECT_EQ(1, iov[1].iov_len);
+}
@@ -0,0 +1,271 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/charconv.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+template <typename T>
+static wsl::from_chars_result parse(const std::string &s, T &value, int base = 10)
+{
+    return wsl::from_chars(s.data(), s.data() + s.size(), value, base);
+}
+
+static wsl::from_chars_result parse(const std::string &s, double &value)
+{
+    return wsl::from_chars(s.data(), s.data() + s.size(), value);
+}
+
+static wsl::from_chars_result parse(const std::string &s, float &value)
+{
+    return wsl::from_chars(s.data(), s.data() + s.size(), value);
+}
+
+template <typename T>
+static void expect_limits()
+{
+    T v = 0;
+    const std::string max = std::to_string(std::numeric_limits<T>::max());
+    const std::string min = std::to_string(std::numeric_limits<T>::min());
+    EXPECT_TRUE(parse(max, v).ok());
+    EXPECT_EQ(std::numeric_limits<T>::max(), v);
+    EXPECT_TRUE(parse(min, v).ok());
+    EXPECT_EQ(std::numeric_limits<T>::min(), v);
+
+    // one past either end, the value is left alone.
+    std::string above = max;
+    ++above[above.size() - 1];
+    if (above[above.size() - 1] > '9') {
+        above = max + "0";
+    }
+    v = 7;
+    const wsl::from_chars_result r = parse(above, v);
+    EXPECT_EQ(std::errc::result_out_of_range, r.ec);
+    EXPECT_EQ(above.size(), size_t(r.ptr - above.data()));
+    EXPECT_EQ(7, v);
+    if (std::numeric_limits<T>::is_signed) {
+        std::string below = min;
+        ++below[below.size() - 1];
+        EXPECT_EQ(std::errc::result_out_of_range, parse(below, v).ec);
+    } else {
+        EXPECT_EQ(std::errc::invalid_argument, parse("-1", v).ec);
+    }
+}
+
+TEST(charconv, integers)
+{
+    int v = 0;
+    wsl::from_chars_result r = parse("12345", v);
+    EXPECT_TRUE(r.ok());
+    EXPECT_EQ(12345, v);
+    r = parse("-42abc", v);
+    EXPECT_TRUE(r.ok());
+    EXPECT_EQ(-42, v);
+    EXPECT_STREQ("abc", std::string(r.ptr, 3).c_str());
+    EXPECT_TRUE(parse("000000000000000000000000000017", v).ok());
+    EXPECT_EQ(17, v);
+    EXPECT_TRUE(parse("-0", v).ok());
+    EXPECT_EQ(0, v);
+
+    // errors point at first, no whitespace, '+' or bare sign.
+    const char *bad[] = {"", "-", "+1", " 1", "x1", "--1"};
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        v = 9;
+        const std::string s(bad[i]);
+        r = parse(s, v);
+        EXPECT_EQ(std::errc::invalid_argument, r.ec) << s;
+        EXPECT_EQ(s.data(), r.ptr) << s;
+        EXPECT_EQ(9, v);
+    }
+
+    expect_limits<int8_t>();
+    expect_limits<uint8_t>();
+    expect_limits<int16_t>();
+    expect_limits<uint16_t>();
+    expect_limits<int32_t>();
+    expect_limits<uint32_t>();
+    expect_limits<int64_t>();
+    expect_limits<uint64_t>();
+
+    uint64_t u = 0;
+    EXPECT_EQ(std::errc::result_out_of_range, parse("99999999999999999999", u).ec);
+    EXPECT_EQ(std::errc::result_out_of_range, parse("100000000000000000000000", u).ec);
+
+    EXPECT_TRUE(parse("ff", v, 16).ok());
+    EXPECT_EQ(255, v);
+    EXPECT_TRUE(parse("-Zz", v, 36).ok());
+    EXPECT_EQ(-(35 * 36 + 35), v);
+    r = parse("1012", v, 2);
+    EXPECT_EQ(5, v);
+    EXPECT_EQ('2', *r.ptr);
+    EXPECT_TRUE(parse("ffffffffffffffff", u, 16).ok());
+    EXPECT_EQ(~uint64_t(0), u);
+    EXPECT_EQ(std::errc::result_out_of_range, parse("10000000000000000", u, 16).ec);
+
+    const wsl::string_view view("1234;");
+    r = wsl::from_chars(view, v);
+    EXPECT_EQ(1234, v);
+    EXPECT_EQ(view.data() + 4, r.ptr);
+    const char bytes[] = {'7', '7'};
+    EXPECT_TRUE(wsl::from_chars(wsl::buffer_view<const char>(bytes, 2), v).ok());
+    EXPECT_EQ(77, v);
+    EXPECT_TRUE(wsl::from_chars(wsl::buffer_view<const char>(bytes, 2), v, 8).ok());
+    EXPECT_EQ(63, v);
+}
+
+// every length and alignment of the 8 digit blocks, against strtoull.
+TEST(charconv, swar_lengths)
+{
+    std::mt19937_64 rng(46);
+    for (int round = 0; round < 2000; ++round) {
+        const size_t n = 1 + round % 20;
+        std::string s;
+        for (size_t i = 0; i < n; ++i) {
+            s += static_cast<char>('0' + rng() % 10);
+        }
+        const std::string stop = s + static_cast<char>(" x.9"[rng() % 3]);
+        uint64_t v = 0;
+        const wsl::from_chars_result r = parse(stop, v);
+        errno = 0;
+        const unsigned long long expected = std::strtoull(s.c_str(), WALLE_NULL, 10);
+        if (errno == ERANGE) {
+            EXPECT_EQ(std::errc::result_out_of_range, r.ec) << s;
+        } else {
+            ASSERT_TRUE(r.ok()) << s;
+            EXPECT_EQ(expected, v) << s;
+        }
+        EXPECT_EQ(stop.data() + n, r.ptr) << stop;
+    }
+}
+
+TEST(charconv, floating_point)
+{
+    double d = 0;
+    EXPECT_TRUE(parse("1.5", d).ok());
+    EXPECT_EQ(1.5, d);
+    EXPECT_TRUE(parse("-.25e1", d).ok());
+    EXPECT_EQ(-2.5, d);
+    EXPECT_TRUE(parse("1e22", d).ok());
+    EXPECT_EQ(1e22, d);
+    EXPECT_TRUE(parse("1e23", d).ok());
+    EXPECT_EQ(1e23, d);
+    EXPECT_TRUE(parse("4.9406564584124654e-324", d).ok());
+    EXPECT_EQ(std::numeric_limits<double>::denorm_min(), d);
+    EXPECT_TRUE(parse("1.7976931348623157e308", d).ok());
+    EXPECT_EQ(std::numeric_limits<double>::max(), d);
+    EXPECT_TRUE(parse("-0.0", d).ok());
+    EXPECT_TRUE(d == 0 && std::signbit(d));
+    EXPECT_TRUE(parse("0e999999999999", d).ok());
+    EXPECT_EQ(0, d);
+    // 2^53 + 1 and the halfway points around it round to even.
+    EXPECT_TRUE(parse("9007199254740993", d).ok());
+    EXPECT_EQ(9007199254740992.0, d);
+    EXPECT_TRUE(parse("9007199254740995", d).ok());
+    EXPECT_EQ(9007199254740996.0, d);
+    // just above halfway, decided by the 30th digit.
+    EXPECT_TRUE(parse("9007199254740993.00000000000001", d).ok());
+    EXPECT_EQ(9007199254740994.0, d);
+
+    wsl::from_chars_result r;
+    const char *parts[][2] = {
+        {"1.", "1."}, {"1e", "1"}, {"1e+", "1"}, {"1e+2x", "1e+2"}, {"2.5E-3;", "2.5E-3"},
+        {"inf", "inf"}, {"-Infinity", "-Infinity"}, {"infin", "inf"}, {"nan(0x1f)", "nan(0x1f)"},
+        {"nan(", "nan"}, {"NaN", "NaN"}
+    };
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); ++i) {
+        const std::string s(parts[i][0]);
+        r = parse(s, d);
+        EXPECT_TRUE(r.ok()) << s;
+        EXPECT_EQ(std::strlen(parts[i][1]), size_t(r.ptr - s.data())) << s;
+    }
+    parse("-inf", d);
+    EXPECT_TRUE(std::isinf(d) && d < 0);
+    parse("nan", d);
+    EXPECT_TRUE(std::isnan(d));
+
+    const char *bad[] = {"", ".", "-", "+1", "e5", " 1", "-.e1", "in"};
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        const std::string s(bad[i]);
+        d = 3;
+        r = parse(s, d);
+        EXPECT_EQ(std::errc::invalid_argument, r.ec) << s;
+        EXPECT_EQ(s.data(), r.ptr) << s;
+        EXPECT_EQ(3, d);
+    }
+
+    d = 3;
+    const std::string huge("1e309");
+    r = parse(huge, d);
+    EXPECT_EQ(std::errc::result_out_of_range, r.ec);
+    EXPECT_EQ(huge.data() + huge.size(), r.ptr);
+    EXPECT_EQ(std::errc::result_out_of_range, parse("-1e-400", d).ec);
+    EXPECT_EQ(3, d);
+
+    float f = 0;
+    EXPECT_TRUE(parse("3.4028235e38", f).ok());
+    EXPECT_EQ(std::numeric_limits<float>::max(), f);
+    EXPECT_TRUE(parse("1.4e-45", f).ok());
+    EXPECT_EQ(std::numeric_limits<float>::denorm_min(), f);
+    EXPECT_EQ(std::errc::result_out_of_range, parse("3.5e38", f).ec);
+    EXPECT_TRUE(parse("16777217", f).ok());
+    EXPECT_EQ(16777216.0f, f);
+
+    const wsl::string_view view("0.125,");
+    r = wsl::from_chars(view, d);
+    EXPECT_EQ(0.125, d);
+    EXPECT_EQ(view.data() + 5, r.ptr);
+}
+
+// random doubles printed with 17 digits, and random digit strings of any
+// length and exponent, bit exact against strtod / strtof.
+TEST(charconv, random_against_strtod)
+{
+    std::mt19937_64 rng(46);
+    char buf[64];
+    for (int i = 0; i < 200000; ++i) {
+        uint64_t bits = rng();
+        double x;
+        std::memcpy(&x, &bits, sizeof(x));
+        if (!std::isfinite(x)) {
+            continue;
+        }
+        std::snprintf(buf, sizeof(buf), "%.*g", int(1 + rng() % 17), x);
+        double d = 0;
+        const wsl::from_chars_result r = wsl::from_chars(buf, buf + std::strlen(buf), d);
+        const double expected = std::strtod(buf, WALLE_NULL);
+        if (expected == 0 || std::isinf(expected)) {
+            continue;
+        }
+        ASSERT_TRUE(r.ok()) << buf;
+        ASSERT_EQ(0, std::memcmp(&expected, &d, sizeof(d))) << buf;
+    }
+    for (int i = 0; i < 100000; ++i) {
+        std::string s;
+        const size_t digits = 1 + rng() % 40;
+        for (size_t j = 0; j < digits; ++j) {
+            s += static_cast<char>('0' + rng() % 10);
+        }
+        s.insert(rng() % (s.size() + 1), ".");
+        s += "e" + std::to_string(int(rng() % 700) - 350);
+        double d = 0;
+        float f = 0;
+        const wsl::from_chars_result r = parse(s, d);
+        const double expected = std::strtod(s.c_str(), WALLE_NULL);
+        if (std::isinf(expected) || (expected == 0 && s.find_first_of("123456789") < s.find('e'))) {
+            ASSERT_EQ(std::errc::result_out_of_range, r.ec) << s;
+        } else {
+            ASSERT_TRUE(r.ok()) << s;
+            ASSERT_EQ(0, std::memcmp(&expected, &d, sizeof(d))) << s;
+        }
+        const float expected_float = std::strtof(s.c_str(), WALLE_NULL);
+        if (parse(s, f).ok()) {
+            ASSERT_EQ(0, std::memcmp(&expected_float, &f, sizeof(f))) << s;
+        } else {
+            ASSERT_TRUE(expected_float == 0 || std::isinf(expected_float)) << s;
+        }
+    }
+}
@@ -0,0 +1,199 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/concurrent_hash_map.h>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+TEST(concurrent_hash_map, basic)
+{
+    wsl::concurrent_hash_map<int, int> m(4);
+    EXPECT_EQ(4u, m.shard_count());
+    EXPECT_TRUE(m.empty());
+    int v = 0;
+    EXPECT_FALSE(m.find(1, v));
+    EXPECT_TRUE(m.insert(1, 10));
+    EXPECT_FALSE(m.insert(1, 11));
+    EXPECT_EQ(10, m.get(1));
+    EXPECT_FALSE(m.insert_or_assign(1, 12));
+    EXPECT_TRUE(m.insert_or_assign(2, 20));
+    EXPECT_TRUE(m.find(1, v));
+    EXPECT_EQ(12, v);
+    EXPECT_EQ(-1, m.get(3, -1));
+
+    int calls = 0;
+    EXPECT_EQ(30, m.compute_if_absent(3, [&calls]() { ++calls; return 30; }));
+    EXPECT_EQ(30, m.compute_if_absent(3, [&calls]() { ++calls; return 31; }));
+    EXPECT_EQ(1, calls);
+    EXPECT_TRUE(m.compute_if_present(3, [](int &x) { x += 5; }));
+    EXPECT_FALSE(m.compute_if_present(4, [](int &x) { x += 5; }));
+    EXPECT_EQ(35, m.get(3));
+    EXPECT_EQ(3u, m.size());
+
+    EXPECT_TRUE(m.erase(2));
+    EXPECT_FALSE(m.erase(2));
+    EXPECT_FALSE(m.contains(2));
+    EXPECT_EQ(2u, m.size());
+
+    m.clear();
+    EXPECT_TRUE(m.empty());
+    EXPECT_FALSE(m.contains(1));
+
+    // non trivially copyable keys and values take the locked read path.
+    wsl::concurrent_hash_map<std::string, std::string> s;
+    s.insert_or_assign("key", std::string(100, 'v'));
+    EXPECT_EQ(std::string(100, 'v'), s.get("key"));
+    EXPECT_EQ("none", s.get("other", "none"));
+    EXPECT_EQ("made", s.compute_if_absent("other", []() { return std::string("made"); }));
+    EXPECT_TRUE(s.erase("key"));
+    EXPECT_EQ(1u, s.size());
+}
+
+// inserts and erases against std::unordered_map, through many growths
+// with migrations in flight.
+TEST(concurrent_hash_map, random)
+{
+    std::mt19937_64 rng(48);
+    wsl::concurrent_hash_map<uint64_t, uint64_t> m(2);
+    std::unordered_map<uint64_t, uint64_t> ref;
+    bool saw_migration = false;
+    for (int round = 0; round < 300000; ++round) {
+        const uint64_t k = rng() % (round < 150000 ? 50000 : 2000);
+        uint64_t v = 0;
+        switch (rng() % 4) {
+        case 0:
+        case 1:
+            ASSERT_EQ(ref.find(k) == ref.end(), m.insert_or_assign(k, uint64_t(round)));
+            ref[k] = uint64_t(round);
+            break;
+        case 2:
+            ASSERT_EQ(ref.erase(k) == 1, m.erase(k));
+            break;
+        default:
+            ASSERT_EQ(ref.find(k) != ref.end(), m.find(k, v));
+            if (ref.find(k) != ref.end()) {
+                ASSERT_EQ(ref[k], v);
+            }
+        }
+        ASSERT_EQ(ref.size(), m.size());
+        if (round % 1000 == 0 && m.get_stats().migrating) {
+            saw_migration = true;
+        }
+    }
+    EXPECT_TRUE(saw_migration);
+    for (std::unordered_map<uint64_t, uint64_t>::iterator it = ref.begin(); it != ref.end(); ++it) {
+        ASSERT_EQ(it->second, m.get(it->first));
+    }
+    const wsl::concurrent_hash_map<uint64_t, uint64_t>::shard_stats st = m.get_stats();
+    EXPECT_EQ(ref.size(), st.size);
+    EXPECT_GT(st.grows, 0u);
+    EXPECT_GT(st.retired_bytes, 0u);
+    EXPECT_GE(st.capacity * 3 / 4, st.size);
+}
+
+struct update_error {};
+
+static void throwing_update(uint64_t &v)
+{
+    v = 999;
+    throw update_error();
+}
+
+// a write that throws leaves the value alone and the shard readable.
+TEST(concurrent_hash_map, throwing_update)
+{
+    wsl::concurrent_hash_map<uint64_t, uint64_t> m(1);
+    for (uint64_t k = 0; k < 100; ++k) {
+        m.insert(k, k);
+    }
+    EXPECT_THROW(m.compute_if_present(7, throwing_update), update_error);
+    EXPECT_THROW(m.compute_if_present(8, throwing_update), update_error);
+
+    // a version left odd would make this lookup spin forever.
+    std::atomic<bool> done(false);
+    uint64_t v = 0;
+    std::thread reader([&m, &done, &v]() {
+        m.find(7, v);
+        done.store(true);
+    });
+    for (int i = 0; i < 5000 && !done.load(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(done.load());
+    reader.join();
+    EXPECT_EQ(7u, v);
+    EXPECT_EQ(8u, m.get(8));
+
+    // writes and growth go on as before.
+    for (uint64_t k = 100; k < 1000; ++k) {
+        m.insert(k, k);
+    }
+    EXPECT_TRUE(m.compute_if_present(7, [](uint64_t &x) { x += 1; }));
+    EXPECT_EQ(8u, m.get(7));
+    EXPECT_EQ(1000u, m.size());
+}
+
+struct pair_value {
+    uint64_t a;
+    uint64_t b;
+};
+
+// readers never see a torn value or a value of another key while writers
+// assign, erase and grow the same shards.
+TEST(concurrent_hash_map, threads)
+{
+    static const uint64_t kKeys = 4096;
+    wsl::concurrent_hash_map<uint64_t, pair_value> m(8);
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> bad(0);
+    std::atomic<uint64_t> hits(0);
+    std::vector<std::thread> threads;
+    for (int r = 0; r < 4; ++r) {
+        threads.push_back(std::thread([&, r]() {
+            std::mt19937_64 rng(static_cast<uint64_t>(r));
+            while (!stop.load(std::memory_order_relaxed)) {
+                const uint64_t k = rng() % kKeys;
+                pair_value v;
+                if (m.find(k, v)) {
+                    hits.fetch_add(1, std::memory_order_relaxed);
+                    if (v.a / kKeys != k || v.b != ~v.a) {
+                        bad.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        }));
+    }
+    for (int w = 0; w < 2; ++w) {
+        threads.push_back(std::thread([&, w]() {
+            std::mt19937_64 rng(uint64_t(100 + w));
+            for (int i = 0; i < 200000; ++i) {
+                const uint64_t k = rng() % kKeys;
+                if (rng() % 8 == 0) {
+                    m.erase(k);
+                } else {
+                    pair_value v;
+                    v.a = k * kKeys + uint64_t(i) % kKeys;
+                    v.b = ~v.a;
+                    m.insert_or_assign(k, v);
+                }
+            }
+        }));
+    }
+    threads[4].join();
+    threads[5].join();
+    stop.store(true);
+    for (int r = 0; r < 4; ++r) {
+        threads[size_t(r)].join();
+    }
+    EXPECT_EQ(0u, bad.load());
+    EXPECT_GT(hits.load(), 0u);
+    for (uint64_t k = 0; k < kKeys; ++k) {
+        pair_value v;
+        if (m.find(k, v)) {
+            ASSERT_EQ(k, v.a / kKeys);
+        }
+    }
+}
@@ -0,0 +1,188 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/flat_hash_map.h>
+#include <walle/wsl/flat_hash_set.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+TEST(flat_hash_map, basic)
+{
+    wsl::flat_hash_map<int, int> m;
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(0u, m.capacity());
+    EXPECT_TRUE(m.begin() == m.end());
+    EXPECT_TRUE(m.find(1) == m.end());
+    EXPECT_EQ(0u, m.erase(1));
+
+    EXPECT_TRUE(m.insert(std::make_pair(1, 10)).second);
+    EXPECT_FALSE(m.insert(std::make_pair(1, 11)).second);
+    EXPECT_EQ(10, m[1]);
+    m[2] = 20;
+    EXPECT_TRUE(m.emplace(3, 30).second);
+    EXPECT_FALSE(m.try_emplace(3, 31).second);
+    EXPECT_FALSE(m.insert_or_assign(3, 32).second);
+    EXPECT_EQ(32, m.at(3));
+    EXPECT_EQ(3u, m.size());
+    EXPECT_EQ(16u, m.capacity());
+    EXPECT_TRUE(m.contains(2));
+    EXPECT_EQ(1u, m.count(2));
+    EXPECT_EQ(0u, m.count(4));
+
+    int sum = 0;
+    for (wsl::flat_hash_map<int, int>::const_iterator it = m.begin(); it != m.end(); ++it) {
+        sum += it->first * 100 + it->second;
+    }
+    EXPECT_EQ(600 + 62, sum);
+
+    EXPECT_EQ(1u, m.erase(2));
+    EXPECT_FALSE(m.contains(2));
+    EXPECT_EQ(2u, m.size());
+
+    wsl::flat_hash_map<int, int> copy(m);
+    EXPECT_TRUE(copy == m);
+    copy[4] = 40;
+    EXPECT_TRUE(copy != m);
+    wsl::flat_hash_map<int, int> moved(std::move(copy));
+    EXPECT_EQ(3u, moved.size());
+    EXPECT_TRUE(copy.empty());
+    copy = moved;
+    EXPECT_TRUE(copy == moved);
+    swap(copy, m);
+    EXPECT_EQ(3u, m.size());
+
+    m.clear();
+    EXPECT_TRUE(m.empty());
+    EXPECT_EQ(16u, m.capacity());
+    EXPECT_TRUE(m.begin() == m.end());
+    m.rehash(0);
+    EXPECT_EQ(0u, m.capacity());
+
+    const wsl::flat_hash_map<int, std::string> init({{1, "one"}, {2, "two"}});
+    EXPECT_EQ("two", init.at(2));
+    EXPECT_EQ("one", init.find(1)->second);
+}
+
+TEST(flat_hash_map, string_keys)
+{
+    wsl::flat_hash_map<std::string, int> m;
+    m["alpha"] = 1;
+    m["beta"] = 2;
+    m.insert(std::make_pair(std::string(100, 'x'), 3));
+
+    // views, c strings and wsl strings probe without building a key.
+    EXPECT_EQ(1, m.find(wsl::string_view("alpha"))->second);
+    EXPECT_TRUE(m.find(wsl::string_view("alph")) == m.end());
+    EXPECT_TRUE(m.contains("beta"));
+    EXPECT_EQ(3, m.at(wsl::string_view(std::string(100, 'x').c_str())));
+    EXPECT_TRUE(m.contains(wsl::string("alpha")));
+    EXPECT_EQ(1u, m.erase(wsl::string_view("beta")));
+    EXPECT_EQ(2u, m.size());
+
+    // erase by iterator still picks the iterator overload.
+    wsl::flat_hash_map<std::string, int>::iterator it = m.find("alpha");
+    m.erase(it);
+    EXPECT_EQ(1u, m.size());
+
+    wsl::flat_hash_map<wsl::string, int> w;
+    w[wsl::string("k")] = 5;
+    EXPECT_EQ(5, w.at("k"));
+    EXPECT_TRUE(w.contains(std::string("k")));
+
+    wsl::flat_hash_set<std::string> s({"a", "b", "c"});
+    EXPECT_TRUE(s.contains(wsl::string_view("b")));
+    EXPECT_FALSE(s.contains("d"));
+    EXPECT_EQ(1u, s.erase("c"));
+    EXPECT_EQ(2u, s.size());
+}
+
+static int g_live = 0;
+
+struct counted {
+    explicit counted(int v = 0) : value(v) { ++g_live; }
+    counted(const counted &o) : value(o.value) { ++g_live; }
+    counted(counted &&o) : value(o.value) { ++g_live; }
+    ~counted() { --g_live; }
+    counted &operator=(const counted &o) { value = o.value; return *this; }
+
+    int value;
+};
+
+TEST(flat_hash_map, lifetimes)
+{
+    {
+        wsl::flat_hash_map<int, counted> m;
+        for (int i = 0; i < 1000; ++i) {
+            m.try_emplace(i, i);
+        }
+        EXPECT_EQ(1000, g_live);
+        for (int i = 0; i < 1000; i += 2) {
+            m.erase(i);
+        }
+        EXPECT_EQ(500, g_live);
+        wsl::flat_hash_map<int, counted> copy(m);
+        EXPECT_EQ(1000, g_live);
+        copy.clear();
+        EXPECT_EQ(500, g_live);
+    }
+    EXPECT_EQ(0, g_live);
+
+    wsl::flat_hash_map<int, std::unique_ptr<int> > owners;
+    for (int i = 0; i < 100; ++i) {
+        owners[i].reset(new int(i));
+    }
+    owners.rehash(1000);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(i, *owners[i]);
+    }
+}
+
+// random inserts and erases against std::unordered_map, with key ranges
+// that cycle the table through tombstone rebuilds and growth.
+TEST(flat_hash_map, random)
+{
+    std::mt19937_64 rng(47);
+    wsl::flat_hash_map<uint64_t, uint64_t> m;
+    std::unordered_map<uint64_t, uint64_t> ref;
+    for (int round = 0; round < 400000; ++round) {
+        const uint64_t range = round < 200000 ? 5000 : 100000;
+        const uint64_t k = rng() % range;
+        switch (rng() % 4) {
+        case 0:
+        case 1:
+            m[k] = uint64_t(round);
+            ref[k] = uint64_t(round);
+            break;
+        case 2:
+            ASSERT_EQ(ref.erase(k), m.erase(k));
+            break;
+        default: {
+            wsl::flat_hash_map<uint64_t, uint64_t>::iterator it = m.find(k);
+            std::unordered_map<uint64_t, uint64_t>::iterator rit = ref.find(k);
+            ASSERT_EQ(rit == ref.end(), it == m.end());
+            if (rit != ref.end()) {
+                ASSERT_EQ(rit->second, it->second);
+            }
+        }
+        }
+        ASSERT_EQ(ref.size(), m.size());
+        ASSERT_LE(m.size(), m.capacity() * 7 / 8);
+    }
+    size_t n = 0;
+    for (wsl::flat_hash_map<uint64_t, uint64_t>::iterator it = m.begin(); it != m.end(); ++it, ++n) {
+        ASSERT_EQ(ref[it->first], it->second);
+    }
+    EXPECT_EQ(ref.size(), n);
+
+    // erase while iterating.
+    for (wsl::flat_hash_map<uint64_t, uint64_t>::iterator it = m.begin(); it != m.end();) {
+        it = it->first % 3 ? m.erase(it) : ++it;
+    }
+    for (wsl::flat_hash_map<uint64_t, uint64_t>::iterator it = m.begin(); it != m.end(); ++it) {
+        ASSERT_EQ(0u, it->first % 3);
+    }
+
+    m.reserve(1 << 20);
+    EXPECT_GE(m.capacity() * 7 / 8, size_t(1) << 20);
+}
@@ -0,0 +1,168 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/lru_cache.h>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(lru_cache, basic)
+{
+    wsl::lru_cache<int, std::string> c(100, 4);
+    EXPECT_EQ(4u, c.shard_count());
+    EXPECT_TRUE(c.empty());
+    std::string v;
+    EXPECT_FALSE(c.find(1, v));
+    EXPECT_TRUE(c.insert(1, "one"));
+    EXPECT_TRUE(c.insert(2, "two"));
+    EXPECT_TRUE(c.find(1, v));
+    EXPECT_EQ("one", v);
+    EXPECT_TRUE(c.insert(1, "uno"));
+    EXPECT_TRUE(c.find(1, v));
+    EXPECT_EQ("uno", v);
+    EXPECT_TRUE(c.contains(2));
+    EXPECT_EQ(2u, c.size());
+
+    EXPECT_TRUE(c.erase(2));
+    EXPECT_FALSE(c.erase(2));
+    EXPECT_FALSE(c.contains(2));
+
+    wsl::lru_cache<int, std::string>::stats st = c.get_stats();
+    EXPECT_EQ(1u, st.size);
+    EXPECT_EQ(1u, st.usage);
+    EXPECT_EQ(100u, st.capacity);
+    EXPECT_EQ(2u, st.hits);
+    EXPECT_EQ(1u, st.misses);
+    EXPECT_EQ(3u, st.inserts);
+    EXPECT_EQ(0u, st.evictions);
+
+    c.clear();
+    EXPECT_TRUE(c.empty());
+    EXPECT_EQ(0u, c.get_stats().usage);
+
+    // the default shard count leaves shards of at least 32.
+    wsl::lru_cache<int, int> small(64);
+    EXPECT_EQ(2u, small.shard_count());
+}
+
+TEST(lru_cache, clock)
+{
+    std::vector<int> evicted;
+    wsl::lru_cache<int, int> c(4, 1, [&evicted](const int &k, int &v) {
+        EXPECT_EQ(k * 10, v);
+        evicted.push_back(k);
+    });
+    for (int k = 1; k <= 4; ++k) {
+        c.insert(k, k * 10);
+    }
+    int v = 0;
+    EXPECT_TRUE(c.find(1, v));
+    EXPECT_TRUE(c.find(2, v));
+
+    // 1 and 2 were read again, 3 goes first, then 4, then the new 5.
+    c.insert(5, 50);
+    ASSERT_EQ(1u, evicted.size());
+    EXPECT_EQ(3, evicted[0]);
+    c.insert(6, 60);
+    EXPECT_EQ(4, evicted[1]);
+    EXPECT_TRUE(c.contains(1));
+    EXPECT_TRUE(c.contains(2));
+    EXPECT_TRUE(c.contains(6));
+    c.insert(7, 70);
+    EXPECT_EQ(5, evicted[2]);
+    EXPECT_EQ(4u, c.size());
+    EXPECT_EQ(3u, c.get_stats().evictions);
+
+    // erase and clear don't call back.
+    c.erase(1);
+    c.clear();
+    EXPECT_EQ(3u, evicted.size());
+}
+
+TEST(lru_cache, charge)
+{
+    size_t evicted_bytes = 0;
+    wsl::lru_cache<std::string, std::string> c(100, 1,
+        [&evicted_bytes](const std::string &, std::string &v) { evicted_bytes += v.size(); });
+    EXPECT_TRUE(c.insert("a", std::string(40, 'a'), 40));
+    EXPECT_TRUE(c.insert("b", std::string(40, 'b'), 40));
+    EXPECT_EQ(80u, c.get_stats().usage);
+    EXPECT_TRUE(c.insert("c", std::string(40, 'c'), 40));
+    EXPECT_EQ(40u, evicted_bytes);
+    EXPECT_FALSE(c.contains("a"));
+    EXPECT_EQ(80u, c.get_stats().usage);
+
+    // a replaced value changes the charge, and can push others out.
+    EXPECT_TRUE(c.insert("b", std::string(90, 'b'), 90));
+    EXPECT_EQ(90u, c.get_stats().usage);
+    EXPECT_EQ(1u, c.size());
+
+    // heavier than the shard: not cached, the old value goes too.
+    EXPECT_FALSE(c.insert("b", std::string(101, 'b'), 101));
+    EXPECT_FALSE(c.contains("b"));
+    EXPECT_EQ(0u, c.get_stats().usage);
+    EXPECT_TRUE(c.empty());
+}
+
+TEST(lru_cache, values_released)
+{
+    std::shared_ptr<int> p(new int(7));
+    {
+        wsl::lru_cache<int, std::shared_ptr<int> > c(2, 1);
+        c.insert(1, p);
+        c.insert(2, p);
+        EXPECT_EQ(3, p.use_count());
+        c.insert(3, std::shared_ptr<int>());
+        EXPECT_EQ(2, p.use_count());
+        c.erase(2);
+        EXPECT_EQ(1, p.use_count());
+        c.insert(4, p);
+    }
+    EXPECT_EQ(1, p.use_count());
+}
+
+// readers and loaders on shared keys: values always match their keys and
+// every shard stays within capacity.
+TEST(lru_cache, threads)
+{
+    std::atomic<size_t> evictions(0);
+    wsl::lru_cache<uint64_t, uint64_t> c(1000, 8, [&evictions](const uint64_t &k, uint64_t &v) {
+        EXPECT_EQ(k * 3, v);
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    });
+    std::atomic<uint64_t> bad(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 6; ++t) {
+        threads.push_back(std::thread([&, t]() {
+            std::mt19937_64 rng(static_cast<uint64_t>(t));
+            for (int i = 0; i < 100000; ++i) {
+                // a skewed key space: low keys come up far more often.
+                const uint64_t k = (rng() % 64) * (rng() % 64);
+                uint64_t v = 0;
+                if (c.find(k, v)) {
+                    if (v != k * 3) {
+                        bad.fetch_add(1, std::memory_order_relaxed);
+                    }
+                } else {
+                    c.insert(k, k * 3);
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    EXPECT_EQ(0u, bad.load());
+    const wsl::lru_cache<uint64_t, uint64_t>::stats st = c.get_stats();
+    EXPECT_EQ(600000u, st.hits + st.misses);
+    EXPECT_EQ(st.misses, st.inserts);
+    EXPECT_EQ(evictions.load(), st.evictions);
+    // two loaders of one key both insert, the second replaces.
+    EXPECT_GE(st.inserts - st.evictions, st.size);
+    EXPECT_GT(st.hits, st.misses);
+    for (size_t i = 0; i < c.shard_count(); ++i) {
+        const wsl::lru_cache<uint64_t, uint64_t>::stats s = c.get_shard_stats(i);
+        EXPECT_LE(s.usage, s.capacity);
+    }
+}
@@ -0,0 +1,97 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/mpmc_queue.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(mpmc_queue, try_ops)
+{
+    wsl::mpmc_queue<std::string> q(3);
+    EXPECT_EQ(4, q.capacity());
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(q.try_push(std::to_string(i)));
+    }
+    EXPECT_FALSE(q.try_push("full"));
+    std::string out;
+    EXPECT_TRUE(q.try_pop(out));
+    EXPECT_EQ("0", out);
+    EXPECT_EQ(3, q.size_approx());
+}
+
+TEST(mpmc_queue, batch)
+{
+    wsl::mpmc_queue<int> q(8);
+    const int in[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int out[10];
+    EXPECT_EQ(8, q.try_push_n(in, 10));
+    EXPECT_EQ(0, q.try_push_n(in, 10));
+    EXPECT_EQ(5, q.try_pop_n(out, 5));
+    EXPECT_EQ(4, out[4]);
+    EXPECT_EQ(2, q.try_push_n(in + 8, 2));
+    EXPECT_EQ(5, q.try_pop_n(out, 10));
+    EXPECT_EQ(9, out[4]);
+    EXPECT_EQ(0, q.try_pop_n(out, 10));
+
+    // zero items return at once, on a queue neither full nor empty too.
+    EXPECT_EQ(0, q.try_pop_n(out, 0));
+    EXPECT_EQ(0, q.pop_n(out, 0));
+    EXPECT_EQ(3, q.try_push_n(in, 3));
+    EXPECT_EQ(0, q.try_push_n(in, 0));
+    EXPECT_EQ(0, q.try_pop_n(out, 0));
+    EXPECT_EQ(0, q.pop_n(out, 0));
+    q.push_n(in, 0);
+    EXPECT_EQ(3, q.try_pop_n(out, 10));
+    EXPECT_EQ(2, out[2]);
+}
+
+TEST(mpmc_queue, timed)
+{
+    wsl::mpmc_queue<int> q(2);
+    int v;
+    EXPECT_FALSE(q.pop_for(v, std::chrono::milliseconds(5)));
+    q.push(1);
+    q.push(2);
+    EXPECT_FALSE(q.push_for(3, std::chrono::milliseconds(5)));
+    EXPECT_TRUE(q.pop_for(v, std::chrono::milliseconds(5)));
+    EXPECT_EQ(1, v);
+}
+
+TEST(mpmc_queue, blocking_threads)
+{
+    const uint64_t per_producer = 100000;
+    const int producers = 4;
+    const int consumers = 4;
+    wsl::mpmc_queue<uint64_t> q(64);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.push_back(std::thread([&q, per_producer]() {
+            for (uint64_t i = 1; i <= per_producer; ++i) {
+                q.push(i);
+            }
+        }));
+    }
+    std::vector<uint64_t> sums(consumers, 0);
+    for (int c = 0; c < consumers; ++c) {
+        threads.push_back(std::thread([&q, &sums, c, per_producer, producers, consumers]() {
+            uint64_t buf[16];
+            uint64_t left = per_producer * producers / consumers;
+            while (left) {
+                const size_t n = q.pop_n(buf, left < 16 ? left : 16);
+                for (size_t i = 0; i < n; ++i) {
+                    sums[c] += buf[i];
+                }
+                left -= n;
+            }
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    uint64_t total = 0;
+    for (int c = 0; c < consumers; ++c) {
+        total += sums[c];
+    }
+    EXPECT_EQ(producers * per_producer * (per_producer + 1) / 2, total);
+}
@@ -0,0 +1,223 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/multi_matcher.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<uint32_t, size_t> > match_list;
+
+static wsl::multi_matcher::callback_type collect(match_list *out)
+{
+    return [out](uint32_t id, size_t offset) {
+        out->push_back(std::make_pair(id, offset));
+        return true;
+    };
+}
+
+static bool same_byte(char a, char b, bool ignore_case)
+{
+    return ignore_case ? wsl::ascii::to_lower(static_cast<unsigned char>(a)) ==
+                         wsl::ascii::to_lower(static_cast<unsigned char>(b)) : a == b;
+}
+
+static match_list brute_force(const std::vector<std::string> &patterns, const std::string &text,
+                              bool ignore_case)
+{
+    match_list r;
+    for (size_t id = 0; id < patterns.size(); ++id) {
+        const std::string &p = patterns[id];
+        for (size_t i = 0; i + p.size() <= text.size(); ++i) {
+            size_t k = 0;
+            while (k < p.size() && same_byte(text[i + k], p[k], ignore_case)) {
+                ++k;
+            }
+            if (k == p.size()) {
+                r.push_back(std::make_pair(static_cast<uint32_t>(id), i));
+            }
+        }
+    }
+    std::sort(r.begin(), r.end());
+    return r;
+}
+
+static std::string random_string(std::mt19937 &rng, size_t len, const char *alphabet, size_t k)
+{
+    std::string s;
+    for (size_t i = 0; i < len; ++i) {
+        s.push_back(alphabet[rng() % k]);
+    }
+    return s;
+}
+
+TEST(multi_matcher, basic)
+{
+    wsl::multi_matcher m;
+    EXPECT_EQ(0u, m.add("he"));
+    EXPECT_EQ(1u, m.add("she"));
+    EXPECT_EQ(2u, m.add("his"));
+    EXPECT_EQ(3u, m.add("hers"));
+    m.compile();
+    EXPECT_EQ(4u, m.size());
+    EXPECT_EQ(wsl::string_view("hers"), m.pattern(3));
+    match_list found;
+    EXPECT_EQ(3u, m.match("ushers", collect(&found)));
+    // reported in order of their end offsets.
+    ASSERT_EQ(3u, found.size());
+    EXPECT_EQ(std::make_pair(1u, size_t(1)), found[0]);
+    EXPECT_EQ(std::make_pair(0u, size_t(2)), found[1]);
+    EXPECT_EQ(std::make_pair(3u, size_t(2)), found[2]);
+    EXPECT_TRUE(m.contains_any("this"));
+    EXPECT_FALSE(m.contains_any("hx hrs"));
+    EXPECT_FALSE(m.contains_any(""));
+}
+
+TEST(multi_matcher, stop_early)
+{
+    wsl::multi_matcher m;
+    m.add("a");
+    m.add("aa");
+    m.compile();
+    size_t calls = 0;
+    EXPECT_EQ(3u, m.match("aaaa", [&calls](uint32_t, size_t) { return ++calls < 3; }));
+    EXPECT_EQ(3u, calls);
+}
+
+TEST(multi_matcher, matches_brute_force)
+{
+    std::mt19937 rng(21);
+    for (int round = 0; round < 300; ++round) {
+        const bool ignore_case = round % 2;
+        const char *alphabet = ignore_case ? "abAB\xe4" : "abc\xe4";
+        std::vector<std::string> patterns;
+        const size_t count = 1 + rng() % 40;
+        for (size_t i = 0; i < count; ++i) {
+            patterns.push_back(random_string(rng, 1 + rng() % 6, alphabet, 3 + rng() % 2));
+        }
+        wsl::multi_matcher m(ignore_case);
+        for (size_t i = 0; i < patterns.size(); ++i) {
+            m.add(wsl::string_view(patterns[i].data(), patterns[i].size()));
+        }
+        m.compile();
+        const std::string text = random_string(rng, rng() % 300, "abcAB\xe4x", 7);
+        match_list found;
+        m.match(wsl::string_view(text.data(), text.size()), collect(&found));
+        std::sort(found.begin(), found.end());
+        ASSERT_EQ(brute_force(patterns, text, ignore_case), found) << round;
+
+        // the same text fed in random chunks.
+        match_list streamed;
+        wsl::multi_matcher::stream s(m);
+        for (size_t at = 0; at < text.size();) {
+            const size_t len = std::min(text.size() - at, size_t(rng() % 8));
+            ASSERT_TRUE(s.feed(wsl::string_view(text.data() + at, len), collect(&streamed)));
+            at += len;
+        }
+        EXPECT_EQ(text.size(), s.offset());
+        std::sort(streamed.begin(), streamed.end());
+        ASSERT_EQ(found, streamed) << round;
+    }
+}
+
+TEST(multi_matcher, many_patterns)
+{
+    std::mt19937 rng(4);
+    std::vector<std::string> patterns;
+    wsl::multi_matcher m(true);
+    for (size_t i = 0; i < 5000; ++i) {
+        patterns.push_back(random_string(rng, 3 + rng() % 10, "abcdefghijklmnopqrstuvwxyz", 26));
+        m.add(wsl::string_view(patterns.back().data(), patterns.back().size()));
+    }
+    m.compile();
+    EXPECT_GT(m.memory_usage(), 0u);
+    EXPECT_LE(m.state_count(), 50000u);
+    std::string text = random_string(rng, 8000, "abcdefghijklmnopqrstuvwxyz ", 27);
+    // plant upper case copies of a few patterns.
+    for (size_t i = 0; i < 20; ++i) {
+        std::string p = patterns[rng() % patterns.size()];
+        wsl::ascii::to_upper(wsl::buffer_view<char>(&p[0], p.size()));
+        text.replace(rng() % (text.size() - 20), p.size(), p);
+    }
+    match_list found;
+    m.match(wsl::string_view(text.data(), text.size()), collect(&found));
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(brute_force(patterns, text, true), found);
+}
+
+TEST(multi_matcher, long_input_lanes)
+{
+    // long enough for the interleaved lanes, with matches across lane starts.
+    std::mt19937 rng(8);
+    std::vector<std::string> patterns;
+    wsl::multi_matcher m;
+    for (size_t i = 0; i < 50; ++i) {
+        patterns.push_back(random_string(rng, 2 + rng() % 5, "abc", 3));
+        m.add(wsl::string_view(patterns.back().data(), patterns.back().size()));
+    }
+    m.compile();
+    const std::string text = random_string(rng, 4 * wsl::multi_matcher::kLaneBytes + 1234, "abcd", 4);
+    const wsl::string_view tv(text.data(), text.size());
+    match_list found;
+    m.match(tv, collect(&found));
+    for (size_t i = 1; i < found.size(); ++i) {
+        const size_t prev_end = found[i - 1].second + patterns[found[i - 1].first].size();
+        ASSERT_LE(prev_end, found[i].second + patterns[found[i].first].size());
+    }
+    match_list sorted(found);
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(brute_force(patterns, text, false), sorted);
+
+    // stopping in a later lane leaves the stream at that occurrence.
+    const size_t stop_at = found.size() * 3 / 4;
+    size_t calls = 0;
+    wsl::multi_matcher::stream s(m);
+    EXPECT_FALSE(s.feed(tv, [&calls, stop_at](uint32_t, size_t) { return ++calls <= stop_at; }));
+    EXPECT_EQ(stop_at + 1, calls);
+    EXPECT_FALSE(s.feed(tv, [](uint32_t, size_t) { return true; }));
+
+    // chunks of two lanes worth carry their state across.
+    match_list streamed;
+    s.reset();
+    const size_t chunk = 2 * 4 * wsl::multi_matcher::kLaneBytes / 3 * 2;
+    for (size_t at = 0; at < text.size(); at += chunk) {
+        s.feed(tv.substr(at, chunk), collect(&streamed));
+    }
+    EXPECT_EQ(found, streamed);
+}
+
+TEST(multi_matcher, dense_hits_over_windows)
+{
+    // a hit on most bytes over several windows, with a short rest.
+    wsl::multi_matcher m;
+    m.add("a");
+    m.add("aba");
+    m.compile();
+    std::mt19937 rng(40);
+    const std::string text = random_string(rng, 5 * wsl::multi_matcher::kWindowBytes + 777, "aaab", 4);
+    const wsl::string_view tv(text.data(), text.size());
+    std::vector<std::string> patterns;
+    patterns.push_back("a");
+    patterns.push_back("aba");
+    match_list found;
+    EXPECT_EQ(brute_force(patterns, text, false).size(), m.match(tv, collect(&found)));
+    match_list sorted(found);
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(brute_force(patterns, text, false), sorted);
+
+    // the first hit stops the scan.
+    size_t calls = 0;
+    EXPECT_EQ(1u, m.match(tv, [&calls](uint32_t, size_t) { ++calls; return false; }));
+    EXPECT_EQ(1u, calls);
+
+    // a stop in a later window reports exactly the hits before it.
+    const size_t stop_at = found.size() * 2 / 3;
+    match_list head;
+    wsl::multi_matcher::stream st(m);
+    EXPECT_FALSE(st.feed(tv, [&head, stop_at](uint32_t id, size_t offset) {
+        head.push_back(std::make_pair(id, offset));
+        return head.size() <= stop_at;
+    }));
+    ASSERT_EQ(stop_at + 1, head.size());
+    EXPECT_TRUE(std::equal(head.begin(), head.end(), found.begin()));
+}
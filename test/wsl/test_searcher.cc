@@ -0,0 +1,124 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/searcher.h>
+#include <random>
+#include <string>
+
+static const size_t kNpos = size_t(-1);
+
+static const wsl::searcher::algorithm kAlgorithms[] = {
+    wsl::searcher::kAuto, wsl::searcher::kPrefilter, wsl::searcher::kHorspool, wsl::searcher::kTwoWay
+};
+
+static const wsl::internal::simd_isa kIsas[] = {
+    wsl::internal::kSimdSse2, wsl::internal::kSimdAvx2
+};
+
+static size_t to_pos(std::string::size_type p)
+{
+    return p == std::string::npos ? kNpos : p;
+}
+
+static std::string random_string(std::mt19937 &rng, size_t len, const char *alphabet, size_t k)
+{
+    std::string s;
+    for (size_t i = 0; i < len; ++i) {
+        s.push_back(alphabet[rng() % k]);
+    }
+    return s;
+}
+
+TEST(searcher, small_needles)
+{
+    wsl::searcher empty;
+    EXPECT_EQ(wsl::searcher::kEmpty, empty.get_algorithm());
+    EXPECT_EQ(3u, empty.find("abc", 3));
+    EXPECT_EQ(kNpos, empty.find("abc", 4));
+
+    wsl::searcher one("c");
+    EXPECT_EQ(wsl::searcher::kByte, one.get_algorithm());
+    EXPECT_EQ(2u, one.find("abcabc"));
+    EXPECT_EQ(5u, one.find("abcabc", 3));
+    EXPECT_EQ(kNpos, one.find("ab"));
+
+    wsl::searcher s("needle");
+    EXPECT_EQ(wsl::searcher::kPrefilter, s.get_algorithm());
+    EXPECT_EQ(wsl::string_view("needle"), s.needle());
+    EXPECT_TRUE(s.contains("a needle in a haystack"));
+    EXPECT_FALSE(s.contains("a needl in a haystack"));
+    EXPECT_EQ(kNpos, s.find("needl"));
+}
+
+TEST(searcher, auto_selection)
+{
+    std::mt19937 rng(3);
+    // long needles over all 256 byte values shift far enough for horspool.
+    std::string bytes;
+    for (size_t i = 0; i < 2000; ++i) {
+        bytes.push_back(static_cast<char>(rng()));
+    }
+    EXPECT_EQ(wsl::searcher::kHorspool, wsl::searcher(wsl::string_view(bytes.data(), bytes.size())).get_algorithm());
+    const std::string text = random_string(rng, 2000, "abcdefghijklmnopqrstuvwxyz ", 27);
+    EXPECT_EQ(wsl::searcher::kPrefilter, wsl::searcher(wsl::string_view(text.data(), text.size())).get_algorithm());
+}
+
+TEST(searcher, matches_std_string)
+{
+    std::mt19937 rng(11);
+    for (size_t isa = 0; isa < 2; ++isa) {
+        if (!wsl::internal::set_search_isa(kIsas[isa])) {
+            continue;
+        }
+        for (int round = 0; round < 4000; ++round) {
+            // small alphabets give periodic needles and many partial matches.
+            const size_t k = 2 + rng() % 3;
+            const std::string hay = random_string(rng, rng() % 400, "ab\xe9z", k);
+            const size_t m = 1 + (round % 3 == 0 ? rng() % 200 : rng() % 12);
+            std::string needle = random_string(rng, m, "ab\xe9z", k);
+            if (!hay.empty() && round % 2) {
+                // a needle taken from the haystack matches at least once.
+                const size_t at = rng() % hay.size();
+                needle = hay.substr(at, m);
+            }
+            const size_t pos = rng() % (hay.size() + 2);
+            for (size_t a = 0; a < 4; ++a) {
+                wsl::searcher s(wsl::string_view(needle.data(), needle.size()), kAlgorithms[a]);
+                ASSERT_EQ(to_pos(hay.find(needle, pos)), s.find(wsl::string_view(hay.data(), hay.size()), pos))
+                    << hay << " / " << needle << " algorithm " << a;
+            }
+        }
+    }
+}
+
+TEST(searcher, degenerate_inputs_fall_back)
+{
+    // every window passes the prefilter and the horspool last byte check.
+    const std::string hay(100000, 'a');
+    std::string needle(40, 'a');
+    needle[0] = 'b';
+    for (size_t a = 0; a < 4; ++a) {
+        wsl::searcher s(wsl::string_view(needle.data(), needle.size()), kAlgorithms[a]);
+        EXPECT_EQ(kNpos, s.find(wsl::string_view(hay.data(), hay.size())));
+        const std::string with_match = hay + needle;
+        EXPECT_EQ(hay.size(), s.find(wsl::string_view(with_match.data(), with_match.size())));
+    }
+}
+
+TEST(searcher, reuse_across_haystacks)
+{
+    const char *pattern = "ERROR [replication] lost lease on shard";
+    wsl::searcher s(pattern);
+    std::string log;
+    size_t expected = kNpos;
+    for (int i = 0; i < 1000; ++i) {
+        log += "INFO [replication] renewed lease on shard 17\n";
+        if (i == 700) {
+            expected = log.size();
+            log += pattern;
+            log += " 17\n";
+        }
+    }
+    EXPECT_EQ(expected, s.find(wsl::string_view(log.data(), log.size())));
+    EXPECT_EQ(kNpos, s.find(wsl::string_view(log.data(), log.size()), expected + 1));
+    wsl::searcher copy = s;
+    EXPECT_EQ(expected, copy.find(wsl::string_view(log.data(), log.size())));
+}
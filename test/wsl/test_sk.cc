@@ -18,4 +18,26 @@ TEST(multi_skip_list, insert)
     sl.insert(1);
     sl.insert(1);
     EXPECT_EQ(4, sl.size());
-}
\ No newline at end of file
+}
+TEST(skip_list, erase_by_iterator)
+{
+    wsl::skip_list<int> sl;
+    for (int i = 0; i < 10; ++i) {
+        sl.insert(i);
+    }
+    sl.insert(sl.find(5), 5);
+    EXPECT_EQ(10u, sl.size());
+    wsl::skip_list<int>::iterator it = sl.erase(sl.find(3));
+    EXPECT_EQ(4, *it);
+    sl.erase(sl.find(6), sl.end());
+    EXPECT_EQ(5u, sl.size());
+    EXPECT_EQ(5, sl.back());
+
+    wsl::multi_skip_list<int> multi;
+    multi.insert(1);
+    multi.insert(1);
+    multi.insert(2);
+    multi.erase(multi.begin(), multi.find(2));
+    EXPECT_EQ(1u, multi.size());
+    EXPECT_EQ(2, multi.front());
+}
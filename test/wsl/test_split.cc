@@ -0,0 +1,153 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/split.h>
+#include <random>
+#include <string>
+#include <vector>
+
+static const wsl::internal::simd_isa kIsas[] = {
+    wsl::internal::kSimdSse2, wsl::internal::kSimdAvx2
+};
+
+static const size_t kNoLimit = size_t(-1);
+
+static std::vector<std::string> collect(const wsl::split_range &range)
+{
+    std::vector<std::string> pieces;
+    for (wsl::split_range::iterator it = range.begin(); it != range.end(); ++it) {
+        pieces.push_back(std::string(it->data(), it->size()));
+    }
+    return pieces;
+}
+
+static std::vector<std::string> naive_split(const std::string &text, const std::string &delims,
+                                            bool skip_empty, size_t max_split)
+{
+    std::vector<std::string> pieces;
+    size_t pos = 0;
+    size_t splits = 0;
+    for (;;) {
+        if (splits == max_split || delims.empty()) {
+            if (skip_empty) {
+                pos = std::min(text.find_first_not_of(delims, pos), text.size());
+            }
+            if (!skip_empty || pos < text.size()) {
+                pieces.push_back(text.substr(pos));
+            }
+            return pieces;
+        }
+        const size_t d = text.find_first_of(delims, pos);
+        const size_t end = d == std::string::npos ? text.size() : d;
+        if (!skip_empty || end > pos) {
+            pieces.push_back(text.substr(pos, end - pos));
+            if (d != std::string::npos) {
+                ++splits;
+            }
+        }
+        if (d == std::string::npos) {
+            return pieces;
+        }
+        pos = d + 1;
+    }
+}
+
+TEST(split, basic)
+{
+    std::vector<std::string> expect;
+    expect.push_back("a");
+    expect.push_back("");
+    expect.push_back("b");
+    expect.push_back("");
+    EXPECT_EQ(expect, collect(wsl::split("a,,b,", ',')));
+
+    expect.clear();
+    expect.push_back("a");
+    expect.push_back("b");
+    EXPECT_EQ(expect, collect(wsl::split(",a,,b,", ',', true)));
+
+    // an empty text is one empty piece, or nothing skipping empty pieces.
+    EXPECT_EQ(std::vector<std::string>(1), collect(wsl::split("", ',')));
+    EXPECT_TRUE(collect(wsl::split("", ',', true)).empty());
+    EXPECT_TRUE(collect(wsl::split(",,,", ',', true)).empty());
+
+    // no delimiters, the text is one piece.
+    EXPECT_EQ(std::vector<std::string>(1, "a,b"), collect(wsl::split("a,b", "")));
+
+    expect.clear();
+    expect.push_back("GET");
+    expect.push_back("/index.html");
+    expect.push_back("HTTP/1.1");
+    EXPECT_EQ(expect, collect(wsl::split("GET /index.html\tHTTP/1.1\r\n", " \t\r\n", true)));
+
+    const wsl::string_view text("key=value");
+    wsl::split_range range = wsl::split(text, '=');
+    wsl::split_range::iterator it = range.begin();
+    EXPECT_EQ(text.data(), it->data());
+    EXPECT_EQ(wsl::string_view("value"), *++it);
+    EXPECT_TRUE(++it == range.end());
+}
+
+TEST(split, max_split)
+{
+    std::vector<std::string> expect;
+    expect.push_back("a");
+    expect.push_back("b,c,d");
+    EXPECT_EQ(expect, collect(wsl::split("a,b,c,d", ',', false, 1)));
+    EXPECT_EQ(std::vector<std::string>(1, "a,b,c,d"), collect(wsl::split("a,b,c,d", ',', false, 0)));
+
+    // empty pieces and the delimiters leading the rest are skipped.
+    expect.clear();
+    expect.push_back("a");
+    expect.push_back("b");
+    expect.push_back("c  d ");
+    EXPECT_EQ(expect, collect(wsl::split("  a  b  c  d ", ' ', true, 2)));
+}
+
+TEST(split, block_boundaries)
+{
+    for (size_t k = 0; k < sizeof(kIsas) / sizeof(kIsas[0]); ++k) {
+        if (!wsl::internal::set_search_isa(kIsas[k])) {
+            continue;
+        }
+        // a delimiter at every offset around the 64 byte blocks.
+        for (size_t len = 0; len < 200; ++len) {
+            for (size_t at = 0; at < len; at += 7) {
+                std::string text(len, 'x');
+                text[at] = '\t';
+                text[len - 1 - at / 2] = '\n';
+                for (int skip = 0; skip < 2; ++skip) {
+                    EXPECT_EQ(naive_split(text, "\t", skip, kNoLimit),
+                              collect(wsl::split(wsl::string_view(text.data(), text.size()), '\t', skip)));
+                    EXPECT_EQ(naive_split(text, "\t\n", skip, kNoLimit),
+                              collect(wsl::split(wsl::string_view(text.data(), text.size()), "\t\n", skip)));
+                }
+            }
+        }
+    }
+    wsl::internal::set_search_isa(wsl::internal::best_simd_isa());
+}
+
+TEST(split, random)
+{
+    std::mt19937 rng(41);
+    const char *delim_sets[] = { ",", " \t", "|;:", "\x80\xff", " \t\r\n\v\f" };
+    const char alphabet[] = "ab,|; \t:\r\n\x80\xff";
+    for (size_t k = 0; k < sizeof(kIsas) / sizeof(kIsas[0]); ++k) {
+        if (!wsl::internal::set_search_isa(kIsas[k])) {
+            continue;
+        }
+        for (size_t round = 0; round < 400; ++round) {
+            std::string text;
+            const size_t len = rng() % 300;
+            for (size_t i = 0; i < len; ++i) {
+                text.push_back(alphabet[rng() % (sizeof(alphabet) - 1)]);
+            }
+            const std::string delims = delim_sets[round % 5];
+            const bool skip = rng() % 2;
+            const size_t max_split = rng() % 3 ? kNoLimit : rng() % 10;
+            EXPECT_EQ(naive_split(text, delims, skip, max_split),
+                      collect(wsl::split(wsl::string_view(text.data(), text.size()),
+                                         wsl::string_view(delims.data(), delims.size()), skip, max_split)));
+        }
+    }
+    wsl::internal::set_search_isa(wsl::internal::best_simd_isa());
+}
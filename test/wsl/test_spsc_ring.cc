@@ -0,0 +1,70 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/spsc_ring.h>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+TEST(spsc_ring, push_pop)
+{
+    wsl::spsc_ring<std::string> ring(3);
+    EXPECT_EQ(4, ring.capacity());
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.try_push(std::to_string(i)));
+    }
+    EXPECT_FALSE(ring.try_push("full"));
+    std::string out;
+    EXPECT_TRUE(ring.try_pop(out));
+    EXPECT_EQ("0", out);
+    EXPECT_TRUE(ring.try_emplace(3, 'x'));
+    EXPECT_EQ(4, ring.size());
+    EXPECT_EQ("1", *ring.front());
+}
+
+TEST(spsc_ring, spans_wrap)
+{
+    wsl::spsc_ring<int> ring(8);
+    int in[6] = {0, 1, 2, 3, 4, 5};
+    int out[6];
+    EXPECT_EQ(6, ring.push_n(in, 6));
+    EXPECT_EQ(6, ring.pop_n(out, 6));
+    // the tail is now 2 slots before the storage end.
+    wsl::buffer_view<int> span = ring.push_n(5);
+    EXPECT_EQ(2, span.size());
+    span[0] = 10;
+    span[1] = 11;
+    ring.produce(2);
+    EXPECT_EQ(6, ring.push_n(in, 6));
+    EXPECT_EQ(0, ring.push_n(1).size());
+    wsl::buffer_view<int> ready = ring.pop_n(8);
+    ASSERT_EQ(2, ready.size());
+    EXPECT_EQ(11, ready[1]);
+    ring.consume(2);
+    EXPECT_EQ(6, ring.pop_n(out, 6));
+    EXPECT_EQ(5, out[5]);
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(spsc_ring, threads)
+{
+    const uint64_t count = 1000000;
+    wsl::spsc_ring<uint64_t> ring(1024);
+    std::thread producer([&ring, count]() {
+        for (uint64_t i = 0; i < count; ) {
+            wsl::buffer_view<uint64_t> span = ring.push_n(64);
+            size_t n = 0;
+            for (; n < span.size() && i < count; ++n) {
+                span[n] = i++;
+            }
+            ring.produce(n);
+        }
+    });
+    uint64_t expect = 0;
+    while (expect < count) {
+        uint64_t v;
+        if (ring.try_pop(v)) {
+            ASSERT_EQ(expect, v);
+            ++expect;
+        }
+    }
+    producer.join();
+}
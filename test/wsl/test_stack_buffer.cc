@@ -1,8 +1,133 @@
 #include <google/gtest/gtest.h>
 #include <walle/wsl/stack_buffer.h>
+#include <walle/wsl/container_buffer.h>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 TEST(stack_buffer, empty)
 {
     wsl::stack_buffer<char, 4096> sv;
     EXPECT_EQ(0, sv.size());
-}
\ No newline at end of file
+}
+
+TEST(stack_buffer, grow)
+{
+    wsl::stack_buffer<int, 4> sb;
+    for (int i = 0; i < 100; ++i) {
+        sb.push_back(i);
+    }
+    EXPECT_FALSE(sb.is_stack());
+    EXPECT_EQ(100, sb.size());
+    EXPECT_EQ(99, sb[99]);
+    const int more[] = {100, 101};
+    sb.append(more, more + 2);
+    EXPECT_EQ(102, sb.size());
+    EXPECT_EQ(101, sb[101]);
+
+    wsl::stack_buffer<int, 4> moved(std::move(sb));
+    EXPECT_EQ(102, moved.size());
+    EXPECT_EQ(50, moved[50]);
+
+    // the moved from buffer is empty and usable again, on its inline array.
+    EXPECT_EQ(0, sb.size());
+    EXPECT_EQ(4, sb.capacity());
+    EXPECT_TRUE(sb.is_stack());
+    for (int i = 0; i < 10; ++i) {
+        sb.push_back(i);
+    }
+    sb.append(more, more + 2);
+    EXPECT_EQ(12, sb.size());
+    EXPECT_EQ(101, sb[11]);
+
+    wsl::stack_buffer<int, 4> small;
+    small.push_back(7);
+    wsl::stack_buffer<int, 4> moved_small(std::move(small));
+    EXPECT_EQ(7, moved_small[0]);
+    EXPECT_EQ(0, small.size());
+    small.append(more, more + 2);
+    EXPECT_EQ(100, small[0]);
+
+    // move assignment from a heap backed buffer.
+    moved_small = std::move(moved);
+    EXPECT_EQ(102, moved_small.size());
+    EXPECT_EQ(0, moved.size());
+    moved.append(more, more + 2);
+    EXPECT_EQ(2, moved.size());
+}
+
+TEST(stack_buffer, no_vtable)
+{
+    EXPECT_FALSE((std::is_polymorphic<wsl::stack_buffer<char, 16> >::value));
+    EXPECT_FALSE((std::is_polymorphic<wsl::container_buffer<std::string> >::value));
+}
+
+TEST(stack_buffer, realloc_growth)
+{
+    wsl::stack_buffer<char, 16> sb;
+    std::string expect;
+    for (int i = 0; i < 1 << 20; ++i) {
+        sb.push_back(static_cast<char>('a' + i % 26));
+        expect.push_back(static_cast<char>('a' + i % 26));
+    }
+    EXPECT_EQ(expect, std::string(sb.data(), sb.size()));
+}
+
+struct counted {
+    int value;
+    counted() : value(0) {}
+    counted(int v) : value(v) {}
+    counted(const counted &other) : value(other.value) {}
+    counted &operator=(const counted &other) { value = other.value; return *this; }
+};
+
+TEST(stack_buffer, non_trivial)
+{
+    EXPECT_FALSE(std::is_trivially_copyable<counted>::value);
+    wsl::stack_buffer<counted, 2> sb;
+    for (int i = 0; i < 100; ++i) {
+        sb.push_back(counted(i));
+    }
+    EXPECT_EQ(0, sb[0].value);
+    EXPECT_EQ(99, sb[99].value);
+}
+
+TEST(stack_buffer, growth_policy)
+{
+    wsl::stack_buffer<int, 4, wsl::malloc_allocator<int>, wsl::grow_double> dbl;
+    dbl.resize(5);
+    EXPECT_EQ(8, dbl.capacity());
+    wsl::stack_buffer<int, 4, wsl::malloc_allocator<int>, wsl::grow_exact> exact;
+    exact.resize(5);
+    EXPECT_EQ(5, exact.capacity());
+    EXPECT_TRUE(wsl::has_reallocate<wsl::malloc_allocator<int> >::value);
+    EXPECT_FALSE(wsl::has_reallocate<std::allocator<int> >::value);
+}
+
+static void append_hello(wsl::internal::basic_buffer<char> &buf)
+{
+    const char hello[] = "hello, world";
+    buf.append(hello, sizeof(hello) - 1);
+}
+
+TEST(stack_buffer, type_erased)
+{
+    wsl::stack_buffer<char, 4> sb;
+    {
+        wsl::internal::buffer_adapter<wsl::stack_buffer<char, 4> > erased(sb);
+        append_hello(erased);
+        append_hello(erased);
+    }
+    EXPECT_EQ(std::string("hello, worldhello, world"), std::string(sb.data(), sb.size()));
+}
+
+TEST(container_buffer, grow)
+{
+    std::vector<char> v;
+    wsl::container_buffer<std::vector<char> > cb(v);
+    const char data[] = "abc";
+    cb.append(data, 3);
+    cb.push_back('d');
+    EXPECT_EQ(4, cb.size());
+    EXPECT_EQ(std::string("abcd"), std::string(v.data(), 4));
+}
@@ -0,0 +1,101 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/static_string_map.h>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum command {
+    kNone,
+    kGet,
+    kSet,
+    kDel,
+    kIncr
+};
+
+TEST(static_string_map, basic)
+{
+    static const wsl::static_string_map<command> commands({
+        {"get", kGet}, {"set", kSet}, {"del", kDel}, {"incr", kIncr}
+    });
+    EXPECT_EQ(4u, commands.size());
+    EXPECT_EQ(kGet, commands.get("get"));
+    EXPECT_EQ(kSet, commands.get("set"));
+    EXPECT_EQ(kDel, commands.get("del"));
+    EXPECT_EQ(kIncr, commands.get("incr"));
+    EXPECT_EQ(kNone, commands.get("GET"));
+    EXPECT_EQ(kNone, commands.get("ge"));
+    EXPECT_EQ(kNone, commands.get("gets"));
+    EXPECT_EQ(kNone, commands.get(""));
+    EXPECT_TRUE(commands.contains("del"));
+    EXPECT_TRUE(commands.find("delete") == WALLE_NULL);
+
+    // the map owns copies of the keys.
+    std::vector<std::pair<wsl::string_view, int> > items;
+    std::string key("temporary");
+    items.push_back(std::make_pair(wsl::string_view(key.data(), key.size()), 7));
+    wsl::static_string_map<int> owned(items.begin(), items.end());
+    key = "overwrite";
+    EXPECT_EQ(7, owned.get("temporary"));
+    EXPECT_EQ(0, owned.get("overwrite"));
+
+    const wsl::static_string_map<int> empty({});
+    EXPECT_EQ(0u, empty.size());
+    EXPECT_FALSE(empty.contains(""));
+    EXPECT_FALSE(empty.contains("x"));
+
+    const wsl::static_string_map<int> only_empty({{"", 3}});
+    EXPECT_EQ(3, only_empty.get(""));
+    EXPECT_EQ(-1, only_empty.get("a", -1));
+    // a default view has a null data().
+    EXPECT_EQ(3, only_empty.get(wsl::string_view()));
+    EXPECT_FALSE(commands.contains(wsl::string_view()));
+}
+
+TEST(static_string_map, copy)
+{
+    wsl::static_string_map<command> *source = new wsl::static_string_map<command>({
+        {"get", kGet}, {"set", kSet}, {"del", kDel}, {"incr", kIncr}
+    });
+    wsl::static_string_map<command> copy(*source);
+    wsl::static_string_map<command> assigned({{"x", kNone}});
+    assigned = *source;
+    delete source;
+    // the copies hold their own keys.
+    EXPECT_EQ(kGet, copy.get("get"));
+    EXPECT_EQ(kIncr, copy.get("incr"));
+    EXPECT_EQ(kNone, copy.get("incx"));
+    EXPECT_EQ(kDel, assigned.get("del"));
+    EXPECT_FALSE(assigned.contains("x"));
+}
+
+TEST(static_string_map, sizes)
+{
+    std::mt19937 rng(45);
+    for (size_t n = 1; n <= 2000; n = n * 3 / 2 + 1) {
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < n; ++i) {
+            std::string k = "key_" + std::to_string(i);
+            const size_t extra = rng() % 20;
+            for (size_t j = 0; j < extra; ++j) {
+                k += static_cast<char>('a' + rng() % 26);
+            }
+            // no key is a prefix of another.
+            keys.push_back(k + "#");
+        }
+        std::vector<std::pair<wsl::string_view, size_t> > items;
+        for (size_t i = 0; i < n; ++i) {
+            items.push_back(std::make_pair(wsl::string_view(keys[i].data(), keys[i].size()), i + 1));
+        }
+        const wsl::static_string_map<size_t> map(items.begin(), items.end());
+        ASSERT_EQ(n, map.size());
+        EXPECT_GE(map.table_size() * 4, n * 5);
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(i + 1, map.get(wsl::string_view(keys[i].data(), keys[i].size()))) << n;
+            // a prefix or an extension of a key is a miss.
+            const std::string longer = keys[i] + "!";
+            ASSERT_EQ(0u, map.get(wsl::string_view(longer.data(), longer.size())));
+            ASSERT_EQ(0u, map.get(wsl::string_view(keys[i].data(), keys[i].size() - 1)));
+        }
+    }
+}
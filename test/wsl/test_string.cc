@@ -0,0 +1,195 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/string.h>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+
+static size_t g_allocations = 0;
+
+template <typename T>
+struct counting_allocator : public wsl::malloc_allocator<T> {
+    T *allocate(size_t n)
+    {
+        ++g_allocations;
+        return wsl::malloc_allocator<T>::allocate(n);
+    }
+};
+
+typedef wsl::basic_string<char, counting_allocator<char> > counted_string;
+
+TEST(string, basic)
+{
+    wsl::string s;
+    EXPECT_TRUE(s.empty());
+    EXPECT_STREQ("", s.c_str());
+    EXPECT_EQ(31u, s.capacity());
+
+    s = "hello";
+    s += ' ';
+    s += "world";
+    s.append(3, '!');
+    EXPECT_EQ("hello world!!!", s);
+    EXPECT_EQ(wsl::string_view("hello world!!!"), s.view());
+    EXPECT_STREQ("hello world!!!", s.c_str());
+    EXPECT_EQ(6u, s.find("world"));
+    EXPECT_EQ(11u, s.find('!'));
+    EXPECT_EQ(13u, s.rfind('!'));
+    EXPECT_TRUE(s.starts_with("hello"));
+    EXPECT_TRUE(s.ends_with("!!"));
+    EXPECT_FALSE(s.ends_with("?"));
+
+    s.insert(5, ",");
+    EXPECT_EQ("hello, world!!!", s);
+    s.erase(12);
+    EXPECT_EQ("hello, world", s);
+    s.replace(0, 5, "goodbye");
+    EXPECT_EQ("goodbye, world", s);
+    EXPECT_EQ("world", s.substr(9));
+    s.insert(0, 2, '>');
+    EXPECT_EQ(">>goodbye, world", s);
+    s.pop_back();
+    EXPECT_EQ('l', s.back());
+    EXPECT_EQ('>', s.front());
+
+    EXPECT_TRUE(wsl::string("abc") < wsl::string("abd"));
+    EXPECT_TRUE(wsl::string("ab") < wsl::string("abc"));
+    EXPECT_TRUE(wsl::string("abc") > wsl::string("ab"));
+    EXPECT_EQ(0, wsl::string("abc").compare("abc"));
+    EXPECT_TRUE(wsl::string("abc") != "abd");
+    EXPECT_EQ(wsl::string("key=value"), wsl::string("key=") + wsl::string_view("value"));
+
+    const std::string std_str("from std::string");
+    EXPECT_EQ(std_str, wsl::string(std_str).str());
+
+    wsl::u16string u(u"wide");
+    u.push_back(u'!');
+    EXPECT_EQ(wsl::u16string_view(u"wide!"), u.view());
+    EXPECT_EQ(15u, u.capacity());
+
+    EXPECT_EQ(wsl::hash<wsl::string_view>()(wsl::string_view("key")), wsl::hash<wsl::string>()(wsl::string("key")));
+}
+
+TEST(string, inline_storage)
+{
+    g_allocations = 0;
+    // typical keys stay inside the object, std::string would allocate.
+    counted_string key("session:0123456789abcdef:uid");
+    EXPECT_TRUE(key.is_inline());
+    counted_string copy(key);
+    counted_string moved(std::move(copy));
+    EXPECT_EQ(key, moved);
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(0u, g_allocations);
+
+    counted_string big(100, 'x');
+    EXPECT_FALSE(big.is_inline());
+    EXPECT_EQ(1u, g_allocations);
+    const char *heap = big.data();
+    counted_string stolen(std::move(big));
+    EXPECT_EQ(heap, stolen.data());
+    EXPECT_TRUE(big.is_inline());
+    EXPECT_EQ(1u, g_allocations);
+
+    stolen.resize(10);
+    stolen.shrink_to_fit();
+    EXPECT_TRUE(stolen.is_inline());
+    EXPECT_EQ(counted_string(10, 'x'), stolen);
+
+    counted_string a("short");
+    counted_string b(64, 'y');
+    a.swap(b);
+    EXPECT_EQ(counted_string(64, 'y'), a);
+    EXPECT_EQ("short", b);
+    EXPECT_TRUE(b.is_inline());
+
+    // a bigger inline capacity.
+    wsl::basic_string<char, wsl::malloc_allocator<char>, 63> wide(63, 'z');
+    EXPECT_TRUE(wide.is_inline());
+    wide.push_back('z');
+    EXPECT_FALSE(wide.is_inline());
+}
+
+TEST(string, uninitialized)
+{
+    wsl::string s("id=");
+    char *p = s.append_uninitialized(4);
+    std::memcpy(p, "1234", 4);
+    EXPECT_EQ("id=1234", s);
+    EXPECT_EQ('\0', s.c_str()[7]);
+
+    s.resize_and_overwrite(64, [](char *buf, size_t n) {
+        return static_cast<size_t>(std::snprintf(buf, n, "%s-%d", "value", 42));
+    });
+    EXPECT_EQ("value-42", s);
+    EXPECT_GE(s.capacity(), 64u);
+
+    s.resize_uninitialized(2);
+    EXPECT_EQ("va", s);
+    s.resize(4, '.');
+    EXPECT_EQ("va..", s);
+}
+
+TEST(string, aliasing)
+{
+    wsl::string s("abcdef");
+    s.append(s.view());
+    EXPECT_EQ("abcdefabcdef", s);
+    s.append(s.view());
+    s.append(s.view());
+    EXPECT_EQ(48u, s.size());
+    EXPECT_EQ("abcdefabcdef", s.substr(36));
+
+    s.assign(s.view().substr(6, 6));
+    EXPECT_EQ("abcdef", s);
+    s.insert(3, s.view());
+    EXPECT_EQ("abcabcdefdef", s);
+    s.replace(0, 3, s.view().substr(9));
+    EXPECT_EQ("defabcdefdef", s);
+}
+
+TEST(string, random)
+{
+    std::mt19937 rng(43);
+    wsl::basic_string<char, wsl::malloc_allocator<char>, 7> s;
+    std::string expect;
+    for (int round = 0; round < 20000; ++round) {
+        const std::string piece(rng() % 20, static_cast<char>('a' + rng() % 26));
+        const size_t pos = expect.empty() ? 0 : rng() % expect.size();
+        switch (rng() % 7) {
+        case 0:
+            s.append(piece.data(), piece.size());
+            expect.append(piece);
+            break;
+        case 1:
+            s.insert(pos, wsl::string_view(piece.data(), piece.size()));
+            expect.insert(pos, piece);
+            break;
+        case 2:
+            s.erase(pos, piece.size());
+            expect.erase(pos, piece.size());
+            break;
+        case 3:
+            s.replace(pos, 3, piece.data(), piece.size());
+            expect.replace(pos, 3, piece);
+            break;
+        case 4:
+            s.push_back(piece.empty() ? '-' : piece[0]);
+            expect.push_back(piece.empty() ? '-' : piece[0]);
+            break;
+        case 5:
+            s.resize(pos, 'r');
+            expect.resize(pos, 'r');
+            break;
+        default:
+            if (expect.size() > 200) {
+                s.clear();
+                expect.clear();
+                s.shrink_to_fit();
+            }
+            break;
+        }
+        ASSERT_EQ(expect, s.str());
+        ASSERT_EQ(expect.size(), std::strlen(s.c_str()));
+    }
+}
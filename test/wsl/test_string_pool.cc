@@ -0,0 +1,125 @@
+#include <google/gtest/gtest.h>
+#include <walle/wsl/string_pool.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::string label(size_t i)
+{
+    return "metric.label." + std::to_string(i);
+}
+
+TEST(string_pool, basic)
+{
+    wsl::string_pool pool;
+    EXPECT_EQ(0u, pool.size());
+    EXPECT_EQ(wsl::string_pool::kNoSymbol, pool.find("host"));
+
+    const wsl::string_pool::symbol host = pool.intern("host");
+    const wsl::string_pool::symbol region = pool.intern("region");
+    EXPECT_EQ(0u, host);
+    EXPECT_EQ(1u, region);
+    EXPECT_EQ(host, pool.intern("host"));
+    EXPECT_EQ(host, pool.find("host"));
+    EXPECT_EQ(2u, pool.size());
+    EXPECT_EQ(wsl::string_view("region"), pool.view(region));
+    EXPECT_STREQ("host", pool.c_str(host));
+
+    // interned views of equal strings share their characters.
+    std::string copy("region");
+    const wsl::string_view a = pool.intern_view(wsl::string_view(copy.data(), copy.size()));
+    EXPECT_EQ(pool.view(region).data(), a.data());
+    EXPECT_NE(copy.data(), a.data());
+
+    const wsl::string_pool::symbol empty = pool.intern("");
+    EXPECT_EQ(0u, pool.view(empty).size());
+    EXPECT_STREQ("", pool.c_str(empty));
+    EXPECT_EQ(empty, pool.intern(wsl::string_view()));
+    EXPECT_EQ(empty, pool.find(wsl::string_view()));
+
+    // embedded nuls are part of the string.
+    const wsl::string_pool::symbol nul = pool.intern(wsl::string_view("a\0b", 3));
+    EXPECT_NE(nul, pool.intern("a"));
+    EXPECT_EQ(3u, pool.view(nul).size());
+}
+
+TEST(string_pool, growth)
+{
+    wsl::string_pool pool(1024);
+    std::vector<wsl::string_view> views;
+    for (size_t i = 0; i < 50000; ++i) {
+        const std::string s = label(i);
+        ASSERT_EQ(i, pool.intern(wsl::string_view(s.data(), s.size())));
+        views.push_back(pool.view(wsl::string_pool::symbol(i)));
+    }
+    // a string longer than a quarter arena gets its own block.
+    const std::string big(4000, 'x');
+    const wsl::string_pool::symbol big_id = pool.intern(wsl::string_view(big.data(), big.size()));
+    EXPECT_EQ(big, std::string(pool.c_str(big_id)));
+
+    for (size_t i = 0; i < 50000; ++i) {
+        const std::string s = label(i);
+        ASSERT_EQ(i, pool.find(wsl::string_view(s.data(), s.size())));
+        // views handed out earlier are still valid and unmoved.
+        ASSERT_EQ(views[i].data(), pool.view(wsl::string_pool::symbol(i)).data());
+        ASSERT_EQ(s, std::string(views[i].data(), views[i].size()));
+    }
+
+    const wsl::string_pool::stats st = pool.get_stats();
+    EXPECT_EQ(50001u, st.symbols);
+    EXPECT_GE(st.arena_bytes, st.string_bytes + st.symbols);
+}
+
+TEST(string_pool, freeze)
+{
+    wsl::string_pool pool;
+    const wsl::string_pool::symbol cpu = pool.intern("cpu");
+    pool.freeze();
+    EXPECT_TRUE(pool.frozen());
+    EXPECT_EQ(cpu, pool.intern("cpu"));
+    EXPECT_EQ(wsl::string_pool::kNoSymbol, pool.intern("mem"));
+    EXPECT_TRUE(pool.intern_view("mem").data() == WALLE_NULL);
+    EXPECT_EQ(1u, pool.size());
+}
+
+TEST(string_pool, threads)
+{
+    wsl::string_pool pool;
+    const size_t kThreads = 4;
+    const size_t kStrings = 16384;
+    std::vector<std::vector<wsl::string_pool::symbol> > ids(kThreads);
+    std::atomic<bool> bad(false);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kThreads; ++t) {
+        threads.push_back(std::thread([&pool, &ids, &bad, t, kStrings]() {
+            // every thread interns the same strings in a different order
+            // and reads back what the others have added meanwhile.
+            for (size_t k = 0; k < kStrings; ++k) {
+                const size_t i = (k * (2 * t + 1) + t * 7919) % kStrings;
+                const std::string s = label(i);
+                const wsl::string_pool::symbol id = pool.intern(wsl::string_view(s.data(), s.size()));
+                if (pool.view(id) != wsl::string_view(s.data(), s.size())) {
+                    bad = true;
+                }
+                ids[t].push_back(id);
+                const size_t n = pool.size();
+                if (n && pool.view(wsl::string_pool::symbol(n - 1)).size() < 14) {
+                    bad = true;
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < kThreads; ++t) {
+        threads[t].join();
+    }
+    EXPECT_FALSE(bad);
+    EXPECT_EQ(kStrings, pool.size());
+    for (size_t t = 0; t < kThreads; ++t) {
+        for (size_t k = 0; k < kStrings; ++k) {
+            const size_t i = (k * (2 * t + 1) + t * 7919) % kStrings;
+            const std::string s = label(i);
+            ASSERT_EQ(pool.find(wsl::string_view(s.data(), s.size())), ids[t][k]);
+        }
+    }
+}
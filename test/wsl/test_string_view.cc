@@ -10,4 +10,111 @@ TEST(string_view, empty)
     wsl::cstring_view s2(abc);
     EXPECT_EQ(true, s1 == s2);
     EXPECT_EQ(false, s1 != s2);
-}
\ No newline at end of file
+
+    // an empty needle is found in a default view, whose data() is null.
+    EXPECT_EQ(0u, sv.find(""));
+    EXPECT_EQ(0u, sv.find(wsl::string_view()));
+    EXPECT_EQ(0u, sv.rfind(""));
+    EXPECT_EQ(0u, sv.rfind(wsl::string_view()));
+    const size_t npos = wsl::string_view::npos;
+    EXPECT_EQ(npos, sv.find("", 1));
+    EXPECT_EQ(0u, sv.rfind("", 5));
+    EXPECT_EQ(npos, sv.find("a"));
+    EXPECT_EQ(npos, sv.rfind("a"));
+    EXPECT_EQ(2u, s1.find("", 2));
+    EXPECT_EQ(3u, s1.find("", 3));
+    EXPECT_EQ(npos, s1.find("", 4));
+    EXPECT_EQ(3u, s1.rfind(""));
+    EXPECT_EQ(1u, s1.rfind("", 1));
+}
+
+#include <random>
+#include <string>
+
+static const wsl::internal::simd_isa kIsas[] = {
+    wsl::internal::kSimdSse2, wsl::internal::kSimdAvx2
+};
+
+static const size_t kNpos = size_t(-1);
+
+static size_t to_pos(std::string::size_type p)
+{
+    return p == std::string::npos ? kNpos : p;
+}
+
+TEST(string_view, find_matches_std_string)
+{
+    std::mt19937 rng(7);
+    for (size_t isa = 0; isa < 2; ++isa) {
+        if (!wsl::internal::set_search_isa(kIsas[isa])) {
+            continue;
+        }
+        for (int round = 0; round < 3000; ++round) {
+            const size_t len = rng() % 150;
+            std::string hay;
+            // a small alphabet gives plenty of partial matches.
+            for (size_t i = 0; i < len; ++i) {
+                hay.push_back("abc\xe9"[rng() % 4]);
+            }
+            std::string needle;
+            const size_t nlen = rng() % 6;
+            for (size_t i = 0; i < nlen; ++i) {
+                needle.push_back("abc\xe9"[rng() % 4]);
+            }
+            const size_t pos = rng() % (len + 2);
+            wsl::string_view sv(hay.data(), hay.size());
+            wsl::string_view nv(needle.data(), needle.size());
+            ASSERT_EQ(to_pos(hay.find(needle, pos)), sv.find(nv, pos)) << hay << " / " << needle;
+            ASSERT_EQ(to_pos(hay.rfind(needle, pos)), sv.rfind(nv, pos)) << hay << " / " << needle;
+            ASSERT_EQ(to_pos(hay.rfind(needle)), sv.rfind(nv)) << hay << " / " << needle;
+            ASSERT_EQ(to_pos(hay.find(needle[0 % (nlen + 1)], pos)), sv.find(needle.c_str()[0], pos));
+            ASSERT_EQ(to_pos(hay.rfind('c', pos)), sv.rfind('c', pos));
+            ASSERT_EQ(to_pos(hay.find_first_of(needle, pos)), sv.find_first_of(nv, pos));
+            ASSERT_EQ(to_pos(hay.find_first_not_of(needle, pos)), sv.find_first_not_of(nv, pos));
+        }
+    }
+}
+
+TEST(string_view, find_byte_sets)
+{
+    // every byte value in and out of the set, at every offset of a block.
+    std::string all;
+    for (int c = 1; c < 256; ++c) {
+        all.push_back(static_cast<char>(c));
+    }
+    for (size_t isa = 0; isa < 2; ++isa) {
+        if (!wsl::internal::set_search_isa(kIsas[isa])) {
+            continue;
+        }
+        const char sets[][8] = {" \t", ",;=\x80", "\xff\x01", "aZ09_-:"};
+        for (size_t s = 0; s < sizeof(sets) / sizeof(sets[0]); ++s) {
+            wsl::string_view set(sets[s]);
+            for (size_t pos = 0; pos < all.size(); ++pos) {
+                wsl::string_view sv(all.data(), all.size());
+                std::string ref(set.data(), set.size());
+                ASSERT_EQ(to_pos(all.find_first_of(ref, pos)), sv.find_first_of(set, pos));
+                ASSERT_EQ(to_pos(all.find_first_not_of(ref, pos)), sv.find_first_not_of(set, pos));
+            }
+        }
+    }
+}
+
+TEST(string_view, find_wide)
+{
+    std::u16string s16(100, u'x');
+    std::u32string s32(100, U'x');
+    s16[77] = u'\x263a';
+    s32[91] = U'\x1f600';
+    for (size_t isa = 0; isa < 2; ++isa) {
+        if (!wsl::internal::set_search_isa(kIsas[isa])) {
+            continue;
+        }
+        wsl::u16string_view v16(s16.data(), s16.size());
+        wsl::u32string_view v32(s32.data(), s32.size());
+        EXPECT_EQ(size_t(77), v16.find(u'\x263a'));
+        EXPECT_EQ(size_t(91), v32.find(U'\x1f600'));
+        EXPECT_EQ(kNpos, v16.find(u'y'));
+        EXPECT_EQ(wsl::internal::find(s16.data(), u'\x263a', s16.size()), s16.data() + 77);
+        EXPECT_EQ(wsl::internal::find(s32.data(), U'\x1f600', s32.size()), s32.data() + 91);
+    }
+}